@@ -282,9 +282,36 @@ namespace ignition
                                           const AdvertiseServiceOptions &_other)
       {
         _out << static_cast<AdvertiseOptions>(_other);
+        if (_other.MaxConcurrency() > 0u)
+          _out << "\tMax concurrency: " << _other.MaxConcurrency() << std::endl;
         return _out;
       }
 
+      /// \brief Get the maximum number of requests of the service that run
+      /// at the same time.
+      /// \return The maximum number of requests, or 0 if the requests run on
+      /// the thread receiving them.
+      /// \sa SetMaxConcurrency.
+      public: unsigned int MaxConcurrency() const;
+
+      /// \brief Set the maximum number of requests of the service that run
+      /// at the same time. By default (0), the requests run one by one on
+      /// the thread that receives all the messages and requests of the
+      /// process, so a slow service delays everything else. With a value
+      /// N > 0, the service gets N threads of its own: up to N requests run
+      /// concurrently and each reply is sent as soon as its request
+      /// completes. The callback must then be thread safe. This option only
+      /// affects the process advertising the service. Values larger than
+      /// kMaxConcurrency are reduced to it.
+      /// \param[in] _maxConcurrency Maximum number of requests.
+      /// \sa MaxConcurrency.
+      public: void SetMaxConcurrency(const unsigned int _maxConcurrency);
+
+      /// \brief Largest maximum number of requests of a service that run at
+      /// the same time.
+      /// \sa SetMaxConcurrency.
+      public: static constexpr unsigned int kMaxConcurrency = 256;
+
       /// \brief Serialize the options. The caller has ownership of the
       /// buffer and is responsible for its [de]allocation.
       /// \param[out] _buffer Destination buffer in which the options
@@ -59,13 +59,19 @@
 #include <ignition/msgs/discovery.pb.h>
 
 #include <algorithm>
+#include <array>
 #include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
 #include <limits>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <set>
 #include <string>
 #include <thread>
+#include <utility>
 #include <vector>
 
 #include <ignition/msgs/Utility.hh>
@@ -105,6 +111,50 @@ namespace ignition
       const std::vector<int> &_sockets,
       const int _timeout);
 
+    /// \internal
+    /// \brief Discovery helper function to pack messages into datagrams.
+    /// Each message is preceded by its size (uint16_t), and a datagram holds
+    /// as many consecutive messages as fit in _maxSize bytes. A message
+    /// larger than that travels alone.
+    /// \param[in] _msgs Messages to pack.
+    /// \param[in] _maxSize Maximum size of a datagram (bytes).
+    /// \param[out] _datagrams The datagrams.
+    /// \return True on success or false if a message couldn't be packed.
+    bool IGNITION_TRANSPORT_VISIBLE packDiscoveryMsgs(
+      const std::vector<msgs::Discovery> &_msgs,
+      const std::size_t _maxSize,
+      std::vector<std::string> &_datagrams);
+
+    /// \brief Statistics about the reception of discovery messages.
+    struct DiscoveryStats
+    {
+      /// \brief Number of times that the pending datagrams were received.
+      /// On Linux, each time receives up to a batch of datagrams with a
+      /// single system call.
+      public: uint64_t batches = 0;
+
+      /// \brief Number of datagrams received.
+      public: uint64_t datagrams = 0;
+
+      /// \brief Number of discovery messages received.
+      public: uint64_t msgs = 0;
+
+      /// \brief Number of messages discarded because they were truncated,
+      /// couldn't be parsed or used another wire protocol version.
+      public: uint64_t discarded = 0;
+
+      /// \brief Number of datagrams dropped because the receive buffer of
+      /// the socket was full. Only available on Linux.
+      public: uint64_t dropped = 0;
+
+      /// \brief Time spent handling the received messages (microseconds).
+      public: uint64_t processingTime = 0;
+    };
+
+    /// \internal
+    /// \brief Gives the tests access to the internals of Discovery.
+    class DiscoveryTestHook;
+
     /// \class Discovery Discovery.hh ignition/transport/Discovery.hh
     /// \brief A discovery class that implements a distributed topic discovery
     /// protocol. It uses UDP multicast for sending/receiving messages and
@@ -221,6 +271,45 @@ namespace ignition
           return;
         }
 
+        // Socket option: SO_RCVBUF. A larger buffer absorbs the bursts of
+        // discovery messages sent when many processes start at once.
+        int recvBufferSize = kDefRecvBufferSize;
+        std::string recvBufferStr;
+        if (env("IGN_TRANSPORT_DISCOVERY_RCVBUF", recvBufferStr))
+        {
+          try
+          {
+            recvBufferSize = std::stoi(recvBufferStr);
+          }
+          catch (...)
+          {
+            std::cerr << "Invalid IGN_TRANSPORT_DISCOVERY_RCVBUF ["
+                      << recvBufferStr << "]. Using the default value ["
+                      << recvBufferSize << "]" << std::endl;
+          }
+        }
+        this->SetRecvBufferSize(recvBufferSize);
+
+        std::string adaptiveStr;
+        if (env("IGN_TRANSPORT_DISCOVERY_ADAPTIVE", adaptiveStr) &&
+            adaptiveStr == "1")
+        {
+          this->SetAdaptive(true);
+        }
+
+#ifdef SO_RXQ_OVFL
+        // Socket option: SO_RXQ_OVFL. The kernel reports with every datagram
+        // the number of datagrams dropped because the receive buffer was
+        // full.
+        int rxqOvfl = 1;
+        if (setsockopt(this->sockets.at(0), SOL_SOCKET, SO_RXQ_OVFL,
+            reinterpret_cast<const char *>(&rxqOvfl), sizeof(rxqOvfl)) != 0)
+        {
+          std::cerr << "Error setting socket option (SO_RXQ_OVFL)."
+                    << std::endl;
+        }
+#endif
+
         // Set 'mcastAddr' to the multicast discovery group.
         memset(&this->mcastAddr, 0, sizeof(this->mcastAddr));
         this->mcastAddr.sin_family = AF_INET;
@@ -301,6 +390,7 @@ namespace ignition
       /// (e.g. if the discovery has not been started).
       public: bool Advertise(const Pub &_publisher)
       {
+        uint64_t newGeneration = 0;
         {
           std::lock_guard<std::mutex> lock(this->mutex);
 
@@ -310,13 +400,19 @@ namespace ignition
           // Add the addressing information (local publisher).
           if (!this->info.AddPublisher(_publisher))
             return false;
+
+          if (_publisher.Options().Scope() != Scope_t::PROCESS)
+          {
+            newGeneration = ++this->generation;
+            this->OnTopologyChange();
+          }
         }
 
         // Only advertise a message outside this process if the scope
         // is not 'Process'
         if (_publisher.Options().Scope() != Scope_t::PROCESS)
           this->SendMsg(DestinationType::ALL, msgs::Discovery::ADVERTISE,
-              _publisher);
+              _publisher, newGeneration);
 
         return true;
       }
@@ -409,6 +505,7 @@ namespace ignition
                                const std::string &_nUuid)
       {
         Pub inf;
+        uint64_t newGeneration = 0;
         {
           std::lock_guard<std::mutex> lock(this->mutex);
 
@@ -421,6 +518,12 @@ namespace ignition
 
           // Remove the topic information.
           this->info.DelPublisherByNode(_topic, this->pUuid, _nUuid);
+
+          if (inf.Options().Scope() != Scope_t::PROCESS)
+          {
+            newGeneration = ++this->generation;
+            this->OnTopologyChange();
+          }
         }
 
         // Only unadvertise a message outside this process if the scope
@@ -428,7 +531,7 @@ namespace ignition
         if (inf.Options().Scope() != Scope_t::PROCESS)
         {
           this->SendMsg(DestinationType::ALL,
-              msgs::Discovery::UNADVERTISE, inf);
+              msgs::Discovery::UNADVERTISE, inf, newGeneration);
         }
 
         return true;
@@ -489,6 +592,7 @@ namespace ignition
       {
         std::lock_guard<std::mutex> lock(this->mutex);
         this->heartbeatInterval = _ms;
+        this->currentHeartbeatInterval = _ms;
       }
 
       /// \brief Set the maximum silence interval.
@@ -500,6 +604,46 @@ namespace ignition
         this->silenceInterval = _ms;
       }
 
+      /// \brief Enable or disable the adaptive timers. In adaptive mode, the
+      /// interval between heartbeats doubles after every heartbeat while the
+      /// topics don't change, up to kMaxHeartbeatBackoff times the heartbeat
+      /// interval, and goes back to the heartbeat interval as soon as a topic
+      /// is advertised or unadvertised anywhere. A process is considered gone
+      /// when it misses two heartbeats, plus a margin for the delays observed
+      /// in its previous heartbeats, instead of after the silence interval.
+      /// Every heartbeat carries the time until the next one, so the other
+      /// processes don't need to be in adaptive mode to follow the backoff.
+      /// It's disabled by default, and can be enabled with the
+      /// IGN_TRANSPORT_DISCOVERY_ADAPTIVE environment variable too.
+      /// \param[in] _adaptive True to enable the adaptive timers.
+      /// \sa Adaptive.
+      public: void SetAdaptive(const bool _adaptive)
+      {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->adaptive = _adaptive;
+        this->currentHeartbeatInterval = this->heartbeatInterval;
+      }
+
+      /// \brief Whether the adaptive timers are enabled.
+      /// \return True if enabled.
+      /// \sa SetAdaptive.
+      public: bool Adaptive() const
+      {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        return this->adaptive;
+      }
+
+      /// \brief Get the time until the next heartbeat, as announced in the
+      /// last heartbeat sent. It's the heartbeat interval unless the
+      /// adaptive timers are enabled.
+      /// \return The value in milliseconds.
+      /// \sa SetAdaptive.
+      public: unsigned int CurrentHeartbeatInterval() const
+      {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        return this->currentHeartbeatInterval;
+      }
+
       /// \brief Register a callback to receive discovery connection events.
       /// Each time a new topic is connected, the callback will be executed.
       /// This version uses a free function as callback.
@@ -520,6 +664,57 @@ namespace ignition
         this->disconnectionCb = _cb;
       }
 
+      /// \brief Set the size of the buffer where the socket keeps the
+      /// discovery messages received until they are handled. The system may
+      /// limit it (e.g. net.core.rmem_max on Linux).
+      /// \param[in] _bytes Size of the buffer (bytes).
+      /// \return True on success.
+      public: bool SetRecvBufferSize(const int _bytes)
+      {
+        if (_bytes <= 0 || setsockopt(this->sockets.at(0), SOL_SOCKET,
+            SO_RCVBUF, reinterpret_cast<const char *>(&_bytes),
+            sizeof(_bytes)) != 0)
+        {
+          std::cerr << "Error setting socket option (SO_RCVBUF)."
+                    << std::endl;
+          return false;
+        }
+        return true;
+      }
+
+      /// \brief Get the size of the buffer where the socket keeps the
+      /// discovery messages received until they are handled.
+      /// \return Size of the buffer (bytes) or -1 on error.
+      /// \sa SetRecvBufferSize.
+      public: int RecvBufferSize() const
+      {
+        int bytes = 0;
+        socklen_t len = sizeof(bytes);
+        if (getsockopt(this->sockets.at(0), SOL_SOCKET, SO_RCVBUF,
+            reinterpret_cast<char *>(&bytes), &len) != 0)
+        {
+          return -1;
+        }
+        return bytes;
+      }
+
+      /// \brief Get the statistics about the reception of discovery
+      /// messages.
+      /// \return The statistics.
+      public: DiscoveryStats Stats() const
+      {
+        std::lock_guard<std::mutex> lock(this->statsMutex);
+        return this->stats;
+      }
+
+      /// \brief Get the wire protocol version carried by the discovery
+      /// messages. Messages with another version are discarded.
+      /// \return The discovery version.
+      public: static uint8_t Version()
+      {
+        return kWireVersion;
+      }
+
       /// \brief Print the current discovery state.
       public: void PrintCurrentState() const
       {
@@ -559,6 +754,17 @@ namespace ignition
               << std::endl;
           }
         }
+
+        const DiscoveryStats recvStats = this->Stats();
+        std::cout << "Reception" << std::endl;
+        std::cout << "\tDatagrams: " << recvStats.datagrams << " in "
+                  << recvStats.batches << " batches" << std::endl;
+        std::cout << "\tMessages: " << recvStats.msgs << " ("
+                  << recvStats.discarded << " discarded)" << std::endl;
+        std::cout << "\tDropped datagrams: " << recvStats.dropped
+                  << std::endl;
+        std::cout << "\tProcessing time: " << recvStats.processingTime
+                  << " us." << std::endl;
         std::cout << "---------------" << std::endl;
       }
 
@@ -610,13 +816,16 @@ namespace ignition
             auto elapsed = now - it->second;
 
             // This publisher has expired.
-            if (std::chrono::duration_cast<std::chrono::milliseconds>
-                 (elapsed).count() > this->silenceInterval)
+            if (std::chrono::duration<double, std::milli>(elapsed).count() >
+                this->SilenceLimit(it->first))
             {
               // Remove all the info entries for this process UUID.
               this->info.DelPublishersByProc(it->first);
 
               uuids.push_back(it->first);
+              this->generations.erase(it->first);
+              this->syncAdvertised.erase(it->first);
+              this->peers.erase(it->first);
 
               // Remove the activity entry.
               this->activity.erase(it++);
@@ -643,7 +852,9 @@ namespace ignition
         }
       }
 
-      /// \brief Broadcast periodic heartbeats.
+      /// \brief Broadcast periodic heartbeats. A heartbeat only carries the
+      /// generation of the publishers advertised by this process. The other
+      /// processes request all of them when it doesn't match theirs.
       private: void UpdateHeartbeat()
       {
         Timestamp now = std::chrono::steady_clock::now();
@@ -653,28 +864,27 @@ namespace ignition
 
           if (now < this->timeNextHeartbeat)
             return;
-        }
-
-        Publisher pub("", "", this->pUuid, "", AdvertiseOptions());
-        this->SendMsg(DestinationType::ALL, msgs::Discovery::HEARTBEAT, pub);
 
-        std::map<std::string, std::vector<Pub>> nodes;
-        {
-          std::lock_guard<std::mutex> lock(this->mutex);
-
-          // Re-advertise topics that are advertised inside this process.
-          this->info.PublishersByProc(this->pUuid, nodes);
-        }
-
-        for (const auto &topic : nodes)
-        {
-          for (const auto &node : topic.second)
+          // Choose the time until the next heartbeat, announced in this one.
+          if (this->adaptive && this->initialized)
           {
-            this->SendMsg(DestinationType::ALL,
-                msgs::Discovery::ADVERTISE, node);
+            if (this->topologyChanged)
+              this->currentHeartbeatInterval = this->heartbeatInterval;
+            else
+            {
+              this->currentHeartbeatInterval = std::min(
+                this->currentHeartbeatInterval * 2,
+                this->heartbeatInterval * kMaxHeartbeatBackoff);
+            }
           }
+          else
+            this->currentHeartbeatInterval = this->heartbeatInterval;
+          this->topologyChanged = false;
         }
 
+        Publisher pub("", "", this->pUuid, "", AdvertiseOptions());
+        this->SendMsg(DestinationType::ALL, msgs::Discovery::HEARTBEAT, pub);
+
         {
           std::lock_guard<std::mutex> lock(this->mutex);
           if (!this->initialized)
@@ -692,7 +902,7 @@ namespace ignition
           }
 
           this->timeNextHeartbeat = std::chrono::steady_clock::now() +
-            std::chrono::milliseconds(this->heartbeatInterval);
+            std::chrono::milliseconds(this->currentHeartbeatInterval);
         }
       }
 
@@ -707,6 +917,7 @@ namespace ignition
       /// \return A timeout (milliseconds).
       private: int NextTimeout() const
       {
+        std::lock_guard<std::mutex> lock(this->mutex);
         auto now = std::chrono::steady_clock::now();
         auto timeUntilNextHeartbeat = this->timeNextHeartbeat - now;
         auto timeUntilNextActivity = this->timeNextActivity - now;
@@ -747,49 +958,134 @@ namespace ignition
         }
       }
 
-      /// \brief Method in charge of receiving the discovery updates.
+      /// \brief Method in charge of receiving the discovery updates. It
+      /// receives the datagrams waiting in the socket, up to kRecvBatch at
+      /// once on Linux, and handles all their messages together.
       private: void RecvDiscoveryUpdate()
       {
-        char rcvStr[Discovery::kMaxRcvStr];
-        sockaddr_in clntAddr;
-        socklen_t addrLen = sizeof(clntAddr);
+        if (this->recvBuffer.empty())
+          this->recvBuffer.resize(kRecvBatch * kMaxRcvStr);
+
+        // Source and length of each datagram received.
+        std::array<sockaddr_in, kRecvBatch> srcAddrs;
+        std::array<std::size_t, kRecvBatch> lengths;
+        std::size_t numDatagrams = 0;
+
+        // Datagrams dropped by the kernel so far, if it told us.
+        bool hasDropped = false;
+        uint64_t dropped = 0;
+
+#ifdef __linux__
+        std::array<mmsghdr, kRecvBatch> hdrs;
+        std::array<iovec, kRecvBatch> iovecs;
+        // Room for the SO_RXQ_OVFL counter of each datagram.
+        alignas(cmsghdr) char controls[kRecvBatch][
+          CMSG_SPACE(sizeof(uint32_t))];
+        memset(hdrs.data(), 0, sizeof(hdrs));
+        for (std::size_t i = 0; i < kRecvBatch; ++i)
+        {
+          iovecs[i].iov_base = &this->recvBuffer[i * kMaxRcvStr];
+          iovecs[i].iov_len = kMaxRcvStr;
+          hdrs[i].msg_hdr.msg_iov = &iovecs[i];
+          hdrs[i].msg_hdr.msg_iovlen = 1;
+          hdrs[i].msg_hdr.msg_name = &srcAddrs[i];
+          hdrs[i].msg_hdr.msg_namelen = sizeof(sockaddr_in);
+          hdrs[i].msg_hdr.msg_control = controls[i];
+          hdrs[i].msg_hdr.msg_controllen = sizeof(controls[i]);
+        }
+
+        int received = recvmmsg(this->sockets.at(0), hdrs.data(),
+            kRecvBatch, MSG_DONTWAIT, nullptr);
+        if (received < 0)
+        {
+          if (errno != EAGAIN && errno != EWOULDBLOCK)
+          {
+            std::cerr << "Discovery::RecvDiscoveryUpdate() recvmmsg error"
+              << std::endl;
+          }
+          return;
+        }
 
-        uint16_t received = recvfrom(this->sockets.at(0),
-              reinterpret_cast<raw_type *>(rcvStr),
+        numDatagrams = static_cast<std::size_t>(received);
+        for (std::size_t i = 0; i < numDatagrams; ++i)
+        {
+          lengths[i] = hdrs[i].msg_len;
+#ifdef SO_RXQ_OVFL
+          for (cmsghdr *cmsg = CMSG_FIRSTHDR(&hdrs[i].msg_hdr); cmsg;
+               cmsg = CMSG_NXTHDR(&hdrs[i].msg_hdr, cmsg))
+          {
+            if (cmsg->cmsg_level == SOL_SOCKET &&
+                cmsg->cmsg_type == SO_RXQ_OVFL)
+            {
+              uint32_t counter;
+              memcpy(&counter, CMSG_DATA(cmsg), sizeof(counter));
+              dropped = counter;
+              hasDropped = true;
+            }
+          }
+#endif
+        }
+#else
+        socklen_t addrLen = sizeof(sockaddr_in);
+        int received = recvfrom(this->sockets.at(0),
+              reinterpret_cast<raw_type *>(this->recvBuffer.data()),
               this->kMaxRcvStr, 0,
-              reinterpret_cast<sockaddr *>(&clntAddr),
+              reinterpret_cast<sockaddr *>(&srcAddrs[0]),
               reinterpret_cast<socklen_t *>(&addrLen));
-        if (received > 0)
+        if (received < 0)
+        {
+          std::cerr << "Discovery::RecvDiscoveryUpdate() recvfrom error"
+            << std::endl;
+          return;
+        }
+
+        numDatagrams = 1;
+        lengths[0] = static_cast<std::size_t>(received);
+#endif
+
+        auto start = std::chrono::steady_clock::now();
+
+        // Ignition Transport delimits each discovery message with a
+        // frame_delimiter that contains byte size information.
+        // A discovery message has the form:
+        //
+        // <frame_delimiter><frame_body>
+        //
+        // Ignition Transport version < 8 sends a frame delimiter that
+        // contains the value of sizeof(frame_delimiter)
+        // + sizeof(frame_body). In other words, the frame_delimiter
+        // contains a value that represents the total size of the
+        // frame_body and frame_delimiter in bytes.
+        //
+        // Ignition Transport version >= 8 sends a frame_delimiter
+        // that contains the value of sizeof(frame_body). In other
+        // words, the frame_delimiter contains a value that represents
+        // the total size of only the frame_body.
+        //
+        // It is possible that two incompatible versions of Ignition
+        // Transport exist on the same network. If we receive an
+        // unexpected size, then we ignore the message.
+        //
+        // A datagram may pack several discovery messages one after the
+        // other, each with its own frame_delimiter.
+        std::vector<std::pair<std::string, msgs::Discovery>> batch;
+        uint64_t numMsgs = 0;
+        uint64_t discarded = 0;
+        for (std::size_t i = 0; i < numDatagrams; ++i)
         {
-          uint16_t len = 0;
-          memcpy(&len, &rcvStr[0], sizeof(len));
-
-          // Ignition Transport delimits each discovery message with a
-          // frame_delimiter that contains byte size information.
-          // A discovery message has the form:
-          //
-          // <frame_delimiter><frame_body>
-          //
-          // Ignition Transport version < 8 sends a frame delimiter that
-          // contains the value of sizeof(frame_delimiter)
-          // + sizeof(frame_body). In other words, the frame_delimiter
-          // contains a value that represents the total size of the
-          // frame_body and frame_delimiter in bytes.
-          //
-          // Ignition Transport version >= 8 sends a frame_delimiter
-          // that contains the value of sizeof(frame_body). In other
-          // words, the frame_delimiter contains a value that represents
-          // the total size of only the frame_body.
-          //
-          // It is possible that two incompatible versions of Ignition
-          // Transport exist on the same network. If we receive an
-          // unexpected size, then we ignore the message.
-
-          // If-condition for version 8+
-          if (len + sizeof(len) == received)
+          const char *data = &this->recvBuffer[i * kMaxRcvStr];
+          std::string srcAddr = inet_ntoa(srcAddrs[i].sin_addr);
+          uint16_t srcPort = ntohs(srcAddrs[i].sin_port);
+
+          std::size_t offset = 0;
+          while (offset + sizeof(uint16_t) <= lengths[i])
           {
-            std::string srcAddr = inet_ntoa(clntAddr.sin_addr);
-            uint16_t srcPort = ntohs(clntAddr.sin_port);
+            uint16_t len = 0;
+            memcpy(&len, &data[offset], sizeof(len));
+
+            // If-condition for version 8+
+            if (offset + sizeof(len) + len > lengths[i])
+              break;
 
             if (this->verbose)
             {
@@ -797,40 +1093,96 @@ namespace ignition
                 << srcAddr << ": " << srcPort << std::endl;
             }
 
-            this->DispatchDiscoveryMsg(srcAddr, rcvStr + sizeof(len), len);
+            ++numMsgs;
+            msgs::Discovery msg;
+            if (!this->ParseDiscoveryMsg(data + offset + sizeof(len), len,
+                  msg))
+            {
+              ++discarded;
+            }
+            // Discard our own discovery messages.
+            else if (msg.process_uuid() != this->pUuid)
+            {
+              batch.emplace_back(srcAddr, std::move(msg));
+            }
+            offset += sizeof(len) + len;
+          }
+
+          // A truncated message.
+          if (offset != lengths[i])
+          {
+            ++numMsgs;
+            ++discarded;
           }
         }
-        else if (received < 0)
+
+        // Update the timestamps of the senders and cache the callbacks, all
+        // in one go for the whole batch. The messages coming via a unicast
+        // relay are only forwarded, they don't count as activity.
+        DiscoveryCallback<Pub> connectCb;
+        DiscoveryCallback<Pub> disconnectCb;
+        if (!batch.empty())
         {
-          std::cerr << "Discovery::RecvDiscoveryUpdate() recvfrom error"
-            << std::endl;
+          std::lock_guard<std::mutex> lock(this->mutex);
+          Timestamp now = std::chrono::steady_clock::now();
+          for (const auto &entry : batch)
+          {
+            const auto &msg = entry.second;
+            if (!msg.has_flags() || !msg.flags().relay())
+              this->activity[msg.process_uuid()] = now;
+          }
+          connectCb = this->connectionCb;
+          disconnectCb = this->disconnectionCb;
+        }
+
+        for (auto &entry : batch)
+        {
+          this->DispatchDiscoveryMsg(entry.first, entry.second, connectCb,
+              disconnectCb);
         }
+
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        std::lock_guard<std::mutex> lock(this->statsMutex);
+        ++this->stats.batches;
+        this->stats.datagrams += numDatagrams;
+        this->stats.msgs += numMsgs;
+        this->stats.discarded += discarded;
+        if (hasDropped)
+          this->stats.dropped = dropped;
+        this->stats.processingTime += static_cast<uint64_t>(
+          std::chrono::duration_cast<std::chrono::microseconds>(
+            elapsed).count());
       }
 
-      /// \brief Parse a discovery message received via the UDP socket
-      /// \param[in] _fromIp IP address of the message sender.
-      /// \param[in] _msg Received message.
-      /// \param[in] _len Entire length of the package in octets.
-      private: void DispatchDiscoveryMsg(const std::string &_fromIp,
-                                         char *_msg, uint16_t _len)
+      /// \brief Parse a discovery message received via the UDP socket.
+      /// \param[in] _data Serialized message.
+      /// \param[in] _len Length of the message in octets.
+      /// \param[out] _msg The message.
+      /// \return True if the message has to be handled or false if it
+      /// couldn't be parsed or uses a different wire protocol version.
+      private: bool ParseDiscoveryMsg(const char *_data, const uint16_t _len,
+                                      msgs::Discovery &_msg) const
       {
-        ignition::msgs::Discovery msg;
-
-        // Parse the message, and return if parsing failed. Parsing could
-        // fail when another discovery node is publishing messages using an
-        // older (or newer) format.
-        if (!msg.ParseFromArray(_msg, _len))
-          return;
+        // Parsing could fail when another discovery node is publishing
+        // messages using an older (or newer) format.
+        if (!_msg.ParseFromArray(_data, _len))
+          return false;
 
         // Discard the message if the wire protocol is different than mine.
-        if (this->kWireVersion != msg.version())
-          return;
-
-        std::string recvPUuid = msg.process_uuid();
+        return this->kWireVersion == _msg.version();
+      }
 
-        // Discard our own discovery messages.
-        if (recvPUuid == this->pUuid)
-          return;
+      /// \brief Handle a discovery message received via the UDP socket.
+      /// \param[in] _fromIp IP address of the message sender.
+      /// \param[in] _msg Received message.
+      /// \param[in] _connectCb Callback notifying the new publishers.
+      /// \param[in] _disconnectCb Callback notifying the publishers gone.
+      private: void DispatchDiscoveryMsg(const std::string &_fromIp,
+                   msgs::Discovery &_msg,
+                   const DiscoveryCallback<Pub> &_connectCb,
+                   const DiscoveryCallback<Pub> &_disconnectCb)
+      {
+        std::string recvPUuid = _msg.process_uuid();
 
         // Forwarding summary:
         //   - From a unicast peer  -> to multicast group (with NO_RELAY flag).
@@ -841,12 +1193,12 @@ namespace ignition
         // forward it to the multicast group, and it will be dispatched once
         // received there. Note that we also unset the RELAY flag and set the
         // NO_RELAY flag, to avoid forwarding the message anymore.
-        if (msg.has_flags() && msg.flags().relay())
+        if (_msg.has_flags() && _msg.flags().relay())
         {
           // Unset the RELAY flag in the header and set the NO_RELAY.
-          msg.mutable_flags()->set_relay(false);
-          msg.mutable_flags()->set_no_relay(true);
-          this->SendMulticast(msg);
+          _msg.mutable_flags()->set_relay(false);
+          _msg.mutable_flags()->set_no_relay(true);
+          this->SendMulticast(_msg);
 
           // A unicast peer contacted me. I need to save its address for
           // sending future messages in the future.
@@ -858,29 +1210,33 @@ namespace ignition
         // to all our relays. Note that this is the most common case, where we
         // receive a regular multicast message and we forward it to any remote
         // relays.
-        else if (!msg.has_flags() || !msg.flags().no_relay())
-        {
-          msg.mutable_flags()->set_relay(true);
-          this->SendUnicast(msg);
-        }
-
-        // Update timestamp and cache the callbacks.
-        DiscoveryCallback<Pub> connectCb;
-        DiscoveryCallback<Pub> disconnectCb;
+        else if (!_msg.has_flags() || !_msg.flags().no_relay())
         {
-          std::lock_guard<std::mutex> lock(this->mutex);
-          this->activity[recvPUuid] = std::chrono::steady_clock::now();
-          connectCb = this->connectionCb;
-          disconnectCb = this->disconnectionCb;
+          _msg.mutable_flags()->set_relay(true);
+          this->SendUnicast(_msg);
         }
 
-        switch (msg.type())
+        switch (_msg.type())
         {
           case msgs::Discovery::ADVERTISE:
           {
+            this->UpdateGeneration(_msg);
+
             // Read the rest of the fields.
             Pub publisher;
-            publisher.SetFromDiscovery(msg);
+            publisher.SetFromDiscovery(_msg);
+
+            // Record the publishers sent after a request for all of them.
+            {
+              std::lock_guard<std::mutex> lock(this->mutex);
+              auto synced = this->syncAdvertised.find(recvPUuid);
+              if (synced != this->syncAdvertised.end())
+              {
+                ++synced->second.count;
+                synced->second.publishers.emplace(publisher.Topic(),
+                    publisher.NUuid());
+              }
+            }
 
             // Check scope of the topic.
             if ((publisher.Options().Scope() == Scope_t::PROCESS) ||
@@ -895,23 +1251,42 @@ namespace ignition
             {
               std::lock_guard<std::mutex> lock(this->mutex);
               added = this->info.AddPublisher(publisher);
+              if (added)
+                this->OnTopologyChange();
             }
 
-            if (added && connectCb)
+            if (added && _connectCb)
             {
               // Execute the client's callback.
-              connectCb(publisher);
+              _connectCb(publisher);
             }
 
             break;
           }
           case msgs::Discovery::SUBSCRIBE:
           {
+            // A request for all the publishers of a process.
+            std::string syncUuid;
+            if (this->HeaderValue(_msg, kSyncKey, syncUuid))
+            {
+              if (syncUuid == this->pUuid)
+              {
+                this->SendSync();
+              }
+              else
+              {
+                // Everybody receives the answer, count its publishers too.
+                std::lock_guard<std::mutex> lock(this->mutex);
+                this->syncAdvertised[syncUuid] = SyncState();
+              }
+              break;
+            }
+
             std::string recvTopic;
             // Read the topic information.
-            if (msg.has_sub())
+            if (_msg.has_sub())
             {
-              recvTopic = msg.sub().topic();
+              recvTopic = _msg.sub().topic();
             }
             else
             {
@@ -952,7 +1327,62 @@ namespace ignition
           }
           case msgs::Discovery::HEARTBEAT:
           {
-            // The timestamp has already been updated.
+            // The timestamp has already been updated. Learn when to expect
+            // the next heartbeat.
+            std::string value;
+            if (this->HeaderValue(_msg, kIntervalKey, value))
+            {
+              this->UpdatePeerTiming(recvPUuid, static_cast<unsigned int>(
+                std::strtoul(value.c_str(), nullptr, 10)));
+            }
+
+            // Request all the publishers of the process if we missed some of
+            // its changes.
+            if (!this->HeaderValue(_msg, kGenerationKey, value))
+              break;
+
+            const uint64_t msgGeneration = std::strtoull(value.c_str(),
+                nullptr, 10);
+
+            // The heartbeat closing the list of all the publishers. The
+            // list is complete only if all its ADVERTISE messages arrived,
+            // otherwise we stay outdated and request it again. A complete
+            // list replaces the publishers that we knew of the process, so
+            // the ones missing were unadvertised while we weren't listening.
+            std::string syncUuid;
+            const bool sync = this->HeaderValue(_msg, kSyncKey, syncUuid);
+            std::string count;
+            const bool hasCount = this->HeaderValue(_msg, kCountKey, count);
+
+            bool outdated;
+            std::vector<Pub> gone;
+            {
+              std::lock_guard<std::mutex> lock(this->mutex);
+              auto &known = this->generations[recvPUuid];
+              auto synced = this->syncAdvertised.find(recvPUuid);
+              if (sync && synced != this->syncAdvertised.end())
+              {
+                if (hasCount && synced->second.count ==
+                    std::strtoull(count.c_str(), nullptr, 10))
+                {
+                  known = msgGeneration;
+                  this->RetainPublishers(recvPUuid,
+                      synced->second.publishers, gone);
+                }
+                this->syncAdvertised.erase(synced);
+              }
+              outdated = known != msgGeneration;
+            }
+
+            if (_disconnectCb)
+            {
+              // Notify the publishers gone.
+              for (const auto &pub : gone)
+                _disconnectCb(pub);
+            }
+
+            if (outdated)
+              this->RequestSync(recvPUuid);
             break;
           }
           case msgs::Discovery::BYE:
@@ -961,14 +1391,18 @@ namespace ignition
             {
               std::lock_guard<std::mutex> lock(this->mutex);
               this->activity.erase(recvPUuid);
+              this->generations.erase(recvPUuid);
+              this->syncAdvertised.erase(recvPUuid);
+              this->peers.erase(recvPUuid);
+              this->OnTopologyChange();
             }
 
-            if (disconnectCb)
+            if (_disconnectCb)
             {
               Pub pub;
               pub.SetPUuid(recvPUuid);
               // Notify the new disconnection.
-              disconnectCb(pub);
+              _disconnectCb(pub);
             }
 
             // Remove the address entry for this topic.
@@ -981,9 +1415,11 @@ namespace ignition
           }
           case msgs::Discovery::UNADVERTISE:
           {
+            this->UpdateGeneration(_msg);
+
             // Read the address.
             Pub publisher;
-            publisher.SetFromDiscovery(msg);
+            publisher.SetFromDiscovery(_msg);
 
             // Check scope of the topic.
             if ((publisher.Options().Scope() == Scope_t::PROCESS) ||
@@ -993,24 +1429,27 @@ namespace ignition
               return;
             }
 
-            if (disconnectCb)
+            if (_disconnectCb)
             {
               // Notify the new disconnection.
-              disconnectCb(publisher);
+              _disconnectCb(publisher);
             }
 
             // Remove the address entry for this topic.
             {
               std::lock_guard<std::mutex> lock(this->mutex);
-              this->info.DelPublisherByNode(publisher.Topic(),
-                publisher.PUuid(), publisher.NUuid());
+              if (this->info.DelPublisherByNode(publisher.Topic(),
+                    publisher.PUuid(), publisher.NUuid()))
+              {
+                this->OnTopologyChange();
+              }
             }
 
             break;
           }
           default:
           {
-            std::cerr << "Unknown message type [" << msg.type() << "].\n";
+            std::cerr << "Unknown message type [" << _msg.type() << "].\n";
             break;
           }
         }
@@ -1019,18 +1458,17 @@ namespace ignition
       /// \brief Broadcast a discovery message.
       /// \param[in] _type Message type.
       /// \param[in] _pub Publishers's information to send.
-      /// \param[in] _flags Optional flags. Currently, the flags are not used
-      /// but they will in the future for specifying things like compression,
-      /// or encryption.
+      /// \param[in] _generation Generation of the publishers of this process
+      /// after the change announced by an ADVERTISE or UNADVERTISE message,
+      /// or 0 if the message doesn't announce a change.
       private: template<typename T>
       void SendMsg(const DestinationType &_destType,
                    const msgs::Discovery::Type _type,
-                   const T &_pub) const
+                   const T &_pub,
+                   const uint64_t _generation = 0) const
       {
-        ignition::msgs::Discovery discoveryMsg;
-        discoveryMsg.set_version(this->Version());
-        discoveryMsg.set_type(_type);
-        discoveryMsg.set_process_uuid(this->pUuid);
+        std::vector<msgs::Discovery> discoveryMsgs(1, this->NewMsg(_type));
+        auto &discoveryMsg = discoveryMsgs.front();
 
         switch (_type)
         {
@@ -1038,6 +1476,11 @@ namespace ignition
           case msgs::Discovery::UNADVERTISE:
           {
             _pub.FillDiscovery(discoveryMsg);
+            if (_generation > 0u)
+            {
+              this->SetHeaderValue(discoveryMsg, kGenerationKey,
+                  std::to_string(_generation));
+            }
             break;
           }
           case msgs::Discovery::SUBSCRIBE:
@@ -1046,6 +1489,20 @@ namespace ignition
             break;
           }
           case msgs::Discovery::HEARTBEAT:
+          {
+            uint64_t currentGeneration;
+            unsigned int interval;
+            {
+              std::lock_guard<std::mutex> lock(this->mutex);
+              currentGeneration = this->generation;
+              interval = this->currentHeartbeatInterval;
+            }
+            this->SetHeaderValue(discoveryMsg, kGenerationKey,
+                std::to_string(currentGeneration));
+            this->SetHeaderValue(discoveryMsg, kIntervalKey,
+                std::to_string(interval));
+            break;
+          }
           case msgs::Discovery::BYE:
             break;
           default:
@@ -1054,142 +1511,358 @@ namespace ignition
             return;
         }
 
-        if (_destType == DestinationType::MULTICAST ||
-            _destType == DestinationType::ALL)
+        this->SendMsgs(_destType, discoveryMsgs);
+
+        if (this->verbose)
         {
-          this->SendMulticast(discoveryMsg);
+          std::cout << "\t* Sending " << msgs::ToString(_type)
+                    << " msg [" << _pub.Topic() << "]" << std::endl;
         }
+      }
 
-        // Send the discovery message to the unicast relays.
-        if (_destType == DestinationType::UNICAST ||
-            _destType == DestinationType::ALL)
+      /// \brief Create a discovery message sent by this process.
+      /// \param[in] _type Message type.
+      /// \return The message.
+      private: msgs::Discovery NewMsg(const msgs::Discovery::Type _type) const
+      {
+        msgs::Discovery msg;
+        msg.set_version(this->Version());
+        msg.set_type(_type);
+        msg.set_process_uuid(this->pUuid);
+        return msg;
+      }
+
+      /// \brief Remove the publishers of a process that aren't in a list.
+      /// The caller should hold the mutex.
+      /// \param[in] _pUuid UUID of the process.
+      /// \param[in] _keep Topic and node UUID of the publishers to keep.
+      /// \param[out] _removed The publishers removed.
+      private: void RetainPublishers(const std::string &_pUuid,
+          const std::set<std::pair<std::string, std::string>> &_keep,
+          std::vector<Pub> &_removed)
+      {
+        std::map<std::string, std::vector<Pub>> pubs;
+        this->info.PublishersByProc(_pUuid, pubs);
+
+        for (const auto &node : pubs)
         {
-          // Set the RELAY flag in the header.
-          discoveryMsg.mutable_flags()->set_relay(true);
-          this->SendUnicast(discoveryMsg);
+          for (const auto &pub : node.second)
+          {
+            if (_keep.count(std::make_pair(pub.Topic(), pub.NUuid())) == 0u &&
+                this->info.DelPublisherByNode(pub.Topic(), _pUuid,
+                  pub.NUuid()))
+            {
+              _removed.push_back(pub);
+            }
+          }
         }
 
+        if (!_removed.empty())
+          this->OnTopologyChange();
+      }
+
+      /// \brief Request all the publishers advertised by another process.
+      /// \param[in] _pUuid UUID of the process.
+      private: void RequestSync(const std::string &_pUuid)
+      {
+        {
+          std::lock_guard<std::mutex> lock(this->mutex);
+          this->syncAdvertised[_pUuid] = SyncState();
+        }
+
+        std::vector<msgs::Discovery> discoveryMsgs(1,
+            this->NewMsg(msgs::Discovery::SUBSCRIBE));
+        discoveryMsgs.front().mutable_sub()->set_topic("");
+        this->SetHeaderValue(discoveryMsgs.front(), kSyncKey, _pUuid);
+        this->SendMsgs(DestinationType::ALL, discoveryMsgs);
+
         if (this->verbose)
         {
-          std::cout << "\t* Sending " << msgs::ToString(_type)
-                    << " msg [" << _pub.Topic() << "]" << std::endl;
+          std::cout << "\t* Requesting the publishers of [" << _pUuid << "]"
+                    << std::endl;
         }
       }
 
-      /// \brief Send a discovery message through all unicast relays.
-      /// \param[in] _msg Discovery message.
-      private: void SendUnicast(const msgs::Discovery &_msg) const
+      /// \brief Send all the publishers advertised outside this process,
+      /// followed by a heartbeat with their generation and number. The
+      /// requests received right after sending them are ignored: every
+      /// process receives the answer to a request.
+      private: void SendSync()
       {
-        uint16_t msgSize;
+        std::map<std::string, std::vector<Pub>> nodes;
+        uint64_t currentGeneration;
+        {
+          std::lock_guard<std::mutex> lock(this->mutex);
 
-        // ByteSizeLong appeared in version 3.1 of Protobuf, and ByteSize
-        // became deprecated.
-#if GOOGLE_PROTOBUF_VERSION < 3001000
-        int msgSizeFull = _msg.ByteSize();
-#else
-        size_t msgSizeFull = _msg.ByteSizeLong();
-#endif
-        if (msgSizeFull + sizeof(msgSize) > this->kMaxRcvStr)
+          Timestamp now = std::chrono::steady_clock::now();
+          if (now - this->lastSync <
+              std::chrono::milliseconds(this->activityInterval))
+          {
+            return;
+          }
+          this->lastSync = now;
+
+          this->info.PublishersByProc(this->pUuid, nodes);
+          currentGeneration = this->generation;
+        }
+
+        std::vector<msgs::Discovery> discoveryMsgs;
+        for (const auto &topic : nodes)
         {
-          std::cerr << "Discovery message too large to send. Discovery won't "
-            << "work. This shouldn't happen.\n";
+          for (const auto &node : topic.second)
+          {
+            if (node.Options().Scope() == Scope_t::PROCESS)
+              continue;
+
+            discoveryMsgs.push_back(
+                this->NewMsg(msgs::Discovery::ADVERTISE));
+            node.FillDiscovery(discoveryMsgs.back());
+          }
+        }
+
+        const std::size_t count = discoveryMsgs.size();
+        discoveryMsgs.push_back(this->NewMsg(msgs::Discovery::HEARTBEAT));
+        this->SetHeaderValue(discoveryMsgs.back(), kGenerationKey,
+            std::to_string(currentGeneration));
+        this->SetHeaderValue(discoveryMsgs.back(), kSyncKey, this->pUuid);
+        this->SetHeaderValue(discoveryMsgs.back(), kCountKey,
+            std::to_string(count));
+
+        this->SendMsgs(DestinationType::ALL, discoveryMsgs);
+      }
+
+      /// \brief Go back to the fastest heartbeats after a change in the
+      /// topics. The mutex has to be locked.
+      private: void OnTopologyChange()
+      {
+        if (!this->adaptive)
           return;
+
+        this->topologyChanged = true;
+        if (this->currentHeartbeatInterval > this->heartbeatInterval)
+        {
+          this->currentHeartbeatInterval = this->heartbeatInterval;
+          this->timeNextHeartbeat = std::min(this->timeNextHeartbeat,
+            std::chrono::steady_clock::now() +
+            std::chrono::milliseconds(this->heartbeatInterval));
         }
-        msgSize = msgSizeFull;
+      }
 
-        uint16_t totalSize = sizeof(msgSize) + msgSize;
-        char *buffer = static_cast<char *>(new char[totalSize]);
-        memcpy(&buffer[0], &msgSize, sizeof(msgSize));
+      /// \brief Record a heartbeat of another process and how late it was.
+      /// \param[in] _pUuid UUID of the process.
+      /// \param[in] _interval Time until its next heartbeat (ms).
+      private: void UpdatePeerTiming(const std::string &_pUuid,
+                                     const unsigned int _interval)
+      {
+        Timestamp now = std::chrono::steady_clock::now();
+        std::lock_guard<std::mutex> lock(this->mutex);
+
+        auto &peer = this->peers[_pUuid];
+        if (peer.interval > 0u)
+        {
+          // Heartbeats coming early (e.g. after a change) don't count.
+          const double delay = std::chrono::duration<double, std::milli>(
+            now - peer.lastHeartbeat).count() - peer.interval;
+          if (delay >= 0)
+            peer.jitter += kJitterWeight * (delay - peer.jitter);
+        }
+        peer.lastHeartbeat = now;
+        peer.interval = _interval;
+      }
 
-        if (_msg.SerializeToArray(buffer + sizeof(msgSize), msgSize))
+      /// \brief Get the maximum time allowed without receiving any discovery
+      /// information from a process before canceling its entries. The mutex
+      /// has to be locked.
+      /// \param[in] _pUuid UUID of the process.
+      /// \return The value in milliseconds.
+      private: double SilenceLimit(const std::string &_pUuid) const
+      {
+        auto it = this->peers.find(_pUuid);
+        if (it == this->peers.end() || it->second.interval == 0u)
+          return this->silenceInterval;
+
+        const auto &peer = it->second;
+        if (this->adaptive)
         {
-          // Send the discovery message to the unicast relays.
-          for (const auto &sockAddr : this->relayAddrs)
+          return 2.0 * peer.interval + kJitterMargin * peer.jitter +
+            this->activityInterval;
+        }
+
+        // Respect the silence interval, as long as it covers a few
+        // heartbeats of the process.
+        return std::max(static_cast<double>(this->silenceInterval),
+          3.0 * peer.interval);
+      }
+
+      /// \brief Advance the generation known for another process when we
+      /// receive its next change.
+      /// \param[in] _msg ADVERTISE or UNADVERTISE message.
+      private: void UpdateGeneration(const msgs::Discovery &_msg)
+      {
+        std::string value;
+        if (!this->HeaderValue(_msg, kGenerationKey, value))
+          return;
+
+        const uint64_t msgGeneration = std::strtoull(value.c_str(), nullptr,
+            10);
+
+        std::lock_guard<std::mutex> lock(this->mutex);
+        auto &known = this->generations[_msg.process_uuid()];
+        if (known + 1u == msgGeneration)
+          known = msgGeneration;
+      }
+
+      /// \brief Get a value from the header of a discovery message.
+      /// \param[in] _msg Discovery message.
+      /// \param[in] _key Key of the value.
+      /// \param[out] _value The value.
+      /// \return True if the header has the key.
+      private: static bool HeaderValue(const msgs::Discovery &_msg,
+                                       const std::string &_key,
+                                       std::string &_value)
+      {
+        if (!_msg.has_header())
+          return false;
+
+        for (const auto &data : _msg.header().data())
+        {
+          if (data.key() == _key && data.value_size() > 0)
           {
-            auto sent = sendto(this->sockets.at(0),
-              reinterpret_cast<const raw_type *>(
-                reinterpret_cast<const unsigned char*>(buffer)),
-              totalSize, 0,
-              reinterpret_cast<const sockaddr *>(&sockAddr),
-              sizeof(sockAddr));
-
-            if (sent != totalSize)
-            {
-              std::cerr << "Exception sending a unicast message" << std::endl;
-              break;
-            }
+            _value = data.value(0);
+            return true;
           }
         }
-        else
+
+        return false;
+      }
+
+      /// \brief Add a value to the header of a discovery message.
+      /// \param[in, out] _msg Discovery message.
+      /// \param[in] _key Key of the value.
+      /// \param[in] _value The value.
+      private: static void SetHeaderValue(msgs::Discovery &_msg,
+                                          const std::string &_key,
+                                          const std::string &_value)
+      {
+        auto data = _msg.mutable_header()->add_data();
+        data->set_key(_key);
+        data->add_value(_value);
+      }
+
+      /// \brief Send discovery messages, packing as many of them as
+      /// possible in each datagram.
+      /// \param[in] _destType Where to send them.
+      /// \param[in] _msgs Discovery messages. The RELAY flag is set on them
+      /// when sending to the unicast relays.
+      private: void SendMsgs(const DestinationType &_destType,
+                             std::vector<msgs::Discovery> &_msgs) const
+      {
+        std::vector<std::string> datagrams;
+
+        if (_destType == DestinationType::MULTICAST ||
+            _destType == DestinationType::ALL)
         {
-          std::cerr << "Discovery::SendUnicast: Error serializing data."
-            << std::endl;
+          if (packDiscoveryMsgs(_msgs, kMaxPackedSize, datagrams))
+          {
+            for (const auto &datagram : datagrams)
+              this->SendMulticast(datagram);
+          }
         }
 
-        delete [] buffer;
+        // Send the discovery messages to the unicast relays.
+        if ((_destType == DestinationType::UNICAST ||
+             _destType == DestinationType::ALL) && !this->relayAddrs.empty())
+        {
+          // Set the RELAY flag in the header.
+          for (auto &msg : _msgs)
+            msg.mutable_flags()->set_relay(true);
+
+          if (packDiscoveryMsgs(_msgs, kMaxPackedSize, datagrams))
+          {
+            for (const auto &datagram : datagrams)
+              this->SendUnicast(datagram);
+          }
+        }
       }
 
-      /// \brief Send a discovery message through the multicast group.
+      /// \brief Send a discovery message through all unicast relays.
       /// \param[in] _msg Discovery message.
-      private: void SendMulticast(const msgs::Discovery &_msg) const
+      private: void SendUnicast(const msgs::Discovery &_msg) const
       {
-        uint16_t msgSize;
+        std::vector<std::string> datagrams;
+        if (packDiscoveryMsgs({_msg}, kMaxPackedSize, datagrams))
+        {
+          for (const auto &datagram : datagrams)
+            this->SendUnicast(datagram);
+        }
+      }
 
-        // ByteSizeLong appeared in version 3.1 of Protobuf, and ByteSize
-        // became deprecated.
-#if GOOGLE_PROTOBUF_VERSION < 3001000
-        int msgSizeFull = _msg.ByteSize();
-#else
-        size_t msgSizeFull = _msg.ByteSizeLong();
-#endif
-        if (msgSizeFull + sizeof(msgSize) > this->kMaxRcvStr)
+      /// \brief Send a datagram through all unicast relays.
+      /// \param[in] _datagram Discovery messages packed by
+      /// packDiscoveryMsgs().
+      private: void SendUnicast(const std::string &_datagram) const
+      {
+        // Send the discovery message to the unicast relays.
+        for (const auto &sockAddr : this->relayAddrs)
         {
-          std::cerr << "Discovery message too large to send. Discovery won't "
-            << "work. This shouldn't happen.\n";
-          return;
+          auto sent = sendto(this->sockets.at(0),
+            reinterpret_cast<const raw_type *>(_datagram.data()),
+            _datagram.size(), 0,
+            reinterpret_cast<const sockaddr *>(&sockAddr),
+            sizeof(sockAddr));
+
+          if (sent != static_cast<decltype(sent)>(_datagram.size()))
+          {
+            std::cerr << "Exception sending a unicast message" << std::endl;
+            break;
+          }
         }
+      }
 
-        msgSize = msgSizeFull;
-        uint16_t totalSize = sizeof(msgSize) + msgSize;
-        char *buffer = static_cast<char *>(new char[totalSize]);
-        memcpy(&buffer[0], &msgSize, sizeof(msgSize));
+      /// \brief Send a discovery message through the multicast group.
+      /// \param[in] _msg Discovery message.
+      private: void SendMulticast(const msgs::Discovery &_msg) const
+      {
+        std::vector<std::string> datagrams;
+        if (packDiscoveryMsgs({_msg}, kMaxPackedSize, datagrams))
+        {
+          for (const auto &datagram : datagrams)
+            this->SendMulticast(datagram);
+        }
+      }
 
-        if (_msg.SerializeToArray(buffer + sizeof(msgSize), msgSize))
+      /// \brief Send a datagram through the multicast group.
+      /// \param[in] _datagram Discovery messages packed by
+      /// packDiscoveryMsgs().
+      private: void SendMulticast(const std::string &_datagram) const
+      {
+        // Send the discovery message to the multicast group through all the
+        // sockets.
+        for (const auto &sock : this->Sockets())
         {
-          // Send the discovery message to the multicast group through all the
-          // sockets.
-          for (const auto &sock : this->Sockets())
+          auto sent = sendto(sock,
+            reinterpret_cast<const raw_type *>(_datagram.data()),
+            _datagram.size(), 0,
+            reinterpret_cast<const sockaddr *>(this->MulticastAddr()),
+            sizeof(*(this->MulticastAddr())));
+          if (sent != static_cast<decltype(sent)>(_datagram.size()))
           {
-            if (sendto(sock, reinterpret_cast<const raw_type *>(
-              reinterpret_cast<const unsigned char*>(buffer)),
-              totalSize, 0,
-              reinterpret_cast<const sockaddr *>(this->MulticastAddr()),
-              sizeof(*(this->MulticastAddr()))) != totalSize)
+            // Ignore EPERM and ENOBUFS errors.
+            //
+            // See issue #106
+            //
+            // Rationale drawn from:
+            //
+            // * https://groups.google.com/forum/#!topic/comp.protocols.tcp-ip/Qou9Sfgr77E
+            // * https://stackoverflow.com/questions/16555101/sendto-dgrams-do-not-block-for-enobufs-on-osx
+            if (errno != EPERM && errno != ENOBUFS)
             {
-              // Ignore EPERM and ENOBUFS errors.
-              //
-              // See issue #106
-              //
-              // Rationale drawn from:
-              //
-              // * https://groups.google.com/forum/#!topic/comp.protocols.tcp-ip/Qou9Sfgr77E
-              // * https://stackoverflow.com/questions/16555101/sendto-dgrams-do-not-block-for-enobufs-on-osx
-              if (errno != EPERM && errno != ENOBUFS)
-              {
-                std::cerr << "Exception sending a multicast message:"
-                  << strerror(errno) << std::endl;
-              }
-              break;
+              std::cerr << "Exception sending a multicast message:"
+                << strerror(errno) << std::endl;
             }
+            break;
           }
         }
-        else
-        {
-          std::cerr << "Discovery::SendMulticast: Error serializing data."
-            << std::endl;
-        }
-
-        delete [] buffer;
       }
 
       /// \brief Get the list of sockets used for discovery.
@@ -1206,13 +1879,6 @@ namespace ignition
         return &this->mcastAddr;
       }
 
-      /// \brief Get the discovery protocol version.
-      /// \return The discovery version.
-      private: uint8_t Version() const
-      {
-        return this->kWireVersion;
-      }
-
       /// \brief Register a new network interface in the discovery system.
       /// \param[in] _ip IP address to register.
       /// \return True when the interface was successfully registered or false
@@ -1305,9 +1971,47 @@ namespace ignition
       private: static const uint16_t kMaxRcvStr =
                std::numeric_limits<uint16_t>::max();
 
+      /// \brief Maximum number of datagrams received at once.
+      private: static const std::size_t kRecvBatch = 16;
+
+      /// \brief Default size of the receive buffer of the socket (bytes).
+      /// \sa SetRecvBufferSize.
+      private: static const int kDefRecvBufferSize = 4 * 1024 * 1024;
+
       /// \brief Wire protocol version. Bump up the version number if you modify
       /// the wire protocol (for discovery or message/service exchange).
-      private: static const uint8_t kWireVersion = 10;
+      private: static const uint8_t kWireVersion = 12;
+
+      /// \brief Maximum size of a datagram packing several discovery
+      /// messages (bytes). It fits in the MTU of most networks.
+      private: static const std::size_t kMaxPackedSize = 1400;
+
+      /// \brief Header key of the generation of the publishers of a process.
+      private: static constexpr const char *kGenerationKey = "generation";
+
+      /// \brief Header key of the time until the next heartbeat (ms).
+      private: static constexpr const char *kIntervalKey = "interval";
+
+      /// \brief Maximum interval between heartbeats in adaptive mode, in
+      /// heartbeat intervals.
+      /// \sa SetAdaptive.
+      private: static const unsigned int kMaxHeartbeatBackoff = 8;
+
+      /// \brief Weight of a new sample in the average delay of the
+      /// heartbeats of a process.
+      private: static constexpr double kJitterWeight = 0.25;
+
+      /// \brief Delays of the heartbeats of a process tolerated in adaptive
+      /// mode, in average delays.
+      private: static constexpr double kJitterMargin = 4.0;
+
+      /// \brief Header key of the UUID of the process whose publishers are
+      /// requested or sent.
+      private: static constexpr const char *kSyncKey = "sync";
+
+      /// \brief Header key of the number of publishers sent before the
+      /// heartbeat closing a sync.
+      private: static constexpr const char *kCountKey = "count";
 
       /// \brief Port used to broadcast the discovery messages.
       private: int port;
@@ -1369,6 +2073,70 @@ namespace ignition
       /// \brief Thread in charge of receiving and handling incoming messages.
       private: std::thread threadReception;
 
+      /// \brief Buffer where the reception thread receives the datagrams,
+      /// with room for kRecvBatch datagrams of kMaxRcvStr bytes.
+      private: std::vector<char> recvBuffer;
+
+      /// \brief Statistics about the reception of discovery messages.
+      private: DiscoveryStats stats;
+
+      /// \brief Protects the statistics.
+      private: mutable std::mutex statsMutex;
+
+      /// \brief Generation of the publishers advertised outside this process.
+      /// It grows with every change, and the heartbeats carry it.
+      private: uint64_t generation = 0;
+
+      /// \brief Generation of the publishers of each remote process, as far
+      /// as we know.
+      private: std::map<std::string, uint64_t> generations;
+
+      /// \brief Publishers received from a process since all of them were
+      /// requested.
+      private: struct SyncState
+      {
+        /// \brief Number of ADVERTISE messages received.
+        public: std::size_t count = 0;
+
+        /// \brief Topic and node UUID of the publishers received.
+        public: std::set<std::pair<std::string, std::string>> publishers;
+      };
+
+      /// \brief Publishers received from each process since all its
+      /// publishers were requested.
+      private: std::map<std::string, SyncState> syncAdvertised;
+
+      /// \brief When this process last sent all its publishers.
+      private: Timestamp lastSync;
+
+      /// \brief Whether the adaptive timers are enabled.
+      /// \sa SetAdaptive.
+      private: bool adaptive = false;
+
+      /// \brief Time until the next heartbeat (ms.), announced in the
+      /// heartbeats.
+      private: unsigned int currentHeartbeatInterval = kDefHeartbeatInterval;
+
+      /// \brief Whether a topic changed since the last heartbeat.
+      private: bool topologyChanged = false;
+
+      /// \brief What we know about the heartbeats of a remote process.
+      private: struct PeerTiming
+               {
+                 /// \brief When the last heartbeat arrived.
+                 public: Timestamp lastHeartbeat;
+
+                 /// \brief Time until the next heartbeat (ms), as announced
+                 /// in the last heartbeat.
+                 public: unsigned int interval = 0;
+
+                 /// \brief Average delay of the heartbeats (ms).
+                 public: double jitter = 0;
+               };
+
+      /// \brief Heartbeat timing of each remote process.
+      private: std::map<std::string, PeerTiming> peers;
+
       /// \brief Time at which the next heartbeat cycle will be sent.
       private: Timestamp timeNextHeartbeat;
 
@@ -1395,6 +2163,8 @@ namespace ignition
 
       /// \brief When true, the service is enabled.
       private: bool enabled;
+
+      friend class DiscoveryTestHook;
     };
 
     /// \def MsgDiscovery
@@ -18,8 +18,15 @@
 #ifndef IGN_TRANSPORT_HANDLERSTORAGE_HH_
 #define IGN_TRANSPORT_HANDLERSTORAGE_HH_
 
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
+#include <shared_mutex>
 #include <string>
 #include <utility>
 
@@ -36,6 +43,11 @@ namespace ignition
     /// \class HandlerStorage HandlerStorage.hh
     /// ignition/transport/HandlerStorage.hh
     /// \brief Class to store and manage service call handlers.
+    ///
+    /// The topics are spread over a fixed number of shards, each one
+    /// protected by its own reader-writer lock. All the functions are thread
+    /// safe, and lookups on different topics, or concurrent lookups on the
+    /// same topic, don't block each other.
     template<typename T> class HandlerStorage
     {
       /// \brief Stores all the service call data for each topic. The key of
@@ -67,10 +79,14 @@ namespace ignition
         std::map<std::string,
           std::map<std::string, std::shared_ptr<T> >> &_handlers) const
       {
-        if (this->data.find(_topic) == this->data.end())
+        const Shard &shard = this->ShardOf(_topic);
+        std::shared_lock<std::shared_mutex> lk(shard.mutex);
+
+        auto it = shard.data.find(_topic);
+        if (it == shard.data.end())
           return false;
 
-        _handlers = this->data.at(_topic);
+        _handlers = it->second;
         return true;
       }
 
@@ -86,10 +102,14 @@ namespace ignition
                                 const std::string &_repTypeName,
                                 std::shared_ptr<T> &_handler) const
       {
-        if (this->data.find(_topic) == this->data.end())
+        const Shard &shard = this->ShardOf(_topic);
+        std::shared_lock<std::shared_mutex> lk(shard.mutex);
+
+        auto it = shard.data.find(_topic);
+        if (it == shard.data.end())
           return false;
 
-        const auto &m = this->data.at(_topic);
+        const auto &m = it->second;
         for (const auto &node : m)
         {
           for (const auto &handler : node.second)
@@ -115,10 +135,14 @@ namespace ignition
                                 const std::string &_msgTypeName,
                                 std::shared_ptr<T> &_handler) const
       {
-        if (this->data.find(_topic) == this->data.end())
+        const Shard &shard = this->ShardOf(_topic);
+        std::shared_lock<std::shared_mutex> lk(shard.mutex);
+
+        auto it = shard.data.find(_topic);
+        if (it == shard.data.end())
           return false;
 
-        const auto &m = this->data.at(_topic);
+        const auto &m = it->second;
         for (const auto &node : m)
         {
           for (const auto &handler : node.second)
@@ -145,10 +169,14 @@ namespace ignition
                            const std::string &_hUuid,
                            std::shared_ptr<T> &_handler) const
       {
-        if (this->data.find(_topic) == this->data.end())
+        const Shard &shard = this->ShardOf(_topic);
+        std::shared_lock<std::shared_mutex> lk(shard.mutex);
+
+        auto it = shard.data.find(_topic);
+        if (it == shard.data.end())
           return false;
 
-        auto const &m = this->data.at(_topic);
+        auto const &m = it->second;
         if (m.find(_nUuid) == m.end())
           return false;
 
@@ -168,17 +196,14 @@ namespace ignition
                               const std::string &_nUuid,
                               const std::shared_ptr<T> &_handler)
       {
-        // Create the topic entry.
-        if (this->data.find(_topic) == this->data.end())
-          this->data[_topic] = UUIDHandler_Collection_M();
+        Shard &shard = this->ShardOf(_topic);
+        std::unique_lock<std::shared_mutex> lk(shard.mutex);
 
-        // Create the Node UUID entry.
-        if (this->data[_topic].find(_nUuid) == this->data[_topic].end())
-          this->data[_topic][_nUuid] = UUIDHandler_M();
-
-        // Add/Replace the Req handler.
-        this->data[_topic][_nUuid].insert(
+        // Create the topic and Node UUID entries if needed and add/replace
+        // the Req handler.
+        shard.data[_topic][_nUuid].insert(
           std::make_pair(_handler->HandlerUuid(), _handler));
+        ++this->version;
       }
 
       /// \brief Return true if we have stored at least one request for the
@@ -187,10 +212,14 @@ namespace ignition
       /// \return true if we have stored at least one request for the topic.
       public: bool HasHandlersForTopic(const std::string &_topic) const
       {
-        if (this->data.find(_topic) == this->data.end())
+        const Shard &shard = this->ShardOf(_topic);
+        std::shared_lock<std::shared_mutex> lk(shard.mutex);
+
+        auto it = shard.data.find(_topic);
+        if (it == shard.data.end())
           return false;
 
-        return !this->data.at(_topic).empty();
+        return !it->second.empty();
       }
 
       /// \brief Check if a node has at least one handler.
@@ -200,11 +229,14 @@ namespace ignition
       public: bool HasHandlersForNode(const std::string &_topic,
                                       const std::string &_nUuid) const
       {
-        if (this->data.find(_topic) == this->data.end())
+        const Shard &shard = this->ShardOf(_topic);
+        std::shared_lock<std::shared_mutex> lk(shard.mutex);
+
+        auto it = shard.data.find(_topic);
+        if (it == shard.data.end())
           return false;
 
-        return this->data.at(_topic).find(_nUuid) !=
-               this->data.at(_topic).end();
+        return it->second.find(_nUuid) != it->second.end();
       }
 
       /// \brief Remove a request handler. The node's uuid is used as a key to
@@ -217,19 +249,25 @@ namespace ignition
                                  const std::string &_nUuid,
                                  const std::string &_reqUuid)
       {
+        Shard &shard = this->ShardOf(_topic);
+        std::unique_lock<std::shared_mutex> lk(shard.mutex);
+
         size_t counter = 0;
-        if (this->data.find(_topic) != this->data.end())
+        if (shard.data.find(_topic) != shard.data.end())
         {
-          if (this->data[_topic].find(_nUuid) != this->data[_topic].end())
+          if (shard.data[_topic].find(_nUuid) != shard.data[_topic].end())
           {
-            counter = this->data[_topic][_nUuid].erase(_reqUuid);
-            if (this->data[_topic][_nUuid].empty())
-              this->data[_topic].erase(_nUuid);
-            if (this->data[_topic].empty())
-              this->data.erase(_topic);
+            counter = shard.data[_topic][_nUuid].erase(_reqUuid);
+            if (shard.data[_topic][_nUuid].empty())
+              shard.data[_topic].erase(_nUuid);
+            if (shard.data[_topic].empty())
+              shard.data.erase(_topic);
           }
         }
 
+        if (counter > 0)
+          ++this->version;
+
         return counter > 0;
       }
 
@@ -240,21 +278,69 @@ namespace ignition
       public: bool RemoveHandlersForNode(const std::string &_topic,
                                          const std::string &_nUuid)
       {
+        Shard &shard = this->ShardOf(_topic);
+        std::unique_lock<std::shared_mutex> lk(shard.mutex);
+
         size_t counter = 0;
-        if (this->data.find(_topic) != this->data.end())
+        if (shard.data.find(_topic) != shard.data.end())
         {
-          counter = this->data[_topic].erase(_nUuid);
-          if (this->data[_topic].empty())
-            this->data.erase(_topic);
+          counter = shard.data[_topic].erase(_nUuid);
+          if (shard.data[_topic].empty())
+            shard.data.erase(_topic);
         }
 
+        if (counter > 0)
+          ++this->version;
+
         return counter > 0;
       }
 
-      /// \brief Stores all the service call data for each topic. The key of
-      /// _data is the topic name. The value is another map, where the key is
-      /// the node UUID and the value is a smart pointer to the handler.
-      private: TopicServiceCalls_M data;
+      /// \brief Get the version of the storage. The version grows every
+      /// time that a handler is added or removed, so it can be used to
+      /// detect that a copy of the handlers is stale.
+      /// \return The version.
+      public: uint64_t Version() const
+      {
+        return this->version.load(std::memory_order_acquire);
+      }
+
+      /// \brief Number of shards.
+      private: static const std::size_t kNumShards = 16;
+
+      /// \brief A subset of the topics and the lock protecting them.
+      private: struct Shard
+               {
+                 /// \brief Readers share the lock, writers own it.
+                 public: mutable std::shared_mutex mutex;
+
+                 /// \brief Stores all the service call data for each topic
+                 /// of the shard.
+                 public: TopicServiceCalls_M data;
+               };
+
+      /// \brief Get the shard storing a topic.
+      /// \param[in] _topic Topic name.
+      /// \return The shard.
+      private: Shard &ShardOf(const std::string &_topic)
+      {
+        return this->shards[std::hash<std::string>()(_topic) % kNumShards];
+      }
+
+      /// \brief Get the shard storing a topic.
+      /// \param[in] _topic Topic name.
+      /// \return The shard.
+      private: const Shard &ShardOf(const std::string &_topic) const
+      {
+        return this->shards[std::hash<std::string>()(_topic) % kNumShards];
+      }
+
+      /// \brief The shards. The key of each shard's data is the topic name.
+      /// The value is another map, where the key is the node UUID and the
+      /// value is a smart pointer to the handler.
+      private: std::array<Shard, kNumShards> shards;
+
+      /// \brief Version of the storage.
+      private: std::atomic<uint64_t> version{0};
     };
     }
   }
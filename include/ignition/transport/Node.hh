@@ -18,11 +18,14 @@
 #define IGN_TRANSPORT_NODE_HH_
 
 #include <algorithm>
+#include <cstddef>
 #include <functional>
+#include <future>
 #include <memory>
 #include <mutex>
 #include <string>
 #include <unordered_set>
+#include <utility>
 #include <vector>
 
 // TODO(anyone): Remove after fixing the warnings
@@ -120,6 +123,21 @@ namespace ignition
         /// \return true when success.
         public: bool Publish(const ProtoMsg &_msg);
 
+        /// \brief Publish an immutable message. The local (intraprocess)
+        /// subscribers share the message without copying it, so it must not
+        /// be modified after this call. Subscribers of the generic and of
+        /// the specific type receive the same instance.
+        ///
+        /// ## Pseudo code example ##
+        ///
+        ///    auto msg = std::make_shared<MsgType>();
+        ///    msg->set_data(5);
+        ///    pub.Publish(std::move(msg));
+        ///
+        /// \param[in] _msg A google::protobuf message.
+        /// \return true when success.
+        public: bool Publish(const std::shared_ptr<const ProtoMsg> &_msg);
+
         /// \brief Publish a raw pre-serialized message.
         ///
         /// \warning This function is only intended for advanced users. The
@@ -145,6 +163,33 @@ namespace ignition
           const std::string &_msgData,
           const std::string &_msgType);
 
+        /// \brief Borrow a buffer from the transport to serialize a message
+        /// directly into it. The buffer is later published with
+        /// PublishLoaned(), which shares it with the raw and remote
+        /// subscribers without copying it. Buffers are recycled once every
+        /// subscriber is done with them.
+        ///
+        /// ## Pseudo code example ##
+        ///
+        ///    auto size = msg.ByteSizeLong();
+        ///    auto buffer = pub.Loan(size);
+        ///    if (buffer && msg.SerializeToArray(buffer.get(), size))
+        ///      pub.PublishLoaned(std::move(buffer), size);
+        ///
+        /// \param[in] _size Number of bytes needed.
+        /// \return A buffer with room for at least _size bytes, or nullptr if
+        /// this publisher is not valid.
+        public: std::shared_ptr<char> Loan(const std::size_t _size);
+
+        /// \brief Publish a message serialized into a buffer obtained with
+        /// Loan(). The message type is the one advertised by this
+        /// publisher. Do not modify the buffer after this call.
+        /// \param[in] _buffer A buffer returned by Loan().
+        /// \param[in] _size Size of the serialized message (bytes).
+        /// \return true when success.
+        public: bool PublishLoaned(std::shared_ptr<char> _buffer,
+                                   const std::size_t _size);
+
         /// \brief Check if message publication is throttled. If so, verify
         /// whether the next message should be published or not.
         ///
@@ -490,6 +535,31 @@ namespace ignition
           ClassT *_obj,
           const AdvertiseServiceOptions &_options = AdvertiseServiceOptions());
 
+      /// \brief Advertise a service whose response is a stream of chunks.
+      /// The callback sends each chunk as soon as it's ready, instead of
+      /// building the whole response in memory. Sending blocks while the
+      /// requester has too many chunks waiting, so a slow requester slows
+      /// down the service. The service runs on its own threads (see
+      /// AdvertiseServiceOptions::SetMaxConcurrency()), one at least.
+      /// \param[in] _topic Topic name associated to the service.
+      /// \param[in] _callback Lambda function executed when the service
+      /// request is received. The callback has the following parameters:
+      ///   \param[in] _request Protobuf message containing the request.
+      ///   \param[in] _send Function sending a chunk of the response. It
+      ///   returns false when the requester stopped the stream or didn't
+      ///   take more chunks in time, and then the callback should return.
+      ///   \return true when the service call was successfully executed.
+      /// \param[in] _options Advertise options.
+      /// \return true when the service was successfully advertised or
+      /// false otherwise.
+      /// \sa Node::RequestStream
+      public: template<typename RequestT, typename ReplyT>
+      bool AdvertiseStream(
+          const std::string &_topic,
+          std::function<bool(const RequestT &_request,
+            const std::function<bool(const ReplyT &_chunk)> &_send)> _callback,
+          const AdvertiseServiceOptions &_options = AdvertiseServiceOptions());
+
       /// \brief Get the list of services advertised by this node.
       /// \return A vector containing all services advertised by this node.
       public: std::vector<std::string> AdvertisedServices() const;
@@ -560,6 +630,26 @@ namespace ignition
           std::function<void(const ReplyT &_reply,
                              const bool _result)> &_callback);
 
+      /// \brief Request a new service using a non-blocking call that returns
+      /// a future. Many requests can be in flight at the same time, even to
+      /// the same responser, and each future becomes ready when the response
+      /// to its request arrives. If the response doesn't arrive in time
+      /// (e.g.: the responser went away), the request is abandoned and the
+      /// future becomes ready with a default response and a false result.
+      /// \param[in] _topic Service name requested.
+      /// \param[in] _request Protobuf message containing the request's
+      /// parameters.
+      /// \param[in] _timeout The request is abandoned after '_timeout' ms.
+      /// The timeout is checked a few times per second.
+      /// \return A future holding the response and the result of the service
+      /// call, or an invalid future (see std::future::valid()) if the service
+      /// couldn't be requested.
+      public: template<typename RequestT, typename ReplyT>
+      std::future<std::pair<ReplyT, bool>> RequestAsync(
+          const std::string &_topic,
+          const RequestT &_request,
+          const unsigned int _timeout);
+
       /// \brief Request a new service using a non-blocking call.
       /// In this version the callback is a member function.
       /// \param[in] _topic Service name requested.
@@ -628,6 +718,52 @@ namespace ignition
           ReplyT &_reply,
           bool &_result);
 
+      /// \brief Request a service many times using a blocking call. All the
+      /// requests are sent to the same responser in a single message, and
+      /// all the responses come back together, which is much cheaper than
+      /// making the requests one by one.
+      /// \param[in] _topic Service name requested.
+      /// \param[in] _requests Protobuf messages containing the parameters
+      /// of each request.
+      /// \param[in] _timeout The requests will timeout after '_timeout' ms.
+      /// \param[out] _replies Protobuf messages containing the responses,
+      /// in the order of the requests.
+      /// \param[out] _results Results of the service calls, in the order of
+      /// the requests.
+      /// \return true when the requests were executed or false if the
+      /// timeout expired.
+      public: template<typename RequestT, typename ReplyT>
+      bool RequestBatch(
+          const std::string &_topic,
+          const std::vector<RequestT> &_requests,
+          const unsigned int &_timeout,
+          std::vector<ReplyT> &_replies,
+          std::vector<bool> &_results);
+
+      /// \brief Request a service advertised with AdvertiseStream() using a
+      /// non-blocking call. Each chunk of the response is passed to a
+      /// callback as soon as it arrives, and the responser only sends more
+      /// chunks once the callback took the previous ones, so at most a few
+      /// chunks are held in memory at any time.
+      /// \param[in] _topic Service name requested.
+      /// \param[in] _request Protobuf message containing the request's
+      /// parameters.
+      /// \param[in] _chunkCallback Lambda function executed when a chunk of
+      /// the response arrives. The callback has the following parameters:
+      ///   \param[in] _chunk Protobuf message containing the chunk.
+      ///   \return false to stop the stream.
+      /// \param[in] _doneCallback Lambda function executed after the last
+      /// chunk. The callback has the following parameters:
+      ///   \param[in] _result Result of the service call. If false, there
+      ///   was a problem executing your request or the stream was stopped.
+      /// \return true when the service call was succesfully requested.
+      public: template<typename RequestT, typename ReplyT>
+      bool RequestStream(
+          const std::string &_topic,
+          const RequestT &_request,
+          const std::function<bool(const ReplyT &_chunk)> &_chunkCallback,
+          const std::function<void(const bool _result)> &_doneCallback);
+
       /// \brief Request a new service without waiting for response.
       /// \param[in] _topic Topic requested.
       /// \param[in] _request Protobuf message containing the request's
@@ -23,6 +23,7 @@
 
 #include "ignition/transport/config.hh"
 #include "ignition/transport/Export.hh"
+#include "ignition/transport/SubscribeOptions.hh"
 
 namespace ignition
 {
@@ -34,6 +35,25 @@ namespace ignition
     // Forward declarations.
     class NodeOptionsPrivate;
 
+    /// \def ResponserPolicy_t This strongly typed enum defines how a node
+    /// chooses a responser when a service is offered by more than one.
+    enum class ResponserPolicy_t
+    {
+      /// \brief Send all the requests to the first responser found.
+      FIRST,
+      /// \brief Take turns between the responsers.
+      ROUND_ROBIN,
+      /// \brief Choose the responser with the fewest requests of this
+      /// process waiting for a response.
+      LEAST_OUTSTANDING,
+      /// \brief Choose the responser with the lowest observed latency,
+      /// weighted by the requests waiting for it.
+      LOWEST_LATENCY,
+      /// \brief Prefer the responsers running on this host, taking turns
+      /// between them.
+      SAME_HOST
+    };
+
     /// \class NodeOptions NodeOptions.hh ignition/transport/NodeOptions.hh
     /// \brief A class for customizing the behavior of the Node.
     /// E.g.: Set a custom namespace or a partition name.
@@ -126,6 +146,31 @@ namespace ignition
       public: bool TopicRemap(const std::string &_fromTopic,
                               std::string &_toTopic) const;
 
+      /// \brief Set the executor used by the subscriptions of this node that
+      /// don't set one in their SubscribeOptions.
+      /// \param[in] _executor The executor. DEFAULT means SINGLE_THREADED.
+      /// \sa Executor_t
+      /// \sa SubscribeOptions::SetExecutor
+      public: void SetExecutor(const Executor_t _executor);
+
+      /// \brief Get the executor used by the subscriptions of this node that
+      /// don't set one in their SubscribeOptions.
+      /// \return The executor.
+      /// \sa SetExecutor
+      public: Executor_t Executor() const;
+
+      /// \brief Set how the service requests of this node choose a
+      /// responser when a service is offered by more than one.
+      /// \param[in] _policy The policy.
+      /// \sa ResponserPolicy_t
+      public: void SetResponserPolicy(const ResponserPolicy_t _policy);
+
+      /// \brief Get how the service requests of this node choose a
+      /// responser.
+      /// \return The policy. The default is FIRST.
+      /// \sa SetResponserPolicy
+      public: ResponserPolicy_t ResponserPolicy() const;
+
 #ifdef _WIN32
 // Disable warning C4251 which is triggered by
 // std::unique_ptr
@@ -26,6 +26,8 @@
 #pragma warning(pop)
 #endif
 
+#include <cstddef>
+#include <cstdint>
 #include <memory>
 #include <mutex>
 #include <string>
@@ -36,6 +38,7 @@
 #include "ignition/transport/config.hh"
 #include "ignition/transport/Export.hh"
 #include "ignition/transport/HandlerStorage.hh"
+#include "ignition/transport/NodeOptions.hh"
 #include "ignition/transport/Publisher.hh"
 #include "ignition/transport/RepHandler.hh"
 #include "ignition/transport/ReqHandler.hh"
@@ -81,12 +84,15 @@ namespace ignition
       /// deallocates the buffer containing the published data.
       /// \ref http://zeromq.org/blog:zero-copy
       /// \param[in] _msgType Message type in string format.
+      /// \param[in] _hint Optional pointer passed to _ffn as its second
+      /// argument.
       /// \return true when success or false otherwise.
       public: bool Publish(const std::string &_topic,
                            char *_data,
                            const size_t _dataSize,
                            DeallocFunc *_ffn,
-                           const std::string &_msgType);
+                           const std::string &_msgType,
+                           void *_hint = nullptr);
 
       /// \brief Method in charge of receiving the topic updates.
       public: void RecvMsgUpdate();
@@ -160,6 +166,12 @@ namespace ignition
           const std::string &_topic,
           const std::string &_msgType) const;
 
+      /// \brief Get the subscription epoch. The epoch grows every time that
+      /// a local or remote subscriber is added or removed, so publishers can
+      /// cache the result of CheckSubscriberInfo() until it changes.
+      /// \return The subscription epoch.
+      public: uint64_t SubscriptionEpoch() const;
+
       /// \brief Call the SubscriptionHandler callbacks (local and raw) for this
       /// NodeShared.
       /// \param[in] _topic The topic name
@@ -184,6 +196,23 @@ namespace ignition
         const std::string &_msgData,
         const HandlerInfo &_handlerInfo);
 
+      /// \brief Call the SubscriptionHandler callbacks (local and raw) for this
+      /// NodeShared without copying the serialized message.
+      /// \param[in] _info Message information.
+      /// \param[in] _msgData The raw serialized data for the message.
+      /// \param[in] _size The size of the serialized data (bytes).
+      /// \param[in] _owner Object keeping _msgData alive. The callbacks that
+      /// run later share it instead of copying the data. If it is null, the
+      /// data is copied for them.
+      /// \param[in] _handlerInfo Information for the handlers of this node,
+      /// as generated by CheckHandlerInfo(const std::string&) const
+      public: void TriggerCallbacks(
+        const MessageInfo &_info,
+        const char *_msgData,
+        const std::size_t _size,
+        const std::shared_ptr<const void> &_owner,
+        const HandlerInfo &_handlerInfo);
+
       /// \brief Method in charge of receiving the control updates (when a new
       /// remote subscriber notifies its presence for example).
       public: void RecvControlUpdate();
@@ -203,6 +232,73 @@ namespace ignition
                                          const std::string &_reqType,
                                          const std::string &_repType);
 
+      /// \brief Store a subscription handler of a node. A handler that
+      /// doesn't run inline gets its executor before it is visible to the
+      /// reception thread, so none of its messages are discarded. The
+      /// caller must hold the mutex.
+      /// \param[in] _topic Fully qualified topic name.
+      /// \param[in] _nUuid UUID of the node subscribing to the topic.
+      /// \param[in] _handler The subscription handler.
+      public: void AddSubscriptionHandler(const std::string &_topic,
+                  const std::string &_nUuid,
+                  const ISubscriptionHandlerPtr &_handler);
+
+      /// \brief Store a raw subscription handler of a node.
+      /// \sa AddSubscriptionHandler.
+      /// \param[in] _topic Fully qualified topic name.
+      /// \param[in] _nUuid UUID of the node subscribing to the topic.
+      /// \param[in] _handler The raw subscription handler.
+      public: void AddSubscriptionHandler(const std::string &_topic,
+                  const std::string &_nUuid,
+                  const RawSubscriptionHandlerPtr &_handler);
+
+      /// \brief Store the handler of a service advertised by a node. A
+      /// service whose requests run on their own threads gets them before
+      /// the handler is visible to the reception thread, and keeps them
+      /// until Node::UnadvertiseSrv() removes the handler. The caller must
+      /// hold the mutex.
+      /// \param[in] _topic Fully qualified service name.
+      /// \param[in] _nUuid UUID of the node advertising the service.
+      /// \param[in] _handler The reply handler.
+      public: void AddRepHandler(const std::string &_topic,
+                                 const std::string &_nUuid,
+                                 const IRepHandlerPtr &_handler);
+
+      /// \brief Store a new service call request and queue it to be sent.
+      /// The request gets a compact identifier used to match its response.
+      /// The caller must hold the mutex.
+      /// \param[in] _topic Fully qualified service name.
+      /// \param[in] _nUuid UUID of the node making the request.
+      /// \param[in] _handler The request handler.
+      /// \param[in] _policy How to choose the responser of the request.
+      public: void AddRequest(const std::string &_topic,
+                              const std::string &_nUuid,
+                              const IReqHandlerPtr &_handler,
+                              const ResponserPolicy_t _policy =
+                                ResponserPolicy_t::FIRST);
+
+      /// \brief Give up on a service call request that didn't get its
+      /// response in time. A response arriving later is ignored, and the
+      /// responser doesn't count the request as outstanding anymore.
+      /// The caller must hold the mutex.
+      /// \param[in] _topic Fully qualified service name.
+      /// \param[in] _handler The request handler.
+      /// \return True if the request was still waiting for its response,
+      /// or false if the response was already received.
+      public: bool AbandonRequest(const std::string &_topic,
+                                  const IReqHandlerPtr &_handler);
+
+      /// \brief Give up on a service call request if it doesn't get its
+      /// response in time. The reception thread then abandons the request
+      /// (see AbandonRequest()) and notifies its handler of a failed call.
+      /// The caller must hold the mutex.
+      /// \param[in] _topic Fully qualified service name.
+      /// \param[in] _handler The request handler, added with AddRequest().
+      /// \param[in] _timeout Maximum time to wait for the response (ms).
+      public: void AddRequestTimeout(const std::string &_topic,
+                                     const IReqHandlerPtr &_handler,
+                                     const unsigned int _timeout);
+
       /// \brief Callback executed when the discovery detects new topics.
       /// \param[in] _pub Information of the publisher in charge of the topic.
       public: void OnNewConnection(const MessagePublisher &_pub);
@@ -219,6 +315,16 @@ namespace ignition
       /// \param[in] _pub Information of the publisher in charge of the service.
       public: void OnNewSrvDisconnection(const ServicePublisher &_pub);
 
+      /// \brief Get statistics about the queue that delivers published
+      /// messages to the subscribers within this process.
+      /// \param[out] _depth Number of messages waiting in the queue.
+      /// \param[out] _capacity Maximum number of messages in the queue.
+      /// \param[out] _dropped Number of messages dropped because the queue
+      /// was full.
+      public: void PublishQueueStats(std::size_t &_depth,
+                                     std::size_t &_capacity,
+                                     uint64_t &_dropped) const;
+
       /// \brief Pass through to bool Publishers(const std::string &_topic,
       /// Addresses_M<Pub> &_publishers) const
       /// \param[in] _topic Service name.
@@ -256,6 +362,34 @@ namespace ignition
       /// return false if any operation on a ZMQ socket triggered an exception.
       private: bool InitializeSockets();
 
+      /// \brief Send the service replies queued by the services that run on
+      /// their own threads. Only called from the reception thread.
+      private: void SendSrvReplies();
+
+      /// \brief Send again the service requests and replies that were
+      /// waiting for a connection, and give up on those waiting for longer
+      /// than the connection timeout. Only called from the reception thread.
+      private: void RetryPendingSends();
+
+      /// \brief Abandon the requests whose timeout expired, and notify
+      /// their handlers of a failed call. Only called from the reception
+      /// thread.
+      private: void ExpireRequests();
+
+      /// \brief Grant more chunks of a streamed response to its responser,
+      /// or stop the stream. Only called from the reception thread.
+      /// \param[in] _topic Service name.
+      /// \param[in] _responserId Socket ID of the responser.
+      /// \param[in] _nodeUuid UUID of the requesting node.
+      /// \param[in] _reqId Identifier of the request.
+      /// \param[in] _credits Number of chunks granted, or 0 to stop the
+      /// stream.
+      private: void SendStreamCredit(const std::string &_topic,
+                                     const std::string &_responserId,
+                                     const std::string &_nodeUuid,
+                                     const uint64_t _reqId,
+                                     const int _credits);
+
       //////////////////////////////////////////////////
       /////// Declare here other member variables //////
       //////////////////////////////////////////////////
@@ -279,6 +413,10 @@ namespace ignition
       public: std::thread threadReception;
 
       /// \brief Mutex to guarantee exclusive access between all threads.
+      /// It serializes operations that change the subscriptions, the
+      /// services and the connections. The handler and topic storages are
+      /// thread safe on their own, so the publish and receive paths don't
+      /// need it.
       public: mutable std::recursive_mutex mutex;
 
       /// \brief Port used by the message discovery layer.
@@ -30,12 +30,14 @@
 #include <google/protobuf/stubs/casts.h>
 #endif
 
+#include <algorithm>
 #include <functional>
 #include <iostream>
 #include <memory>
 #include <string>
 
 #include "ignition/transport/config.hh"
+#include "ignition/transport/AdvertiseOptions.hh"
 #include "ignition/transport/Export.hh"
 #include "ignition/transport/TransportTypes.hh"
 #include "ignition/transport/Uuid.hh"
@@ -76,6 +78,41 @@ namespace ignition
       public: virtual bool RunCallback(const std::string &_req,
                                        std::string &_rep) = 0;
 
+      /// \brief Whether the service streams its response in chunks.
+      /// \return True for streaming services.
+      public: virtual bool IsStream() const
+      {
+        return false;
+      }
+
+      /// \brief Executes the local callback of a streaming service.
+      /// \param[in] _msgReq Input parameter (Protobuf message).
+      /// \param[in] _send Function receiving each chunk of the response. It
+      /// returns false when the requester doesn't want more chunks.
+      /// \return Service call result.
+      public: virtual bool RunLocalStreamCallback(
+        const transport::ProtoMsg &/*_msgReq*/,
+        const std::function<bool(const transport::ProtoMsg &)> &/*_send*/)
+      {
+        std::cerr << "IRepHandler::RunLocalStreamCallback() error: "
+                  << "not a streaming service" << std::endl;
+        return false;
+      }
+
+      /// \brief Executes the callback of a streaming service.
+      /// \param[in] _req Serialized request.
+      /// \param[in] _send Function receiving each serialized chunk of the
+      /// response. It returns false when the requester doesn't want more
+      /// chunks.
+      /// \return Service call result.
+      public: virtual bool RunStreamCallback(const std::string &/*_req*/,
+        const std::function<bool(const std::string &)> &/*_send*/)
+      {
+        std::cerr << "IRepHandler::RunStreamCallback() error: "
+                  << "not a streaming service" << std::endl;
+        return false;
+      }
+
       /// \brief Get the unique UUID of this handler.
       /// \return a string representation of the handler UUID.
       public: std::string HandlerUuid() const
@@ -83,6 +120,26 @@ namespace ignition
         return this->hUuid;
       }
 
+      /// \brief Get the maximum number of requests running at the same time.
+      /// \return The maximum number of requests, or 0 if they run on the
+      /// reception thread.
+      /// \sa AdvertiseServiceOptions::MaxConcurrency
+      public: unsigned int MaxConcurrency() const
+      {
+        return this->maxConcurrency;
+      }
+
+      /// \brief Set the maximum number of requests running at the same time.
+      /// \param[in] _maxConcurrency The maximum number of requests, or 0 to
+      /// run them on the reception thread. Values larger than
+      /// AdvertiseServiceOptions::kMaxConcurrency are reduced to it.
+      /// \sa AdvertiseServiceOptions::SetMaxConcurrency
+      public: void SetMaxConcurrency(const unsigned int _maxConcurrency)
+      {
+        this->maxConcurrency = std::min(_maxConcurrency,
+            AdvertiseServiceOptions::kMaxConcurrency);
+      }
+
       /// \brief Get the message type name used in the service request.
       /// \return Message type name.
       public: virtual std::string ReqTypeName() const = 0;
@@ -102,6 +159,9 @@ namespace ignition
 #ifdef _WIN32
 #pragma warning(pop)
 #endif
+
+      /// \brief Maximum number of requests running at the same time.
+      private: unsigned int maxConcurrency = 0;
     };
 
     /// \class RepHandler RepHandler.hh
@@ -218,6 +278,136 @@ namespace ignition
       /// \brief Callback to the function registered for this handler.
       private: std::function<bool(const Req &, Rep &)> cb;
     };
+
+    /// \class RepStreamHandler RepHandler.hh
+    /// \brief Service reply handler of a streaming service. Its callback
+    /// sends the response in chunks, each one a 'Rep' protobuf message.
+    template <typename Req, typename Rep> class RepStreamHandler
+      : public IRepHandler
+    {
+      // Documentation inherited.
+      public: RepStreamHandler() = default;
+
+      /// \brief Set the callback for this handler.
+      /// \param[in] _cb The callback with the following parameters:
+      /// \param[in] _req Protobuf message containing the service request
+      /// params.
+      /// \param[in] _send Function sending a chunk of the response. It
+      /// blocks while the requester is behind, and returns false if the
+      /// requester doesn't want more chunks.
+      /// The callback returns true when the service call is considered
+      /// successful or false otherwise.
+      public: void SetCallback(const std::function<bool(const Req &,
+        const std::function<bool(const Rep &)> &)> &_cb)
+      {
+        this->cb = _cb;
+      }
+
+      // Documentation inherited.
+      public: bool IsStream() const
+      {
+        return true;
+      }
+
+      /// \brief A streaming service can't run as a regular service.
+      /// \return Always false.
+      public: bool RunLocalCallback(const transport::ProtoMsg &/*_msgReq*/,
+                                    transport::ProtoMsg &/*_msgRep*/)
+      {
+        std::cerr << "RepStreamHandler::RunLocalCallback() error: "
+                  << "streaming services must be requested with "
+                  << "Node::RequestStream()" << std::endl;
+        return false;
+      }
+
+      /// \brief A streaming service can't run as a regular service.
+      /// \return Always false.
+      public: bool RunCallback(const std::string &/*_req*/,
+                               std::string &/*_rep*/)
+      {
+        std::cerr << "RepStreamHandler::RunCallback() error: "
+                  << "streaming services must be requested with "
+                  << "Node::RequestStream()" << std::endl;
+        return false;
+      }
+
+      // Documentation inherited.
+      public: bool RunLocalStreamCallback(const transport::ProtoMsg &_msgReq,
+        const std::function<bool(const transport::ProtoMsg &)> &_send)
+      {
+        if (!this->cb)
+        {
+          std::cerr << "RepStreamHandler::RunLocalStreamCallback() error: "
+                    << "Callback is NULL" << std::endl;
+          return false;
+        }
+
+#if GOOGLE_PROTOBUF_VERSION > 2999999
+        auto msgReq = google::protobuf::down_cast<const Req*>(&_msgReq);
+#else
+        auto msgReq =
+          google::protobuf::internal::down_cast<const Req*>(&_msgReq);
+#endif
+
+        std::function<bool(const Rep &)> send = [&_send](const Rep &_chunk)
+        {
+          return _send(_chunk);
+        };
+
+        return this->cb(*msgReq, send);
+      }
+
+      // Documentation inherited.
+      public: bool RunStreamCallback(const std::string &_req,
+        const std::function<bool(const std::string &)> &_send)
+      {
+        if (!this->cb)
+        {
+          std::cerr << "RepStreamHandler::RunStreamCallback() error: "
+                    << "Callback is NULL" << std::endl;
+          return false;
+        }
+
+        Req msgReq;
+        if (!msgReq.ParseFromString(_req))
+        {
+          std::cerr << "RepStreamHandler::RunStreamCallback() error: "
+                    << "ParseFromString failed" << std::endl;
+          return false;
+        }
+
+        std::function<bool(const Rep &)> send = [&_send](const Rep &_chunk)
+        {
+          std::string data;
+          if (!_chunk.SerializeToString(&data))
+          {
+            std::cerr << "RepStreamHandler::RunStreamCallback(): Error "
+                      << "serializing a chunk of the response" << std::endl;
+            return false;
+          }
+
+          return _send(data);
+        };
+
+        return this->cb(msgReq, send);
+      }
+
+      // Documentation inherited.
+      public: virtual std::string ReqTypeName() const
+      {
+        return Req().GetTypeName();
+      }
+
+      // Documentation inherited.
+      public: virtual std::string RepTypeName() const
+      {
+        return Rep().GetTypeName();
+      }
+
+      /// \brief Callback to the function registered for this handler.
+      private: std::function<bool(const Req &,
+        const std::function<bool(const Rep &)> &)> cb;
+    };
     }
   }
 }
@@ -27,9 +27,13 @@
 #endif
 
 #include <condition_variable>
+#include <cstddef>
+#include <cstdint>
 #include <functional>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "ignition/transport/config.hh"
 #include "ignition/transport/Export.hh"
@@ -55,6 +59,7 @@ namespace ignition
           nUuid(_nUuid),
           result(false),
           requested(false),
+          reqId(0),
           repAvailable(false)
       {
       }
@@ -106,11 +111,58 @@ namespace ignition
         this->requested = _value;
       }
 
+      /// \brief Get the compact identifier used to match the response with
+      /// this request. It's only unique within this process.
+      /// \return The identifier or 0 if it wasn't assigned yet.
+      public: uint64_t RequestId() const
+      {
+        return this->reqId;
+      }
+
+      /// \brief Set the compact identifier of the request.
+      /// \param[in] _id The identifier.
+      public: void RequestId(const uint64_t _id)
+      {
+        this->reqId = _id;
+      }
+
       /// \brief Serialize the Req protobuf message stored.
       /// \param[out] _buffer The serialized data.
       /// \return True if the serialization succeed or false otherwise.
       public: virtual bool Serialize(std::string &_buffer) const = 0;
 
+      /// \brief Serialize all the Req protobuf messages stored. A handler
+      /// can carry a batch of requests that are sent together.
+      /// \param[out] _buffers The serialized data, one per request.
+      /// \return True if the serialization succeed or false otherwise.
+      public: virtual bool SerializeBatch(
+        std::vector<std::string> &_buffers) const
+      {
+        _buffers.resize(1);
+        return this->Serialize(_buffers[0]);
+      }
+
+      /// \brief Notify the responses to all the requests of the handler.
+      /// \param[in] _reps Serialized responses and results of the service
+      /// calls, in the order of the requests.
+      public: virtual void NotifyBatchResult(
+        const std::vector<std::pair<std::string, bool>> &_reps)
+      {
+        if (_reps.empty())
+          this->NotifyResult("", false);
+        else
+          this->NotifyResult(_reps.front().first, _reps.front().second);
+      }
+
+      /// \brief Notify a chunk of a streamed response. The handlers of
+      /// regular requests ignore it.
+      /// \param[in] _rep Serialized chunk.
+      /// \return False to stop the stream.
+      public: virtual bool NotifyChunk(const std::string &/*_rep*/)
+      {
+        return true;
+      }
+
       /// \brief Returns the unique handler UUID.
       /// \return The handler's UUID.
       public: std::string HandlerUuid() const
@@ -174,6 +226,10 @@ namespace ignition
       /// its way. Used to not resend the same REQ more than one time.
       private: bool requested;
 
+      /// \brief Compact identifier of the request, assigned by NodeShared
+      /// when the request is queued.
+      private: uint64_t reqId;
+
       /// \brief When there is a blocking service call request, the call can
       /// be unlocked when a service call REP is available. This variable
       /// captures if we have found a node that can satisty our request.
@@ -408,6 +464,214 @@ namespace ignition
       /// \brief Protobuf message containing the response.
       private: google::protobuf::Message *repMsg = nullptr;
     };
+
+    /// \class ReqBatchHandler ReqHandler.hh
+    /// \brief Request handler carrying a batch of requests of the same
+    /// types. All the requests travel to the responser in one message and
+    /// all the responses come back in another one.
+    template <typename Req, typename Rep> class ReqBatchHandler
+      : public IReqHandler
+    {
+      // Documentation inherited.
+      public: explicit ReqBatchHandler(const std::string &_nUuid)
+        : IReqHandler(_nUuid)
+      {
+      }
+
+      /// \brief Set the REQ protobuf messages for this handler.
+      /// \param[in] _reqMsgs Protobuf messages containing the input
+      /// parameters of the service requests.
+      public: void SetMessages(const std::vector<Req> &_reqMsgs)
+      {
+        this->reqMsgs = _reqMsgs;
+      }
+
+      /// \brief Get the serialized responses and results of the service
+      /// calls, in the order of the requests.
+      /// \return The responses.
+      public: const std::vector<std::pair<std::string, bool>> &Responses()
+        const
+      {
+        return this->reps;
+      }
+
+      /// \brief Serialize the first Req protobuf message stored.
+      /// \param[out] _buffer The serialized data.
+      /// \return True if the serialization succeed or false otherwise.
+      public: bool Serialize(std::string &_buffer) const
+      {
+        if (this->reqMsgs.empty())
+        {
+          std::cerr << "ReqBatchHandler::Serialize() no requests" << std::endl;
+          return false;
+        }
+
+        if (!this->reqMsgs.front().SerializeToString(&_buffer))
+        {
+          std::cerr << "ReqBatchHandler::Serialize(): Error serializing the "
+                    << "request" << std::endl;
+          return false;
+        }
+
+        return true;
+      }
+
+      // Documentation inherited.
+      public: bool SerializeBatch(std::vector<std::string> &_buffers) const
+      {
+        if (this->reqMsgs.empty())
+        {
+          std::cerr << "ReqBatchHandler::SerializeBatch() no requests"
+                    << std::endl;
+          return false;
+        }
+
+        _buffers.resize(this->reqMsgs.size());
+        for (std::size_t i = 0; i < this->reqMsgs.size(); ++i)
+        {
+          if (!this->reqMsgs[i].SerializeToString(&_buffers[i]))
+          {
+            std::cerr << "ReqBatchHandler::SerializeBatch(): Error "
+                      << "serializing the request" << std::endl;
+            return false;
+          }
+        }
+
+        return true;
+      }
+
+      // Documentation inherited.
+      public: void NotifyResult(const std::string &_rep, const bool _result)
+      {
+        this->NotifyBatchResult({std::make_pair(_rep, _result)});
+      }
+
+      // Documentation inherited.
+      public: void NotifyBatchResult(
+        const std::vector<std::pair<std::string, bool>> &_reps)
+      {
+        this->reps = _reps;
+        this->result = !_reps.empty();
+
+        this->repAvailable = true;
+        this->condition.notify_one();
+      }
+
+      // Documentation inherited.
+      public: virtual std::string ReqTypeName() const
+      {
+        return Req().GetTypeName();
+      }
+
+      // Documentation inherited.
+      public: virtual std::string RepTypeName() const
+      {
+        return Rep().GetTypeName();
+      }
+
+      /// \brief Protobuf messages containing the requests' parameters.
+      private: std::vector<Req> reqMsgs;
+
+      /// \brief Serialized responses and results of the service calls.
+      private: std::vector<std::pair<std::string, bool>> reps;
+    };
+
+    /// \class ReqStreamHandler ReqHandler.hh
+    /// \brief Request handler of a streaming service. Each chunk of the
+    /// response is a 'Rep' protobuf message passed to a callback as soon as
+    /// it arrives, and another callback is notified when the stream ends.
+    template <typename Req, typename Rep> class ReqStreamHandler
+      : public IReqHandler
+    {
+      // Documentation inherited.
+      public: explicit ReqStreamHandler(const std::string &_nUuid)
+        : IReqHandler(_nUuid)
+      {
+      }
+
+      /// \brief Set the REQ protobuf message for this handler.
+      /// \param[in] _reqMsg Protobuf message containing the input
+      /// parameters of the service request.
+      public: void SetMessage(const Req &_reqMsg)
+      {
+        this->reqMsg.CopyFrom(_reqMsg);
+      }
+
+      /// \brief Set the callbacks for this handler.
+      /// \param[in] _chunkCb Callback receiving each chunk. It returns false
+      /// to stop the stream.
+      /// \param[in] _doneCb Callback receiving the result of the service
+      /// call when the stream ends.
+      public: void SetCallbacks(
+        const std::function<bool(const Rep &_chunk)> &_chunkCb,
+        const std::function<void(const bool _result)> &_doneCb)
+      {
+        this->chunkCb = _chunkCb;
+        this->doneCb = _doneCb;
+      }
+
+      // Documentation inherited
+      public: bool Serialize(std::string &_buffer) const
+      {
+        if (!this->reqMsg.SerializeToString(&_buffer))
+        {
+          std::cerr << "ReqStreamHandler::Serialize(): Error serializing the "
+                    << "request" << std::endl;
+          return false;
+        }
+
+        return true;
+      }
+
+      // Documentation inherited.
+      public: bool NotifyChunk(const std::string &_rep)
+      {
+        Rep msg;
+        if (!msg.ParseFromString(_rep))
+        {
+          std::cerr << "ReqStreamHandler::NotifyChunk() error: "
+                    << "ParseFromString failed" << std::endl;
+          return false;
+        }
+
+        return !this->chunkCb || this->chunkCb(msg);
+      }
+
+      /// \brief Notify the end of the stream.
+      /// \param[in] _rep Unused.
+      /// \param[in] _result Result of the service call.
+      public: void NotifyResult(const std::string &/*_rep*/,
+                                const bool _result)
+      {
+        if (this->doneCb)
+          this->doneCb(_result);
+
+        this->result = _result;
+        this->repAvailable = true;
+        this->condition.notify_one();
+      }
+
+      // Documentation inherited.
+      public: virtual std::string ReqTypeName() const
+      {
+        return Req().GetTypeName();
+      }
+
+      // Documentation inherited.
+      public: virtual std::string RepTypeName() const
+      {
+        return Rep().GetTypeName();
+      }
+
+      /// \brief Protobuf message containing the request's parameters.
+      private: Req reqMsg;
+
+      /// \brief Callback receiving the chunks.
+      private: std::function<bool(const Rep &_chunk)> chunkCb;
+
+      /// \brief Callback notified at the end of the stream.
+      private: std::function<void(const bool _result)> doneCb;
+    };
     }
   }
 }
@@ -33,6 +33,30 @@ namespace ignition
     //
     class SubscribeOptionsPrivate;
 
+    /// \def Executor_t This strongly typed enum defines the different
+    /// threading models available to run the callbacks of a subscription.
+    /// Whatever the executor, the callbacks of a subscription never run
+    /// concurrently and they run in the order in which the messages were
+    /// received.
+    enum class Executor_t
+    {
+      /// \brief Use the executor set in the NodeOptions of the subscribing
+      /// node (SINGLE_THREADED unless changed).
+      DEFAULT,
+      /// \brief Run the callback on the thread delivering the message. All
+      /// the subscriptions of the process share this thread.
+      SINGLE_THREADED,
+      /// \brief Run the callback on a fixed size pool of threads shared by
+      /// the whole process. Its size is set with the
+      /// IGN_TRANSPORT_EXECUTOR_THREADS environment variable.
+      POOL,
+      /// \brief Run the callback on the shared pool, serialized with the
+      /// callbacks of all the TOPIC_STRAND subscriptions to the same topic.
+      TOPIC_STRAND,
+      /// \brief Run the callback on a thread owned by the subscription.
+      DEDICATED
+    };
+
     /// \class SubscribeOptions SubscribeOptions.hh
     /// ignition/transport/SubscribeOptions.hh
     /// \brief A class to provide different options for a subscription.
@@ -66,6 +90,18 @@ namespace ignition
       /// \return The maximum number of messages per second.
       public: uint64_t MsgsPerSec() const;
 
+      /// \brief Set the executor running the callbacks of the subscription.
+      /// E.g.: a subscriber with a fast control loop can use DEDICATED to
+      /// stay isolated from slow callbacks on other topics.
+      /// \param[in] _executor The executor.
+      /// \sa Executor_t
+      public: void SetExecutor(const Executor_t _executor);
+
+      /// \brief Get the executor running the callbacks of the subscription.
+      /// \return The executor.
+      /// \sa Executor_t
+      public: Executor_t Executor() const;
+
 #ifdef _WIN32
 // Disable warning C4251 which is triggered by
 // std::unique_ptr
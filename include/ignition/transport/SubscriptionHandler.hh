@@ -33,6 +33,7 @@
 #endif
 
 #include <chrono>
+#include <cstddef>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -81,6 +82,10 @@ namespace ignition
       /// \return A string representation of the handler UUID.
       public: std::string HandlerUuid() const;
 
+      /// \brief Get the executor requested for running the callbacks.
+      /// \return The executor set in the subscribe options.
+      public: Executor_t Executor() const;
+
       /// \brief Check if message subscription is throttled. If so, verify
       /// whether the callback should be executed or not.
       /// \return true if the callback should be executed or false otherwise.
@@ -148,6 +153,17 @@ namespace ignition
       public: virtual const std::shared_ptr<ProtoMsg> CreateMsg(
         const std::string &_data,
         const std::string &_type) const = 0;
+
+      /// \brief Create a specific protobuf message given its serialized data.
+      /// The data is parsed in place, it is not copied.
+      /// \param[in] _data The serialized data.
+      /// \param[in] _size The size of the serialized data (bytes).
+      /// \param[in] _type The data type.
+      /// \return Pointer to the specific protobuf message.
+      public: virtual const std::shared_ptr<ProtoMsg> CreateMsg(
+        const char *_data,
+        const std::size_t _size,
+        const std::string &_type) const;
     };
 
     /// \class SubscriptionHandler SubscriptionHandler.hh
@@ -182,6 +198,25 @@ namespace ignition
         return msgPtr;
       }
 
+      // Documentation inherited.
+      public: const std::shared_ptr<ProtoMsg> CreateMsg(
+        const char *_data,
+        const std::size_t _size,
+        const std::string &/*_type*/) const
+      {
+        // Instantiate a specific protobuf message
+        auto msgPtr = std::make_shared<T>();
+
+        // Create the message using some serialized data
+        if (!msgPtr->ParseFromArray(_data, static_cast<int>(_size)))
+        {
+          std::cerr << "SubscriptionHandler::CreateMsg() error: ParseFromArray"
+                    << " failed" << std::endl;
+        }
+
+        return msgPtr;
+      }
+
       // Documentation inherited.
       public: std::string TypeName()
       {
@@ -241,6 +276,15 @@ namespace ignition
       public: const std::shared_ptr<ProtoMsg> CreateMsg(
         const std::string &_data,
         const std::string &_type) const
+      {
+        return this->CreateMsg(_data.data(), _data.size(), _type);
+      }
+
+      // Documentation inherited.
+      public: const std::shared_ptr<ProtoMsg> CreateMsg(
+        const char *_data,
+        const std::size_t _size,
+        const std::string &_type) const
       {
         std::shared_ptr<google::protobuf::Message> msgPtr;
 
@@ -265,9 +309,9 @@ namespace ignition
           return nullptr;
 
         // Create the message using some serialized data
-        if (!msgPtr->ParseFromString(_data))
+        if (!msgPtr->ParseFromArray(_data, static_cast<int>(_size)))
         {
-          std::cerr << "CreateMsg() error: ParseFromString failed" << std::endl;
+          std::cerr << "CreateMsg() error: ParseFromArray failed" << std::endl;
           return nullptr;
         }
 
@@ -19,8 +19,17 @@
 #define IGN_TRANSPORT_TOPICSTORAGE_HH_
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
 #include <map>
+#include <mutex>
+#include <shared_mutex>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "ignition/transport/config.hh"
@@ -38,6 +47,15 @@ namespace ignition
     /// \class TopicStorage TopicStorage.hh ignition/transport/TopicStorage.hh
     /// \brief Store address information about topics and provide convenient
     /// methods for adding new topics, removing them, etc.
+    ///
+    /// The topics are spread over a fixed number of shards, each one
+    /// protected by its own reader-writer lock, so all the functions are
+    /// thread safe. Functions looking at a single topic only lock its shard.
+    /// Functions looking at all the topics visit the shards one at a time.
+    ///
+    /// Secondary indexes by process UUID, node UUID and address are updated
+    /// with every change, so the lookups by process, node or address only
+    /// visit the topics involved instead of the whole storage.
     template<typename T> class TopicStorage
     {
       /// \brief Constructor.
@@ -52,16 +70,12 @@ namespace ignition
       /// was already stored).
       public: bool AddPublisher(const T &_publisher)
       {
-        // The topic does not exist.
-        if (this->data.find(_publisher.Topic()) == this->data.end())
-        {
-          // VS2013 is buggy with initializer list here {}
-          this->data[_publisher.Topic()] =
-            std::map<std::string, std::vector<T>>();
-        }
+        Shard &shard = this->ShardOf(_publisher.Topic());
+        std::unique_lock<std::shared_mutex> lk(shard.mutex);
 
-        // Check if the process uuid exists.
-        auto &m = this->data[_publisher.Topic()];
+        // Create the topic entry if needed and check if the process uuid
+        // exists.
+        auto &m = shard.data[_publisher.Topic()];
         if (m.find(_publisher.PUuid()) != m.end())
         {
           // Check that the Publisher does not exist.
@@ -80,6 +94,8 @@ namespace ignition
 
         // Add a new Publisher entry.
         m[_publisher.PUuid()].push_back(T(_publisher));
+        this->Index(_publisher);
+        ++this->version;
         return true;
       }
 
@@ -88,7 +104,9 @@ namespace ignition
       /// \return True if there is at least one entry stored for the topic.
       public: bool HasTopic(const std::string &_topic) const
       {
-        return this->data.find(_topic) != this->data.end();
+        const Shard &shard = this->ShardOf(_topic);
+        std::shared_lock<std::shared_mutex> lk(shard.mutex);
+        return shard.data.find(_topic) != shard.data.end();
       }
 
       /// \brief Return if there is any publisher stored for the given topic and
@@ -100,11 +118,15 @@ namespace ignition
       public: bool HasTopic(const std::string &_topic,
                             const std::string &_type) const
       {
-        if (!this->HasTopic(_topic))
+        const Shard &shard = this->ShardOf(_topic);
+        std::shared_lock<std::shared_mutex> lk(shard.mutex);
+
+        auto it = shard.data.find(_topic);
+        if (it == shard.data.end())
           return false;
 
         // m is {pUUID=>std::vector<Publisher>}.
-        auto &m = this->data.at(_topic);
+        auto &m = it->second;
 
         for (auto const &procs : m)
         {
@@ -134,11 +156,14 @@ namespace ignition
       public: bool HasAnyPublishers(const std::string &_topic,
                                     const std::string &_pUuid) const
       {
-        if (!this->HasTopic(_topic))
+        const Shard &shard = this->ShardOf(_topic);
+        std::shared_lock<std::shared_mutex> lk(shard.mutex);
+
+        auto it = shard.data.find(_topic);
+        if (it == shard.data.end())
           return false;
 
-        return this->data.at(_topic).find(_pUuid) !=
-               this->data.at(_topic).end();
+        return it->second.find(_pUuid) != it->second.end();
       }
 
       /// \brief Return if the requested publisher's address is stored.
@@ -146,18 +171,8 @@ namespace ignition
       /// \return true if the publisher's address is stored.
       public: bool HasPublisher(const std::string &_addr) const
       {
-        for (auto const &topic : this->data)
-        {
-          for (auto const &proc : topic.second)
-          {
-            for (auto const &pub : proc.second)
-            {
-              if (pub.Addr() == _addr)
-                return true;
-            }
-          }
-        }
-        return false;
+        std::lock_guard<std::mutex> lk(this->indexMutex);
+        return this->byAddr.find(_addr) != this->byAddr.end();
       }
 
       /// \brief Get the address information for a given topic and node UUID.
@@ -171,12 +186,16 @@ namespace ignition
                              const std::string &_nUuid,
                              T &_publisher) const
       {
+        const Shard &shard = this->ShardOf(_topic);
+        std::shared_lock<std::shared_mutex> lk(shard.mutex);
+
         // Topic not found.
-        if (this->data.find(_topic) == this->data.end())
+        auto it = shard.data.find(_topic);
+        if (it == shard.data.end())
           return false;
 
         // m is {pUUID=>Publisher}.
-        auto &m = this->data.at(_topic);
+        auto &m = it->second;
 
         // pUuid not found.
         if (m.find(_pUuid) == m.end())
@@ -207,10 +226,14 @@ namespace ignition
       public: bool Publishers(const std::string &_topic,
                              std::map<std::string, std::vector<T>> &_info) const
       {
-        if (!this->HasTopic(_topic))
+        const Shard &shard = this->ShardOf(_topic);
+        std::shared_lock<std::shared_mutex> lk(shard.mutex);
+
+        auto it = shard.data.find(_topic);
+        if (it == shard.data.end())
           return false;
 
-        _info = this->data.at(_topic);
+        _info = it->second;
         return true;
       }
 
@@ -223,36 +246,45 @@ namespace ignition
                                       const std::string &_pUuid,
                                       const std::string &_nUuid)
       {
+        Shard &shard = this->ShardOf(_topic);
+        std::unique_lock<std::shared_mutex> lk(shard.mutex);
+
         size_t counter = 0;
 
         // Iterate over all the topics.
-        if (this->data.find(_topic) != this->data.end())
+        if (shard.data.find(_topic) != shard.data.end())
         {
           // m is {pUUID=>Publisher}.
-          auto &m = this->data[_topic];
+          auto &m = shard.data[_topic];
 
           // The pUuid exists.
           if (m.find(_pUuid) != m.end())
           {
             // Vector of 0MQ known addresses for a given topic and pUuid.
+            // Keep the removed publishers intact at the end, so they can
+            // be removed from the indexes.
             auto &v = m[_pUuid];
-            auto priorSize = v.size();
-            v.erase(std::remove_if(v.begin(), v.end(),
+            auto removed = std::stable_partition(v.begin(), v.end(),
               [&](const T &_pub)
               {
-                return _pub.NUuid() == _nUuid;
-              }),
-              v.end());
-            counter = priorSize - v.size();
+                return _pub.NUuid() != _nUuid;
+              });
+            for (auto pub = removed; pub != v.end(); ++pub)
+              this->Unindex(*pub);
+            counter = static_cast<size_t>(std::distance(removed, v.end()));
+            v.erase(removed, v.end());
 
             if (v.empty())
               m.erase(_pUuid);
 
             if (m.empty())
-              this->data.erase(_topic);
+              shard.data.erase(_topic);
           }
         }
 
+        if (counter > 0)
+          ++this->version;
+
         return counter > 0;
       }
 
@@ -263,18 +295,34 @@ namespace ignition
       {
         size_t counter = 0;
 
-        // Iterate over all the topics.
-        for (auto it = this->data.begin(); it != this->data.end();)
+        // Only visit the topics of the process.
+        for (auto const &topic : this->TopicsOf(_pUuid))
         {
+          Shard &shard = this->ShardOf(topic);
+          std::unique_lock<std::shared_mutex> lk(shard.mutex);
+
+          auto it = shard.data.find(topic);
+          if (it == shard.data.end())
+            continue;
+
           // m is {pUUID=>Publisher}.
           auto &m = it->second;
-          counter += m.erase(_pUuid);
+          auto proc = m.find(_pUuid);
+          if (proc == m.end())
+            continue;
+
+          for (auto const &pub : proc->second)
+            this->Unindex(pub);
+          m.erase(proc);
+          ++counter;
+
           if (m.empty())
-            this->data.erase(it++);
-          else
-            ++it;
+            shard.data.erase(it);
         }
 
+        if (counter > 0)
+          ++this->version;
+
         return counter > 0;
       }
 
@@ -288,19 +336,24 @@ namespace ignition
       {
         _pubs.clear();
 
-        // Iterate over all the topics.
-        for (auto const &topic : this->data)
+        // Only visit the topics of the process.
+        for (auto const &topic : this->TopicsOf(_pUuid))
         {
+          const Shard &shard = this->ShardOf(topic);
+          std::shared_lock<std::shared_mutex> lk(shard.mutex);
+
+          auto it = shard.data.find(topic);
+          if (it == shard.data.end())
+            continue;
+
           // m is {pUUID=>Publisher}.
-          auto &m = topic.second;
-          if (m.find(_pUuid) != m.end())
-          {
-            auto &v = m.at(_pUuid);
-            for (auto const &pub : v)
-            {
-              _pubs[pub.NUuid()].push_back(T(pub));
-            }
-          }
+          auto &m = it->second;
+          auto proc = m.find(_pUuid);
+          if (proc == m.end())
+            continue;
+
+          for (auto const &pub : proc->second)
+            _pubs[pub.NUuid()].push_back(T(pub));
         }
       }
 
@@ -315,57 +368,200 @@ namespace ignition
       {
         _pubs.clear();
 
-        // Iterate over all the topics.
-        for (auto const &topic : this->data)
+        // Only visit the topics of the node.
+        for (auto const &topic : this->TopicsOf(_pUuid, &_nUuid))
         {
+          const Shard &shard = this->ShardOf(topic);
+          std::shared_lock<std::shared_mutex> lk(shard.mutex);
+
+          auto it = shard.data.find(topic);
+          if (it == shard.data.end())
+            continue;
+
           // m is {pUUID=>Publisher}.
-          auto const &m = topic.second;
-          if (m.find(_pUuid) != m.end())
+          auto const &m = it->second;
+          auto proc = m.find(_pUuid);
+          if (proc == m.end())
+            continue;
+
+          for (auto const &pub : proc->second)
           {
-            auto const &v = m.at(_pUuid);
-            for (auto const &pub : v)
-            {
-              if (pub.NUuid() == _nUuid)
-              {
-                _pubs.push_back(T(pub));
-              }
-            }
+            if (pub.NUuid() == _nUuid)
+              _pubs.push_back(T(pub));
           }
         }
       }
 
       /// \brief Get the list of topics currently stored.
-      /// \param[out] _topics List of stored topics.
+      /// \param[out] _topics List of stored topics, in alphabetical order.
       public: void TopicList(std::vector<std::string> &_topics) const
       {
-        for (auto const &topic : this->data)
-          _topics.push_back(topic.first);
+        std::vector<std::string> topics;
+        for (auto const &shard : this->shards)
+        {
+          std::shared_lock<std::shared_mutex> lk(shard.mutex);
+          for (auto const &topic : shard.data)
+            topics.push_back(topic.first);
+        }
+
+        std::sort(topics.begin(), topics.end());
+        _topics.insert(_topics.end(), topics.begin(), topics.end());
       }
 
       /// \brief Print all the information for debugging purposes.
       public: void Print() const
       {
         std::cout << "---" << std::endl;
-        for (auto const &topic : this->data)
+        for (auto const &shard : this->shards)
         {
-          std::cout << "[" << topic.first << "]" << std::endl;
-          auto &m = topic.second;
-          for (auto const &proc : m)
+          std::shared_lock<std::shared_mutex> lk(shard.mutex);
+          for (auto const &topic : shard.data)
           {
-            std::cout << "\tProc. UUID: " << proc.first << std::endl;
-            auto &v = proc.second;
-            for (auto const &publisher : v)
+            std::cout << "[" << topic.first << "]" << std::endl;
+            auto &m = topic.second;
+            for (auto const &proc : m)
             {
-              std::cout << publisher;
+              std::cout << "\tProc. UUID: " << proc.first << std::endl;
+              auto &v = proc.second;
+              for (auto const &publisher : v)
+              {
+                std::cout << publisher;
+              }
             }
           }
         }
       }
 
-      /// \brief The keys are topics. The values are another map, where the key
-      /// is the process UUID and the value a vector of publishers.
-      private: std::map<std::string,
-                        std::map<std::string, std::vector<T>>> data;
+      /// \brief Get the version of the storage. The version grows every
+      /// time that a publisher is added or removed.
+      /// \return The version.
+      public: uint64_t Version() const
+      {
+        return this->version.load(std::memory_order_acquire);
+      }
+
+      /// \brief Number of shards.
+      private: static const std::size_t kNumShards = 16;
+
+      /// \brief A subset of the topics and the lock protecting them.
+      private: struct Shard
+               {
+                 /// \brief Readers share the lock, writers own it.
+                 public: mutable std::shared_mutex mutex;
+
+                 /// \brief The keys are topics. The values are another map,
+                 /// where the key is the process UUID and the value a vector
+                 /// of publishers.
+                 public: std::map<std::string,
+                                  std::map<std::string, std::vector<T>>> data;
+               };
+
+      /// \brief Get the shard storing a topic.
+      /// \param[in] _topic Topic name.
+      /// \return The shard.
+      private: Shard &ShardOf(const std::string &_topic)
+      {
+        return this->shards[std::hash<std::string>()(_topic) % kNumShards];
+      }
+
+      /// \brief Get the shard storing a topic.
+      /// \param[in] _topic Topic name.
+      /// \return The shard.
+      private: const Shard &ShardOf(const std::string &_topic) const
+      {
+        return this->shards[std::hash<std::string>()(_topic) % kNumShards];
+      }
+
+      /// \brief Add a publisher to the indexes. The shard of its topic has
+      /// to be locked.
+      /// \param[in] _pub The publisher.
+      private: void Index(const T &_pub)
+      {
+        std::lock_guard<std::mutex> lk(this->indexMutex);
+        ++this->byProc[_pub.PUuid()][_pub.NUuid()][_pub.Topic()];
+        ++this->byAddr[_pub.Addr()];
+      }
+
+      /// \brief Remove a publisher from the indexes. The shard of its topic
+      /// has to be locked.
+      /// \param[in] _pub The publisher.
+      private: void Unindex(const T &_pub)
+      {
+        std::lock_guard<std::mutex> lk(this->indexMutex);
+
+        auto proc = this->byProc.find(_pub.PUuid());
+        if (proc != this->byProc.end())
+        {
+          auto node = proc->second.find(_pub.NUuid());
+          if (node != proc->second.end())
+          {
+            auto topic = node->second.find(_pub.Topic());
+            if (topic != node->second.end() && --topic->second == 0u)
+              node->second.erase(topic);
+            if (node->second.empty())
+              proc->second.erase(node);
+          }
+          if (proc->second.empty())
+            this->byProc.erase(proc);
+        }
+
+        auto addr = this->byAddr.find(_pub.Addr());
+        if (addr != this->byAddr.end() && --addr->second == 0u)
+          this->byAddr.erase(addr);
+      }
+
+      /// \brief Get the topics with publishers in a process or in one of
+      /// its nodes.
+      /// \param[in] _pUuid Process UUID.
+      /// \param[in] _nUuid Node UUID, or nullptr for all the nodes of the
+      /// process.
+      /// \return The topics, without repetitions.
+      private: std::vector<std::string> TopicsOf(const std::string &_pUuid,
+                   const std::string *_nUuid = nullptr) const
+      {
+        std::vector<std::string> topics;
+        std::lock_guard<std::mutex> lk(this->indexMutex);
+
+        auto proc = this->byProc.find(_pUuid);
+        if (proc == this->byProc.end())
+          return topics;
+
+        for (auto const &node : proc->second)
+        {
+          if (_nUuid && node.first != *_nUuid)
+            continue;
+          for (auto const &topic : node.second)
+            topics.push_back(topic.first);
+        }
+
+        // A topic may have publishers in several nodes of the process.
+        if (!_nUuid && proc->second.size() > 1u)
+        {
+          std::sort(topics.begin(), topics.end());
+          topics.erase(std::unique(topics.begin(), topics.end()),
+            topics.end());
+        }
+        return topics;
+      }
+
+      /// \brief The shards.
+      private: std::array<Shard, kNumShards> shards;
+
+      /// \brief Protects the indexes. It's always locked after the shards.
+      private: mutable std::mutex indexMutex;
+
+      /// \brief Index of the topics by process and node. The keys are
+      /// process UUIDs, node UUIDs and topics, and the values the number of
+      /// publishers stored for them.
+      private: std::unordered_map<std::string,
+                 std::unordered_map<std::string,
+                   std::unordered_map<std::string, std::size_t>>> byProc;
+
+      /// \brief Number of publishers stored for each address.
+      private: std::unordered_map<std::string, std::size_t> byAddr;
+
+      /// \brief Version of the storage.
+      private: std::atomic<uint64_t> version{0};
     };
     }
   }
@@ -18,8 +18,11 @@
 #ifndef IGNITION_TRANSPORT_DETAIL_NODE_HH_
 #define IGNITION_TRANSPORT_DETAIL_NODE_HH_
 
+#include <future>
 #include <memory>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace ignition
 {
@@ -124,9 +127,14 @@ namespace ignition
         return false;
       }
 
+      // Subscriptions without an executor use the one of the node.
+      SubscribeOptions opts(_opts);
+      if (opts.Executor() == Executor_t::DEFAULT)
+        opts.SetExecutor(this->Options().Executor());
+
       // Create a new subscription handler.
       std::shared_ptr<SubscriptionHandler<MessageT>> subscrHandlerPtr(
-          new SubscriptionHandler<MessageT>(this->NodeUuid(), _opts));
+          new SubscriptionHandler<MessageT>(this->NodeUuid(), opts));
 
       // Insert the callback into the handler.
       subscrHandlerPtr->SetCallback(_cb);
@@ -137,7 +145,7 @@ namespace ignition
       // associated with a topic. When the receiving thread gets new data,
       // it will recover the subscription handler associated to the topic and
       // will invoke the callback.
-      this->Shared()->localSubscribers.normal.AddHandler(
+      this->Shared()->AddSubscriptionHandler(
         fullyQualifiedTopic, this->NodeUuid(), subscrHandlerPtr);
 
       return this->SubscribeHelper(fullyQualifiedTopic);
@@ -246,6 +254,7 @@ namespace ignition
 
       // Insert the callback into the handler.
       repHandlerPtr->SetCallback(_cb);
+      repHandlerPtr->SetMaxConcurrency(_options.MaxConcurrency());
 
       std::lock_guard<std::recursive_mutex> lk(this->Shared()->mutex);
 
@@ -256,7 +265,7 @@ namespace ignition
       // associated with a topic. When the receiving thread gets new requests,
       // it will recover the replier handler associated to the topic and
       // will invoke the service call.
-      this->Shared()->repliers.AddHandler(
+      this->Shared()->AddRepHandler(
         fullyQualifiedTopic, this->NodeUuid(), repHandlerPtr);
 
       // Notify the discovery service to register and advertise my responser.
@@ -366,6 +375,62 @@ namespace ignition
       return this->Advertise(_topic, f, _options);
     }
 
+    //////////////////////////////////////////////////
+    template<typename RequestT, typename ReplyT>
+    bool Node::AdvertiseStream(
+      const std::string &_topic,
+      std::function<bool(const RequestT &,
+        const std::function<bool(const ReplyT &)> &)> _cb,
+      const AdvertiseServiceOptions &_options)
+    {
+      // Topic remapping.
+      std::string topic = _topic;
+      this->Options().TopicRemap(_topic, topic);
+
+      std::string fullyQualifiedTopic;
+      if (!TopicUtils::FullyQualifiedName(this->Options().Partition(),
+        this->Options().NameSpace(), topic, fullyQualifiedTopic))
+      {
+        std::cerr << "Service [" << topic << "] is not valid." << std::endl;
+        return false;
+      }
+
+      // Create a new service reply handler.
+      std::shared_ptr<RepStreamHandler<RequestT, ReplyT>> repHandlerPtr(
+        new RepStreamHandler<RequestT, ReplyT>());
+
+      // Insert the callback into the handler.
+      repHandlerPtr->SetCallback(_cb);
+      repHandlerPtr->SetMaxConcurrency(_options.MaxConcurrency());
+
+      std::lock_guard<std::recursive_mutex> lk(this->Shared()->mutex);
+
+      // Add the topic to the list of advertised services.
+      this->SrvsAdvertised().insert(fullyQualifiedTopic);
+
+      // Store the replier handler.
+      this->Shared()->AddRepHandler(
+        fullyQualifiedTopic, this->NodeUuid(), repHandlerPtr);
+
+      // Notify the discovery service to register and advertise my responser.
+      ServicePublisher publisher(fullyQualifiedTopic,
+        this->Shared()->myReplierAddress,
+        this->Shared()->replierId.ToString(),
+        this->Shared()->pUuid, this->NodeUuid(),
+        RequestT().GetTypeName(), ReplyT().GetTypeName(), _options);
+
+      if (!this->Shared()->AdvertisePublisher(publisher))
+      {
+        std::cerr << "Node::AdvertiseStream(): Error advertising service ["
+                  << topic
+                  << "]. Did you forget to start the discovery service?"
+                  << std::endl;
+        return false;
+      }
+
+      return true;
+    }
+
     //////////////////////////////////////////////////
     template<typename RequestT, typename ReplyT>
     bool Node::Request(
@@ -447,8 +512,8 @@ namespace ignition
         std::lock_guard<std::recursive_mutex> lk(this->Shared()->mutex);
 
         // Store the request handler.
-        this->Shared()->requests.AddHandler(
-          fullyQualifiedTopic, this->NodeUuid(), reqHandlerPtr);
+        this->Shared()->AddRequest(fullyQualifiedTopic, this->NodeUuid(),
+          reqHandlerPtr, this->Options().ResponserPolicy());
 
         // If the responser's address is known, make the request.
         SrvAddresses_M addresses;
@@ -484,6 +549,99 @@ namespace ignition
       return this->Request(_topic, req, _cb);
     }
 
+    //////////////////////////////////////////////////
+    template<typename RequestT, typename ReplyT>
+    std::future<std::pair<ReplyT, bool>> Node::RequestAsync(
+      const std::string &_topic,
+      const RequestT &_request,
+      const unsigned int _timeout)
+    {
+      // Topic remapping.
+      std::string topic = _topic;
+      this->Options().TopicRemap(_topic, topic);
+
+      std::string fullyQualifiedTopic;
+      if (!TopicUtils::FullyQualifiedName(this->Options().Partition(),
+        this->Options().NameSpace(), topic, fullyQualifiedTopic))
+      {
+        std::cerr << "Service [" << topic << "] is not valid." << std::endl;
+        return std::future<std::pair<ReplyT, bool>>();
+      }
+
+      auto promise = std::make_shared<std::promise<std::pair<ReplyT, bool>>>();
+      auto future = promise->get_future();
+
+      bool localResponserFound;
+      IRepHandlerPtr repHandler;
+      {
+        std::lock_guard<std::recursive_mutex> lk(this->Shared()->mutex);
+        localResponserFound = this->Shared()->repliers.FirstHandler(
+              fullyQualifiedTopic,
+              RequestT().GetTypeName(),
+              ReplyT().GetTypeName(),
+              repHandler);
+      }
+
+      // If the responser is within my process.
+      if (localResponserFound)
+      {
+        // There is a responser in my process, let's use it.
+        ReplyT rep;
+        bool result = repHandler->RunLocalCallback(_request, rep);
+
+        promise->set_value(std::make_pair(rep, result));
+        return future;
+      }
+
+      // Create a new request handler.
+      std::shared_ptr<ReqHandler<RequestT, ReplyT>> reqHandlerPtr(
+        new ReqHandler<RequestT, ReplyT>(this->NodeUuid()));
+
+      // Insert the request's parameters.
+      reqHandlerPtr->SetMessage(&_request);
+
+      // Insert the callback into the handler. A request abandoned after the
+      // timeout is notified with an empty response and a false result.
+      reqHandlerPtr->SetCallback(
+        [promise](const ReplyT &_internalRep, const bool _internalResult)
+        {
+          promise->set_value(std::make_pair(_internalRep, _internalResult));
+        });
+
+      {
+        std::lock_guard<std::recursive_mutex> lk(this->Shared()->mutex);
+
+        // Store the request handler.
+        this->Shared()->AddRequest(fullyQualifiedTopic, this->NodeUuid(),
+          reqHandlerPtr, this->Options().ResponserPolicy());
+        this->Shared()->AddRequestTimeout(fullyQualifiedTopic, reqHandlerPtr,
+          _timeout);
+
+        // If the responser's address is known, make the request.
+        SrvAddresses_M addresses;
+        if (this->Shared()->TopicPublishers(fullyQualifiedTopic, addresses))
+        {
+          this->Shared()->SendPendingRemoteReqs(fullyQualifiedTopic,
+            RequestT().GetTypeName(), ReplyT().GetTypeName());
+        }
+        else
+        {
+          // Discover the service responser.
+          if (!this->Shared()->DiscoverService(fullyQualifiedTopic))
+          {
+            std::cerr << "Node::RequestAsync(): Error discovering service ["
+                      << topic
+                      << "]. Did you forget to start the discovery service?"
+                      << std::endl;
+            this->Shared()->AbandonRequest(fullyQualifiedTopic, reqHandlerPtr);
+            return std::future<std::pair<ReplyT, bool>>();
+          }
+        }
+      }
+
+      return future;
+    }
+
     //////////////////////////////////////////////////
     template<typename ClassT, typename RequestT, typename ReplyT>
     bool Node::Request(
@@ -556,8 +714,8 @@ namespace ignition
       }
 
       // Store the request handler.
-      this->Shared()->requests.AddHandler(
-        fullyQualifiedTopic, this->NodeUuid(), reqHandlerPtr);
+      this->Shared()->AddRequest(fullyQualifiedTopic, this->NodeUuid(),
+        reqHandlerPtr, this->Options().ResponserPolicy());
 
       // If the responser's address is known, make the request.
       SrvAddresses_M addresses;
@@ -584,7 +742,10 @@ namespace ignition
 
       // The request was not executed.
       if (!executed)
+      {
+        this->Shared()->AbandonRequest(fullyQualifiedTopic, reqHandlerPtr);
         return false;
+      }
 
       // The request was executed but did not succeed.
       if (!reqHandlerPtr->Result())
@@ -618,6 +779,205 @@ namespace ignition
       return this->Request(_topic, req, _timeout, _reply, _result);
     }
 
+    //////////////////////////////////////////////////
+    template<typename RequestT, typename ReplyT>
+    bool Node::RequestBatch(
+            const std::string &_topic,
+            const std::vector<RequestT> &_requests,
+            const unsigned int &_timeout,
+            std::vector<ReplyT> &_replies,
+            std::vector<bool> &_results)
+    {
+      // Topic remapping.
+      std::string topic = _topic;
+      this->Options().TopicRemap(_topic, topic);
+
+      std::string fullyQualifiedTopic;
+      if (!TopicUtils::FullyQualifiedName(this->Options().Partition(),
+        this->Options().NameSpace(), topic, fullyQualifiedTopic))
+      {
+        std::cerr << "Service [" << topic << "] is not valid." << std::endl;
+        return false;
+      }
+
+      _replies.assign(_requests.size(), ReplyT());
+      _results.assign(_requests.size(), false);
+
+      if (_requests.empty())
+        return true;
+
+      std::unique_lock<std::recursive_mutex> lk(this->Shared()->mutex);
+
+      // If the responser is within my process.
+      IRepHandlerPtr repHandler;
+      if (this->Shared()->repliers.FirstHandler(fullyQualifiedTopic,
+        RequestT().GetTypeName(), ReplyT().GetTypeName(), repHandler))
+      {
+        // There is a responser in my process, let's use it.
+        for (std::size_t i = 0; i < _requests.size(); ++i)
+        {
+          _results[i] =
+            repHandler->RunLocalCallback(_requests[i], _replies[i]);
+        }
+        return true;
+      }
+
+      // Create a new request handler.
+      std::shared_ptr<ReqBatchHandler<RequestT, ReplyT>> reqHandlerPtr(
+        new ReqBatchHandler<RequestT, ReplyT>(this->NodeUuid()));
+
+      // Insert the requests' parameters.
+      reqHandlerPtr->SetMessages(_requests);
+
+      // Store the request handler.
+      this->Shared()->AddRequest(fullyQualifiedTopic, this->NodeUuid(),
+        reqHandlerPtr, this->Options().ResponserPolicy());
+
+      // If the responser's address is known, make the requests.
+      SrvAddresses_M addresses;
+      if (this->Shared()->TopicPublishers(fullyQualifiedTopic, addresses))
+      {
+        this->Shared()->SendPendingRemoteReqs(fullyQualifiedTopic,
+          RequestT().GetTypeName(), ReplyT().GetTypeName());
+      }
+      else
+      {
+        // Discover the service responser.
+        if (!this->Shared()->DiscoverService(fullyQualifiedTopic))
+        {
+          std::cerr << "Node::RequestBatch(): Error discovering service ["
+                    << topic
+                    << "]. Did you forget to start the discovery service?"
+                    << std::endl;
+          return false;
+        }
+      }
+
+      // Wait until the REPs are available.
+      if (!reqHandlerPtr->WaitUntil(lk, _timeout))
+      {
+        this->Shared()->AbandonRequest(fullyQualifiedTopic, reqHandlerPtr);
+        return false;
+      }
+
+      // Parse the responses.
+      const auto &reps = reqHandlerPtr->Responses();
+      for (std::size_t i = 0; i < _requests.size() && i < reps.size(); ++i)
+      {
+        if (!reps[i].second)
+          continue;
+
+        if (!_replies[i].ParseFromString(reps[i].first))
+        {
+          std::cerr << "Node::RequestBatch(): Error Parsing the response"
+                    << std::endl;
+          continue;
+        }
+
+        _results[i] = true;
+      }
+
+      return true;
+    }
+
+    //////////////////////////////////////////////////
+    template<typename RequestT, typename ReplyT>
+    bool Node::RequestStream(
+      const std::string &_topic,
+      const RequestT &_request,
+      const std::function<bool(const ReplyT &)> &_chunkCb,
+      const std::function<void(const bool)> &_doneCb)
+    {
+      // Topic remapping.
+      std::string topic = _topic;
+      this->Options().TopicRemap(_topic, topic);
+
+      std::string fullyQualifiedTopic;
+      if (!TopicUtils::FullyQualifiedName(this->Options().Partition(),
+        this->Options().NameSpace(), topic, fullyQualifiedTopic))
+      {
+        std::cerr << "Service [" << topic << "] is not valid." << std::endl;
+        return false;
+      }
+
+      bool localResponserFound;
+      IRepHandlerPtr repHandler;
+      {
+        std::lock_guard<std::recursive_mutex> lk(this->Shared()->mutex);
+        localResponserFound = this->Shared()->repliers.FirstHandler(
+              fullyQualifiedTopic,
+              RequestT().GetTypeName(),
+              ReplyT().GetTypeName(),
+              repHandler);
+      }
+
+      // If the responser is within my process.
+      if (localResponserFound)
+      {
+        if (!repHandler->IsStream())
+        {
+          std::cerr << "Node::RequestStream(): Service [" << topic
+                    << "] doesn't stream its response" << std::endl;
+          return false;
+        }
+
+        // There is a responser in my process, let's use it. The chunks go
+        // straight to the callback, so there's nothing to hold back.
+        std::function<bool(const ProtoMsg &)> send =
+          [&_chunkCb](const ProtoMsg &_chunk)
+        {
+#if GOOGLE_PROTOBUF_VERSION > 2999999
+          auto msg = google::protobuf::down_cast<const ReplyT*>(&_chunk);
+#else
+          auto msg =
+            google::protobuf::internal::down_cast<const ReplyT*>(&_chunk);
+#endif
+          return !_chunkCb || _chunkCb(*msg);
+        };
+
+        const bool result = repHandler->RunLocalStreamCallback(_request, send);
+        if (_doneCb)
+          _doneCb(result);
+        return true;
+      }
+
+      // Create a new request handler.
+      std::shared_ptr<ReqStreamHandler<RequestT, ReplyT>> reqHandlerPtr(
+        new ReqStreamHandler<RequestT, ReplyT>(this->NodeUuid()));
+
+      // Insert the request's parameters and the callbacks.
+      reqHandlerPtr->SetMessage(_request);
+      reqHandlerPtr->SetCallbacks(_chunkCb, _doneCb);
+
+      std::lock_guard<std::recursive_mutex> lk(this->Shared()->mutex);
+
+      // Store the request handler.
+      this->Shared()->AddRequest(fullyQualifiedTopic, this->NodeUuid(),
+        reqHandlerPtr, this->Options().ResponserPolicy());
+
+      // If the responser's address is known, make the request.
+      SrvAddresses_M addresses;
+      if (this->Shared()->TopicPublishers(fullyQualifiedTopic, addresses))
+      {
+        this->Shared()->SendPendingRemoteReqs(fullyQualifiedTopic,
+          RequestT().GetTypeName(), ReplyT().GetTypeName());
+      }
+      else
+      {
+        // Discover the service responser.
+        if (!this->Shared()->DiscoverService(fullyQualifiedTopic))
+        {
+          std::cerr << "Node::RequestStream(): Error discovering service ["
+                    << topic
+                    << "]. Did you forget to start the discovery service?"
+                    << std::endl;
+          return false;
+        }
+      }
+
+      return true;
+    }
+
     //////////////////////////////////////////////////
     template<typename RequestT>
     bool Node::Request(
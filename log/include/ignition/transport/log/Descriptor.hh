@@ -77,6 +77,13 @@ namespace ignition
           const std::string &_topicName,
           const std::string &_msgType) const;
 
+        /// \brief Whether the log file has an index of its messages by topic
+        /// and time received. With it, the messages of a few topics are read
+        /// without going through the messages of the other topics, so the
+        /// QueryOptions select them topic by topic.
+        /// \return True if the log file has the index.
+        public: bool IndexesTopicTime() const;
+
         // The Log class is a friend so that it can construct a Descriptor
         friend class Log;
 
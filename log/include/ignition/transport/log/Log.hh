@@ -19,9 +19,12 @@
 #define IGNITION_TRANSPORT_LOG_LOG_HH_
 
 #include <chrono>
+#include <cstddef>
+#include <cstdint>
 #include <ios>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <ignition/transport/config.hh>
 #include <ignition/transport/log/Batch.hh>
@@ -41,6 +44,105 @@ namespace ignition
       /// \brief Name of Environment variable containing path to schema
       const std::string SchemaLocationEnvVar = "IGN_TRANSPORT_LOG_SQL_PATH";
 
+      /// \brief A message to insert into a log file with
+      /// Log::InsertMessages()
+      struct RecordedMessage
+      {
+        /// \brief Time the message was received (ns since Unix epoch)
+        public: std::chrono::nanoseconds time;
+
+        /// \brief Name of the topic the message was on
+        public: std::string topic;
+
+        /// \brief Name of the message type
+        public: std::string type;
+
+        /// \brief Serialized message
+        public: std::string data;
+      };
+
+      /// \brief How often SQLite waits for the data of a log file to reach
+      /// the disk. \sa LogProfile
+      enum class LogSynchronous
+      {
+        /// \brief Never. A power loss or an operating system crash may
+        /// corrupt the log file.
+        OFF,
+        /// \brief At critical moments only. With a WAL journal, a power loss
+        /// may roll back the last transactions, but can't corrupt the file.
+        NORMAL,
+        /// \brief At every commit. This is the default of SQLite.
+        FULL
+      };
+
+      /// \brief How the chunks of messages of a log file are compressed.
+      /// \sa LogProfile
+      enum class LogCompression
+      {
+        /// \brief The chunks are stored as they are.
+        NONE,
+        /// \brief The chunks are compressed with zlib, unless that doesn't
+        /// make them smaller.
+        ZLIB
+      };
+
+      /// \brief SQLite settings used to write a log file. They trade the
+      /// durability of the messages recorded, if the process or the machine
+      /// crashes, for write throughput. The defaults are those of SQLite,
+      /// with a transaction committed every 500 ms.
+      /// \sa Log::SetProfile
+      struct IGNITION_TRANSPORT_LOG_VISIBLE LogProfile
+      {
+        /// \brief Check the settings.
+        /// \return True if the page size is 0 or a power of two between 512
+        /// and 65536, none of the sizes or durations is negative, and the
+        /// chunk size isn't 0.
+        public: bool Valid() const;
+
+        /// \brief Use a write-ahead log (WAL) journal instead of a rollback
+        /// journal. Commits only append to the journal, and readers of the
+        /// log file don't block the writer.
+        public: bool wal = false;
+
+        /// \brief How often SQLite waits for the data to reach the disk.
+        public: LogSynchronous synchronous = LogSynchronous::FULL;
+
+        /// \brief Size of a database page (bytes). It only applies when the
+        /// log file is created. 0 keeps the default of SQLite.
+        public: int pageSize = 0;
+
+        /// \brief Size of the page cache (KiB). 0 keeps the default of
+        /// SQLite.
+        public: int64_t cacheSize = 0;
+
+        /// \brief Number of bytes of the log file accessed through memory
+        /// mapping. 0 disables memory mapping.
+        public: int64_t mmapSize = 0;
+
+        /// \brief Maximum duration of a transaction. The messages inserted
+        /// are committed once it has elapsed.
+        public: std::chrono::milliseconds transactionPeriod =
+          std::chrono::milliseconds(500);
+
+        /// \brief Maximum number of messages inserted by a transaction.
+        /// 0 means no limit.
+        public: std::size_t transactionRows = 0;
+
+        /// \brief Store the messages in chunks of consecutive messages of a
+        /// topic (schema 0.2.0). Set it to false to create log files which
+        /// store every message in its own row (schema 0.1.0), readable by
+        /// older versions. It only applies when the log file is created.
+        public: bool chunked = true;
+
+        /// \brief How the chunks are compressed.
+        public: LogCompression compression = LogCompression::ZLIB;
+
+        /// \brief Maximum size of the messages of a chunk (bytes), before
+        /// compression. A chunk is also written when its transaction ends,
+        /// so it never spans more than transactionPeriod.
+        public: std::size_t chunkSize = 1024 * 1024;
+      };
+
       /// \brief Interface to a log file
       class IGNITION_TRANSPORT_LOG_VISIBLE Log
       {
@@ -66,12 +168,33 @@ namespace ignition
         /// \brief Open a log file
         /// \param[in] _file path to log file
         /// \param[in] _mode flag indicating read only or read/write
-        ///   Can use (in or out)
+        ///   Can use (in or out). With out, a new log file is created; add
+        ///   app to write into an existing log file instead.
         /// \return True if the log file was successfully opened, false
         /// otherwise.
         public: bool Open(const std::string &_file,
             std::ios_base::openmode _mode = std::ios_base::in);
 
+        /// \brief Set the SQLite settings used to write the log file. When a
+        /// log file is open for writing, the current transaction is
+        /// committed and the settings apply immediately, except the page
+        /// size.
+        /// \param[in] _profile The settings.
+        /// \return False if the settings are not valid or could not be
+        /// applied.
+        public: bool SetProfile(const LogProfile &_profile);
+
+        /// \brief Get the SQLite settings used to write the log file.
+        /// \return The settings.
+        public: const LogProfile &Profile() const;
+
+        /// \brief Migrate the log file to the latest schema version. The
+        /// messages are moved into chunks, and the migration is recorded in
+        /// the migrations table of the log file. The log file must be open
+        /// for writing.
+        /// \return True if the log file uses the latest schema version.
+        public: bool Migrate();
+
         /// \brief Get the name of the log file.
         /// \return The name of the log file, or an empty string if Open has
         /// not been successfully called.
@@ -96,6 +219,18 @@ namespace ignition
             const std::string &_topic, const std::string &_type,
             const void *_data, std::size_t _len);
 
+        /// \brief Insert several messages into the log file. This is faster
+        /// than calling InsertMessage() for each of them: consecutive
+        /// messages on the same topic share the topic lookup, and many rows
+        /// are written by each execution of the insert statement.
+        /// A message that can't be inserted is skipped, the others are
+        /// still inserted.
+        /// \param[in] _msgs The messages, in the order they were received
+        /// \return The number of messages successfully inserted. It is
+        /// _msgs.size() if none of them failed.
+        public: std::size_t InsertMessages(
+            const std::vector<RecordedMessage> &_msgs);
+
         /// \brief Get messages according to the specified options. By default,
         /// it will query all messages over the entire time range of the log.
         /// \param[in] _options A QueryOptions type to indicate what kind of
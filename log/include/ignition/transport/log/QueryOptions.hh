@@ -73,6 +73,30 @@ namespace ignition
         /// \return \code{" ORDER BY messages.time_recv;"}
         public: static SqlStatement StandardMessageQueryClose();
 
+        /// \brief Generate one or more SQL query statements selecting the
+        /// chunks that hold the messages, for log files which store messages
+        /// in chunks (schema 0.2.0 and later). MsgIter reads the messages of
+        /// the chunks selected, in the order they were received. The default
+        /// implementation selects all the chunks (within the time range of a
+        /// TimeRangeOption), so override it to select fewer.
+        /// \param[in] _descriptor A Descriptor to help form the SQL statements
+        /// \return One or more SQL statements.
+        /// \sa StandardChunkQueryPreamble()
+        public: virtual std::vector<SqlStatement> GenerateChunkStatements(
+          const Descriptor &_descriptor) const;
+
+        /// \brief Get a standard SQL statement preamble to select chunks, from
+        /// the SELECT keyword up to (but not including) the WHERE keyword.
+        /// Conditions on topic_id, start_time and end_time may follow.
+        /// Append the output of StandardChunkQueryClose() to order the chunks
+        /// by the time their first message was received, as MsgIter expects.
+        /// \return The initial clause of a chunk SQL statement.
+        public: static SqlStatement StandardChunkQueryPreamble();
+
+        /// \brief Get a standard ending to a SQL statement selecting chunks.
+        /// \return \code{" ORDER BY chunks.start_time;"}
+        public: static SqlStatement StandardChunkQueryClose();
+
         /// \brief Virtual destructor
         public: virtual ~QueryOptions() = default;
       };
@@ -110,6 +134,13 @@ namespace ignition
         /// that this TimeRangeOption has been set with.
         public: SqlStatement GenerateTimeConditions() const;
 
+        /// \brief Generate a SQL string selecting the chunks which overlap
+        /// the time range. This should be appended to a SQL statement after a
+        /// WHERE keyword.
+        /// \return A partial SqlStatement that specifies the time conditions
+        /// on chunks.
+        public: SqlStatement GenerateChunkTimeConditions() const;
+
         /// \brief Destructor
         public: ~TimeRangeOption();
 
@@ -183,6 +214,10 @@ namespace ignition
         public: std::vector<SqlStatement> GenerateStatements(
           const Descriptor &_descriptor) const override;
 
+        // Documentation inherited
+        public: std::vector<SqlStatement> GenerateChunkStatements(
+          const Descriptor &_descriptor) const override;
+
         /// \brief Destructor
         public: ~TopicList();
 
@@ -238,6 +273,10 @@ namespace ignition
         public: std::vector<SqlStatement> GenerateStatements(
           const Descriptor &_descriptor) const override;
 
+        // Documentation inherited
+        public: std::vector<SqlStatement> GenerateChunkStatements(
+          const Descriptor &_descriptor) const override;
+
         /// \brief Destructor
         public: ~TopicPattern();
 
@@ -281,6 +320,10 @@ namespace ignition
         public: std::vector<SqlStatement> GenerateStatements(
           const Descriptor &_descriptor) const override;
 
+        // Documentation inherited
+        public: std::vector<SqlStatement> GenerateChunkStatements(
+          const Descriptor &_descriptor) const override;
+
         /// \brief Destructor
         public: ~AllTopics();
 
@@ -17,6 +17,7 @@
 #ifndef IGNITION_TRANSPORT_LOG_RECORDER_HH_
 #define IGNITION_TRANSPORT_LOG_RECORDER_HH_
 
+#include <cstddef>
 #include <cstdint>
 #include <memory>
 #include <regex>
@@ -26,6 +27,7 @@
 #include <ignition/transport/Clock.hh>
 #include <ignition/transport/config.hh>
 #include <ignition/transport/log/Export.hh>
+#include <ignition/transport/log/Log.hh>
 
 namespace ignition
 {
@@ -47,10 +49,32 @@ namespace ignition
         ALREADY_SUBSCRIBED_TO_TOPIC = -6,
       };
 
+      /// \brief What to do when a message arrives and the buffer of the
+      /// recorder is full.
+      /// \sa Recorder::SetBufferPolicy
+      enum class RecorderBufferPolicy
+      {
+        /// \brief Wait until the messages buffered are written. It delays
+        /// the reception of the messages of every topic.
+        BLOCK,
+        /// \brief Drop the oldest message buffered.
+        DROP_OLDEST,
+        /// \brief Drop the message arriving.
+        DROP_NEWEST
+      };
+
+      /// \brief Default capacity of the buffer of the recorder (bytes).
+      /// \sa Recorder::SetBufferSize
+      const std::size_t kDefaultRecorderBufferSize = 64 * 1024 * 1024;
+
       /// \brief Records ignition transport topics
       /// This class makes it easy to record topics to a log file.
       /// Responsibilities: topic name matching, time received tracking,
       /// multiple thread safety, subscribing to topics
+      ///
+      /// The messages received are copied into a buffer and a dedicated
+      /// thread writes them into the log file in batches, so the disk
+      /// doesn't delay the reception of messages.
       class IGNITION_TRANSPORT_LOG_VISIBLE Recorder
       {
         /// \brief Default constructor
@@ -101,6 +125,53 @@ namespace ignition
         /// not been successfully called.
         public: std::string Filename() const;
 
+        /// \brief Set the maximum size of the messages received and not
+        /// written into the log file yet. Defaults to
+        /// kDefaultRecorderBufferSize.
+        /// \param[in] _bytes Maximum size (bytes). A message larger than it
+        /// is only buffered when no other message is.
+        /// \sa SetBufferPolicy
+        public: void SetBufferSize(const std::size_t _bytes);
+
+        /// \brief Get the maximum size of the messages received and not
+        /// written into the log file yet.
+        /// \return Maximum size (bytes).
+        public: std::size_t BufferSize() const;
+
+        /// \brief Set what to do when a message arrives and the buffer is
+        /// full. Defaults to RecorderBufferPolicy::BLOCK.
+        /// \param[in] _policy The policy.
+        /// \sa SetBufferSize
+        public: void SetBufferPolicy(const RecorderBufferPolicy _policy);
+
+        /// \brief Get what to do when a message arrives and the buffer is
+        /// full.
+        /// \return The policy.
+        public: RecorderBufferPolicy BufferPolicy() const;
+
+        /// \brief Get statistics about the buffer of the messages received
+        /// and not written into the log file yet.
+        /// \param[out] _depth Number of messages buffered.
+        /// \param[out] _bytes Size of the messages buffered (bytes).
+        /// \param[out] _dropped Number of messages dropped because the
+        /// buffer was full.
+        public: void BufferStats(std::size_t &_depth,
+                                 std::size_t &_bytes,
+                                 uint64_t &_dropped) const;
+
+        /// \brief Set the SQLite settings used to write the log file. They
+        /// apply to the next recording, and to the current one except the
+        /// page size.
+        /// \param[in] _profile The settings.
+        /// \return False if the settings are not valid or could not be
+        /// applied.
+        /// \sa Log::SetProfile
+        public: bool SetProfile(const LogProfile &_profile);
+
+        /// \brief Get the SQLite settings used to write the log file.
+        /// \return The settings.
+        public: LogProfile Profile() const;
+
         /// \brief Get the set of topics have have been added.
         /// \return The set of topic names that have been added using the
         /// AddTopic functions.
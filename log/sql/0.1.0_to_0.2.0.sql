@@ -0,0 +1,51 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+/* Migrates a database from schema 0.1.0 to 0.2.0. Log::Migrate() runs it in
+   a transaction, then moves the rows of the messages table into chunks and
+   drops the messages table. */
+
+INSERT INTO migrations (from_version, to_version) VALUES ('0.1.0', '0.2.0');
+
+/* Contains every message received on every topic recorded, in chunks of
+   consecutive messages of a topic. Each row is an entry of the chunk index. */
+CREATE TABLE chunks (
+  /* Uniquely identifies a row in this table. Sqlite3 will make it an alias of rowid. */
+  id INTEGER PRIMARY KEY AUTOINCREMENT,
+  /* Topic the messages were received on */
+  topic_id REFERENCES topics (id) ON DELETE CASCADE,
+  /* Timestamp the first message was received (utc nanoseconds) */
+  start_time INTEGER NOT NULL,
+  /* Timestamp the last message was received (utc nanoseconds) */
+  end_time INTEGER NOT NULL,
+  /* Number of messages in the chunk */
+  message_count INTEGER NOT NULL,
+  /* Compression of data: 'none' or 'zlib' */
+  compression TEXT NOT NULL,
+  /* Size of data once decompressed (bytes) */
+  size INTEGER NOT NULL,
+  /* The messages ordered by time received. Each one is made of the timestamp
+     it was received (8 bytes), the size of the serialized protobuf message
+     (4 bytes), both little endian, and the serialized protobuf message. */
+  data BLOB NOT NULL
+);
+
+/* Queries select the chunks of some topics that overlap a time range */
+CREATE INDEX idx_chunk_topic_time ON chunks (topic_id, start_time, end_time);
+
+/* Messages are read in the order they were received */
+CREATE INDEX idx_chunk_start_time ON chunks (start_time);
@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+/* Note: Use PRAGMA foreign_keys = ON; prior to writing to a database using this schema */
+
+/* Describes the schema version used in this database */
+CREATE TABLE migrations (
+  /* Uniquely identifies a row in this table. Sqlite3 will make it an alias of rowid. */
+  id INTEGER PRIMARY KEY AUTOINCREMENT,
+  /* Previous schema version. NULL on the row inserted when the database is created. */
+  from_version TEXT DEFAULT NULL,
+  /* Version of the schema the database was migrated to. */
+  to_version TEXT NOT NULL,
+  /* Time when the migration happened (auto populates). */
+  time_utc INTEGER NOT NULL DEFAULT CURRENT_TIMESTAMP
+);
+
+/* Set the initial version to 0.2.0 */
+INSERT INTO migrations (to_version) VALUES ('0.2.0');
+
+/* Contains every type of message used by a recorded topic */
+CREATE TABLE message_types (
+  /* Uniquely identifies a row in this table. Sqlite3 will make it an alias of rowid. */
+  id INTEGER PRIMARY KEY AUTOINCREMENT,
+  /* Name of the message (e.g. .ignition.msgs.LaserScan) */
+  name TEXT NOT NULL,
+  /* Full text of the protobuf file, or NULL if logging did not have access to it */
+  proto_descriptor TEXT
+);
+
+/* Contains every topic logged */
+CREATE TABLE topics (
+  /* Uniquely identifies a row in this table. Sqlite3 will make it an alias of rowid. */
+  id INTEGER PRIMARY KEY AUTOINCREMENT,
+  /* Name of the topic (e.g. /car/roof/scan) */
+  name TEXT NOT NULL,
+  /* A message type in the message_types table */
+  message_type_id NOT NULL REFERENCES message_types (id) ON DELETE CASCADE
+);
+
+/* There is at most 1 row in topics for each name/message_type combo */
+CREATE UNIQUE INDEX idx_topic ON topics (name, message_type_id);
+
+/* Contains every message received on every topic recorded, in chunks of
+   consecutive messages of a topic. Each row is an entry of the chunk index. */
+CREATE TABLE chunks (
+  /* Uniquely identifies a row in this table. Sqlite3 will make it an alias of rowid. */
+  id INTEGER PRIMARY KEY AUTOINCREMENT,
+  /* Topic the messages were received on */
+  topic_id REFERENCES topics (id) ON DELETE CASCADE,
+  /* Timestamp the first message was received (utc nanoseconds) */
+  start_time INTEGER NOT NULL,
+  /* Timestamp the last message was received (utc nanoseconds) */
+  end_time INTEGER NOT NULL,
+  /* Number of messages in the chunk */
+  message_count INTEGER NOT NULL,
+  /* Compression of data: 'none' or 'zlib' */
+  compression TEXT NOT NULL,
+  /* Size of data once decompressed (bytes) */
+  size INTEGER NOT NULL,
+  /* The messages ordered by time received. Each one is made of the timestamp
+     it was received (8 bytes), the size of the serialized protobuf message
+     (4 bytes), both little endian, and the serialized protobuf message. */
+  data BLOB NOT NULL
+);
+
+/* Queries select the chunks of some topics that overlap a time range */
+CREATE INDEX idx_chunk_topic_time ON chunks (topic_id, start_time, end_time);
+
+/* Messages are read in the order they were received */
+CREATE INDEX idx_chunk_start_time ON chunks (start_time);
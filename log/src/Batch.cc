@@ -33,6 +33,15 @@ BatchPrivate::BatchPrivate(const std::shared_ptr<raii_sqlite3::Database> &_db,
 {
 }
 
+//////////////////////////////////////////////////
+BatchPrivate::BatchPrivate(const std::shared_ptr<raii_sqlite3::Database> &_db,
+      std::vector<SqlStatement> &&_statements,  // NOLINT(build/c++11)
+      const QualifiedTimeRange &_range)
+  : statements(new std::vector<SqlStatement>(std::move(_statements))), db(_db),
+    chunked(true), range(_range)
+{
+}
+
 //////////////////////////////////////////////////
 BatchPrivate::~BatchPrivate()
 {
@@ -73,8 +82,17 @@ Batch::iterator Batch::begin()
     return Batch::iterator();
   }
 
-  std::unique_ptr<MsgIterPrivate> msgPriv(new MsgIterPrivate(
-        this->dataPtr->db, this->dataPtr->statements));
+  std::unique_ptr<MsgIterPrivate> msgPriv;
+  if (this->dataPtr->chunked)
+  {
+    msgPriv.reset(new MsgIterPrivate(this->dataPtr->db,
+          this->dataPtr->statements, this->dataPtr->range));
+  }
+  else
+  {
+    msgPriv.reset(new MsgIterPrivate(
+          this->dataPtr->db, this->dataPtr->statements));
+  }
   return Batch::iterator(std::move(msgPriv));
 }
 
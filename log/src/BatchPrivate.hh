@@ -20,6 +20,7 @@
 #include <memory>
 #include <vector>
 
+#include "ignition/transport/log/QualifiedTime.hh"
 #include "ignition/transport/log/SqlStatement.hh"
 #include "raii-sqlite3.hh"
 
@@ -37,6 +38,15 @@ class ignition::transport::log::BatchPrivate
       const std::shared_ptr<raii_sqlite3::Database> &_db,
       std::vector<SqlStatement> &&_statements);  // NOLINT(build/c++11)
 
+  /// \brief constructor for log files storing messages in chunks
+  /// \param[in] _db an open sqlite3 database handle wrapper
+  /// \param[in] _statements a list of statments to be executed to get chunks
+  /// \param[in] _range time range of the messages of the chunks to get
+  public: BatchPrivate(
+      const std::shared_ptr<raii_sqlite3::Database> &_db,
+      std::vector<SqlStatement> &&_statements,  // NOLINT(build/c++11)
+      const QualifiedTimeRange &_range);
+
   /// \brief destructor
   public: ~BatchPrivate();
 
@@ -45,6 +55,12 @@ class ignition::transport::log::BatchPrivate
 
   /// \brief SQLite3 database pointer wrapper
   public: std::shared_ptr<raii_sqlite3::Database> db;
+
+  /// \brief True if the statements select chunks instead of messages
+  public: bool chunked = false;
+
+  /// \brief Time range of the messages of the chunks
+  public: QualifiedTimeRange range = QualifiedTimeRange::AllTime();
 };
 
 #endif
@@ -0,0 +1,248 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <zlib.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+
+#include "Chunk.hh"
+#include "Console.hh"
+
+using namespace ignition::transport;
+using namespace ignition::transport::log;
+
+//////////////////////////////////////////////////
+/// \brief Append an integer to a buffer, little endian.
+/// \param[in, out] _buffer The buffer.
+/// \param[in] _value The integer.
+/// \param[in] _bytes Number of bytes of the integer.
+static void PutInt(std::string &_buffer, const uint64_t _value,
+    const std::size_t _bytes)
+{
+  for (std::size_t i = 0; i < _bytes; ++i)
+    _buffer.push_back(static_cast<char>((_value >> (8 * i)) & 0xFF));
+}
+
+//////////////////////////////////////////////////
+/// \brief Read a little endian integer.
+/// \param[in] _buffer Pointer to the first byte of the integer.
+/// \param[in] _bytes Number of bytes of the integer.
+/// \return The integer.
+static uint64_t GetInt(const char *_buffer, const std::size_t _bytes)
+{
+  uint64_t value = 0;
+  for (std::size_t i = 0; i < _bytes; ++i)
+  {
+    value |= static_cast<uint64_t>(
+        static_cast<unsigned char>(_buffer[i])) << (8 * i);
+  }
+  return value;
+}
+
+//////////////////////////////////////////////////
+bool ChunkWriter::Append(const std::chrono::nanoseconds &_time,
+    const void *_data, const std::size_t _len)
+{
+  if (_len > std::numeric_limits<uint32_t>::max())
+  {
+    LERR("Message of " << _len << " bytes is too large for a chunk\n");
+    return false;
+  }
+
+  if (this->count == 0)
+  {
+    this->startTime = _time;
+    this->endTime = _time;
+  }
+  else
+  {
+    this->sorted = this->sorted && _time >= this->lastTime;
+    this->startTime = std::min(this->startTime, _time);
+    this->endTime = std::max(this->endTime, _time);
+  }
+  this->lastTime = _time;
+
+  PutInt(this->data, static_cast<uint64_t>(_time.count()), 8);
+  PutInt(this->data, _len, 4);
+  this->data.append(static_cast<const char *>(_data), _len);
+  ++this->count;
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool ChunkWriter::Finish(const LogCompression _compression,
+    std::string &_data, std::string &_compressionName)
+{
+  // Order the messages by time, keeping the order of the messages received
+  // at the same time.
+  if (!this->sorted)
+  {
+    struct Entry
+    {
+      int64_t time;
+      std::size_t offset;
+      std::size_t size;
+    };
+
+    std::vector<Entry> entries;
+    entries.reserve(this->count);
+    for (std::size_t offset = 0; offset < this->data.size();)
+    {
+      const char *header = this->data.data() + offset;
+      const std::size_t size = kChunkHeaderSize + GetInt(header + 8, 4);
+      entries.push_back(Entry{
+          static_cast<int64_t>(GetInt(header, 8)), offset, size});
+      offset += size;
+    }
+
+    std::stable_sort(entries.begin(), entries.end(),
+        [](const Entry &_a, const Entry &_b)
+        {
+          return _a.time < _b.time;
+        });
+
+    std::string ordered;
+    ordered.reserve(this->data.size());
+    for (const Entry &entry : entries)
+      ordered.append(this->data, entry.offset, entry.size);
+    this->data.swap(ordered);
+  }
+
+  _compressionName = "none";
+  _data.clear();
+
+  if (_compression == LogCompression::ZLIB)
+  {
+    uLongf compressedSize = compressBound(this->data.size());
+    _data.resize(compressedSize);
+    const int returnCode = compress2(
+        reinterpret_cast<Bytef *>(&_data[0]), &compressedSize,
+        reinterpret_cast<const Bytef *>(this->data.data()),
+        this->data.size(), Z_BEST_SPEED);
+    if (returnCode != Z_OK)
+    {
+      LERR("Failed to compress chunk: " << returnCode << "\n");
+      return false;
+    }
+
+    // Keep the compressed data only if it's smaller
+    if (compressedSize < this->data.size())
+    {
+      _data.resize(compressedSize);
+      _compressionName = "zlib";
+    }
+  }
+
+  if (_compressionName == "none")
+    _data.swap(this->data);
+
+  this->data.clear();
+  this->count = 0;
+  this->sorted = true;
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool ChunkWriter::Empty() const
+{
+  return this->count == 0;
+}
+
+//////////////////////////////////////////////////
+std::size_t ChunkWriter::Count() const
+{
+  return this->count;
+}
+
+//////////////////////////////////////////////////
+std::size_t ChunkWriter::Size() const
+{
+  return this->data.size();
+}
+
+//////////////////////////////////////////////////
+std::chrono::nanoseconds ChunkWriter::StartTime() const
+{
+  return this->startTime;
+}
+
+//////////////////////////////////////////////////
+std::chrono::nanoseconds ChunkWriter::EndTime() const
+{
+  return this->endTime;
+}
+
+//////////////////////////////////////////////////
+bool ChunkReader::Reset(const void *_data, const std::size_t _len,
+    const std::string &_compression, const std::size_t _size)
+{
+  this->offset = 0;
+
+  if (_compression == "none")
+  {
+    this->data.assign(static_cast<const char *>(_data), _len);
+    return true;
+  }
+
+  if (_compression != "zlib")
+  {
+    LERR("Unknown chunk compression [" << _compression << "]\n");
+    this->data.clear();
+    return false;
+  }
+
+  this->data.resize(_size);
+  uLongf size = _size;
+  const int returnCode = uncompress(
+      reinterpret_cast<Bytef *>(&this->data[0]), &size,
+      static_cast<const Bytef *>(_data), _len);
+  if (returnCode != Z_OK || size != _size)
+  {
+    LERR("Failed to decompress chunk: " << returnCode << "\n");
+    this->data.clear();
+    return false;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool ChunkReader::Next(std::chrono::nanoseconds &_time,
+    const char *&_data, std::size_t &_len)
+{
+  if (this->offset + kChunkHeaderSize > this->data.size())
+    return false;
+
+  const char *header = this->data.data() + this->offset;
+  const std::size_t len = GetInt(header + 8, 4);
+  if (this->offset + kChunkHeaderSize + len > this->data.size())
+  {
+    LERR("Chunk is truncated\n");
+    this->offset = this->data.size();
+    return false;
+  }
+
+  _time = std::chrono::nanoseconds(static_cast<int64_t>(GetInt(header, 8)));
+  _data = header + kChunkHeaderSize;
+  _len = len;
+  this->offset += kChunkHeaderSize + len;
+  return true;
+}
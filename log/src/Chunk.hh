@@ -0,0 +1,161 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef IGNITION_TRANSPORT_LOG_SRC_CHUNK_HH_
+#define IGNITION_TRANSPORT_LOG_SRC_CHUNK_HH_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include <ignition/transport/config.hh>
+#include <ignition/transport/log/Export.hh>
+#include <ignition/transport/log/Log.hh>
+
+namespace ignition
+{
+  namespace transport
+  {
+    namespace log
+    {
+      // Inline bracket to help doxygen filtering.
+      inline namespace IGNITION_TRANSPORT_VERSION_NAMESPACE {
+      //
+      /// \brief Size of the header of a message in a chunk: the time it was
+      /// received (8 bytes) and the size of its data (4 bytes).
+      const std::size_t kChunkHeaderSize = 12;
+
+      /// \brief Builds the data of a chunk, the consecutive messages of a
+      /// topic stored in a row of the chunks table.
+      /// \note We export the symbols for this class so it can be used in
+      /// UNIT_Chunk_TEST
+      class IGNITION_TRANSPORT_LOG_VISIBLE ChunkWriter
+      {
+        /// \brief Add a message.
+        /// \param[in] _time Time the message was received.
+        /// \param[in] _data Serialized message.
+        /// \param[in] _len Number of bytes of the message.
+        /// \return False if the message is larger than 4 GiB.
+        public: bool Append(const std::chrono::nanoseconds &_time,
+                            const void *_data, std::size_t _len);
+
+        /// \brief Get the data of the chunk, with the messages ordered by
+        /// time, and start a new chunk.
+        /// \param[in] _compression How to compress the data.
+        /// \param[out] _data The data, compressed if that made it smaller.
+        /// \param[out] _compressionName How the data was compressed: "none"
+        /// or "zlib".
+        /// \return False if the data could not be compressed.
+        public: bool Finish(LogCompression _compression,
+                            std::string &_data,
+                            std::string &_compressionName);
+
+        /// \brief Whether the chunk has no messages.
+        /// \return True if there isn't any message.
+        public: bool Empty() const;
+
+        /// \brief Get the number of messages.
+        /// \return The number of messages.
+        public: std::size_t Count() const;
+
+        /// \brief Get the size of the data, before compression.
+        /// \return The size (bytes).
+        public: std::size_t Size() const;
+
+        /// \brief Get the time the first message was received.
+        /// \return The time.
+        public: std::chrono::nanoseconds StartTime() const;
+
+        /// \brief Get the time the last message was received.
+        /// \return The time.
+        public: std::chrono::nanoseconds EndTime() const;
+
+#ifdef _WIN32
+// Disable warning C4251 which is triggered by
+// std::string
+#pragma warning(push)
+#pragma warning(disable: 4251)
+#endif
+        /// \brief Messages appended, uncompressed.
+        private: std::string data;
+#ifdef _WIN32
+#pragma warning(pop)
+#endif
+
+        /// \brief Number of messages.
+        private: std::size_t count = 0;
+
+        /// \brief Time of the first message.
+        private: std::chrono::nanoseconds startTime;
+
+        /// \brief Time of the last message.
+        private: std::chrono::nanoseconds endTime;
+
+        /// \brief Whether the messages were appended in time order.
+        private: bool sorted = true;
+
+        /// \brief Time of the last message appended.
+        private: std::chrono::nanoseconds lastTime;
+      };
+
+      /// \brief Reads the messages of a chunk.
+      /// \note We export the symbols for this class so it can be used in
+      /// UNIT_Chunk_TEST
+      class IGNITION_TRANSPORT_LOG_VISIBLE ChunkReader
+      {
+        /// \brief Start reading a chunk.
+        /// \param[in] _data Data of the chunk, as stored.
+        /// \param[in] _len Number of bytes of the data.
+        /// \param[in] _compression How the data is compressed.
+        /// \param[in] _size Size of the data once decompressed (bytes).
+        /// \return False if the data could not be decompressed.
+        public: bool Reset(const void *_data, std::size_t _len,
+                           const std::string &_compression,
+                           std::size_t _size);
+
+        /// \brief Read the next message. The pointer to its data is valid
+        /// until the next call to Reset().
+        /// \param[out] _time Time the message was received.
+        /// \param[out] _data Serialized message.
+        /// \param[out] _len Number of bytes of the message.
+        /// \return False if there isn't any message left, or the chunk is
+        /// truncated.
+        public: bool Next(std::chrono::nanoseconds &_time,
+                          const char *&_data, std::size_t &_len);
+
+#ifdef _WIN32
+// Disable warning C4251 which is triggered by
+// std::string
+#pragma warning(push)
+#pragma warning(disable: 4251)
+#endif
+        /// \brief Messages of the chunk, decompressed.
+        private: std::string data;
+#ifdef _WIN32
+#pragma warning(pop)
+#endif
+
+        /// \brief Offset of the next message.
+        private: std::size_t offset = 0;
+      };
+      }
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "Chunk.hh"
+#include "gtest/gtest.h"
+
+using namespace ignition::transport;
+using namespace std::chrono_literals;
+
+//////////////////////////////////////////////////
+/// \brief Read all the messages of a chunk.
+/// \param[in] _data Data of the chunk.
+/// \param[in] _compression How the data is compressed.
+/// \param[in] _size Size of the data once decompressed.
+/// \param[out] _times Time of each message.
+/// \return The data of each message.
+static std::vector<std::string> readChunk(const std::string &_data,
+    const std::string &_compression, const std::size_t _size,
+    std::vector<std::chrono::nanoseconds> &_times)
+{
+  std::vector<std::string> msgs;
+  _times.clear();
+
+  log::ChunkReader reader;
+  EXPECT_TRUE(reader.Reset(_data.data(), _data.size(), _compression, _size));
+
+  std::chrono::nanoseconds time;
+  const char *data;
+  std::size_t len;
+  while (reader.Next(time, data, len))
+  {
+    _times.push_back(time);
+    msgs.emplace_back(data, len);
+  }
+  return msgs;
+}
+
+//////////////////////////////////////////////////
+TEST(Chunk, RoundTrip)
+{
+  log::ChunkWriter writer;
+  EXPECT_TRUE(writer.Empty());
+
+  const std::string first(100, 'a');
+  const std::string second;
+  EXPECT_TRUE(writer.Append(1s, first.data(), first.size()));
+  EXPECT_TRUE(writer.Append(2s, second.data(), second.size()));
+  EXPECT_FALSE(writer.Empty());
+  EXPECT_EQ(2u, writer.Count());
+  EXPECT_EQ(2 * log::kChunkHeaderSize + first.size(), writer.Size());
+  EXPECT_EQ(1s, writer.StartTime());
+  EXPECT_EQ(2s, writer.EndTime());
+
+  const std::size_t size = writer.Size();
+  std::string data;
+  std::string compression;
+  EXPECT_TRUE(writer.Finish(log::LogCompression::NONE, data, compression));
+  EXPECT_EQ("none", compression);
+  EXPECT_EQ(size, data.size());
+
+  // Finishing starts a new chunk
+  EXPECT_TRUE(writer.Empty());
+  EXPECT_EQ(0u, writer.Size());
+
+  std::vector<std::chrono::nanoseconds> times;
+  std::vector<std::string> msgs = readChunk(data, compression, size, times);
+  ASSERT_EQ(2u, msgs.size());
+  EXPECT_EQ(first, msgs[0]);
+  EXPECT_EQ(second, msgs[1]);
+  EXPECT_EQ(1s, times[0]);
+  EXPECT_EQ(2s, times[1]);
+}
+
+//////////////////////////////////////////////////
+TEST(Chunk, Compression)
+{
+  log::ChunkWriter writer;
+  for (int i = 0; i < 100; ++i)
+  {
+    const std::string msg = "message " + std::to_string(i % 3);
+    EXPECT_TRUE(writer.Append(std::chrono::nanoseconds(i),
+          msg.data(), msg.size()));
+  }
+
+  const std::size_t size = writer.Size();
+  std::string data;
+  std::string compression;
+  EXPECT_TRUE(writer.Finish(log::LogCompression::ZLIB, data, compression));
+  EXPECT_EQ("zlib", compression);
+  EXPECT_LT(data.size(), size);
+
+  std::vector<std::chrono::nanoseconds> times;
+  std::vector<std::string> msgs = readChunk(data, compression, size, times);
+  ASSERT_EQ(100u, msgs.size());
+  EXPECT_EQ("message 2", msgs[98]);
+  EXPECT_EQ(98ns, times[98]);
+
+  // Data which doesn't get smaller is stored as it is
+  const char incompressible[] = {'\x8f', '\x13'};
+  EXPECT_TRUE(writer.Append(0ns, incompressible, sizeof(incompressible)));
+  EXPECT_TRUE(writer.Finish(log::LogCompression::ZLIB, data, compression));
+  EXPECT_EQ("none", compression);
+
+  // Unknown compression, or wrong size
+  log::ChunkReader reader;
+  EXPECT_FALSE(reader.Reset(data.data(), data.size(), "lz4", size));
+  EXPECT_FALSE(reader.Reset(data.data(), data.size(), "zlib", size));
+}
+
+//////////////////////////////////////////////////
+TEST(Chunk, Unsorted)
+{
+  // Messages received at the same time keep their order
+  log::ChunkWriter writer;
+  const std::vector<std::chrono::nanoseconds> appended = {3ns, 1ns, 2ns, 1ns};
+  for (std::size_t i = 0; i < appended.size(); ++i)
+  {
+    const std::string msg = std::to_string(i);
+    EXPECT_TRUE(writer.Append(appended[i], msg.data(), msg.size()));
+  }
+  EXPECT_EQ(1ns, writer.StartTime());
+  EXPECT_EQ(3ns, writer.EndTime());
+
+  const std::size_t size = writer.Size();
+  std::string data;
+  std::string compression;
+  EXPECT_TRUE(writer.Finish(log::LogCompression::NONE, data, compression));
+
+  std::vector<std::chrono::nanoseconds> times;
+  std::vector<std::string> msgs = readChunk(data, compression, size, times);
+  EXPECT_EQ(std::vector<std::string>({"1", "3", "2", "0"}), msgs);
+  EXPECT_EQ(std::vector<std::chrono::nanoseconds>({1ns, 1ns, 2ns, 3ns}),
+      times);
+}
+
+//////////////////////////////////////////////////
+TEST(Chunk, Truncated)
+{
+  log::ChunkWriter writer;
+  const std::string msg = "message";
+  EXPECT_TRUE(writer.Append(1ns, msg.data(), msg.size()));
+
+  std::string data;
+  std::string compression;
+  EXPECT_TRUE(writer.Finish(log::LogCompression::NONE, data, compression));
+  data.pop_back();
+
+  log::ChunkReader reader;
+  EXPECT_TRUE(reader.Reset(data.data(), data.size(), compression,
+        data.size()));
+  std::chrono::nanoseconds time;
+  const char *msgData;
+  std::size_t len;
+  EXPECT_FALSE(reader.Next(time, msgData, len));
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -49,6 +49,12 @@ auto Descriptor::MsgTypesToTopicsToId() const -> const NameToMap &
   return this->dataPtr->msgTypesToTopicsToId;
 }
 
+//////////////////////////////////////////////////
+bool Descriptor::IndexesTopicTime() const
+{
+  return this->dataPtr->indexesTopicTime;
+}
+
 //////////////////////////////////////////////////
 int64_t Descriptor::TopicId(const std::string &_topicName,
     const std::string &_msgType) const
@@ -89,6 +89,9 @@ namespace ignition
 
         /// \internal \sa Descriptor::MsgTypesToTopicsToId()
         public: NameToMap msgTypesToTopicsToId;
+
+        /// \internal \sa Descriptor::IndexesTopicTime()
+        public: bool indexesTopicTime = false;
 #ifdef _WIN32
 #pragma warning(pop)
 #endif
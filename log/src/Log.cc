@@ -22,15 +22,18 @@
 #include <cstdlib>
 #include <fstream>
 #include <functional>
+#include <map>
 #include <memory>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "ignition/transport/log/Descriptor.hh"
 #include "ignition/transport/log/Log.hh"
 #include "ignition/transport/log/SqlStatement.hh"
 #include "BatchPrivate.hh"
 #include "build_config.hh"
+#include "Chunk.hh"
 #include "Console.hh"
 #include "Descriptor.hh"
 #include "raii-sqlite3.hh"
@@ -38,6 +41,75 @@
 using namespace ignition::transport;
 using namespace ignition::transport::log;
 
+/// \brief Number of rows written by each execution of the multi-row insert
+/// statement. Each row binds three parameters, well below the minimum
+/// SQLITE_MAX_VARIABLE_NUMBER of 999.
+static constexpr std::size_t kRowsPerInsert = 64;
+
+/// \brief Schema version storing every message in its own row.
+static const char kRowsVersion[] = "0.1.0";
+
+/// \brief Schema version storing the messages in chunks.
+static const char kChunksVersion[] = "0.2.0";
+
+//////////////////////////////////////////////////
+/// \brief Read a file of the SQL schema directory.
+/// \param[in] _name Name of the file, without the .sql extension.
+/// \param[out] _sql Content of the file.
+/// \return True if the file was read.
+static bool ReadSchemaFile(const std::string &_name, std::string &_sql)
+{
+  // Test hook so tests can be run before `make install`
+  std::string schemaFile;
+  const char *envPath = std::getenv(SchemaLocationEnvVar.c_str());
+  if (envPath)
+  {
+    schemaFile = envPath;
+  }
+  else
+  {
+    schemaFile = SCHEMA_INSTALL_PATH;
+  }
+  schemaFile += "/" + _name + ".sql";
+
+  LDBG("Schema file: " << schemaFile << "\n");
+  std::ifstream fin(schemaFile, std::ifstream::in);
+  if (!fin)
+  {
+    LERR("Failed to open schema [" << schemaFile << "].\n"
+        << " Set " << SchemaLocationEnvVar << " to the schema location.\n");
+    return false;
+  }
+
+  // Read the schema file
+  _sql.clear();
+  char buffer[4096];
+  while (fin)
+  {
+    fin.read(buffer, sizeof(buffer));
+    _sql.insert(_sql.size(), buffer, fin.gcount());
+  }
+  if (_sql.empty())
+  {
+    LERR("Failed to read schema file [" << schemaFile << "]\n");
+    return false;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Get the statement that inserts messages into the database.
+/// \param[in] _rows Number of rows inserted by the statement.
+/// \return The SQL of the statement.
+static std::string InsertMessagesSql(const std::size_t _rows)
+{
+  std::string sql = "INSERT INTO messages (time_recv, message, topic_id)"
+    " VALUES (?, ?, ?)";
+  for (std::size_t i = 1; i < _rows; ++i)
+    sql += ", (?, ?, ?)";
+  return sql + ";";
+}
+
 /// \brief Private implementation
 class ignition::transport::log::Log::Implementation
 {
@@ -48,6 +120,10 @@ class ignition::transport::log::Log::Implementation
   /// \return one of the SQLite error codes
   public: int EndTransactionIfEnoughTimeHasPassed();
 
+  /// \brief Write the open chunks, then end the transaction
+  /// \return one of the SQLite error codes
+  public: int EndTransaction();
+
   /// \brief Begin transaction if one isn't already open
   /// \return one of the SQLite error codes
   public: int BeginTransactionIfNotInOne();
@@ -65,10 +141,76 @@ class ignition::transport::log::Log::Implementation
   public: bool InsertMessage(const std::chrono::nanoseconds &_time,
       int64_t _topic, const void *_data, std::size_t _len);
 
-  /// \brief Return true if enough time has passed since the last transaction
+  /// \brief Insert messages into the database, many rows at a time. A
+  /// message that fails doesn't prevent the others from being inserted.
+  /// \param[in] _msgs the messages
+  /// \param[in] _topics the topic_id of each message, or -1 to skip it
+  /// \return the number of messages inserted
+  public: std::size_t InsertMessages(const std::vector<RecordedMessage> &_msgs,
+      const std::vector<int64_t> &_topics);
+
+  /// \brief Add a message to the open chunk of its topic, writing the chunk
+  /// first if the message doesn't fit in it
+  /// \param[in] _time time the message was received
+  /// \param[in] _topic topic_id of the message
+  /// \param[in] _data message data
+  /// \param[in] _len number of bytes of data
+  /// \return true if the message was added
+  public: bool AppendToChunk(const std::chrono::nanoseconds &_time,
+      int64_t _topic, const void *_data, std::size_t _len);
+
+  /// \brief Write a chunk into the chunks table, and start a new one
+  /// \param[in] _topic topic_id of the messages of the chunk
+  /// \param[in] _chunk the chunk
+  /// \return true if the chunk was written
+  public: bool WriteChunk(int64_t _topic, ChunkWriter &_chunk);
+
+  /// \brief Write all the open chunks into the chunks table
+  /// \return true if all the chunks were written
+  public: bool WriteChunks();
+
+  /// \brief Move the rows of the messages table into chunks
+  /// \return true if all the messages were moved
+  public: bool MoveMessagesIntoChunks();
+
+  /// \brief Get a prepared statement, compiling it the first time
+  /// \param[in, out] _statement the cached statement
+  /// \param[in] _sql the SQL of the statement
+  /// \return the statement, or nullptr if it could not be compiled
+  public: raii_sqlite3::Statement *Prepare(
+      std::unique_ptr<raii_sqlite3::Statement> &_statement,
+      const std::string &_sql);
+
+  /// \brief Bind the parameters of one row of an insert message statement
+  /// \param[in] _statement the statement
+  /// \param[in] _row index of the row within the statement
+  /// \param[in] _time time the message was received
+  /// \param[in] _topic topic_id of the message
+  /// \param[in] _data message data, which must outlive the execution
+  /// \param[in] _len number of bytes of data
+  /// \return true if all the parameters were bound
+  public: static bool BindMessage(raii_sqlite3::Statement &_statement,
+      std::size_t _row, const std::chrono::nanoseconds &_time,
+      int64_t _topic, const void *_data, std::size_t _len);
+
+  /// \brief Execute a prepared statement, then reset it and clear its
+  /// bindings so it can be executed again
+  /// \param[in] _statement the statement
+  /// \return one of the SQLite result codes
+  public: static int Execute(raii_sqlite3::Statement &_statement);
+
+  /// \brief Return true if enough time has passed since the last transaction,
+  /// or enough messages were inserted by it
   /// \return true if the transaction has lasted long enough
   public: bool TimeForNewTransaction() const;
 
+  /// \brief Apply the SQLite settings of the profile to a database
+  /// \param[in] _db the database
+  /// \param[in] _create true if the database is being created, which is the
+  /// only time the page size can be set
+  /// \return true if all the settings were applied
+  public: bool ApplyProfile(raii_sqlite3::Database &_db, bool _create) const;
+
   /// \brief SQLite3 database pointer wrapper
   public: std::shared_ptr<raii_sqlite3::Database> db;
 
@@ -81,8 +223,20 @@ class ignition::transport::log::Log::Implementation
   /// \brief last time the transaction was ended
   public: std::chrono::steady_clock::time_point lastTransaction;
 
-  /// \brief duration between transactions
-  public: std::chrono::milliseconds transactionPeriod;
+  /// \brief SQLite settings used to write the log file
+  public: LogProfile profile;
+
+  /// \brief Number of messages inserted by the current transaction
+  public: std::size_t rowsInTransaction = 0;
+
+  /// \brief True if the log file is open for writing
+  public: bool writable = false;
+
+  /// \brief True if the log file stores the messages in chunks
+  public: bool chunked = false;
+
+  /// \brief Chunks of messages not written yet, by topic_id
+  public: std::map<int64_t, ChunkWriter> chunks;
 
   /// \brief Flag to track whether we need to generate a new Descriptor
   private: mutable bool needNewDescriptor = true;
@@ -98,6 +252,24 @@ class ignition::transport::log::Log::Implementation
 
   /// \brief Time of the last message in the log file.
   public: std::chrono::nanoseconds endTime = std::chrono::nanoseconds(-1);
+
+  // The prepared statements are declared after db, so they are finalized
+  // before the database is closed.
+
+  /// \brief Statement inserting one message
+  public: std::unique_ptr<raii_sqlite3::Statement> insertMessageStatement;
+
+  /// \brief Statement inserting kRowsPerInsert messages
+  public: std::unique_ptr<raii_sqlite3::Statement> insertMessagesStatement;
+
+  /// \brief Statement inserting a message type
+  public: std::unique_ptr<raii_sqlite3::Statement> insertMessageTypeStatement;
+
+  /// \brief Statement inserting a topic
+  public: std::unique_ptr<raii_sqlite3::Statement> insertTopicStatement;
+
+  /// \brief Statement inserting a chunk
+  public: std::unique_ptr<raii_sqlite3::Statement> insertChunkStatement;
 };
 
 //////////////////////////////////////////////////
@@ -159,9 +331,23 @@ const log::Descriptor *Log::Implementation::Descriptor() const
       }
     } while (returnCode == SQLITE_ROW);
 
+    // Check for the index of the messages by topic and time received
+    raii_sqlite3::Statement indexStatement(*(this->db),
+        "SELECT COUNT(*) FROM sqlite_master WHERE type = 'index' AND"
+        " name IN ('idx_topic_time_recv', 'idx_chunk_topic_time');");
+    if (!indexStatement ||
+        sqlite3_step(indexStatement.Handle()) != SQLITE_ROW)
+    {
+      LERR("Failed to query indexes: " << sqlite3_errmsg(
+          this->db->Handle()) << "\n");
+      return nullptr;
+    }
+
     // Save the result into the descriptor
     this->needNewDescriptor = false;
     descriptor.dataPtr->Reset(topicsInLog);
+    descriptor.dataPtr->indexesTopicTime =
+      sqlite3_column_int64(indexStatement.Handle(), 0) > 0;
   }
 
   return &this->descriptor;
@@ -175,6 +361,18 @@ int Log::Implementation::EndTransactionIfEnoughTimeHasPassed()
     return SQLITE_OK;
   }
 
+  return this->EndTransaction();
+}
+
+//////////////////////////////////////////////////
+int Log::Implementation::EndTransaction()
+{
+  // The chunks never span several transactions
+  if (!this->WriteChunks())
+  {
+    return SQLITE_ERROR;
+  }
+
   // End the transaction
   int returnCode = sqlite3_exec(
       this->db->Handle(), "END;", NULL, 0, nullptr);
@@ -202,6 +400,7 @@ int Log::Implementation::BeginTransactionIfNotInOne()
     return returnCode;
   }
   this->inTransaction = true;
+  this->rowsInTransaction = 0;
   LDBG("Began transaction\n");
   this->lastTransaction = std::chrono::steady_clock::now();
   return returnCode;
@@ -210,8 +409,60 @@ int Log::Implementation::BeginTransactionIfNotInOne()
 //////////////////////////////////////////////////
 bool Log::Implementation::TimeForNewTransaction() const
 {
+  if (this->profile.transactionRows > 0 &&
+      this->rowsInTransaction >= this->profile.transactionRows)
+  {
+    return true;
+  }
+
   auto now = std::chrono::steady_clock::now();
-  return now - this->transactionPeriod > this->lastTransaction;
+  return now - this->profile.transactionPeriod > this->lastTransaction;
+}
+
+//////////////////////////////////////////////////
+bool Log::Implementation::ApplyProfile(raii_sqlite3::Database &_db,
+    const bool _create) const
+{
+  std::string sql;
+
+  // The page size must be set before the first table is created
+  if (_create && this->profile.pageSize > 0)
+    sql += "PRAGMA page_size = " + std::to_string(this->profile.pageSize) + ";";
+
+  sql += this->profile.wal ?
+    "PRAGMA journal_mode = WAL;" : "PRAGMA journal_mode = DELETE;";
+
+  switch (this->profile.synchronous)
+  {
+    case LogSynchronous::OFF:
+      sql += "PRAGMA synchronous = OFF;";
+      break;
+    case LogSynchronous::NORMAL:
+      sql += "PRAGMA synchronous = NORMAL;";
+      break;
+    case LogSynchronous::FULL:
+    default:
+      sql += "PRAGMA synchronous = FULL;";
+      break;
+  }
+
+  // A negative cache size is a number of KiB
+  if (this->profile.cacheSize > 0)
+  {
+    sql += "PRAGMA cache_size = -" +
+      std::to_string(this->profile.cacheSize) + ";";
+  }
+
+  sql += "PRAGMA mmap_size = " + std::to_string(this->profile.mmapSize) + ";";
+
+  int returnCode = sqlite3_exec(_db.Handle(), sql.c_str(), NULL, 0, nullptr);
+  if (returnCode != SQLITE_OK)
+  {
+    LERR("Failed to apply log profile: " << sqlite3_errmsg(_db.Handle())
+         << "\n");
+    return false;
+  }
+  return true;
 }
 
 //////////////////////////////////////////////////
@@ -243,15 +494,15 @@ int64_t Log::Implementation::InsertOrGetTopicId(
     "INSERT INTO topics (name, message_type_id)"
     " SELECT ?002, id FROM message_types WHERE name = ?001 LIMIT 1;";
 
-  raii_sqlite3::Statement messageTypeStatement(
-      *(this->db), sqlMessageType);
+  raii_sqlite3::Statement *messageTypeStatement = this->Prepare(
+      this->insertMessageTypeStatement, sqlMessageType);
   if (!messageTypeStatement)
   {
     LERR("Failed to compile statement to insert message type\n");
     return -1;
   }
-  raii_sqlite3::Statement topicStatement(
-      *(this->db), sqlTopic);
+  raii_sqlite3::Statement *topicStatement = this->Prepare(
+      this->insertTopicStatement, sqlTopic);
   if (!topicStatement)
   {
     LERR("Failed to compile statement to insert topic\n");
@@ -265,21 +516,21 @@ int64_t Log::Implementation::InsertOrGetTopicId(
   int returnCode;
   // Bind parameters
   returnCode = sqlite3_bind_text(
-      messageTypeStatement.Handle(), 1, _type.c_str(), _type.size(), nullptr);
+      messageTypeStatement->Handle(), 1, _type.c_str(), _type.size(), nullptr);
   if (returnCode != SQLITE_OK)
   {
     LERR("Failed to bind message type name(1): " << returnCode << "\n");
     return -1;
   }
   returnCode = sqlite3_bind_text(
-      topicStatement.Handle(), 1, _type.c_str(), _type.size(), nullptr);
+      topicStatement->Handle(), 1, _type.c_str(), _type.size(), nullptr);
   if (returnCode != SQLITE_OK)
   {
     LERR("Failed to bind message type name(2): " << returnCode << "\n");
     return -1;
   }
   returnCode = sqlite3_bind_text(
-      topicStatement.Handle(), 2, _name.c_str(), _name.size(), nullptr);
+      topicStatement->Handle(), 2, _name.c_str(), _name.size(), nullptr);
   if (returnCode != SQLITE_OK)
   {
     LERR("Failed to bind topic name: " << returnCode << "\n");
@@ -287,13 +538,13 @@ int64_t Log::Implementation::InsertOrGetTopicId(
   }
 
   // Execute the statements
-  returnCode = sqlite3_step(messageTypeStatement.Handle());
+  returnCode = Execute(*messageTypeStatement);
   if (returnCode != SQLITE_DONE)
   {
     LERR("Failed to insert message type: " << returnCode << "\n");
     return -1;
   }
-  returnCode = sqlite3_step(topicStatement.Handle());
+  returnCode = Execute(*topicStatement);
   if (returnCode != SQLITE_DONE)
   {
     LERR("Faild to insert topic: " << returnCode << "\n");
@@ -313,13 +564,14 @@ bool Log::Implementation::InsertMessage(
     const void *_data,
     const std::size_t _len)
 {
-  int returnCode;
-  const std::string sql =
-    "INSERT INTO messages (time_recv, message, topic_id)"
-    "VALUES (?001, ?002, ?003);";
+  if (this->chunked)
+  {
+    return this->AppendToChunk(_time, _topic, _data, _len);
+  }
 
-  // Compile the statement
-  raii_sqlite3::Statement statement(*(this->db), sql);
+  // Compile the statement the first time, then reuse it
+  raii_sqlite3::Statement *statement = this->Prepare(
+      this->insertMessageStatement, InsertMessagesSql(1));
   if (!statement)
   {
     LERR("Failed to compile insert message statement\n");
@@ -327,22 +579,122 @@ bool Log::Implementation::InsertMessage(
   }
 
   // Bind parameters
-  returnCode = sqlite3_bind_int64(statement.Handle(), 1, _time.count());
-  if (returnCode != SQLITE_OK)
+  if (!BindMessage(*statement, 0, _time, _topic, _data, _len))
   {
-    LERR("Failed to bind time received: " << returnCode << "\n");
+    sqlite3_clear_bindings(statement->Handle());
     return false;
   }
-  returnCode = sqlite3_bind_blob(statement.Handle(), 2, _data, _len, nullptr);
-  if (returnCode != SQLITE_OK)
+
+  // Reset startTime and endTime
+  this->startTime = std::chrono::nanoseconds(-1);
+  this->endTime = std::chrono::nanoseconds(-1);
+
+  // Execute the statement
+  int returnCode = Execute(*statement);
+  if (returnCode != SQLITE_DONE)
   {
-    LERR("Failed to bind message data: " << returnCode << "\n");
+    LERR("Failed to insert message: " << returnCode << "\n");
     return false;
   }
-  returnCode = sqlite3_bind_int(statement.Handle(), 3, _topic);
-  if (returnCode != SQLITE_OK)
+  ++this->rowsInTransaction;
+  return true;
+}
+
+//////////////////////////////////////////////////
+std::size_t Log::Implementation::InsertMessages(
+    const std::vector<RecordedMessage> &_msgs,
+    const std::vector<int64_t> &_topics)
+{
+  std::size_t inserted = 0;
+
+  // Insert messages one row at a time, skipping those that fail
+  auto insertEach = [&](std::size_t _begin, const std::size_t _end)
+  {
+    for (; _begin < _end; ++_begin)
+    {
+      const RecordedMessage &msg = _msgs[_begin];
+      if (_topics[_begin] >= 0 && this->InsertMessage(msg.time,
+            _topics[_begin], msg.data.data(), msg.data.size()))
+      {
+        ++inserted;
+      }
+    }
+  };
+
+  std::size_t i = 0;
+
+  // Write full groups of kRowsPerInsert rows with the multi-row statement
+  if (!this->chunked && _msgs.size() >= kRowsPerInsert)
+  {
+    raii_sqlite3::Statement *statement = this->Prepare(
+        this->insertMessagesStatement, InsertMessagesSql(kRowsPerInsert));
+    if (!statement)
+    {
+      LERR("Failed to compile insert messages statement\n");
+    }
+
+    // Reset startTime and endTime
+    this->startTime = std::chrono::nanoseconds(-1);
+    this->endTime = std::chrono::nanoseconds(-1);
+
+    for (; statement && i + kRowsPerInsert <= _msgs.size();
+         i += kRowsPerInsert)
+    {
+      bool bound = true;
+      for (std::size_t row = 0; bound && row < kRowsPerInsert; ++row)
+      {
+        const RecordedMessage &msg = _msgs[i + row];
+        bound = _topics[i + row] >= 0 &&
+          BindMessage(*statement, row, msg.time, _topics[i + row],
+              msg.data.data(), msg.data.size());
+      }
+
+      if (bound)
+      {
+        int returnCode = Execute(*statement);
+        if (returnCode == SQLITE_DONE)
+        {
+          this->rowsInTransaction += kRowsPerInsert;
+          inserted += kRowsPerInsert;
+          continue;
+        }
+        LERR("Failed to insert messages: " << returnCode << "\n");
+      }
+      else
+      {
+        sqlite3_clear_bindings(statement->Handle());
+      }
+
+      // The statement inserts all its rows or none, so retry them one at a
+      // time to lose only the messages that fail
+      insertEach(i, i + kRowsPerInsert);
+    }
+  }
+
+  // Write the rest one row at a time
+  insertEach(i, _msgs.size());
+  return inserted;
+}
+
+//////////////////////////////////////////////////
+bool Log::Implementation::AppendToChunk(
+    const std::chrono::nanoseconds &_time,
+    const int64_t _topic,
+    const void *_data,
+    const std::size_t _len)
+{
+  ChunkWriter &chunk = this->chunks[_topic];
+  if (!chunk.Empty() &&
+      chunk.Size() + kChunkHeaderSize + _len > this->profile.chunkSize)
+  {
+    if (!this->WriteChunk(_topic, chunk))
+    {
+      return false;
+    }
+  }
+
+  if (!chunk.Append(_time, _data, _len))
   {
-    LERR("Failed to bind topic_id: " << returnCode << "\n");
     return false;
   }
 
@@ -350,23 +702,192 @@ bool Log::Implementation::InsertMessage(
   this->startTime = std::chrono::nanoseconds(-1);
   this->endTime = std::chrono::nanoseconds(-1);
 
+  ++this->rowsInTransaction;
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool Log::Implementation::WriteChunk(const int64_t _topic,
+    ChunkWriter &_chunk)
+{
+  if (_chunk.Empty())
+  {
+    return true;
+  }
+
+  const std::string sql =
+    "INSERT INTO chunks (topic_id, start_time, end_time, message_count,"
+    " compression, size, data)"
+    " VALUES (?001, ?002, ?003, ?004, ?005, ?006, ?007);";
+
+  raii_sqlite3::Statement *statement = this->Prepare(
+      this->insertChunkStatement, sql);
+  if (!statement)
+  {
+    LERR("Failed to compile insert chunk statement\n");
+    return false;
+  }
+
+  const int64_t start = _chunk.StartTime().count();
+  const int64_t end = _chunk.EndTime().count();
+  const int64_t count = _chunk.Count();
+  const int64_t size = _chunk.Size();
+  std::string data;
+  std::string compression;
+  if (!_chunk.Finish(this->profile.compression, data, compression))
+  {
+    return false;
+  }
+
+  // Bind parameters
+  sqlite3_stmt *handle = statement->Handle();
+  if (sqlite3_bind_int64(handle, 1, _topic) != SQLITE_OK ||
+      sqlite3_bind_int64(handle, 2, start) != SQLITE_OK ||
+      sqlite3_bind_int64(handle, 3, end) != SQLITE_OK ||
+      sqlite3_bind_int64(handle, 4, count) != SQLITE_OK ||
+      sqlite3_bind_text(handle, 5, compression.c_str(), compression.size(),
+        nullptr) != SQLITE_OK ||
+      sqlite3_bind_int64(handle, 6, size) != SQLITE_OK ||
+      sqlite3_bind_blob(handle, 7, data.data(), data.size(), nullptr) !=
+        SQLITE_OK)
+  {
+    LERR("Failed to bind chunk: " << sqlite3_errmsg(
+        this->db->Handle()) << "\n");
+    sqlite3_clear_bindings(handle);
+    return false;
+  }
 
   // Execute the statement
-  returnCode = sqlite3_step(statement.Handle());
+  int returnCode = Execute(*statement);
   if (returnCode != SQLITE_DONE)
   {
-    LERR("Failed to insert message: " << returnCode << "\n");
+    LERR("Failed to insert chunk: " << returnCode << "\n");
+    return false;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool Log::Implementation::WriteChunks()
+{
+  bool result = true;
+  for (auto &chunk : this->chunks)
+  {
+    result = this->WriteChunk(chunk.first, chunk.second) && result;
+  }
+  return result;
+}
+
+//////////////////////////////////////////////////
+bool Log::Implementation::MoveMessagesIntoChunks()
+{
+  // The indexes of the log file change
+  this->needNewDescriptor = true;
+
+  // Ordered by topic, so only one chunk is open at a time
+  raii_sqlite3::Statement statement(*(this->db),
+      "SELECT topic_id, time_recv, message FROM messages"
+      " ORDER BY topic_id, time_recv;");
+  if (!statement)
+  {
+    LERR("Failed to compile statement to read messages\n");
+    return false;
+  }
+
+  int64_t lastTopic = -1;
+  int returnCode;
+  while ((returnCode = sqlite3_step(statement.Handle())) == SQLITE_ROW)
+  {
+    const int64_t topic = sqlite3_column_int64(statement.Handle(), 0);
+    const std::chrono::nanoseconds time(
+        sqlite3_column_int64(statement.Handle(), 1));
+    const void *data = sqlite3_column_blob(statement.Handle(), 2);
+    const std::size_t len = sqlite3_column_bytes(statement.Handle(), 2);
+
+    if (topic != lastTopic && lastTopic >= 0 &&
+        !this->WriteChunk(lastTopic, this->chunks[lastTopic]))
+    {
+      return false;
+    }
+    lastTopic = topic;
+
+    if (!this->AppendToChunk(time, topic, data, len))
+    {
+      return false;
+    }
+  }
+
+  if (returnCode != SQLITE_DONE)
+  {
+    LERR("Failed to read messages: " << returnCode << "\n");
+    return false;
+  }
+  return this->WriteChunks();
+}
+
+//////////////////////////////////////////////////
+raii_sqlite3::Statement *Log::Implementation::Prepare(
+    std::unique_ptr<raii_sqlite3::Statement> &_statement,
+    const std::string &_sql)
+{
+  if (!_statement)
+  {
+    std::unique_ptr<raii_sqlite3::Statement> statement(
+        new raii_sqlite3::Statement(*(this->db), _sql));
+    if (!*statement)
+      return nullptr;
+    _statement = std::move(statement);
+  }
+  return _statement.get();
+}
+
+//////////////////////////////////////////////////
+bool Log::Implementation::BindMessage(
+    raii_sqlite3::Statement &_statement,
+    const std::size_t _row,
+    const std::chrono::nanoseconds &_time,
+    const int64_t _topic,
+    const void *_data,
+    const std::size_t _len)
+{
+  const int first = static_cast<int>(3 * _row);
+
+  int returnCode = sqlite3_bind_int64(
+      _statement.Handle(), first + 1, _time.count());
+  if (returnCode != SQLITE_OK)
+  {
+    LERR("Failed to bind time received: " << returnCode << "\n");
+    return false;
+  }
+  returnCode = sqlite3_bind_blob(
+      _statement.Handle(), first + 2, _data, _len, nullptr);
+  if (returnCode != SQLITE_OK)
+  {
+    LERR("Failed to bind message data: " << returnCode << "\n");
+    return false;
+  }
+  returnCode = sqlite3_bind_int64(_statement.Handle(), first + 3, _topic);
+  if (returnCode != SQLITE_OK)
+  {
+    LERR("Failed to bind topic_id: " << returnCode << "\n");
     return false;
   }
   return true;
 }
 
+//////////////////////////////////////////////////
+int Log::Implementation::Execute(raii_sqlite3::Statement &_statement)
+{
+  int returnCode = sqlite3_step(_statement.Handle());
+  sqlite3_reset(_statement.Handle());
+  sqlite3_clear_bindings(_statement.Handle());
+  return returnCode;
+}
+
 //////////////////////////////////////////////////
 Log::Log()
   : dataPtr(new Implementation)
 {
-  // Default to 2 transactions per second
-  this->dataPtr->transactionPeriod = std::chrono::milliseconds(500);
 }
 
 //////////////////////////////////////////////////
@@ -378,9 +899,10 @@ Log::Log(Log &&_other)  // NOLINT
 //////////////////////////////////////////////////
 Log::~Log()
 {
-  if (this->dataPtr && this->dataPtr->inTransaction)
+  // Commit the messages inserted, however long ago the transaction began
+  if (this->Valid() && this->dataPtr->inTransaction)
   {
-    this->dataPtr->EndTransactionIfEnoughTimeHasPassed();
+    this->dataPtr->EndTransaction();
   }
 }
 
@@ -421,68 +943,185 @@ bool Log::Open(const std::string &_file, const std::ios_base::openmode _mode)
   // Don't need to create a schema if this is read only
   if (std::ios_base::out & _mode)
   {
-    // Test hook so tests can be run before `make install`
-    std::string schemaFile;
-    const char *envPath = std::getenv(SchemaLocationEnvVar.c_str());
-    if (envPath)
+    // A log file opened to append to may be initialized already
+    bool initialized = false;
+    if (std::ios_base::app & _mode)
     {
-      schemaFile = envPath;
-    }
-    else
-    {
-      schemaFile = SCHEMA_INSTALL_PATH;
+      raii_sqlite3::Statement statement(*db,
+          "SELECT COUNT(*) FROM sqlite_master"
+          " WHERE type = 'table' AND name = 'migrations';");
+      if (!statement || sqlite3_step(statement.Handle()) != SQLITE_ROW)
+      {
+        LERR("Failed to open log: " << sqlite3_errmsg(db->Handle()) << "\n");
+        return false;
+      }
+      initialized = sqlite3_column_int64(statement.Handle(), 0) > 0;
     }
-    schemaFile += "/0.1.0.sql";
 
-    // Assume the database is uninitialized; use the schema to initialize it
-    LDBG("Schema file: " << schemaFile << "\n");
-    std::ifstream fin(schemaFile, std::ifstream::in);
-    if (!fin)
+    if (!this->dataPtr->ApplyProfile(*db, !initialized))
     {
-      LERR("Failed to open schema [" << schemaFile << "].\n"
-          << " Set " << SchemaLocationEnvVar << " to the schema location.\n");
       return false;
     }
 
-    // Read the schema file
-    std::string schema;
-    char buffer[4096];
-    while (fin)
-    {
-      fin.read(buffer, sizeof(buffer));
-      schema.insert(schema.size(), buffer, fin.gcount());
-    }
-    if (schema.empty())
+    if (!initialized)
     {
-      LERR("Failed to read schema file [" << schemaFile << "]\n");
-      return false;
-    }
+      // The database is uninitialized; use the schema to initialize it
+      std::string schema;
+      if (!ReadSchemaFile(
+            this->dataPtr->profile.chunked ? kChunksVersion : kRowsVersion,
+            schema))
+      {
+        return false;
+      }
 
-    // Apply the schema to the database
-    int returnCode = sqlite3_exec(db->Handle(), schema.c_str(), NULL, 0, NULL);
-    if (returnCode != SQLITE_OK)
-    {
-      LERR("Failed to open log: " << sqlite3_errmsg(db->Handle()) << "\n");
-      return false;
+      // Apply the schema to the database
+      int returnCode = sqlite3_exec(
+          db->Handle(), schema.c_str(), NULL, 0, NULL);
+      if (returnCode != SQLITE_OK)
+      {
+        LERR("Failed to open log: " << sqlite3_errmsg(db->Handle()) << "\n");
+        return false;
+      }
     }
   }
 
   this->dataPtr->db = std::move(db);
 
   // Check the schema version
-  // TODO(sloretz) handle multiple versions
   std::string version = this->Version();
-  if ("0.1.0" != this->Version())
+  if (kRowsVersion != version && kChunksVersion != version)
   {
     LERR("Log file Version '" << version << "' is unsupported by this tool\n");
     this->dataPtr->db.reset();
     return false;
   }
 
+  // Log files storing a row per message are indexed by topic and time
+  // received when they are written to. Files recorded by older versions
+  // don't have the index, which only speeds up queries.
+  if ((std::ios_base::out & _mode) && kRowsVersion == version &&
+      sqlite3_exec(this->dataPtr->db->Handle(),
+        "CREATE INDEX IF NOT EXISTS idx_topic_time_recv"
+        " ON messages (topic_id, time_recv);", NULL, 0, nullptr) != SQLITE_OK)
+  {
+    LWRN("Failed to index messages by topic: "
+         << sqlite3_errmsg(this->dataPtr->db->Handle()) << "\n");
+  }
+
   this->dataPtr->filename = _file;
+  this->dataPtr->writable = (std::ios_base::out & _mode) != 0;
+  this->dataPtr->chunked = kChunksVersion == version;
+  return true;
+}
+
+//////////////////////////////////////////////////
+bool Log::Migrate()
+{
+  if (!this->Valid() || !this->dataPtr->writable)
+  {
+    LERR("The log file must be open for writing to migrate it\n");
+    return false;
+  }
+
+  if (this->dataPtr->chunked)
+  {
+    return true;
+  }
+
+  std::string migration;
+  if (!ReadSchemaFile(std::string(kRowsVersion) + "_to_" + kChunksVersion,
+        migration))
+  {
+    return false;
+  }
+
+  // The migration runs in a transaction of its own
+  if (this->dataPtr->inTransaction &&
+      SQLITE_OK != this->dataPtr->EndTransaction())
+  {
+    return false;
+  }
+
+  // The statements inserting rows into the messages table are not needed
+  // anymore, and would prevent dropping it
+  this->dataPtr->insertMessageStatement.reset();
+  this->dataPtr->insertMessagesStatement.reset();
+
+  sqlite3 *handle = this->dataPtr->db->Handle();
+  bool migrated =
+    sqlite3_exec(handle, "BEGIN;", NULL, 0, nullptr) == SQLITE_OK &&
+    sqlite3_exec(handle, migration.c_str(), NULL, 0, nullptr) == SQLITE_OK &&
+    this->dataPtr->MoveMessagesIntoChunks() &&
+    sqlite3_exec(handle, "DROP TABLE messages;", NULL, 0, nullptr) ==
+      SQLITE_OK &&
+    sqlite3_exec(handle, "END;", NULL, 0, nullptr) == SQLITE_OK;
+
+  if (!migrated)
+  {
+    LERR("Failed to migrate log: " << sqlite3_errmsg(handle) << "\n");
+    sqlite3_exec(handle, "ROLLBACK;", NULL, 0, nullptr);
+    this->dataPtr->chunks.clear();
+    return false;
+  }
+
+  this->dataPtr->chunked = true;
+  this->dataPtr->startTime = std::chrono::nanoseconds(-1);
+  this->dataPtr->endTime = std::chrono::nanoseconds(-1);
+  LDBG("Migrated log from " << kRowsVersion << " to " << kChunksVersion
+       << "\n");
+
+  // Give the space of the messages table back to the file system
+  if (sqlite3_exec(handle, "VACUUM;", NULL, 0, nullptr) != SQLITE_OK)
+  {
+    LWRN("Failed to vacuum log: " << sqlite3_errmsg(handle) << "\n");
+  }
   return true;
 }
 
+//////////////////////////////////////////////////
+bool Log::SetProfile(const LogProfile &_profile)
+{
+  if (!_profile.Valid())
+  {
+    LERR("Invalid log profile\n");
+    return false;
+  }
+
+  this->dataPtr->profile = _profile;
+
+  if (!this->Valid() || !this->dataPtr->writable)
+  {
+    return true;
+  }
+
+  // The journal mode can't change within a transaction
+  if (this->dataPtr->inTransaction &&
+      SQLITE_OK != this->dataPtr->EndTransaction())
+  {
+    return false;
+  }
+
+  return this->dataPtr->ApplyProfile(*(this->dataPtr->db), false);
+}
+
+//////////////////////////////////////////////////
+const LogProfile &Log::Profile() const
+{
+  return this->dataPtr->profile;
+}
+
+//////////////////////////////////////////////////
+bool LogProfile::Valid() const
+{
+  const bool validPageSize = this->pageSize == 0 ||
+    (this->pageSize >= 512 && this->pageSize <= 65536 &&
+     (this->pageSize & (this->pageSize - 1)) == 0);
+
+  return validPageSize && this->cacheSize >= 0 && this->mmapSize >= 0 &&
+    this->transactionPeriod >= std::chrono::milliseconds::zero() &&
+    this->chunkSize > 0;
+}
+
 //////////////////////////////////////////////////
 const log::Descriptor *Log::Descriptor() const
 {
@@ -531,6 +1170,52 @@ bool Log::InsertMessage(
   return true;
 }
 
+//////////////////////////////////////////////////
+std::size_t Log::InsertMessages(const std::vector<RecordedMessage> &_msgs)
+{
+  if (!this->Valid() || _msgs.empty())
+  {
+    return 0;
+  }
+
+  // Need to insert multiple messages pertransaction for best performance
+  if (SQLITE_OK != this->dataPtr->BeginTransactionIfNotInOne())
+  {
+    return 0;
+  }
+
+  // Get the topics.id of each message. Consecutive messages are usually on
+  // the same topic, so the last one is remembered. The messages whose topic
+  // can't be inserted are skipped.
+  std::vector<int64_t> topicIds;
+  topicIds.reserve(_msgs.size());
+  const RecordedMessage *last = nullptr;
+  int64_t topicId = -1;
+  for (const RecordedMessage &msg : _msgs)
+  {
+    if (!last || msg.topic != last->topic || msg.type != last->type)
+    {
+      topicId = this->dataPtr->InsertOrGetTopicId(msg.topic, msg.type);
+      last = &msg;
+    }
+    topicIds.push_back(topicId);
+  }
+
+  // Insert the messages into the database
+  const std::size_t inserted = this->dataPtr->InsertMessages(_msgs, topicIds);
+
+  // Finish the transaction if enough time has passed
+  if (SQLITE_OK != this->dataPtr->EndTransactionIfEnoughTimeHasPassed())
+  {
+    // Something is really busted if this happens
+    LERR("Failed to end transcation: "<< sqlite3_errmsg(
+        this->dataPtr->db->Handle()) << "\n");
+    return 0;
+  }
+
+  return inserted;
+}
+
 //////////////////////////////////////////////////
 Batch Log::QueryMessages(const QueryOptions &_options)
 {
@@ -541,9 +1226,27 @@ Batch Log::QueryMessages(const QueryOptions &_options)
   if (!desc)
     return Batch();
 
-  std::unique_ptr<BatchPrivate> batchPriv(
-        new BatchPrivate(this->dataPtr->db,
-                         _options.GenerateStatements(*desc)));
+  std::unique_ptr<BatchPrivate> batchPriv;
+  if (this->dataPtr->chunked)
+  {
+    // The messages of the open chunks are part of the log too
+    this->dataPtr->WriteChunks();
+
+    std::vector<SqlStatement> statements =
+      _options.GenerateChunkStatements(*desc);
+
+    // The messages of the chunks selected are filtered by time received
+    const TimeRangeOption *timeOption =
+      dynamic_cast<const TimeRangeOption *>(&_options);
+    batchPriv.reset(new BatchPrivate(this->dataPtr->db,
+        std::move(statements),
+        timeOption ? timeOption->TimeRange() : QualifiedTimeRange::AllTime()));
+  }
+  else
+  {
+    batchPriv.reset(new BatchPrivate(this->dataPtr->db,
+        _options.GenerateStatements(*desc)));
+  }
 
   return Batch(std::move(batchPriv));
 }
@@ -563,8 +1266,12 @@ std::chrono::nanoseconds Log::StartTime() const
     return this->dataPtr->startTime;
   }
 
+  // The messages of the open chunks are part of the log too
+  this->dataPtr->WriteChunks();
+
   // Compile the statement
-  const char* const getStartTimeStatement =
+  const char* const getStartTimeStatement = this->dataPtr->chunked ?
+      "SELECT MIN(start_time) AS start_time FROM chunks;" :
       "SELECT MIN(time_recv) AS start_time FROM messages;";
   raii_sqlite3::Statement statement(*(this->dataPtr->db),
                                     getStartTimeStatement);
@@ -607,8 +1314,12 @@ std::chrono::nanoseconds Log::EndTime() const
     return this->dataPtr->endTime;
   }
 
+  // The messages of the open chunks are part of the log too
+  this->dataPtr->WriteChunks();
+
   // Compile the statement
-  const char* const getEndTimeStatement =
+  const char* const getEndTimeStatement = this->dataPtr->chunked ?
+      "SELECT MAX(end_time) AS end_time FROM chunks;" :
       "SELECT MAX(time_recv) AS end_time FROM messages;";
   raii_sqlite3::Statement statement(*(this->dataPtr->db),
                                     getEndTimeStatement);
@@ -630,7 +1341,8 @@ std::chrono::nanoseconds Log::EndTime() const
     // If the database is corrupt, then we need to iterate over the valid
     // messages until we get the to corrupt statement. The timestamp
     // of the last valid message is returned.
-    const char* const getAllTimesStatement =
+    const char* const getAllTimesStatement = this->dataPtr->chunked ?
+      "SELECT end_time FROM chunks;" :
       "SELECT time_recv AS end_time FROM messages;";
     raii_sqlite3::Statement statementAll(*(this->dataPtr->db),
         getAllTimesStatement);
@@ -32,6 +32,23 @@ TEST(LogCommandAPI, RecordBadRegex)
   EXPECT_EQ(BAD_REGEX, recordTopics(":memory:", "*"));
 }
 
+//////////////////////////////////////////////////
+TEST(LogCommandAPI, RecordInvalidProfile)
+{
+  // Synchronous mode.
+  EXPECT_EQ(INVALID_PROFILE, recordTopicsWithProfile(
+        ":memory:", ".*", 1, 3, 0, 0, 0, 500, 0));
+  // Page size.
+  EXPECT_EQ(INVALID_PROFILE, recordTopicsWithProfile(
+        ":memory:", ".*", 1, 1, 1000, 0, 0, 500, 0));
+  // Transaction period.
+  EXPECT_EQ(INVALID_PROFILE, recordTopicsWithProfile(
+        ":memory:", ".*", 1, 1, 4096, 0, 0, -1, 0));
+  // Messages per transaction.
+  EXPECT_EQ(INVALID_PROFILE, recordTopicsWithProfile(
+        ":memory:", ".*", 1, 1, 4096, 0, 0, 500, -1));
+}
+
 //////////////////////////////////////////////////
 TEST(LogCommandAPI, PlaybackBadRegex)
 {
@@ -15,12 +15,22 @@
  *
 */
 
+#include <sqlite3.h>
+
 #include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <fstream>
 #include <ios>
+#include <memory>
+#include <regex>
+#include <set>
 #include <string>
 #include <unordered_set>
+#include <vector>
 
 #include "ignition/transport/log/Log.hh"
+#include "ignition/transport/log/QueryOptions.hh"
 #include "ignition/transport/test_config.h"
 #include "ignition/transport/log/test_config.h"
 #include "gtest/gtest.h"
@@ -203,6 +213,544 @@ TEST(Log, Insert2Get1MessageByTopic)
   }
 }
 
+//////////////////////////////////////////////////
+/// \brief Insert messages in a batch, and query them.
+/// \param[in] _chunked Whether the log stores the messages in chunks.
+static void insertMessages(const bool _chunked)
+{
+  log::LogProfile profile;
+  profile.chunked = _chunked;
+
+  log::Log logFile;
+  EXPECT_EQ(0u, logFile.InsertMessages({}));
+  ASSERT_TRUE(logFile.SetProfile(profile));
+  ASSERT_TRUE(logFile.Open(":memory:", std::ios_base::out));
+  EXPECT_EQ(0u, logFile.InsertMessages({}));
+
+  // Enough messages to use the multi-row insert and the single-row one,
+  // alternating between two topics in runs.
+  std::vector<log::RecordedMessage> msgs;
+  for (int i = 0; i < 150; ++i)
+  {
+    const std::string topic = (i / 10) % 2 ? "/odd" : "/even";
+    msgs.push_back(log::RecordedMessage{std::chrono::nanoseconds(i + 1),
+      topic, "some.message.type", "data" + std::to_string(i)});
+  }
+  EXPECT_EQ(msgs.size(), logFile.InsertMessages(msgs));
+
+  // A single message goes after the batch.
+  std::string data("last");
+  EXPECT_TRUE(logFile.InsertMessage(151ns, "/even", "some.message.type",
+      reinterpret_cast<const void *>(data.c_str()), data.size()));
+
+  EXPECT_EQ(1ns, logFile.StartTime());
+  EXPECT_EQ(151ns, logFile.EndTime());
+
+  auto batch = logFile.QueryMessages();
+  int count = 0;
+  for (const log::Message &msg : batch)
+  {
+    if (count < 150)
+    {
+      EXPECT_EQ(msgs[count].topic, msg.Topic());
+      EXPECT_EQ(msgs[count].data, msg.Data());
+      EXPECT_EQ(msgs[count].time, msg.TimeReceived());
+    }
+    else
+    {
+      EXPECT_EQ("/even", msg.Topic());
+      EXPECT_EQ(data, msg.Data());
+    }
+    ++count;
+  }
+  EXPECT_EQ(151, count);
+
+  int odd = 0;
+  for (const log::Message &msg : logFile.QueryMessages(log::TopicList("/odd")))
+  {
+    EXPECT_EQ("/odd", msg.Topic());
+    ++odd;
+  }
+  EXPECT_EQ(70, odd);
+}
+
+//////////////////////////////////////////////////
+TEST(Log, InsertMessages)
+{
+  insertMessages(true);
+}
+
+//////////////////////////////////////////////////
+TEST(Log, InsertMessagesRows)
+{
+  insertMessages(false);
+}
+
+//////////////////////////////////////////////////
+/// \brief A message that fails doesn't prevent the rest of its batch from
+/// being inserted.
+TEST(Log, InsertMessagesPartialFailure)
+{
+  const std::string file = "LogInsertMessagesPartialFailure.tlog";
+  std::remove(file.c_str());
+
+  log::LogProfile profile;
+  profile.chunked = false;
+  {
+    log::Log logFile;
+    ASSERT_TRUE(logFile.SetProfile(profile));
+    ASSERT_TRUE(logFile.Open(file, std::ios_base::out));
+  }
+
+  // Reject the messages received at 100ns and 140ns: one of them is in a
+  // multi-row insert, the other one is inserted alone.
+  sqlite3 *db = nullptr;
+  ASSERT_EQ(SQLITE_OK, sqlite3_open(file.c_str(), &db));
+  EXPECT_EQ(SQLITE_OK, sqlite3_exec(db,
+        "CREATE TRIGGER reject BEFORE INSERT ON messages"
+        " WHEN NEW.time_recv IN (100, 140)"
+        " BEGIN SELECT RAISE(ABORT, 'rejected'); END;",
+        nullptr, nullptr, nullptr)) << sqlite3_errmsg(db);
+  sqlite3_close(db);
+
+  std::vector<log::RecordedMessage> msgs;
+  for (int i = 0; i < 150; ++i)
+  {
+    msgs.push_back(log::RecordedMessage{std::chrono::nanoseconds(i),
+      "/topic", "some.message.type", std::to_string(i)});
+  }
+
+  {
+    log::Log logFile;
+    ASSERT_TRUE(logFile.SetProfile(profile));
+    ASSERT_TRUE(logFile.Open(file, std::ios_base::out | std::ios_base::app));
+    EXPECT_EQ(msgs.size() - 2, logFile.InsertMessages(msgs));
+  }
+
+  log::Log logFile;
+  ASSERT_TRUE(logFile.Open(file, std::ios_base::in));
+  std::vector<std::string> data;
+  for (const log::Message &msg : logFile.QueryMessages())
+    data.push_back(msg.Data());
+
+  ASSERT_EQ(msgs.size() - 2, data.size());
+  EXPECT_EQ("99", data[99]);
+  EXPECT_EQ("101", data[100]);
+  EXPECT_EQ("141", data[139]);
+  EXPECT_EQ("149", data.back());
+
+  std::remove(file.c_str());
+}
+
+//////////////////////////////////////////////////
+/// \brief Count the messages of a log file, opening it read only.
+/// \param[in] _file The log file.
+/// \return The number of messages.
+static int countMessages(const std::string &_file)
+{
+  log::Log logFile;
+  EXPECT_TRUE(logFile.Open(_file, std::ios_base::in));
+  int count = 0;
+  for (const log::Message &msg : logFile.QueryMessages())
+  {
+    (void)msg;
+    ++count;
+  }
+  return count;
+}
+
+//////////////////////////////////////////////////
+TEST(Log, Profile)
+{
+  log::LogProfile profile;
+  EXPECT_TRUE(profile.Valid());
+  EXPECT_FALSE(profile.wal);
+  EXPECT_EQ(log::LogSynchronous::FULL, profile.synchronous);
+  EXPECT_EQ(500ms, profile.transactionPeriod);
+
+  profile.pageSize = 1000;
+  EXPECT_FALSE(profile.Valid());
+  profile.pageSize = 256;
+  EXPECT_FALSE(profile.Valid());
+  profile.pageSize = 8192;
+  EXPECT_TRUE(profile.Valid());
+  profile.mmapSize = -1;
+  EXPECT_FALSE(profile.Valid());
+  profile.mmapSize = 0;
+  profile.transactionPeriod = -1ms;
+  EXPECT_FALSE(profile.Valid());
+
+  log::Log logFile;
+  EXPECT_FALSE(logFile.SetProfile(profile));
+  EXPECT_EQ(500ms, logFile.Profile().transactionPeriod);
+
+  profile.transactionPeriod = 1h;
+  EXPECT_TRUE(logFile.SetProfile(profile));
+  EXPECT_EQ(8192, logFile.Profile().pageSize);
+  EXPECT_EQ(1h, logFile.Profile().transactionPeriod);
+}
+
+//////////////////////////////////////////////////
+TEST(Log, ProfileTransactionRows)
+{
+  const std::string file = "LogProfileTransactionRows.tlog";
+  std::remove(file.c_str());
+
+  {
+    // Only the number of messages ends the transactions.
+    log::LogProfile profile;
+    profile.wal = true;
+    profile.synchronous = log::LogSynchronous::NORMAL;
+    profile.pageSize = 8192;
+    profile.cacheSize = 4096;
+    profile.mmapSize = 1 << 20;
+    profile.transactionPeriod = 1h;
+    profile.transactionRows = 2;
+
+    log::Log logFile;
+    ASSERT_TRUE(logFile.SetProfile(profile));
+    ASSERT_TRUE(logFile.Open(file, std::ios_base::out));
+
+    // The journal is a write-ahead log.
+    EXPECT_TRUE(std::ifstream(file + "-wal").good());
+
+    std::string data("data");
+    EXPECT_TRUE(logFile.InsertMessage(1ns, "/topic", "some.message.type",
+        reinterpret_cast<const void *>(data.c_str()), data.size()));
+    EXPECT_EQ(0, countMessages(file));
+
+    EXPECT_TRUE(logFile.InsertMessage(2ns, "/topic", "some.message.type",
+        reinterpret_cast<const void *>(data.c_str()), data.size()));
+    EXPECT_EQ(2, countMessages(file));
+
+    // Changing the profile commits the current transaction.
+    EXPECT_TRUE(logFile.InsertMessage(3ns, "/topic", "some.message.type",
+        reinterpret_cast<const void *>(data.c_str()), data.size()));
+    EXPECT_EQ(2, countMessages(file));
+    profile.synchronous = log::LogSynchronous::OFF;
+    EXPECT_TRUE(logFile.SetProfile(profile));
+    EXPECT_EQ(3, countMessages(file));
+  }
+
+  EXPECT_EQ(3, countMessages(file));
+  std::remove(file.c_str());
+  std::remove((file + "-wal").c_str());
+  std::remove((file + "-shm").c_str());
+}
+
+//////////////////////////////////////////////////
+/// \brief Query options written for log files storing a row per message.
+class MessageOnlyOptions : public log::QueryOptions
+{
+  // Documentation inherited
+  public: std::vector<log::SqlStatement> GenerateStatements(
+    const log::Descriptor & /*_descriptor*/) const override
+  {
+    log::SqlStatement sql = StandardMessageQueryPreamble();
+    sql.Append(StandardMessageQueryClose());
+    return {sql};
+  }
+};
+
+//////////////////////////////////////////////////
+TEST(Log, Chunks)
+{
+  // Small chunks, so each topic has several of them.
+  log::LogProfile profile;
+  profile.chunkSize = 64;
+
+  log::Log logFile;
+  ASSERT_TRUE(logFile.SetProfile(profile));
+  ASSERT_TRUE(logFile.Open(":memory:", std::ios_base::out));
+
+  // The messages of /fast are received out of order.
+  std::vector<log::RecordedMessage> msgs;
+  for (int i = 0; i < 100; ++i)
+  {
+    const int time = i % 5 ? 10 * i : 10 * i + 25;
+    msgs.push_back(log::RecordedMessage{std::chrono::nanoseconds(time),
+      "/fast", "some.message.type", std::string(10, 'a' + i % 26)});
+    if (i % 10 == 0)
+    {
+      msgs.push_back(log::RecordedMessage{std::chrono::nanoseconds(time + 5),
+        "/slow", "other.message.type", std::to_string(i)});
+    }
+  }
+  EXPECT_EQ(msgs.size(), logFile.InsertMessages(msgs));
+
+  // The messages are merged by time received.
+  EXPECT_EQ(10ns, logFile.StartTime());
+  EXPECT_EQ(990ns, logFile.EndTime());
+  std::chrono::nanoseconds last(0);
+  int fast = 0;
+  int slow = 0;
+  for (const log::Message &msg : logFile.QueryMessages())
+  {
+    EXPECT_LE(last, msg.TimeReceived());
+    last = msg.TimeReceived();
+    if (msg.Topic() == "/fast")
+    {
+      EXPECT_EQ("some.message.type", msg.Type());
+      EXPECT_EQ(10u, msg.Data().size());
+      ++fast;
+    }
+    else
+    {
+      EXPECT_EQ("/slow", msg.Topic());
+      EXPECT_EQ("other.message.type", msg.Type());
+      ++slow;
+    }
+  }
+  EXPECT_EQ(100, fast);
+  EXPECT_EQ(10, slow);
+
+  // Only the messages in the time range are returned, even when their chunk
+  // overlaps it.
+  const log::QualifiedTime begin(
+      210ns, log::QualifiedTime::Qualifier::EXCLUSIVE);
+  const log::QualifiedTime end(390ns);
+  std::vector<std::chrono::nanoseconds> times;
+  for (const log::Message &msg : logFile.QueryMessages(
+        log::AllTopics(log::QualifiedTimeRange(begin, end))))
+  {
+    times.push_back(msg.TimeReceived());
+  }
+  ASSERT_EQ(21u, times.size());
+  EXPECT_EQ(220ns, times.front());
+  EXPECT_EQ(390ns, times.back());
+
+  int count = 0;
+  for (const log::Message &msg : logFile.QueryMessages(
+        log::TopicList("/slow", log::QualifiedTimeRange(begin, end))))
+  {
+    EXPECT_EQ("/slow", msg.Topic());
+    ++count;
+  }
+  EXPECT_EQ(2, count);
+
+  // Options which only generate message statements see every message
+  count = 0;
+  for (const log::Message &msg : logFile.QueryMessages(MessageOnlyOptions()))
+  {
+    EXPECT_FALSE(msg.Topic().empty());
+    ++count;
+  }
+  EXPECT_EQ(110, count);
+}
+
+//////////////////////////////////////////////////
+TEST(Log, Migrate)
+{
+  const std::string file = "LogMigrate.tlog";
+  std::remove(file.c_str());
+
+  // Compressible messages
+  std::vector<log::RecordedMessage> msgs;
+  for (int i = 0; i < 1000; ++i)
+  {
+    msgs.push_back(log::RecordedMessage{std::chrono::nanoseconds(i),
+      i % 2 ? "/odd" : "/even", "some.message.type",
+      "data " + std::to_string(i % 10) + std::string(100, ' ')});
+  }
+
+  {
+    log::LogProfile profile;
+    profile.chunked = false;
+
+    log::Log logFile;
+    ASSERT_TRUE(logFile.SetProfile(profile));
+    ASSERT_TRUE(logFile.Open(file, std::ios_base::out));
+    EXPECT_EQ("0.1.0", logFile.Version());
+    EXPECT_EQ(msgs.size(), logFile.InsertMessages(msgs));
+
+    // Only log files open for writing are migrated.
+    EXPECT_FALSE(log::Log().Migrate());
+  }
+  const auto rowsSize = std::ifstream(file, std::ios_base::ate).tellg();
+
+  {
+    log::Log logFile;
+    ASSERT_TRUE(logFile.Open(file,
+          std::ios_base::out | std::ios_base::app));
+    EXPECT_EQ("0.1.0", logFile.Version());
+    EXPECT_TRUE(logFile.Migrate());
+    EXPECT_EQ("0.2.0", logFile.Version());
+
+    // Migrating again does nothing.
+    EXPECT_TRUE(logFile.Migrate());
+
+    // Messages are added to the migrated log file.
+    std::string data("last");
+    EXPECT_TRUE(logFile.InsertMessage(1000ns, "/even", "some.message.type",
+        reinterpret_cast<const void *>(data.c_str()), data.size()));
+  }
+  EXPECT_LT(std::ifstream(file, std::ios_base::ate).tellg(), rowsSize);
+
+  {
+    log::Log logFile;
+    ASSERT_TRUE(logFile.Open(file));
+    EXPECT_EQ("0.2.0", logFile.Version());
+    EXPECT_EQ(0ns, logFile.StartTime());
+    EXPECT_EQ(1000ns, logFile.EndTime());
+
+    std::size_t count = 0;
+    for (const log::Message &msg : logFile.QueryMessages())
+    {
+      if (count < msgs.size())
+      {
+        EXPECT_EQ(msgs[count].time, msg.TimeReceived());
+        EXPECT_EQ(msgs[count].topic, msg.Topic());
+        EXPECT_EQ(msgs[count].data, msg.Data());
+      }
+      ++count;
+    }
+    EXPECT_EQ(msgs.size() + 1, count);
+  }
+
+  std::remove(file.c_str());
+}
+
+//////////////////////////////////////////////////
+/// \brief Get the query plan of a statement.
+/// \param[in] _file The log file.
+/// \param[in] _sql The statement.
+/// \return The detail of each step of the plan.
+static std::vector<std::string> queryPlan(const std::string &_file,
+    const log::SqlStatement &_sql)
+{
+  std::vector<std::string> plan;
+  sqlite3 *db = nullptr;
+  EXPECT_EQ(SQLITE_OK, sqlite3_open_v2(
+        _file.c_str(), &db, SQLITE_OPEN_READONLY, nullptr));
+
+  // The plan doesn't depend on the values of the parameters
+  const std::string explain = "EXPLAIN QUERY PLAN " + _sql.statement;
+  sqlite3_stmt *statement = nullptr;
+  EXPECT_EQ(SQLITE_OK, sqlite3_prepare_v2(
+        db, explain.c_str(), -1, &statement, nullptr)) << sqlite3_errmsg(db);
+  while (sqlite3_step(statement) == SQLITE_ROW)
+  {
+    plan.push_back(
+        reinterpret_cast<const char *>(sqlite3_column_text(statement, 3)));
+  }
+
+  sqlite3_finalize(statement);
+  sqlite3_close(db);
+  return plan;
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that the query plan of a statement only searches an index,
+/// without scanning a table or sorting the rows.
+/// \param[in] _file The log file.
+/// \param[in] _sql The statement.
+/// \param[in] _index Name of the index the statement should search.
+static void expectIndexSearch(const std::string &_file,
+    const log::SqlStatement &_sql, const std::string &_index)
+{
+  bool searchesIndex = false;
+  for (const std::string &detail : queryPlan(_file, _sql))
+  {
+    EXPECT_NE(0u, detail.find("SCAN")) << _sql.statement;
+    EXPECT_EQ(std::string::npos, detail.find("TEMP B-TREE")) << _sql.statement;
+    searchesIndex = searchesIndex ||
+      detail.find("INDEX " + _index + " ") != std::string::npos;
+  }
+  EXPECT_TRUE(searchesIndex) << _sql.statement;
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the query plans of the statements generated by the query
+/// options, and that the topics merged by them are ordered by time.
+/// \param[in] _chunked Whether the log stores the messages in chunks.
+static void checkQueryPlans(const bool _chunked)
+{
+  const std::string file = "LogQueryPlans.tlog";
+  std::remove(file.c_str());
+
+  {
+    log::LogProfile profile;
+    profile.chunked = _chunked;
+    profile.chunkSize = 64;
+
+    log::Log logFile;
+    ASSERT_TRUE(logFile.SetProfile(profile));
+    ASSERT_TRUE(logFile.Open(file, std::ios_base::out));
+
+    std::vector<log::RecordedMessage> msgs;
+    for (int i = 0; i < 300; ++i)
+    {
+      msgs.push_back(log::RecordedMessage{std::chrono::nanoseconds(i),
+        "/topic" + std::to_string(i % 3), "some.message.type",
+        std::to_string(i)});
+    }
+    EXPECT_EQ(msgs.size(), logFile.InsertMessages(msgs));
+  }
+
+  log::Log logFile;
+  ASSERT_TRUE(logFile.Open(file));
+  const log::Descriptor *descriptor = logFile.Descriptor();
+  ASSERT_NE(nullptr, descriptor);
+  EXPECT_TRUE(descriptor->IndexesTopicTime());
+
+  const std::string topicIndex =
+    _chunked ? "idx_chunk_topic_time" : "idx_topic_time_recv";
+  const std::string timeIndex =
+    _chunked ? "idx_chunk_start_time" : "idx_time_recv";
+  const log::QualifiedTimeRange range(10ns, 200ns);
+
+  std::vector<std::unique_ptr<log::QueryOptions>> topicOptions;
+  topicOptions.emplace_back(new log::TopicList("/topic0"));
+  topicOptions.emplace_back(new log::TopicList("/topic0", range));
+  topicOptions.emplace_back(new log::TopicList(
+        std::set<std::string>{"/topic0", "/topic2"}));
+  topicOptions.emplace_back(new log::TopicPattern(
+        std::regex("/topic[02]"), range));
+  for (const auto &options : topicOptions)
+  {
+    const std::vector<log::SqlStatement> statements = _chunked ?
+      options->GenerateChunkStatements(*descriptor) :
+      options->GenerateStatements(*descriptor);
+    ASSERT_EQ(1u, statements.size());
+    expectIndexSearch(file, statements[0], topicIndex);
+  }
+
+  const log::AllTopics allTopics(range);
+  const std::vector<log::SqlStatement> statements = _chunked ?
+    allTopics.GenerateChunkStatements(*descriptor) :
+    allTopics.GenerateStatements(*descriptor);
+  ASSERT_EQ(1u, statements.size());
+  expectIndexSearch(file, statements[0], timeIndex);
+
+  // The messages of the topics are merged by time received
+  std::vector<std::chrono::nanoseconds> times;
+  for (const log::Message &msg : logFile.QueryMessages(
+        log::TopicPattern(std::regex("/topic[02]"), range)))
+  {
+    EXPECT_NE("/topic1", msg.Topic());
+    times.push_back(msg.TimeReceived());
+  }
+  ASSERT_EQ(127u, times.size());
+  EXPECT_EQ(11ns, times.front());
+  EXPECT_EQ(200ns, times.back());
+  for (std::size_t i = 1; i < times.size(); ++i)
+    EXPECT_LT(times[i - 1], times[i]);
+
+  std::remove(file.c_str());
+}
+
+//////////////////////////////////////////////////
+TEST(Log, QueryPlans)
+{
+  checkQueryPlans(true);
+}
+
+//////////////////////////////////////////////////
+TEST(Log, QueryPlansRows)
+{
+  checkQueryPlans(false);
+}
+
 //////////////////////////////////////////////////
 TEST(Log, CheckLogTimes)
 {
@@ -237,7 +785,15 @@ TEST(Log, CheckVersion)
 {
   log::Log logFile;
   ASSERT_TRUE(logFile.Open(":memory:", std::ios_base::out));
-  EXPECT_EQ("0.1.0", logFile.Version());
+  EXPECT_EQ("0.2.0", logFile.Version());
+
+  // Log files storing every message in its own row can still be created.
+  log::LogProfile profile;
+  profile.chunked = false;
+  log::Log rowsFile;
+  ASSERT_TRUE(rowsFile.SetProfile(profile));
+  ASSERT_TRUE(rowsFile.Open(":memory:", std::ios_base::out));
+  EXPECT_EQ("0.1.0", rowsFile.Version());
 }
 
 //////////////////////////////////////////////////
@@ -258,6 +814,62 @@ TEST(Log, OpenCorruptDatabase)
   EXPECT_EQ(4806000000ns, logFile.EndTime());
 }
 
+//////////////////////////////////////////////////
+TEST(Log, QueryWithoutTopicTimeIndex)
+{
+  // Log files recorded by older versions don't index the messages by topic,
+  // so the messages of the topics are selected together.
+  log::Log logFile;
+  std::string path =
+    testing::portablePathUnion(IGN_TRANSPORT_LOG_TEST_PATH, "data");
+  path = testing::portablePathUnion(path, "state.tlog");
+  ASSERT_TRUE(logFile.Open(path));
+  const log::Descriptor *descriptor = logFile.Descriptor();
+  ASSERT_NE(nullptr, descriptor);
+  EXPECT_FALSE(descriptor->IndexesTopicTime());
+
+  const std::vector<log::SqlStatement> statements =
+    log::TopicPattern(std::regex(".*")).GenerateStatements(*descriptor);
+  ASSERT_EQ(1u, statements.size());
+  EXPECT_EQ(std::string::npos, statements[0].statement.find("UNION"));
+
+  // The index is created when such a log file is opened to write to it
+  const std::string file = "LogQueryWithoutTopicTimeIndex.tlog";
+  std::remove(file.c_str());
+
+  log::LogProfile profile;
+  profile.chunked = false;
+  {
+    log::Log rowsFile;
+    ASSERT_TRUE(rowsFile.SetProfile(profile));
+    ASSERT_TRUE(rowsFile.Open(file, std::ios_base::out));
+  }
+
+  sqlite3 *db = nullptr;
+  ASSERT_EQ(SQLITE_OK, sqlite3_open(file.c_str(), &db));
+  EXPECT_EQ(SQLITE_OK, sqlite3_exec(db, "DROP INDEX idx_topic_time_recv;",
+        nullptr, nullptr, nullptr)) << sqlite3_errmsg(db);
+  sqlite3_close(db);
+
+  {
+    log::Log readFile;
+    ASSERT_TRUE(readFile.Open(file, std::ios_base::in));
+    descriptor = readFile.Descriptor();
+    ASSERT_NE(nullptr, descriptor);
+    EXPECT_FALSE(descriptor->IndexesTopicTime());
+  }
+
+  log::Log appendFile;
+  ASSERT_TRUE(appendFile.SetProfile(profile));
+  ASSERT_TRUE(appendFile.Open(file, std::ios_base::out | std::ios_base::app));
+  descriptor = appendFile.Descriptor();
+  ASSERT_NE(nullptr, descriptor);
+  EXPECT_TRUE(descriptor->IndexesTopicTime());
+  EXPECT_EQ("0.1.0", appendFile.Version());
+
+  std::remove(file.c_str());
+}
+
 
 //////////////////////////////////////////////////
 int main(int argc, char **argv)
@@ -17,7 +17,10 @@
 
 #include <sqlite3.h>
 
+#include <algorithm>
+#include <chrono>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "Console.hh"
@@ -42,6 +45,16 @@ MsgIterPrivate::MsgIterPrivate(
   PrepareNextStatement();
 }
 
+//////////////////////////////////////////////////
+MsgIterPrivate::MsgIterPrivate(
+    const std::shared_ptr<raii_sqlite3::Database> &_db,
+    const std::shared_ptr<std::vector<SqlStatement>> &_statements,
+    const QualifiedTimeRange &_range)
+  : db(_db), statements(_statements), chunked(true), range(_range)
+{
+  PrepareNextStatement();
+}
+
 //////////////////////////////////////////////////
 MsgIterPrivate::~MsgIterPrivate()
 {
@@ -105,9 +118,176 @@ bool MsgIterPrivate::PrepareNextStatement()
   return true;
 }
 
+//////////////////////////////////////////////////
+/// \brief Order chunk cursors so that std::push_heap puts the cursor with
+/// the earliest message at the front.
+/// \param[in] _a A cursor
+/// \param[in] _b Another cursor
+/// \return true if the next message of _a was received after the one of _b
+static bool LaterMessage(const std::unique_ptr<ChunkCursor> &_a,
+                         const std::unique_ptr<ChunkCursor> &_b)
+{
+  return _a->time > _b->time;
+}
+
+//////////////////////////////////////////////////
+/// \brief Check if a time comes after the beginning of a range
+/// \param[in] _time The time
+/// \param[in] _begin The beginning of the range
+/// \return true if _time is not before _begin
+static bool AfterBeginning(const std::chrono::nanoseconds &_time,
+                           const QualifiedTime &_begin)
+{
+  if (_begin.IsIndeterminate())
+    return true;
+
+  if (*_begin.GetQualifier() == QualifiedTime::Qualifier::EXCLUSIVE)
+    return _time > *_begin.GetTime();
+  return _time >= *_begin.GetTime();
+}
+
+//////////////////////////////////////////////////
+/// \brief Check if a time comes before the ending of a range
+/// \param[in] _time The time
+/// \param[in] _end The ending of the range
+/// \return true if _time is not after _end
+static bool BeforeEnding(const std::chrono::nanoseconds &_time,
+                         const QualifiedTime &_end)
+{
+  if (_end.IsIndeterminate())
+    return true;
+
+  if (*_end.GetQualifier() == QualifiedTime::Qualifier::EXCLUSIVE)
+    return _time < *_end.GetTime();
+  return _time <= *_end.GetTime();
+}
+
+//////////////////////////////////////////////////
+bool MsgIterPrivate::NextChunkMessage(ChunkCursor &_cursor) const
+{
+  while (_cursor.reader.Next(_cursor.time, _cursor.data, _cursor.len))
+  {
+    // The messages of a chunk are ordered by time, so none of the following
+    // ones is in the range either.
+    if (!BeforeEnding(_cursor.time, this->range.Ending()))
+      return false;
+
+    if (AfterBeginning(_cursor.time, this->range.Beginning()))
+      return true;
+  }
+  return false;
+}
+
+//////////////////////////////////////////////////
+void MsgIterPrivate::ReadChunk()
+{
+  // Assumes statement has column order:
+  // chunks id (0), start_time (1), topics name (2), message_types name (3),
+  // chunk data (4), compression (5), uncompressed size (6)
+  sqlite3_stmt *handle = this->statement->Handle();
+
+  std::unique_ptr<ChunkCursor> cursor(new ChunkCursor);
+  cursor->topic.assign(
+      reinterpret_cast<const char *>(sqlite3_column_text(handle, 2)),
+      sqlite3_column_bytes(handle, 2));
+  cursor->type.assign(
+      reinterpret_cast<const char *>(sqlite3_column_text(handle, 3)),
+      sqlite3_column_bytes(handle, 3));
+
+  const void *data = sqlite3_column_blob(handle, 4);
+  const std::size_t numData = sqlite3_column_bytes(handle, 4);
+  const std::string compression(
+      reinterpret_cast<const char *>(sqlite3_column_text(handle, 5)),
+      sqlite3_column_bytes(handle, 5));
+  const std::size_t size = sqlite3_column_int64(handle, 6);
+
+  if (!cursor->reader.Reset(data, numData, compression, size))
+  {
+    LERR("Failed to read chunk [" << sqlite3_column_int64(handle, 0)
+         << "]\n");
+    return;
+  }
+
+  if (this->NextChunkMessage(*cursor))
+  {
+    this->cursors.push_back(std::move(cursor));
+    std::push_heap(this->cursors.begin(), this->cursors.end(), LaterMessage);
+  }
+}
+
+//////////////////////////////////////////////////
+void MsgIterPrivate::StepChunks()
+{
+  // Put the chunk of the previous message back, if it has more messages
+  if (this->current)
+  {
+    if (this->NextChunkMessage(*this->current))
+    {
+      this->cursors.push_back(std::move(this->current));
+      std::push_heap(this->cursors.begin(), this->cursors.end(), LaterMessage);
+    }
+    this->current.reset();
+  }
+
+  while (this->statement)
+  {
+    // The chunks are ordered by start time. Read them until the next one
+    // starts after the earliest message of the chunks already read.
+    while (!this->statementDone)
+    {
+      if (!this->chunkPending)
+      {
+        const int returnCode = sqlite3_step(this->statement->Handle());
+        if (returnCode != SQLITE_ROW)
+        {
+          if (returnCode != SQLITE_DONE)
+            LERR("Failed to get chunk [" << returnCode << "]\n");
+          this->statementDone = true;
+          break;
+        }
+        this->chunkPending = true;
+      }
+
+      const std::chrono::nanoseconds startTime(
+          sqlite3_column_int64(this->statement->Handle(), 1));
+      if (!this->cursors.empty() && startTime > this->cursors.front()->time)
+        break;
+
+      this->ReadChunk();
+      this->chunkPending = false;
+    }
+
+    if (!this->cursors.empty())
+    {
+      std::pop_heap(this->cursors.begin(), this->cursors.end(), LaterMessage);
+      this->current = std::move(this->cursors.back());
+      this->cursors.pop_back();
+
+      this->message.reset(new Message(
+            this->current->time,
+            this->current->data, this->current->len,
+            this->current->type.c_str(), this->current->type.size(),
+            this->current->topic.c_str(), this->current->topic.size()));
+      return;
+    }
+
+    // Out of data
+    this->statement.reset();
+    this->statementDone = false;
+    ++this->statementIndex;
+    this->PrepareNextStatement();
+  }
+}
+
 //////////////////////////////////////////////////
 void MsgIterPrivate::StepStatement()
 {
+  if (this->chunked)
+  {
+    this->StepChunks();
+    return;
+  }
+
   if (this->statement)
   {
     // Get the results from the statement
@@ -18,11 +18,16 @@
 #ifndef IGNITION_TRANSPORT_LOG_MSGITERPRIVATE_HH_
 #define IGNITION_TRANSPORT_LOG_MSGITERPRIVATE_HH_
 
+#include <chrono>
+#include <cstddef>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "ignition/transport/log/Message.hh"
+#include "ignition/transport/log/QualifiedTime.hh"
 #include "ignition/transport/log/SqlStatement.hh"
+#include "Chunk.hh"
 #include "raii-sqlite3.hh"
 
 using namespace ignition::transport;
@@ -37,6 +42,28 @@ namespace log
 // Inline bracket to help doxygen filtering.
 inline namespace IGNITION_TRANSPORT_VERSION_NAMESPACE
 {
+  /// \brief A chunk being read, and its next message in the time range
+  struct ChunkCursor
+  {
+    /// \brief Name of the topic
+    public: std::string topic;
+
+    /// \brief Name of the message type
+    public: std::string type;
+
+    /// \brief Reads the messages of the chunk
+    public: ChunkReader reader;
+
+    /// \brief Time the next message was received
+    public: std::chrono::nanoseconds time;
+
+    /// \brief Data of the next message
+    public: const char *data = nullptr;
+
+    /// \brief Number of bytes of the next message
+    public: std::size_t len = 0;
+  };
+
   class MsgIterPrivate
   {
     /// \brief constructor
@@ -49,12 +76,33 @@ inline namespace IGNITION_TRANSPORT_VERSION_NAMESPACE
     public: MsgIterPrivate(const std::shared_ptr<raii_sqlite3::Database> &_db,
         const std::shared_ptr<std::vector<SqlStatement>> &_statements);
 
+    /// \brief constructor for log files storing messages in chunks
+    /// \param[in] _db Shared reference to a database
+    /// \param[in] _statements A set of SQL statements selecting the chunks
+    /// that this message will iterate through
+    /// \param[in] _range Time range of the messages of the chunks
+    public: MsgIterPrivate(const std::shared_ptr<raii_sqlite3::Database> &_db,
+        const std::shared_ptr<std::vector<SqlStatement>> &_statements,
+        const QualifiedTimeRange &_range);
+
     /// \brief destructor
     public: ~MsgIterPrivate();
 
     /// \brief Executes the statement once
     public: void StepStatement();
 
+    /// \brief Moves to the next message of the chunks, merging the chunks
+    /// so the messages are ordered by time received
+    public: void StepChunks();
+
+    /// \brief Reads the chunk the statement is at
+    public: void ReadChunk();
+
+    /// \brief Moves a chunk cursor to its next message in the time range
+    /// \param[in,out] _cursor The cursor
+    /// \return false if the chunk has no message left
+    public: bool NextChunkMessage(ChunkCursor &_cursor) const;
+
     /// \brief Prepares the next statement to be executed
     /// \return true if the statement was sucessfully prepared
     public: bool PrepareNextStatement();
@@ -73,6 +121,25 @@ inline namespace IGNITION_TRANSPORT_VERSION_NAMESPACE
 
     /// \brief the message this iterator is at
     public: std::unique_ptr<Message> message;
+
+    /// \brief true if the statements select chunks instead of messages
+    public: bool chunked = false;
+
+    /// \brief time range of the messages of the chunks
+    public: QualifiedTimeRange range = QualifiedTimeRange::AllTime();
+
+    /// \brief true if the statement is at a chunk which wasn't read yet
+    public: bool chunkPending = false;
+
+    /// \brief true if the statement selected all of its chunks
+    public: bool statementDone = false;
+
+    /// \brief chunks being read, as a heap ordered by the time of their
+    /// next message
+    public: std::vector<std::unique_ptr<ChunkCursor>> cursors;
+
+    /// \brief chunk holding the message this iterator is at
+    public: std::unique_ptr<ChunkCursor> current;
   };
 }
 }
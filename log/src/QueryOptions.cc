@@ -15,6 +15,7 @@
  *
 */
 
+#include <cstddef>
 #include <cstdint>
 #include <regex>
 #include <set>
@@ -53,6 +54,72 @@ static void AppendTopicListClause(
   _sql.statement += ")";
 }
 
+/// \brief Maximum number of topics whose messages are merged by a query.
+/// Each topic adds a SELECT to the query, so this stays well below the
+/// default limits of SQLite on the number of SELECTs of a compound query (500)
+/// and on the number of parameters of a statement (999).
+static constexpr std::size_t kMaxMergedTopics = 64;
+
+//////////////////////////////////////////////////
+/// \brief Append time conditions to a WHERE clause
+/// \param[in,out] _sql The SqlStatement to append the conditions to
+/// \param[in] _timeCondition The time conditions, which may be empty
+static void AppendTimeCondition(
+    SqlStatement &_sql, const SqlStatement &_timeCondition)
+{
+  if (!_timeCondition.statement.empty())
+  {
+    _sql.statement += " AND (";
+    _sql.Append(_timeCondition);
+    _sql.statement += ")";
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Generate a statement selecting the rows of a list of topics
+/// \param[in] _descriptor The descriptor of the log file
+/// \param[in] _ids The vector of Topic IDs to select
+/// \param[in] _preamble The clause preceding the WHERE keyword
+/// \param[in] _timeCondition The time conditions, which may be empty
+/// \param[in] _close The clause ordering the rows by time
+/// \return The statement
+static SqlStatement GenerateTopicListStatement(
+    const Descriptor &_descriptor, const std::vector<int64_t> &_ids,
+    const SqlStatement &_preamble, const SqlStatement &_timeCondition,
+    const SqlStatement &_close)
+{
+  SqlStatement sql;
+  if (_descriptor.IndexesTopicTime() && _ids.size() > 1 &&
+      _ids.size() <= kMaxMergedTopics)
+  {
+    // Select the rows of each topic on its own, in the order of the index by
+    // topic and time, and let SQLite merge them. Otherwise SQLite either
+    // scans the rows of every topic, or sorts the rows of the topics selected
+    // before returning the first one.
+    for (const int64_t id : _ids)
+    {
+      if (!sql.statement.empty())
+        sql.statement += " UNION ALL ";
+
+      sql.Append(_preamble);
+      sql.statement += " WHERE (topic_id = ?)";
+      sql.parameters.emplace_back(id);
+      AppendTimeCondition(sql, _timeCondition);
+    }
+  }
+  else
+  {
+    sql = _preamble;
+    sql.statement += " WHERE (";
+    AppendTopicListClause(sql, _ids);
+    sql.statement += ")";
+    AppendTimeCondition(sql, _timeCondition);
+  }
+
+  sql.Append(_close);
+  return sql;
+}
+
 //////////////////////////////////////////////////
 SqlStatement QueryOptions::StandardMessageQueryPreamble()
 {
@@ -72,13 +139,62 @@ SqlStatement QueryOptions::StandardMessageQueryClose()
   return SqlStatement{ " ORDER BY messages.time_recv;", {} };
 }
 
+//////////////////////////////////////////////////
+std::vector<SqlStatement> QueryOptions::GenerateChunkStatements(
+    const Descriptor & /*_descriptor*/) const
+{
+  // Select every chunk, so the options which only know about messages still
+  // see all of them. MsgIter filters the messages of the chunks by time.
+  SqlStatement sql = StandardChunkQueryPreamble();
+
+  const TimeRangeOption *timeOption =
+    dynamic_cast<const TimeRangeOption *>(this);
+  if (timeOption)
+  {
+    const SqlStatement &timeCondition =
+      timeOption->GenerateChunkTimeConditions();
+    if (!timeCondition.statement.empty())
+    {
+      sql.statement += "WHERE ";
+      sql.Append(timeCondition);
+    }
+  }
+
+  sql.Append(StandardChunkQueryClose());
+
+  return {sql};
+}
+
+//////////////////////////////////////////////////
+SqlStatement QueryOptions::StandardChunkQueryPreamble()
+{
+  SqlStatement sql;
+  sql.statement =
+      "SELECT chunks.id, chunks.start_time, topics.name,"
+      " message_types.name, chunks.data, chunks.compression, chunks.size"
+      " FROM chunks JOIN topics ON topics.id = chunks.topic_id"
+      " JOIN message_types ON message_types.id = topics.message_type_id ";
+
+  return sql;
+}
+
+//////////////////////////////////////////////////
+SqlStatement QueryOptions::StandardChunkQueryClose()
+{
+  return SqlStatement{ " ORDER BY chunks.start_time;", {} };
+}
+
 //////////////////////////////////////////////////
 class TimeRangeOption::Implementation
 {
   /// \brief Convert the QualifiedTimeRange into a SqlStatement clause that
   /// can be appended to the complete clause.
+  /// \param[in] _startColumn Column compared with the beginning of the range
+  /// \param[in] _finishColumn Column compared with the end of the range
   /// \return SqlStatement time range clause
-  public: SqlStatement GenerateTimeConditions() const
+  public: SqlStatement GenerateTimeConditions(
+      const std::string &_startColumn,
+      const std::string &_finishColumn) const
   {
     SqlStatement sql;
 
@@ -112,7 +228,7 @@ class TimeRangeOption::Implementation
 
     if (!startCompare.empty())
     {
-      sql.statement += "time_recv " + startCompare + " ?";
+      sql.statement += _startColumn + " " + startCompare + " ?";
       sql.parameters.emplace_back(start.GetTime()->count());
 
       if (!finishCompare.empty())
@@ -121,7 +237,7 @@ class TimeRangeOption::Implementation
 
     if (!finishCompare.empty())
     {
-      sql.statement += "time_recv " + finishCompare + " ?";
+      sql.statement += _finishColumn + " " + finishCompare + " ?";
       sql.parameters.emplace_back(finish.GetTime()->count());
     }
 
@@ -169,7 +285,15 @@ const QualifiedTimeRange &TimeRangeOption::TimeRange() const
 //////////////////////////////////////////////////
 SqlStatement TimeRangeOption::GenerateTimeConditions() const
 {
-  return this->dataPtr->GenerateTimeConditions();
+  return this->dataPtr->GenerateTimeConditions("time_recv", "time_recv");
+}
+
+//////////////////////////////////////////////////
+SqlStatement TimeRangeOption::GenerateChunkTimeConditions() const
+{
+  // A chunk overlaps the range if it ends after the range begins and begins
+  // before the range ends
+  return this->dataPtr->GenerateTimeConditions("end_time", "start_time");
 }
 
 //////////////////////////////////////////////////
@@ -181,11 +305,10 @@ TimeRangeOption::~TimeRangeOption()
 //////////////////////////////////////////////////
 class TopicList::Implementation
 {
-  /// \brief Generate a WHERE clause for topics that exist in the requested list
+  /// \brief Find the topics that exist in the requested list
   /// \param[in] _descriptor The descriptor forwarded by the interface class
-  /// \return The desired WHERE clause
-  public: SqlStatement GenerateStatement(
-    const Descriptor &_descriptor)
+  /// \return The IDs of the topics
+  public: std::vector<int64_t> TopicIds(const Descriptor &_descriptor)
   {
     const Descriptor::NameToMap &map = _descriptor.TopicsToMsgTypesToId();
     std::vector<int64_t> rowIDs;
@@ -203,12 +326,7 @@ class TopicList::Implementation
       }
     }
 
-    SqlStatement sql = QueryOptions::StandardMessageQueryPreamble();
-    sql.statement += " WHERE (";
-    AppendTopicListClause(sql, rowIDs);
-    sql.statement += ")";
-
-    return sql;
+    return rowIDs;
   }
 
   /// \brief Topics for this option
@@ -266,20 +384,22 @@ const std::set<std::string> &TopicList::Topics() const
 std::vector<SqlStatement> TopicList::GenerateStatements(
     const Descriptor &_descriptor) const
 {
-  SqlStatement sql = this->dataPtr->GenerateStatement(_descriptor);
-
-  // Add the time range condition
-  const SqlStatement &timeCondition = this->GenerateTimeConditions();
-  if (!timeCondition.statement.empty())
-  {
-    sql.statement += " AND (";
-    sql.Append(timeCondition);
-    sql.statement += ")";
-  }
-
-  sql.Append(QueryOptions::StandardMessageQueryClose());
+  return {GenerateTopicListStatement(_descriptor,
+      this->dataPtr->TopicIds(_descriptor),
+      QueryOptions::StandardMessageQueryPreamble(),
+      this->GenerateTimeConditions(),
+      QueryOptions::StandardMessageQueryClose())};
+}
 
-  return {sql};
+//////////////////////////////////////////////////
+std::vector<SqlStatement> TopicList::GenerateChunkStatements(
+    const Descriptor &_descriptor) const
+{
+  return {GenerateTopicListStatement(_descriptor,
+      this->dataPtr->TopicIds(_descriptor),
+      QueryOptions::StandardChunkQueryPreamble(),
+      this->GenerateChunkTimeConditions(),
+      QueryOptions::StandardChunkQueryClose())};
 }
 
 //////////////////////////////////////////////////
@@ -291,11 +411,10 @@ TopicList::~TopicList()
 //////////////////////////////////////////////////
 class TopicPattern::Implementation
 {
-  /// \brief Generate a WHERE clause for topics that match the requested pattern
+  /// \brief Find the topics that match the requested pattern
   /// \param[in] _descriptor The descriptor forwarded by the interface class
-  /// \return The desired WHERE clause
-  public: SqlStatement GenerateStatement(
-      const Descriptor &_descriptor)
+  /// \return The IDs of the topics
+  public: std::vector<int64_t> TopicIds(const Descriptor &_descriptor)
   {
     const Descriptor::NameToMap &map = _descriptor.TopicsToMsgTypesToId();
     std::vector<int64_t> rowIDs;
@@ -315,12 +434,7 @@ class TopicPattern::Implementation
       }
     }
 
-    SqlStatement sql = QueryOptions::StandardMessageQueryPreamble();
-    sql.statement += " WHERE (";
-    AppendTopicListClause(sql, rowIDs);
-    sql.statement += ")";
-
-    return sql;
+    return rowIDs;
   }
 
   /// \brief Pattern for this option
@@ -370,20 +484,22 @@ const std::regex &TopicPattern::Pattern() const
 std::vector<SqlStatement> TopicPattern::GenerateStatements(
     const Descriptor &_descriptor) const
 {
-  SqlStatement sql = this->dataPtr->GenerateStatement(_descriptor);
-
-  // Add the time range condition
-  const SqlStatement &timeCondition = this->GenerateTimeConditions();
-  if (!timeCondition.statement.empty())
-  {
-    sql.statement += " AND (";
-    sql.Append(timeCondition);
-    sql.statement += ")";
-  }
-
-  sql.Append(QueryOptions::StandardMessageQueryClose());
+  return {GenerateTopicListStatement(_descriptor,
+      this->dataPtr->TopicIds(_descriptor),
+      QueryOptions::StandardMessageQueryPreamble(),
+      this->GenerateTimeConditions(),
+      QueryOptions::StandardMessageQueryClose())};
+}
 
-  return {sql};
+//////////////////////////////////////////////////
+std::vector<SqlStatement> TopicPattern::GenerateChunkStatements(
+    const Descriptor &_descriptor) const
+{
+  return {GenerateTopicListStatement(_descriptor,
+      this->dataPtr->TopicIds(_descriptor),
+      QueryOptions::StandardChunkQueryPreamble(),
+      this->GenerateChunkTimeConditions(),
+      QueryOptions::StandardChunkQueryClose())};
 }
 
 //////////////////////////////////////////////////
@@ -439,6 +555,24 @@ std::vector<SqlStatement> AllTopics::GenerateStatements(
   return {sql};
 }
 
+//////////////////////////////////////////////////
+std::vector<SqlStatement> AllTopics::GenerateChunkStatements(
+    const Descriptor & /*_descriptor*/) const
+{
+  SqlStatement sql = this->StandardChunkQueryPreamble();
+
+  const SqlStatement &timeCondition = this->GenerateChunkTimeConditions();
+  if (!timeCondition.statement.empty())
+  {
+    sql.statement += "WHERE ";
+    sql.Append(timeCondition);
+  }
+
+  sql.Append(this->StandardChunkQueryClose());
+
+  return {sql};
+}
+
 //////////////////////////////////////////////////
 AllTopics::~AllTopics()
 {
@@ -22,6 +22,7 @@
 
 #include "ignition/transport/log/QualifiedTime.hh"
 #include "ignition/transport/log/QueryOptions.hh"
+#include "ignition/transport/log/SqlStatement.hh"
 #include "gtest/gtest.h"
 
 using namespace ignition::transport;
@@ -48,6 +49,28 @@ TEST(QueryOptionsTimeRange, GetRangeConst)
   EXPECT_EQ(range, constRangeOption.TimeRange());
 }
 
+//////////////////////////////////////////////////
+TEST(QueryOptionsTimeRange, ChunkTimeConditions)
+{
+  // A chunk overlaps the range if it ends after the range begins and begins
+  // before the range ends
+  log::QualifiedTime beginTime(1s, log::QualifiedTime::Qualifier::INCLUSIVE);
+  log::QualifiedTime endTime(2s, log::QualifiedTime::Qualifier::EXCLUSIVE);
+  log::TimeRangeOption rangeOption(log::QualifiedTimeRange(beginTime, endTime));
+
+  log::SqlStatement sql = rangeOption.GenerateChunkTimeConditions();
+  EXPECT_EQ("end_time >= ? AND start_time < ?", sql.statement);
+  ASSERT_EQ(2u, sql.parameters.size());
+  EXPECT_EQ(1000000000, *sql.parameters[0].QueryInteger());
+  EXPECT_EQ(2000000000, *sql.parameters[1].QueryInteger());
+
+  sql = rangeOption.GenerateTimeConditions();
+  EXPECT_EQ("time_recv >= ? AND time_recv < ?", sql.statement);
+
+  log::TimeRangeOption allTime(log::QualifiedTimeRange::AllTime());
+  EXPECT_TRUE(allTime.GenerateChunkTimeConditions().statement.empty());
+}
+
 //////////////////////////////////////////////////
 TEST(QueryOptionsTopicList, TopicList)
 {
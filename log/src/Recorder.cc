@@ -22,6 +22,9 @@
 #include <mutex>
 #include <regex>
 #include <set>
+#include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
 #include <ignition/transport/Clock.hh>
@@ -33,6 +36,7 @@
 #include <ignition/transport/TransportTypes.hh>
 
 #include "Console.hh"
+#include "RecorderBuffer.hh"
 #include "raii-sqlite3.hh"
 #include "build_config.hh"
 
@@ -54,6 +58,10 @@ class ignition::transport::log::Recorder::Implementation
           std::size_t _len,
           const transport::MessageInfo &_info);
 
+  /// \brief Write the messages buffered into the log file, until the
+  /// buffer is closed and empty. It runs in writerThread.
+  public: void WriteMessages();
+
   /// \brief Callback that listens for newly advertised topics
   /// \param[in] _publisher The Publisher that has advertised
   public: void OnAdvertisement(const Publisher &_publisher);
@@ -67,6 +75,9 @@ class ignition::transport::log::Recorder::Implementation
   /// \brief log file or nullptr if not recording
   public: std::unique_ptr<Log> logFile;
 
+  /// \brief SQLite settings used to write the log file
+  public: LogProfile profile;
+
   /// \brief A set of topic patterns that we want to subscribe to
   public: std::vector<std::regex> patterns;
 
@@ -81,6 +92,13 @@ class ignition::transport::log::Recorder::Implementation
   /// \brief mutex for thread safety with log file
   public: std::mutex logFileMutex;
 
+  /// \brief Messages received and not written into the log file yet.
+  public: RecorderBuffer buffer;
+
+  /// \brief Thread writing the messages buffered into the log file while
+  /// recording.
+  public: std::thread writerThread;
+
   /// \brief node used to create subscriptions
   public: Node node;
 
@@ -130,19 +148,26 @@ void Recorder::Implementation::OnMessageReceived(
     LWRN("Clock isn't ready yet. Dropping message\n");
   }
 
-  std::lock_guard<std::mutex> lock(this->logFileMutex);
-
-  // Note: this->logFile will only be a nullptr before Start() has been called
-  // or after Stop() has been called. If it is a nullptr, then we are not
-  // recording anything yet, so we can just skip inserting the message.
-  if (this->logFile && !this->logFile->InsertMessage(
-        this->clock->Time(),
-        _info.Topic(),
-        _info.Type(),
-        reinterpret_cast<const void *>(_data),
-        _len))
+  // Note: the buffer is only open between Start() and Stop(). If it is
+  // closed, then we are not recording anything, so the message is skipped.
+  // The writer thread inserts it into the log file later.
+  this->buffer.Push(RecordedMessage{this->clock->Time(), _info.Topic(),
+    _info.Type(), std::string(_data, _len)});
+}
+
+//////////////////////////////////////////////////
+void Recorder::Implementation::WriteMessages()
+{
+  std::vector<RecordedMessage> msgs;
+  while (this->buffer.PopAll(msgs))
   {
-    LWRN("Failed to insert message into log file\n");
+    std::lock_guard<std::mutex> lock(this->logFileMutex);
+    const std::size_t inserted = this->logFile->InsertMessages(msgs);
+    if (inserted < msgs.size())
+    {
+      LWRN("Failed to insert " << msgs.size() - inserted << " of "
+           << msgs.size() << " messages into log file\n");
+    }
   }
 }
 
@@ -271,6 +296,7 @@ RecorderError Recorder::Start(const std::string &_file)
   }
 
   this->dataPtr->logFile.reset(new Log());
+  this->dataPtr->logFile->SetProfile(this->dataPtr->profile);
   if (!this->dataPtr->logFile->Open(_file, std::ios_base::out))
   {
     LERR("Failed to open or create file [" << _file << "]\n");
@@ -278,6 +304,10 @@ RecorderError Recorder::Start(const std::string &_file)
     return RecorderError::FAILED_TO_OPEN;
   }
 
+  this->dataPtr->buffer.Open();
+  this->dataPtr->writerThread =
+    std::thread(&Implementation::WriteMessages, this->dataPtr.get());
+
   LMSG("Started recording to [" << _file << "]\n");
 
   return RecorderError::SUCCESS;
@@ -286,6 +316,11 @@ RecorderError Recorder::Start(const std::string &_file)
 //////////////////////////////////////////////////
 void Recorder::Stop()
 {
+  // The writer thread finishes once the messages left are written.
+  this->dataPtr->buffer.Close();
+  if (this->dataPtr->writerThread.joinable())
+    this->dataPtr->writerThread.join();
+
   std::lock_guard<std::mutex> lock(this->dataPtr->logFileMutex);
   this->dataPtr->logFile.reset(nullptr);
 }
@@ -302,6 +337,59 @@ int64_t Recorder::AddTopic(const std::regex &_topic)
   return this->dataPtr->AddTopic(_topic);
 }
 
+//////////////////////////////////////////////////
+void Recorder::SetBufferSize(const std::size_t _bytes)
+{
+  this->dataPtr->buffer.SetCapacity(_bytes);
+}
+
+//////////////////////////////////////////////////
+std::size_t Recorder::BufferSize() const
+{
+  return this->dataPtr->buffer.Capacity();
+}
+
+//////////////////////////////////////////////////
+void Recorder::SetBufferPolicy(const RecorderBufferPolicy _policy)
+{
+  this->dataPtr->buffer.SetPolicy(_policy);
+}
+
+//////////////////////////////////////////////////
+RecorderBufferPolicy Recorder::BufferPolicy() const
+{
+  return this->dataPtr->buffer.Policy();
+}
+
+//////////////////////////////////////////////////
+void Recorder::BufferStats(std::size_t &_depth, std::size_t &_bytes,
+    uint64_t &_dropped) const
+{
+  this->dataPtr->buffer.Stats(_depth, _bytes, _dropped);
+}
+
+//////////////////////////////////////////////////
+bool Recorder::SetProfile(const LogProfile &_profile)
+{
+  if (!_profile.Valid())
+  {
+    LERR("Invalid log profile\n");
+    return false;
+  }
+
+  std::lock_guard<std::mutex> lock(this->dataPtr->logFileMutex);
+  this->dataPtr->profile = _profile;
+  return !this->dataPtr->logFile ||
+    this->dataPtr->logFile->SetProfile(_profile);
+}
+
+//////////////////////////////////////////////////
+LogProfile Recorder::Profile() const
+{
+  std::lock_guard<std::mutex> lock(this->dataPtr->logFileMutex);
+  return this->dataPtr->profile;
+}
+
 //////////////////////////////////////////////////
 std::string Recorder::Filename() const
 {
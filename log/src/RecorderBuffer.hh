@@ -0,0 +1,231 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef IGNITION_TRANSPORT_LOG_SRC_RECORDERBUFFER_HH_
+#define IGNITION_TRANSPORT_LOG_SRC_RECORDERBUFFER_HH_
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iterator>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <ignition/transport/config.hh>
+#include <ignition/transport/log/Log.hh>
+#include <ignition/transport/log/Recorder.hh>
+
+namespace ignition
+{
+  namespace transport
+  {
+    namespace log
+    {
+      // Inline bracket to help doxygen filtering.
+      inline namespace IGNITION_TRANSPORT_VERSION_NAMESPACE {
+      //
+      /// \brief Buffer where the subscription callbacks of the recorder
+      /// leave the messages received, and from which the writer thread takes
+      /// them in batches. Its capacity is a number of bytes. An open buffer
+      /// accepts messages; a closed one only lets the writer take the
+      /// messages left. All the functions are thread safe.
+      class RecorderBuffer
+      {
+        /// \brief Set the capacity.
+        /// \param[in] _bytes Maximum number of bytes of the messages held.
+        public: void SetCapacity(const std::size_t _bytes)
+        {
+          std::lock_guard<std::mutex> lock(this->mutex);
+          this->capacity = _bytes;
+          this->notFull.notify_all();
+        }
+
+        /// \brief Get the capacity.
+        /// \return Maximum number of bytes of the messages held.
+        public: std::size_t Capacity() const
+        {
+          std::lock_guard<std::mutex> lock(this->mutex);
+          return this->capacity;
+        }
+
+        /// \brief Set what to do with a message when the buffer is full.
+        /// \param[in] _policy The policy.
+        public: void SetPolicy(const RecorderBufferPolicy _policy)
+        {
+          std::lock_guard<std::mutex> lock(this->mutex);
+          this->policy = _policy;
+          this->notFull.notify_all();
+        }
+
+        /// \brief Get what to do with a message when the buffer is full.
+        /// \return The policy.
+        public: RecorderBufferPolicy Policy() const
+        {
+          std::lock_guard<std::mutex> lock(this->mutex);
+          return this->policy;
+        }
+
+        /// \brief Start accepting messages.
+        public: void Open()
+        {
+          std::lock_guard<std::mutex> lock(this->mutex);
+          this->closed = false;
+        }
+
+        /// \brief Stop accepting messages, and wake up the threads waiting.
+        public: void Close()
+        {
+          std::lock_guard<std::mutex> lock(this->mutex);
+          this->closed = true;
+          this->notFull.notify_all();
+          this->notEmpty.notify_all();
+        }
+
+        /// \brief Add a message. If there isn't room for it, the policy is
+        /// applied. A message larger than the capacity is only accepted when
+        /// the buffer is empty.
+        /// \param[in] _msg The message.
+        /// \return True if the message was added, false if the buffer is
+        /// closed or the message was dropped.
+        public: bool Push(RecordedMessage &&_msg)
+        {
+          const std::size_t size = Size(_msg);
+
+          std::unique_lock<std::mutex> lock(this->mutex);
+          while (!this->closed && !this->Fits(size))
+          {
+            if (this->policy == RecorderBufferPolicy::DROP_NEWEST)
+            {
+              ++this->dropped;
+              return false;
+            }
+            else if (this->policy == RecorderBufferPolicy::DROP_OLDEST)
+            {
+              this->bytes -= Size(this->msgs.front());
+              this->msgs.pop_front();
+              ++this->dropped;
+            }
+            else
+            {
+              this->notFull.wait(lock);
+            }
+          }
+
+          if (this->closed)
+            return false;
+
+          this->bytes += size;
+          this->msgs.push_back(std::move(_msg));
+          this->notEmpty.notify_one();
+          return true;
+        }
+
+        /// \brief Take all the messages held, waiting for one if there isn't
+        /// any.
+        /// \param[out] _msgs The messages, oldest first.
+        /// \return False if there isn't any message left and the buffer is
+        /// closed.
+        public: bool PopAll(std::vector<RecordedMessage> &_msgs)
+        {
+          _msgs.clear();
+
+          std::unique_lock<std::mutex> lock(this->mutex);
+          this->notEmpty.wait(lock, [this]
+          {
+            return !this->msgs.empty() || this->closed;
+          });
+
+          if (this->msgs.empty())
+            return false;
+
+          _msgs.reserve(this->msgs.size());
+          std::move(this->msgs.begin(), this->msgs.end(),
+            std::back_inserter(_msgs));
+          this->msgs.clear();
+          this->bytes = 0;
+          this->notFull.notify_all();
+          return true;
+        }
+
+        /// \brief Get the statistics of the buffer.
+        /// \param[out] _depth Number of messages held.
+        /// \param[out] _bytes Number of bytes of the messages held.
+        /// \param[out] _dropped Number of messages dropped because the
+        /// buffer was full.
+        public: void Stats(std::size_t &_depth, std::size_t &_bytes,
+                           uint64_t &_dropped) const
+        {
+          std::lock_guard<std::mutex> lock(this->mutex);
+          _depth = this->msgs.size();
+          _bytes = this->bytes;
+          _dropped = this->dropped;
+        }
+
+        /// \brief Number of bytes that a message takes in the buffer.
+        /// \param[in] _msg The message.
+        /// \return The number of bytes.
+        private: static std::size_t Size(const RecordedMessage &_msg)
+        {
+          return sizeof(RecordedMessage) + _msg.topic.size() +
+            _msg.type.size() + _msg.data.size();
+        }
+
+        /// \brief Whether there is room for a message. The mutex has to be
+        /// locked.
+        /// \param[in] _size Number of bytes of the message.
+        /// \return True if the message fits.
+        private: bool Fits(const std::size_t _size) const
+        {
+          return this->msgs.empty() || this->bytes + _size <= this->capacity;
+        }
+
+        /// \brief Protects all the members.
+        private: mutable std::mutex mutex;
+
+        /// \brief Notified when messages are taken.
+        private: std::condition_variable notFull;
+
+        /// \brief Notified when a message is added.
+        private: std::condition_variable notEmpty;
+
+        /// \brief The messages, oldest first.
+        private: std::deque<RecordedMessage> msgs;
+
+        /// \brief Number of bytes of the messages held.
+        private: std::size_t bytes = 0;
+
+        /// \brief Maximum number of bytes of the messages held.
+        private: std::size_t capacity = kDefaultRecorderBufferSize;
+
+        /// \brief What to do with a message when the buffer is full.
+        private: RecorderBufferPolicy policy = RecorderBufferPolicy::BLOCK;
+
+        /// \brief Number of messages dropped because the buffer was full.
+        private: uint64_t dropped = 0;
+
+        /// \brief Whether the buffer stopped accepting messages.
+        private: bool closed = true;
+      };
+      }
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,193 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "RecorderBuffer.hh"
+#include "gtest/gtest.h"
+
+using namespace ignition;
+using namespace transport;
+using namespace log;
+
+//////////////////////////////////////////////////
+/// \brief Create a message.
+/// \param[in] _id Identifier stored as the data of the message.
+/// \return The message.
+static RecordedMessage makeMsg(const int _id)
+{
+  return RecordedMessage{std::chrono::nanoseconds(_id), "/foo",
+    "ignition.msgs.StringMsg", std::to_string(_id)};
+}
+
+//////////////////////////////////////////////////
+/// \brief Fill a buffer with room for three messages, push a fourth one and
+/// take all of them.
+/// \param[in] _policy The policy of the buffer.
+/// \param[out] _msgs The messages taken.
+/// \return The number of messages dropped.
+static uint64_t overflow(const RecorderBufferPolicy _policy,
+                         std::vector<RecordedMessage> &_msgs)
+{
+  RecorderBuffer buffer;
+  buffer.SetPolicy(_policy);
+  buffer.Open();
+
+  EXPECT_TRUE(buffer.Push(makeMsg(0)));
+  std::size_t depth;
+  std::size_t bytes;
+  uint64_t dropped;
+  buffer.Stats(depth, bytes, dropped);
+  buffer.SetCapacity(3 * bytes);
+
+  EXPECT_TRUE(buffer.Push(makeMsg(1)));
+  EXPECT_TRUE(buffer.Push(makeMsg(2)));
+  buffer.Push(makeMsg(3));
+
+  EXPECT_TRUE(buffer.PopAll(_msgs));
+  buffer.Stats(depth, bytes, dropped);
+  EXPECT_EQ(depth, 0u);
+  EXPECT_EQ(bytes, 0u);
+  return dropped;
+}
+
+//////////////////////////////////////////////////
+TEST(RecorderBufferTest, OpenClose)
+{
+  RecorderBuffer buffer;
+  EXPECT_EQ(buffer.Capacity(), kDefaultRecorderBufferSize);
+  EXPECT_EQ(buffer.Policy(), RecorderBufferPolicy::BLOCK);
+
+  // Closed until opened.
+  EXPECT_FALSE(buffer.Push(makeMsg(0)));
+
+  buffer.Open();
+  EXPECT_TRUE(buffer.Push(makeMsg(1)));
+  EXPECT_TRUE(buffer.Push(makeMsg(2)));
+  buffer.Close();
+  EXPECT_FALSE(buffer.Push(makeMsg(3)));
+
+  // The messages left can still be taken.
+  std::vector<RecordedMessage> msgs;
+  EXPECT_TRUE(buffer.PopAll(msgs));
+  ASSERT_EQ(msgs.size(), 2u);
+  EXPECT_EQ(msgs[0].data, "1");
+  EXPECT_EQ(msgs[1].data, "2");
+  EXPECT_FALSE(buffer.PopAll(msgs));
+  EXPECT_TRUE(msgs.empty());
+
+  std::size_t depth;
+  std::size_t bytes;
+  uint64_t dropped;
+  buffer.Stats(depth, bytes, dropped);
+  EXPECT_EQ(dropped, 0u);
+}
+
+//////////////////////////////////////////////////
+TEST(RecorderBufferTest, DropNewest)
+{
+  std::vector<RecordedMessage> msgs;
+  EXPECT_EQ(overflow(RecorderBufferPolicy::DROP_NEWEST, msgs), 1u);
+  ASSERT_EQ(msgs.size(), 3u);
+  EXPECT_EQ(msgs.front().data, "0");
+  EXPECT_EQ(msgs.back().data, "2");
+}
+
+//////////////////////////////////////////////////
+TEST(RecorderBufferTest, DropOldest)
+{
+  std::vector<RecordedMessage> msgs;
+  EXPECT_EQ(overflow(RecorderBufferPolicy::DROP_OLDEST, msgs), 1u);
+  ASSERT_EQ(msgs.size(), 3u);
+  EXPECT_EQ(msgs.front().data, "1");
+  EXPECT_EQ(msgs.back().data, "3");
+}
+
+//////////////////////////////////////////////////
+TEST(RecorderBufferTest, Block)
+{
+  RecorderBuffer buffer;
+  buffer.Open();
+  EXPECT_TRUE(buffer.Push(makeMsg(0)));
+
+  // There is only room for one message.
+  std::size_t depth;
+  std::size_t bytes;
+  uint64_t dropped;
+  buffer.Stats(depth, bytes, dropped);
+  buffer.SetCapacity(bytes);
+
+  // The producer waits until the consumer takes the first message.
+  std::thread producer([&buffer]
+  {
+    EXPECT_TRUE(buffer.Push(makeMsg(1)));
+  });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  std::vector<RecordedMessage> msgs;
+  EXPECT_TRUE(buffer.PopAll(msgs));
+  ASSERT_EQ(msgs.size(), 1u);
+  EXPECT_EQ(msgs[0].data, "0");
+
+  producer.join();
+  EXPECT_TRUE(buffer.PopAll(msgs));
+  ASSERT_EQ(msgs.size(), 1u);
+  EXPECT_EQ(msgs[0].data, "1");
+
+  // Closing releases a blocked producer.
+  EXPECT_TRUE(buffer.Push(makeMsg(2)));
+  std::thread blocked([&buffer]
+  {
+    EXPECT_FALSE(buffer.Push(makeMsg(3)));
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  buffer.Close();
+  blocked.join();
+
+  buffer.Stats(depth, bytes, dropped);
+  EXPECT_EQ(depth, 1u);
+  EXPECT_EQ(dropped, 0u);
+}
+
+//////////////////////////////////////////////////
+TEST(RecorderBufferTest, LargeMessage)
+{
+  RecorderBuffer buffer;
+  buffer.SetCapacity(1u);
+  buffer.SetPolicy(RecorderBufferPolicy::DROP_NEWEST);
+  buffer.Open();
+
+  // A message larger than the capacity only fits in an empty buffer.
+  EXPECT_TRUE(buffer.Push(makeMsg(0)));
+  EXPECT_FALSE(buffer.Push(makeMsg(1)));
+
+  std::vector<RecordedMessage> msgs;
+  EXPECT_TRUE(buffer.PopAll(msgs));
+  EXPECT_EQ(msgs.size(), 1u);
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -15,7 +15,10 @@
  *
 */
 
+#include <chrono>
 #include <csignal>
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
 #include <regex>
 
@@ -43,7 +46,13 @@ int verbosity(int _level)
 }
 
 //////////////////////////////////////////////////
-int recordTopics(const char *_file, const char *_pattern)
+/// \brief Record topics whose name matches the given pattern.
+/// \param[in] _file Path to the log file to record
+/// \param[in] _pattern ECMAScript regular expression to match against topics
+/// \param[in] _profile SQLite settings used to write the log file
+/// \return One of the error codes.
+static int record(const char *_file, const char *_pattern,
+    const transport::log::LogProfile &_profile)
 {
   std::regex regexPattern;
   try
@@ -58,6 +67,9 @@ int recordTopics(const char *_file, const char *_pattern)
 
   transport::log::Recorder recorder;
 
+  if (!recorder.SetProfile(_profile))
+    return INVALID_PROFILE;
+
   if (recorder.AddTopic(regexPattern) < 0)
     return FAILED_TO_SUBSCRIBE;
 
@@ -72,6 +84,48 @@ int recordTopics(const char *_file, const char *_pattern)
   return SUCCESS;
 }
 
+//////////////////////////////////////////////////
+int recordTopics(const char *_file, const char *_pattern)
+{
+  return record(_file, _pattern, transport::log::LogProfile());
+}
+
+//////////////////////////////////////////////////
+int recordTopicsWithProfile(const char *_file, const char *_pattern,
+    int _wal, int _synchronous, int _pageSize, int _cacheSize,
+    int _mmapSize, int _transactionPeriod, int _transactionRows)
+{
+  transport::log::LogProfile profile;
+  profile.wal = _wal > 0;
+  switch (_synchronous)
+  {
+    case 0:
+      profile.synchronous = transport::log::LogSynchronous::OFF;
+      break;
+    case 1:
+      profile.synchronous = transport::log::LogSynchronous::NORMAL;
+      break;
+    case 2:
+      profile.synchronous = transport::log::LogSynchronous::FULL;
+      break;
+    default:
+      LERR("Invalid synchronous mode [" << _synchronous << "]\n");
+      return INVALID_PROFILE;
+  }
+  if (_transactionRows < 0)
+  {
+    LERR("Invalid number of messages per transaction\n");
+    return INVALID_PROFILE;
+  }
+  profile.pageSize = _pageSize;
+  profile.cacheSize = _cacheSize;
+  profile.mmapSize = static_cast<int64_t>(_mmapSize) * 1024 * 1024;
+  profile.transactionPeriod = std::chrono::milliseconds(_transactionPeriod);
+  profile.transactionRows = static_cast<std::size_t>(_transactionRows);
+
+  return record(_file, _pattern, profile);
+}
+
 //////////////////////////////////////////////////
 void playbackSignHandler(int) // NOLINT
 {
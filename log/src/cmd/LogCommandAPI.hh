@@ -27,6 +27,7 @@ extern "C"
     FAILED_TO_SUBSCRIBE = 4,
     INVALID_VERSION     = 5,
     INVALID_REMAP       = 6,
+    INVALID_PROFILE     = 7,
   };
 
   /// \brief Sets verbosity of library
@@ -40,6 +41,31 @@ extern "C"
     const char *_file,
     const char *_pattern);
 
+  /// \brief Record topics whose name matches the given pattern, with the
+  /// given SQLite settings
+  /// \param[in] _file Path to the log file to record
+  /// \param[in] _pattern ECMAScript regular expression to match against topics
+  /// \param[in] _wal Set to > 0 to use a write-ahead log journal.
+  /// \param[in] _synchronous 0 (OFF), 1 (NORMAL) or 2 (FULL).
+  /// \param[in] _pageSize Page size (bytes), 0 for the SQLite default.
+  /// \param[in] _cacheSize Page cache size (KiB), 0 for the SQLite default.
+  /// \param[in] _mmapSize Size of the memory mapping (MiB), 0 to disable it.
+  /// \param[in] _transactionPeriod Maximum duration of a transaction
+  /// (milliseconds).
+  /// \param[in] _transactionRows Maximum number of messages per transaction,
+  /// 0 for no limit.
+  /// \sa ignition::transport::log::LogProfile
+  int IGNITION_TRANSPORT_LOG_VISIBLE recordTopicsWithProfile(
+    const char *_file,
+    const char *_pattern,
+    int _wal,
+    int _synchronous,
+    int _pageSize,
+    int _cacheSize,
+    int _mmapSize,
+    int _transactionPeriod,
+    int _transactionRows);
+
   /// \brief Playback topics whose name matches the given pattern
   /// \param[in] _file Path to the log file to playback
   /// \param[in] _pattern ECMAScript regular expression to match against topics
@@ -15,6 +15,7 @@
  *
 */
 
+#include <algorithm>
 #include <cstdint>
 #include <cstring>
 #include <iostream>
@@ -68,6 +69,10 @@ namespace ignition
 
       /// \brief Destructor.
       public: virtual ~AdvertiseServiceOptionsPrivate() = default;
+
+      /// \brief Maximum number of concurrent requests. 0 runs them on the
+      /// reception thread.
+      public: unsigned int maxConcurrency = 0;
     };
     }
   }
@@ -323,6 +328,7 @@ AdvertiseServiceOptions &AdvertiseServiceOptions::operator=(
   const AdvertiseServiceOptions &_other)
 {
   AdvertiseOptions::operator=(_other);
+  this->SetMaxConcurrency(_other.MaxConcurrency());
   return *this;
 }
 
@@ -330,7 +336,8 @@ AdvertiseServiceOptions &AdvertiseServiceOptions::operator=(
 bool AdvertiseServiceOptions::operator==(
   const AdvertiseServiceOptions &_other) const
 {
-  return AdvertiseOptions::operator==(_other);
+  return AdvertiseOptions::operator==(_other) &&
+         this->MaxConcurrency() == _other.MaxConcurrency();
 }
 
 //////////////////////////////////////////////////
@@ -340,6 +347,20 @@ bool AdvertiseServiceOptions::operator!=(
   return !(*this == _other);
 }
 
+//////////////////////////////////////////////////
+unsigned int AdvertiseServiceOptions::MaxConcurrency() const
+{
+  return this->dataPtr->maxConcurrency;
+}
+
+//////////////////////////////////////////////////
+void AdvertiseServiceOptions::SetMaxConcurrency(
+  const unsigned int _maxConcurrency)
+{
+  this->dataPtr->maxConcurrency =
+    std::min(_maxConcurrency, kMaxConcurrency);
+}
+
 #ifndef _WIN32
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wdeprecated-declarations"
@@ -16,6 +16,7 @@
 */
 
 #include <iostream>
+#include <limits>
 #include <string>
 #include <vector>
 
@@ -261,6 +262,7 @@ TEST(AdvertiseOptionsTest, srvDefConstructor)
 {
   AdvertiseServiceOptions opts;
   EXPECT_EQ(opts.Scope(), Scope_t::ALL);
+  EXPECT_EQ(0u, opts.MaxConcurrency());
 }
 
 //////////////////////////////////////////////////
@@ -269,6 +271,7 @@ TEST(AdvertiseOptionsTest, srvCopyConstructor)
 {
   AdvertiseServiceOptions opts1;
   opts1.SetScope(Scope_t::HOST);
+  opts1.SetMaxConcurrency(4u);
   AdvertiseServiceOptions opts2(opts1);
   EXPECT_EQ(opts1, opts2);
 }
@@ -296,6 +299,10 @@ TEST(AdvertiseOptionsTest, srvEqualityOp)
   opts2.SetScope(Scope_t::PROCESS);
   EXPECT_TRUE(opts1 == opts2);
   EXPECT_FALSE(opts1 != opts2);
+  opts1.SetMaxConcurrency(2u);
+  EXPECT_FALSE(opts1 == opts2);
+  opts2.SetMaxConcurrency(2u);
+  EXPECT_TRUE(opts1 == opts2);
 }
 
 //////////////////////////////////////////////////
@@ -309,6 +316,15 @@ TEST(AdvertiseOptionsTest, srvStreamInsertion)
     "Advertise options:\n"
     "\tScope: All\n";
   EXPECT_EQ(output.str(), expectedOutput);
+
+  opts.SetMaxConcurrency(3u);
+  output.str("");
+  output << opts;
+  expectedOutput =
+    "Advertise options:\n"
+    "\tScope: All\n"
+    "\tMax concurrency: 3\n";
+  EXPECT_EQ(output.str(), expectedOutput);
 }
 
 //////////////////////////////////////////////////
@@ -320,6 +336,19 @@ TEST(AdvertiseOptionsTest, srvAccessors)
   EXPECT_EQ(opts.Scope(), Scope_t::ALL);
   opts.SetScope(Scope_t::HOST);
   EXPECT_EQ(opts.Scope(), Scope_t::HOST);
+
+  // Max concurrency.
+  EXPECT_EQ(0u, opts.MaxConcurrency());
+  opts.SetMaxConcurrency(8u);
+  EXPECT_EQ(8u, opts.MaxConcurrency());
+  opts.SetMaxConcurrency(AdvertiseServiceOptions::kMaxConcurrency);
+  EXPECT_EQ(AdvertiseServiceOptions::kMaxConcurrency, opts.MaxConcurrency());
+
+  // The maximum concurrency is bounded.
+  opts.SetMaxConcurrency(AdvertiseServiceOptions::kMaxConcurrency + 1);
+  EXPECT_EQ(AdvertiseServiceOptions::kMaxConcurrency, opts.MaxConcurrency());
+  opts.SetMaxConcurrency(std::numeric_limits<unsigned int>::max());
+  EXPECT_EQ(AdvertiseServiceOptions::kMaxConcurrency, opts.MaxConcurrency());
 }
 
 //////////////////////////////////////////////////
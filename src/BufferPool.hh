@@ -0,0 +1,229 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef IGN_TRANSPORT_BUFFERPOOL_HH_
+#define IGN_TRANSPORT_BUFFERPOOL_HH_
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "ignition/transport/config.hh"
+
+namespace ignition
+{
+  namespace transport
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_TRANSPORT_VERSION_NAMESPACE {
+    //
+    /// \class BufferPool BufferPool.hh
+    /// \brief Pool of reusable buffers used to store serialized messages.
+    /// Buffers are grouped by capacity (powers of two) and handed out as
+    /// shared pointers that return the memory to the pool once the last
+    /// reference (ZeroMQ, a raw handler or the user) is released. The idle
+    /// buffers are limited in number per capacity and in total size, so a
+    /// burst of large messages doesn't keep its memory allocated.
+    class BufferPool : public std::enable_shared_from_this<BufferPool>
+    {
+      /// \brief Deleter that returns a buffer to its pool. If the pool
+      /// does not exist anymore, the buffer is deallocated.
+      public: struct Deleter
+              {
+                /// \brief Pool that owns the buffer.
+                public: std::weak_ptr<BufferPool> pool;
+
+                /// \brief Capacity of the buffer (bytes).
+                public: std::size_t capacity = 0;
+
+                /// \brief Return the buffer to the pool.
+                /// \param[in] _buffer The buffer.
+                public: void operator()(char *_buffer) const
+                {
+                  auto owner = this->pool.lock();
+                  if (owner)
+                    owner->Release(_buffer, this->capacity);
+                  else
+                    delete[] _buffer;
+                }
+              };
+
+      /// \brief Constructor.
+      /// \param[in] _maxIdleBytes Maximum total capacity of the idle
+      /// buffers (bytes).
+      public: explicit BufferPool(
+                  const std::size_t _maxIdleBytes = kDefaultMaxIdleBytes)
+        : maxIdleBytes(_maxIdleBytes)
+      {
+      }
+
+      /// \brief Destructor.
+      public: ~BufferPool()
+      {
+        for (auto &bucket : this->idle)
+        {
+          for (char *buffer : bucket.second)
+            delete[] buffer;
+        }
+      }
+
+      /// \brief Get a buffer with room for at least _size bytes.
+      /// \param[in] _size Number of bytes requested.
+      /// \return The buffer.
+      public: std::shared_ptr<char> Acquire(const std::size_t _size)
+      {
+        // Round up to the next power of two, so buffers of similar sizes can
+        // be reused for each other.
+        std::size_t capacity = kMinCapacity;
+        while (capacity < _size)
+          capacity <<= 1;
+
+        char *buffer = nullptr;
+        {
+          std::lock_guard<std::mutex> lk(this->mutex);
+          auto bucket = this->idle.find(capacity);
+          if (bucket != this->idle.end() && !bucket->second.empty())
+          {
+            buffer = bucket->second.back();
+            bucket->second.pop_back();
+            this->idleBytes -= capacity;
+          }
+        }
+
+        if (!buffer)
+          buffer = new char[capacity];
+
+        Deleter deleter;
+        deleter.pool = this->weak_from_this();
+        deleter.capacity = capacity;
+        return std::shared_ptr<char>(buffer, deleter);
+      }
+
+      /// \brief Get the capacity of a buffer acquired from a BufferPool.
+      /// \param[in] _buffer The buffer.
+      /// \return The capacity in bytes or 0 if _buffer was not acquired
+      /// from a BufferPool.
+      public: static std::size_t Capacity(
+                  const std::shared_ptr<char> &_buffer)
+      {
+        const Deleter *deleter = std::get_deleter<Deleter>(_buffer);
+        if (!deleter)
+          return 0;
+
+        return deleter->capacity;
+      }
+
+      /// \brief Set the maximum total capacity of the idle buffers. Idle
+      /// buffers are released if they exceed it.
+      /// \param[in] _maxIdleBytes The maximum (bytes).
+      public: void SetMaxIdleBytes(const std::size_t _maxIdleBytes)
+      {
+        std::lock_guard<std::mutex> lk(this->mutex);
+        this->maxIdleBytes = _maxIdleBytes;
+        this->Evict(0);
+      }
+
+      /// \brief Get the maximum total capacity of the idle buffers.
+      /// \return The maximum (bytes).
+      public: std::size_t MaxIdleBytes()
+      {
+        std::lock_guard<std::mutex> lk(this->mutex);
+        return this->maxIdleBytes;
+      }
+
+      /// \brief Get the total capacity of the idle buffers.
+      /// \return The total capacity (bytes).
+      public: std::size_t IdleBytes()
+      {
+        std::lock_guard<std::mutex> lk(this->mutex);
+        return this->idleBytes;
+      }
+
+      /// \brief Return a buffer to the pool.
+      /// \param[in] _buffer The buffer.
+      /// \param[in] _capacity Capacity of the buffer (bytes).
+      private: void Release(char *_buffer, const std::size_t _capacity)
+      {
+        if (_capacity <= kMaxPooledCapacity)
+        {
+          std::lock_guard<std::mutex> lk(this->mutex);
+          auto &bucket = this->idle[_capacity];
+          if (bucket.size() < kMaxIdleBuffers &&
+              _capacity <= this->maxIdleBytes)
+          {
+            this->Evict(_capacity);
+            bucket.push_back(_buffer);
+            this->idleBytes += _capacity;
+            return;
+          }
+        }
+
+        delete[] _buffer;
+      }
+
+      /// \brief Release idle buffers, the largest first, until there is room
+      /// for a buffer. Must be called with the mutex locked.
+      /// \param[in] _capacity Capacity of the buffer (bytes).
+      private: void Evict(const std::size_t _capacity)
+      {
+        auto bucket = this->idle.rbegin();
+        while (this->idleBytes + _capacity > this->maxIdleBytes &&
+               bucket != this->idle.rend())
+        {
+          if (bucket->second.empty())
+          {
+            ++bucket;
+            continue;
+          }
+
+          delete[] bucket->second.back();
+          bucket->second.pop_back();
+          this->idleBytes -= bucket->first;
+        }
+      }
+
+      /// \brief Smallest capacity handed out (bytes).
+      public: static const std::size_t kMinCapacity = 64;
+
+      /// \brief Buffers larger than this (bytes) are not kept in the pool.
+      public: static const std::size_t kMaxPooledCapacity = 64 * 1024 * 1024;
+
+      /// \brief Maximum number of idle buffers kept per capacity.
+      public: static const std::size_t kMaxIdleBuffers = 8;
+
+      /// \brief Default maximum total capacity of the idle buffers (bytes).
+      public: static constexpr std::size_t kDefaultMaxIdleBytes =
+        4 * 1024 * 1024;
+
+      /// \brief Mutex to protect the idle buffers.
+      private: std::mutex mutex;
+
+      /// \brief Idle buffers indexed by capacity.
+      private: std::map<std::size_t, std::vector<char *>> idle;
+
+      /// \brief Total capacity of the idle buffers (bytes).
+      private: std::size_t idleBytes = 0;
+
+      /// \brief Maximum total capacity of the idle buffers (bytes).
+      private: std::size_t maxIdleBytes;
+    };
+    }
+  }
+}
+#endif
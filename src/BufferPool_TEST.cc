@@ -0,0 +1,93 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "BufferPool.hh"
+#include "gtest/gtest.h"
+
+using namespace ignition;
+using namespace transport;
+
+//////////////////////////////////////////////////
+/// \brief Check that released buffers are reused.
+TEST(BufferPoolTest, Reuse)
+{
+  auto pool = std::make_shared<BufferPool>();
+  EXPECT_EQ(BufferPool::kDefaultMaxIdleBytes, pool->MaxIdleBytes());
+
+  std::shared_ptr<char> buffer = pool->Acquire(100);
+  EXPECT_EQ(128u, BufferPool::Capacity(buffer));
+  EXPECT_EQ(0u, BufferPool::Capacity(std::shared_ptr<char>(new char[1],
+    std::default_delete<char[]>())));
+
+  char *raw = buffer.get();
+  buffer.reset();
+  EXPECT_EQ(128u, pool->IdleBytes());
+
+  buffer = pool->Acquire(128);
+  EXPECT_EQ(raw, buffer.get());
+  EXPECT_EQ(0u, pool->IdleBytes());
+
+  // Buffers outliving their pool are deallocated.
+  pool.reset();
+  buffer.reset();
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that the idle buffers don't exceed the maximum size.
+TEST(BufferPoolTest, MaxIdleBytes)
+{
+  const std::size_t kMiB = 1024 * 1024;
+  auto pool = std::make_shared<BufferPool>(4 * kMiB);
+
+  // A burst of large loans.
+  std::vector<std::shared_ptr<char>> buffers;
+  for (int i = 0; i < 3; ++i)
+    buffers.push_back(pool->Acquire(2 * kMiB));
+  buffers.push_back(pool->Acquire(1024));
+  buffers.push_back(pool->Acquire(8 * kMiB));
+  buffers.clear();
+  EXPECT_LE(pool->IdleBytes(), 4 * kMiB);
+  EXPECT_GE(pool->IdleBytes(), 2 * kMiB);
+
+  // Smaller buffers evict the largest ones. The 1 KiB buffer stays idle,
+  // so only seven 512 KiB buffers fit.
+  for (int i = 0; i < 8; ++i)
+    buffers.push_back(pool->Acquire(512 * 1024));
+  buffers.clear();
+  EXPECT_EQ(7 * 512 * 1024 + 1024u, pool->IdleBytes());
+
+  // Lowering the maximum releases idle buffers.
+  pool->SetMaxIdleBytes(1 * kMiB);
+  EXPECT_LE(pool->IdleBytes(), 1 * kMiB);
+  pool->SetMaxIdleBytes(0);
+  EXPECT_EQ(0u, pool->IdleBytes());
+
+  buffers.push_back(pool->Acquire(64));
+  buffers.clear();
+  EXPECT_EQ(0u, pool->IdleBytes());
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -23,6 +23,10 @@
 #pragma warning(pop)
 #endif
 
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <string>
 #include <vector>
 
 #include "ignition/transport/Discovery.hh"
@@ -61,6 +65,57 @@ inline namespace IGNITION_TRANSPORT_VERSION_NAMESPACE
     // Return if we got a reply.
     return items[0].revents & ZMQ_POLLIN;
   }
+
+  /////////////////////////////////////////////////
+  bool packDiscoveryMsgs(const std::vector<msgs::Discovery> &_msgs,
+    const std::size_t _maxSize, std::vector<std::string> &_datagrams)
+  {
+    _datagrams.clear();
+
+    std::string datagram;
+    for (const auto &msg : _msgs)
+    {
+      // ByteSizeLong appeared in version 3.1 of Protobuf, and ByteSize
+      // became deprecated.
+#if GOOGLE_PROTOBUF_VERSION < 3001000
+      const std::size_t msgSize = static_cast<std::size_t>(msg.ByteSize());
+#else
+      const std::size_t msgSize = msg.ByteSizeLong();
+#endif
+      uint16_t frameSize;
+      if (msgSize + sizeof(frameSize) > std::numeric_limits<uint16_t>::max())
+      {
+        std::cerr << "Discovery message too large to send. Discovery won't "
+          << "work. This shouldn't happen.\n";
+        return false;
+      }
+      frameSize = static_cast<uint16_t>(msgSize);
+
+      // Start a new datagram when the message doesn't fit in this one.
+      if (!datagram.empty() &&
+          datagram.size() + sizeof(frameSize) + msgSize > _maxSize)
+      {
+        _datagrams.push_back(std::move(datagram));
+        datagram.clear();
+      }
+
+      const std::size_t offset = datagram.size();
+      datagram.resize(offset + sizeof(frameSize) + msgSize);
+      memcpy(&datagram[offset], &frameSize, sizeof(frameSize));
+      if (!msg.SerializeToArray(&datagram[offset + sizeof(frameSize)],
+            static_cast<int>(msgSize)))
+      {
+        std::cerr << "packDiscoveryMsgs(): Error serializing data."
+          << std::endl;
+        return false;
+      }
+    }
+
+    if (!datagram.empty())
+      _datagrams.push_back(std::move(datagram));
+
+    return true;
+  }
 }
 }
 }
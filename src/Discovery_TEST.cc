@@ -16,10 +16,14 @@
 */
 
 #include <chrono>
+#include <cstdint>
 #include <cstdlib>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
+#include <utility>
+#include <vector>
 
 #include "gtest/gtest.h"
 #include "ignition/transport/AdvertiseOptions.hh"
@@ -55,6 +59,43 @@ static bool connectionExecuted = false;
 static bool disconnectionExecuted = false;
 static int g_counter = 0;
 
+namespace ignition
+{
+  namespace transport
+  {
+    inline namespace IGNITION_TRANSPORT_VERSION_NAMESPACE {
+    /// \brief Access to the private members of Discovery within the tests.
+    class DiscoveryTestHook
+    {
+      /// \brief Handle a discovery message as if it was received.
+      /// \param[in] _discovery The discovery object.
+      /// \param[in] _msg The message.
+      /// \param[in] _disconnectCb Callback notifying the publishers gone.
+      public: template<typename T>
+      static void Dispatch(Discovery<T> &_discovery, msgs::Discovery _msg,
+          const DiscoveryCallback<T> &_disconnectCb)
+      {
+        _discovery.DispatchDiscoveryMsg("127.0.0.1", _msg, nullptr,
+            _disconnectCb);
+      }
+
+      /// \brief Get the generation known for the publishers of a process.
+      /// \param[in] _discovery The discovery object.
+      /// \param[in] _pUuid Process UUID.
+      /// \return The generation, or 0 if unknown.
+      public: template<typename T>
+      static uint64_t Generation(const Discovery<T> &_discovery,
+          const std::string &_pUuid)
+      {
+        std::lock_guard<std::mutex> lock(_discovery.mutex);
+        auto it = _discovery.generations.find(_pUuid);
+        return it == _discovery.generations.end() ? 0u : it->second;
+      }
+    };
+    }
+  }
+}
+
 /// \brief Helper class to access the protected member variables of Discovery
 /// within the tests.
 template<typename T> class DiscoveryDerived : public transport::Discovery<T>
@@ -78,6 +119,23 @@ template<typename T> class DiscoveryDerived : public transport::Discovery<T>
     EXPECT_EQ(this->activity.find(_pUuid) !=
               this->activity.end(), _expectedActivity);
   };
+
+  /// \brief Handle a discovery message as if it was received.
+  /// \param[in] _msg The message.
+  /// \param[in] _disconnectCb Callback notifying the publishers gone.
+  public: void Dispatch(msgs::Discovery _msg,
+      const DiscoveryCallback<T> &_disconnectCb = nullptr)
+  {
+    DiscoveryTestHook::Dispatch<T>(*this, _msg, _disconnectCb);
+  }
+
+  /// \brief Get the generation known for the publishers of a process.
+  /// \param[in] _pUuid Process UUID.
+  /// \return The generation, or 0 if unknown.
+  public: uint64_t Generation(const std::string &_pUuid) const
+  {
+    return DiscoveryTestHook::Generation<T>(*this, _pUuid);
+  }
 };
 
 //////////////////////////////////////////////////
@@ -132,6 +190,15 @@ void onDiscoveryResponseMultiple(const transport::MessagePublisher &_publisher)
   ++g_counter;
 }
 
+//////////////////////////////////////////////////
+/// \brief Function called each time a discovery update is received. It
+/// counts the publishers of the first process.
+void onDiscoveryResponseCount(const transport::MessagePublisher &_publisher)
+{
+  if (_publisher.PUuid() == pUuid1)
+    ++g_counter;
+}
+
 //////////////////////////////////////////////////
 /// \brief Function called each time a discovery update is received.
 void onDisconnection(const transport::MessagePublisher &_publisher)
@@ -523,6 +590,337 @@ TEST(DiscoveryTest, TestActivity)
   discovery1.TestActivity(proc2Uuid, false);
 }
 
+//////////////////////////////////////////////////
+/// \brief Check that a process started after the advertisements learns all
+/// of them: the heartbeats only carry their generation, and the new process
+/// requests the rest.
+TEST(DiscoveryTest, TestLateDiscovery)
+{
+  reset();
+
+  const int kPublishers = 50;
+  MsgDiscovery discovery1(pUuid1, g_msgPort);
+  discovery1.Start();
+  for (int i = 0; i < kPublishers; ++i)
+  {
+    MessagePublisher publisher(g_topic + std::to_string(i), addr1, ctrl1,
+      pUuid1, nUuid1, "t", AdvertiseMessageOptions());
+    EXPECT_TRUE(discovery1.Advertise(publisher));
+  }
+
+  MsgDiscovery discovery2(pUuid2, g_msgPort);
+  discovery2.ConnectionsCb(onDiscoveryResponseCount);
+  discovery2.Start();
+
+  int i = 0;
+  while (i < 3 * MaxIters && g_counter < kPublishers)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(Nap));
+    ++i;
+  }
+
+  EXPECT_EQ(g_counter, kPublishers);
+
+  // The following heartbeats don't announce them again.
+  std::this_thread::sleep_for(std::chrono::milliseconds(
+    discovery1.HeartbeatInterval() * 2));
+  EXPECT_EQ(g_counter, kPublishers);
+
+  reset();
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that a burst of advertisements from many publishers is
+/// received and counted.
+TEST(DiscoveryTest, TestRecvStats)
+{
+  reset();
+
+  const int kPublishers = 200;
+  MsgDiscovery discovery1(pUuid1, g_msgPort);
+  MsgDiscovery discovery2(pUuid2, g_msgPort);
+
+  EXPECT_FALSE(discovery2.SetRecvBufferSize(0));
+  EXPECT_TRUE(discovery2.SetRecvBufferSize(256 * 1024));
+  EXPECT_GT(discovery2.RecvBufferSize(), 0);
+
+  discovery2.ConnectionsCb(onDiscoveryResponseCount);
+  discovery1.Start();
+  discovery2.Start();
+
+  for (int i = 0; i < kPublishers; ++i)
+  {
+    MessagePublisher publisher(g_topic + std::to_string(i), addr1, ctrl1,
+      pUuid1, nUuid1, "t", AdvertiseMessageOptions());
+    EXPECT_TRUE(discovery1.Advertise(publisher));
+  }
+
+  int i = 0;
+  while (i < 3 * MaxIters && g_counter < kPublishers)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(Nap));
+    ++i;
+  }
+  EXPECT_EQ(g_counter, kPublishers);
+
+  auto stats = discovery2.Stats();
+  EXPECT_GE(stats.msgs, static_cast<uint64_t>(kPublishers));
+  EXPECT_GE(stats.msgs, stats.datagrams);
+  EXPECT_GE(stats.datagrams, stats.batches);
+  EXPECT_GT(stats.batches, 0u);
+  EXPECT_EQ(stats.discarded, 0u);
+
+  reset();
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that the heartbeats slow down while nothing changes, that
+/// the other processes follow them, and that they speed up again when a
+/// topic is advertised.
+TEST(DiscoveryTest, TestAdaptiveHeartbeat)
+{
+  reset();
+
+  const unsigned int kHeartbeat = 100;
+  DiscoveryDerived<MessagePublisher> discovery1(pUuid1, g_msgPort);
+  DiscoveryDerived<MessagePublisher> discovery2(pUuid2, g_msgPort);
+
+  EXPECT_FALSE(discovery1.Adaptive());
+  discovery1.SetAdaptive(true);
+  EXPECT_TRUE(discovery1.Adaptive());
+  discovery1.SetHeartbeatInterval(kHeartbeat);
+  EXPECT_EQ(discovery1.CurrentHeartbeatInterval(), kHeartbeat);
+
+  // A silence interval much shorter than the slowest heartbeats.
+  discovery2.SetHeartbeatInterval(kHeartbeat);
+  discovery2.SetSilenceInterval(3 * kHeartbeat);
+  discovery2.ConnectionsCb(onDiscoveryResponseCount);
+
+  discovery1.Start();
+  discovery2.Start();
+
+  MessagePublisher publisher(g_topic, addr1, ctrl1, pUuid1, nUuid1, "t",
+    AdvertiseMessageOptions());
+  EXPECT_TRUE(discovery1.Advertise(publisher));
+
+  // The heartbeats back off.
+  int i = 0;
+  while (i < 3 * MaxIters &&
+         discovery1.CurrentHeartbeatInterval() < 8 * kHeartbeat)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(Nap));
+    ++i;
+  }
+  EXPECT_EQ(discovery1.CurrentHeartbeatInterval(), 8 * kHeartbeat);
+
+  // The other process waits for them.
+  std::this_thread::sleep_for(std::chrono::milliseconds(12 * kHeartbeat));
+  discovery2.TestActivity(pUuid1, true);
+  EXPECT_EQ(g_counter, 1);
+
+  // A change brings the fast heartbeats back.
+  MessagePublisher publisher2(g_topic + "2", addr1, ctrl1, pUuid1, nUuid1,
+    "t", AdvertiseMessageOptions());
+  EXPECT_TRUE(discovery1.Advertise(publisher2));
+  EXPECT_EQ(discovery1.CurrentHeartbeatInterval(), kHeartbeat);
+
+  i = 0;
+  while (i < MaxIters && g_counter < 2)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(Nap));
+    ++i;
+  }
+  EXPECT_EQ(g_counter, 2);
+
+  reset();
+}
+
+//////////////////////////////////////////////////
+/// \brief Create a discovery message of the first process.
+/// \param[in] _type Message type.
+/// \param[in] _header Key/value pairs of the header.
+/// \return The message.
+static msgs::Discovery newDiscoveryMsg(const msgs::Discovery::Type _type,
+    const std::vector<std::pair<std::string, std::string>> &_header = {})
+{
+  msgs::Discovery msg;
+  msg.set_type(_type);
+  msg.set_process_uuid(pUuid1);
+  for (const auto &entry : _header)
+  {
+    auto data = msg.mutable_header()->add_data();
+    data->set_key(entry.first);
+    data->add_value(entry.second);
+  }
+  return msg;
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that the publishers of a process resent after a request
+/// are only accepted if none of them was lost.
+TEST(DiscoveryTest, TestSyncLostDatagram)
+{
+  const int kPublishers = 3;
+  DiscoveryDerived<MessagePublisher> discovery(pUuid2, g_msgPort);
+
+  std::vector<msgs::Discovery> advertised;
+  for (int i = 0; i < kPublishers; ++i)
+  {
+    advertised.push_back(newDiscoveryMsg(msgs::Discovery::ADVERTISE));
+    MessagePublisher(g_topic + std::to_string(i), addr1, ctrl1, pUuid1,
+      nUuid1, "t", AdvertiseMessageOptions()).FillDiscovery(
+        advertised.back());
+  }
+
+  const auto heartbeat = newDiscoveryMsg(msgs::Discovery::HEARTBEAT,
+    {{"generation", "3"}});
+  const auto syncHeartbeat = newDiscoveryMsg(msgs::Discovery::HEARTBEAT,
+    {{"generation", "3"}, {"sync", pUuid1},
+     {"count", std::to_string(kPublishers)}});
+
+  // The heartbeat shows that we missed some changes, so we request all the
+  // publishers. The datagram with the second one is lost.
+  discovery.Dispatch(heartbeat);
+  EXPECT_EQ(0u, discovery.Generation(pUuid1));
+  discovery.Dispatch(advertised[0]);
+  discovery.Dispatch(advertised[2]);
+  discovery.Dispatch(syncHeartbeat);
+  EXPECT_EQ(0u, discovery.Generation(pUuid1));
+
+  // We are still outdated, so they are requested again. This time they all
+  // arrive.
+  for (const auto &msg : advertised)
+    discovery.Dispatch(msg);
+  discovery.Dispatch(syncHeartbeat);
+  EXPECT_EQ(3u, discovery.Generation(pUuid1));
+
+  // Up to date.
+  discovery.Dispatch(heartbeat);
+  EXPECT_EQ(3u, discovery.Generation(pUuid1));
+
+  // Another process only trusts the answer if it saw the request.
+  DiscoveryDerived<MessagePublisher> other(transport::Uuid().ToString(),
+    g_msgPort);
+  for (const auto &msg : advertised)
+    other.Dispatch(msg);
+  other.Dispatch(syncHeartbeat);
+  EXPECT_EQ(0u, other.Generation(pUuid1));
+
+  auto request = newDiscoveryMsg(msgs::Discovery::SUBSCRIBE,
+    {{"sync", pUuid1}});
+  request.set_process_uuid(pUuid2);
+  other.Dispatch(request);
+  for (const auto &msg : advertised)
+    other.Dispatch(msg);
+  other.Dispatch(syncHeartbeat);
+  EXPECT_EQ(3u, other.Generation(pUuid1));
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that a complete list of the publishers of a process
+/// removes the ones whose UNADVERTISE message was lost.
+TEST(DiscoveryTest, TestSyncLostUnadvertise)
+{
+  DiscoveryDerived<MessagePublisher> discovery(pUuid2, g_msgPort);
+
+  std::vector<msgs::Discovery> advertised;
+  for (int i = 0; i < 2; ++i)
+  {
+    advertised.push_back(newDiscoveryMsg(msgs::Discovery::ADVERTISE,
+      {{"generation", std::to_string(i + 1)}}));
+    MessagePublisher(g_topic + std::to_string(i), addr1, ctrl1, pUuid1,
+      nUuid1, "t", AdvertiseMessageOptions()).FillDiscovery(
+        advertised.back());
+  }
+
+  for (const auto &msg : advertised)
+    discovery.Dispatch(msg);
+  EXPECT_EQ(2u, discovery.Generation(pUuid1));
+  MessagePublisher pub;
+  EXPECT_TRUE(discovery.Info().Publisher(g_topic + "1", pUuid1,
+    nUuid1, pub));
+
+  // The UNADVERTISE of the second publisher (generation 3) is lost, so the
+  // next heartbeat shows that we are outdated.
+  discovery.Dispatch(newDiscoveryMsg(msgs::Discovery::HEARTBEAT,
+    {{"generation", "3"}}));
+  EXPECT_EQ(2u, discovery.Generation(pUuid1));
+
+  // The answer only contains the first publisher.
+  std::vector<MessagePublisher> gone;
+  auto onDisconnection = [&gone](const MessagePublisher &_pub)
+  {
+    gone.push_back(_pub);
+  };
+  discovery.Dispatch(advertised[0], onDisconnection);
+  discovery.Dispatch(newDiscoveryMsg(msgs::Discovery::HEARTBEAT,
+    {{"generation", "3"}, {"sync", pUuid1}, {"count", "1"}}),
+    onDisconnection);
+
+  EXPECT_EQ(3u, discovery.Generation(pUuid1));
+  EXPECT_TRUE(discovery.Info().Publisher(g_topic + "0", pUuid1,
+    nUuid1, pub));
+  EXPECT_FALSE(discovery.Info().Publisher(g_topic + "1", pUuid1,
+    nUuid1, pub));
+  ASSERT_EQ(1u, gone.size());
+  EXPECT_EQ(g_topic + "1", gone[0].Topic());
+  EXPECT_EQ(nUuid1, gone[0].NUuid());
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that the discovery messages are packed into datagrams that
+/// don't exceed the maximum size.
+TEST(DiscoveryTest, TestPackDiscoveryMsgs)
+{
+  std::vector<msgs::Discovery> discoveryMsgs(30);
+  for (std::size_t i = 0; i < discoveryMsgs.size(); ++i)
+  {
+    discoveryMsgs[i].set_version(1);
+    discoveryMsgs[i].set_type(msgs::Discovery::ADVERTISE);
+    discoveryMsgs[i].set_process_uuid(pUuid1);
+    discoveryMsgs[i].mutable_pub()->set_topic(g_topic + std::to_string(i));
+    discoveryMsgs[i].mutable_pub()->set_address(addr1);
+  }
+
+  const std::size_t kMaxSize = 500;
+  std::vector<std::string> datagrams;
+  ASSERT_TRUE(packDiscoveryMsgs(discoveryMsgs, kMaxSize, datagrams));
+  EXPECT_GT(datagrams.size(), 1u);
+  EXPECT_LT(datagrams.size(), discoveryMsgs.size());
+
+  // Unpack them.
+  std::size_t next = 0;
+  for (const auto &datagram : datagrams)
+  {
+    EXPECT_LE(datagram.size(), kMaxSize);
+
+    std::size_t offset = 0;
+    while (offset < datagram.size())
+    {
+      uint16_t len = 0;
+      ASSERT_LE(offset + sizeof(len), datagram.size());
+      memcpy(&len, &datagram[offset], sizeof(len));
+      ASSERT_LE(offset + sizeof(len) + len, datagram.size());
+
+      msgs::Discovery msg;
+      ASSERT_TRUE(msg.ParseFromArray(&datagram[offset + sizeof(len)], len));
+      ASSERT_LT(next, discoveryMsgs.size());
+      EXPECT_EQ(msg.pub().topic(), discoveryMsgs[next].pub().topic());
+      ++next;
+
+      offset += sizeof(len) + len;
+    }
+  }
+  EXPECT_EQ(next, discoveryMsgs.size());
+
+  // A message larger than the maximum size travels alone.
+  ASSERT_TRUE(packDiscoveryMsgs(discoveryMsgs, 10u, datagrams));
+  EXPECT_EQ(datagrams.size(), discoveryMsgs.size());
+
+  ASSERT_TRUE(packDiscoveryMsgs({}, kMaxSize, datagrams));
+  EXPECT_TRUE(datagrams.empty());
+}
+
 //////////////////////////////////////////////////
 /// \brief Check that a wrong IGN_IP value makes HostAddr() to return 127.0.0.1
 TEST(DiscoveryTest, WrongIgnIp)
@@ -0,0 +1,635 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef IGN_TRANSPORT_EXECUTORS_HH_
+#define IGN_TRANSPORT_EXECUTORS_HH_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "ignition/transport/config.hh"
+#include "ignition/transport/SubscribeOptions.hh"
+
+namespace ignition
+{
+  namespace transport
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_TRANSPORT_VERSION_NAMESPACE {
+    //
+    /// \brief Largest number of threads of a WorkerPool per hardware thread.
+    static const std::size_t kMaxThreadsPerCore = 16;
+
+    /// \brief Get the largest number of threads of a WorkerPool.
+    /// \return kMaxThreadsPerCore times the number of hardware threads.
+    inline std::size_t MaxPoolThreads()
+    {
+      return kMaxThreadsPerCore *
+        std::max(std::thread::hardware_concurrency(), 1u);
+    }
+
+    /// \brief Parse the number of threads of a WorkerPool from a string.
+    /// Numbers larger than MaxPoolThreads() are clamped.
+    /// \param[in] _str A positive number.
+    /// \param[out] _threads The parsed number of threads.
+    /// \return True if _str is a valid number of threads.
+    inline bool PoolThreadsFromString(const std::string &_str,
+                                      std::size_t &_threads)
+    {
+      // std::stoul accepts a sign, so a negative value would wrap around.
+      if (_str.empty() ||
+          _str.find_first_not_of("0123456789") != std::string::npos)
+      {
+        return false;
+      }
+
+      unsigned long long threads;
+      try
+      {
+        threads = std::stoull(_str);
+      }
+      catch (...)
+      {
+        // Too many digits, which is still a positive number.
+        threads = MaxPoolThreads();
+      }
+
+      if (threads == 0)
+        return false;
+
+      _threads = static_cast<std::size_t>(
+        std::min<unsigned long long>(threads, MaxPoolThreads()));
+      return true;
+    }
+
+    /// \class WorkerPool Executors.hh
+    /// \brief A fixed number of threads running tasks in FIFO order. With a
+    /// single thread, the tasks run in the order in which they were posted.
+    class WorkerPool
+    {
+      /// \brief Constructor.
+      /// \param[in] _threads Number of threads (between 1 and
+      /// MaxPoolThreads()).
+      public: explicit WorkerPool(const std::size_t _threads)
+        : state(std::make_shared<State>())
+      {
+        const std::size_t count =
+          std::min(std::max<std::size_t>(_threads, 1u), MaxPoolThreads());
+        for (std::size_t i = 0; i < count; ++i)
+          this->threads.emplace_back(&WorkerPool::Run, this->state);
+      }
+
+      /// \brief Destructor. Pending tasks are discarded and the threads are
+      /// joined.
+      public: ~WorkerPool()
+      {
+        this->Stop(true);
+      }
+
+      /// \brief Queue a task.
+      /// \param[in] _task The task.
+      public: void Post(std::function<void()> &&_task)
+      {
+        {
+          std::lock_guard<std::mutex> lk(this->state->mutex);
+          if (this->state->stop)
+            return;
+          this->state->tasks.push_back(std::move(_task));
+        }
+        this->state->cv.notify_one();
+      }
+
+      /// \brief Discard the pending tasks and stop the threads. The task that
+      /// a thread is running (if any) is not interrupted.
+      /// \param[in] _wait True to wait for the threads, false to let them
+      /// finish on their own. A thread never waits for itself.
+      public: void Stop(const bool _wait)
+      {
+        std::deque<std::function<void()>> discarded;
+        {
+          std::lock_guard<std::mutex> lk(this->state->mutex);
+          this->state->stop = true;
+          discarded.swap(this->state->tasks);
+        }
+        this->state->cv.notify_all();
+
+        for (auto &thread : this->threads)
+        {
+          if (!thread.joinable())
+            continue;
+
+          if (_wait && thread.get_id() != std::this_thread::get_id())
+            thread.join();
+          else
+            thread.detach();
+        }
+      }
+
+      /// \brief Get the number of threads.
+      /// \return The number of threads.
+      public: std::size_t Size() const
+      {
+        return this->threads.size();
+      }
+
+      /// \brief State shared with the threads, so a detached thread never
+      /// touches the pool itself.
+      private: struct State
+               {
+                 /// \brief Protects the task queue.
+                 public: std::mutex mutex;
+
+                 /// \brief Signaled when a task is queued or on stop.
+                 public: std::condition_variable cv;
+
+                 /// \brief Pending tasks.
+                 public: std::deque<std::function<void()>> tasks;
+
+                 /// \brief True when the pool is stopped.
+                 public: bool stop = false;
+               };
+
+      /// \brief Body of the threads.
+      /// \param[in] _state The shared state.
+      private: static void Run(std::shared_ptr<State> _state)
+      {
+        for (;;)
+        {
+          std::function<void()> task;
+          {
+            std::unique_lock<std::mutex> lk(_state->mutex);
+            _state->cv.wait(lk, [&_state]
+              {
+                return _state->stop || !_state->tasks.empty();
+              });
+
+            if (_state->stop)
+              return;
+
+            task = std::move(_state->tasks.front());
+            _state->tasks.pop_front();
+          }
+
+          try
+          {
+            task();
+          }
+          catch (...)
+          {
+            std::cerr << "Exception occurred in an executor task"
+                      << std::endl;
+          }
+        }
+      }
+
+      /// \brief The shared state.
+      private: std::shared_ptr<State> state;
+
+      /// \brief The threads.
+      private: std::vector<std::thread> threads;
+    };
+
+    /// \class Strand Executors.hh
+    /// \brief Serializes the tasks posted to it on top of a WorkerPool: they
+    /// run one at a time and in order, on any thread of the pool. A strand
+    /// with a concurrency N > 1 starts the tasks in order, but runs up to N
+    /// of them at the same time.
+    class Strand : public std::enable_shared_from_this<Strand>
+    {
+      /// \brief Constructor.
+      /// \param[in] _pool The pool running the tasks.
+      /// \param[in] _concurrency Maximum number of tasks running at the same
+      /// time (minimum 1).
+      public: explicit Strand(const std::shared_ptr<WorkerPool> &_pool,
+                              const std::size_t _concurrency = 1u)
+        : pool(_pool),
+          concurrency(std::max<std::size_t>(_concurrency, 1u))
+      {
+      }
+
+      /// \brief Queue a task.
+      /// \param[in] _task The task.
+      public: void Post(std::function<void()> &&_task)
+      {
+        {
+          std::lock_guard<std::mutex> lk(this->mutex);
+          if (this->closed)
+            return;
+
+          this->tasks.push_back(std::move(_task));
+          if (this->active >= this->concurrency)
+            return;
+          ++this->active;
+        }
+        this->Schedule();
+      }
+
+      /// \brief Discard the pending tasks and ignore new ones.
+      public: void Close()
+      {
+        std::deque<std::function<void()>> discarded;
+        std::lock_guard<std::mutex> lk(this->mutex);
+        this->closed = true;
+        discarded.swap(this->tasks);
+      }
+
+      /// \brief Wait until the tasks in progress are done. Tasks started
+      /// later are not waited for. It returns right away when called from a
+      /// task of this strand, since a task can't wait for itself.
+      public: void Wait()
+      {
+        const std::thread::id self = std::this_thread::get_id();
+        std::unique_lock<std::mutex> lk(this->mutex);
+        for (const auto &task : this->running)
+        {
+          if (task.first == self)
+            return;
+        }
+
+        const uint64_t last = this->started;
+        this->finished.wait(lk, [this, last]
+          {
+            for (const auto &task : this->running)
+            {
+              if (task.second <= last)
+                return false;
+            }
+            return true;
+          });
+      }
+
+      /// \brief Get the pool running the tasks.
+      /// \return The pool.
+      public: const std::shared_ptr<WorkerPool> &Pool() const
+      {
+        return this->pool;
+      }
+
+      /// \brief Post a drain of the strand to the pool.
+      private: void Schedule()
+      {
+        auto self = this->shared_from_this();
+        this->pool->Post([self]()
+          {
+            self->Drain();
+          });
+      }
+
+      /// \brief Run a batch of tasks. If there are tasks left, the strand
+      /// is scheduled again instead of holding the pool thread, so a busy
+      /// strand doesn't starve the others.
+      private: void Drain()
+      {
+        const std::thread::id self = std::this_thread::get_id();
+        for (unsigned int i = 0; i < kMaxBatch; ++i)
+        {
+          std::function<void()> task;
+          {
+            std::lock_guard<std::mutex> lk(this->mutex);
+            if (i > 0)
+              this->Finished(self);
+
+            if (this->tasks.empty() || this->closed)
+            {
+              --this->active;
+              return;
+            }
+            task = std::move(this->tasks.front());
+            this->tasks.pop_front();
+            this->running.emplace_back(self, ++this->started);
+          }
+
+          try
+          {
+            task();
+          }
+          catch (...)
+          {
+            std::cerr << "Exception occurred in an executor task"
+                      << std::endl;
+          }
+        }
+
+        {
+          std::lock_guard<std::mutex> lk(this->mutex);
+          this->Finished(self);
+        }
+        this->Schedule();
+      }
+
+      /// \brief Mark the task run by a thread as done. The caller must hold
+      /// the mutex.
+      /// \param[in] _thread The thread.
+      private: void Finished(const std::thread::id _thread)
+      {
+        for (auto it = this->running.begin(); it != this->running.end(); ++it)
+        {
+          if (it->first == _thread)
+          {
+            this->running.erase(it);
+            break;
+          }
+        }
+        this->finished.notify_all();
+      }
+
+      /// \brief Maximum number of tasks run by a single drain.
+      private: static const unsigned int kMaxBatch = 16;
+
+      /// \brief The pool running the tasks.
+      private: std::shared_ptr<WorkerPool> pool;
+
+      /// \brief Protects the members below.
+      private: std::mutex mutex;
+
+      /// \brief Pending tasks.
+      private: std::deque<std::function<void()>> tasks;
+
+      /// \brief Maximum number of drains queued or running.
+      private: const std::size_t concurrency;
+
+      /// \brief Number of drains queued or running.
+      private: std::size_t active = 0;
+
+      /// \brief True when the strand is closed.
+      private: bool closed = false;
+
+      /// \brief Number of tasks started so far.
+      private: uint64_t started = 0;
+
+      /// \brief Tasks in progress: thread running each task and its order
+      /// among the started tasks.
+      private: std::vector<std::pair<std::thread::id, uint64_t>> running;
+
+      /// \brief Signaled when a task is done.
+      private: std::condition_variable finished;
+    };
+
+    /// \class Executors Executors.hh
+    /// \brief Runs the subscription callbacks according to their Executor_t.
+    /// Every subscription that doesn't run on the thread delivering the
+    /// message is registered with a strand, so its callbacks are never run
+    /// concurrently and always run in order:
+    ///   * POOL: one strand per subscription on a shared WorkerPool.
+    ///   * TOPIC_STRAND: one strand per topic on the shared WorkerPool.
+    ///   * DEDICATED: one strand per subscription on its own thread.
+    /// Service repliers with a maximum concurrency N are registered as
+    /// DEDICATED with N threads, and their requests run concurrently.
+    /// The shared pool is created the first time it's needed.
+    class Executors
+    {
+      /// \brief Constructor.
+      /// \param[in] _poolSize Number of threads of the shared pool.
+      public: explicit Executors(const std::size_t _poolSize)
+        : poolSize(std::max<std::size_t>(_poolSize, 1u))
+      {
+      }
+
+      /// \brief Destructor. Stops all the threads.
+      public: ~Executors()
+      {
+        // Stop the threads without holding the mutex, a callback in
+        // progress might be posting.
+        std::vector<std::shared_ptr<WorkerPool>> pools;
+        {
+          std::lock_guard<std::mutex> lk(this->mutex);
+          for (auto &entry : this->handlers)
+          {
+            entry.second.strand->Close();
+            if (entry.second.type == Executor_t::DEDICATED)
+              pools.push_back(entry.second.strand->Pool());
+          }
+          for (auto &entry : this->topics)
+            entry.second->Close();
+          if (this->pool)
+            pools.push_back(this->pool);
+        }
+
+        for (auto &workers : pools)
+          workers->Stop(true);
+      }
+
+      /// \brief Whether the callbacks with a given executor run on the
+      /// thread delivering the message.
+      /// \param[in] _type The executor.
+      /// \return True for DEFAULT and SINGLE_THREADED.
+      public: static bool Inline(const Executor_t _type)
+      {
+        return _type == Executor_t::DEFAULT ||
+               _type == Executor_t::SINGLE_THREADED;
+      }
+
+      /// \brief Register a subscription handler. Registering a handler
+      /// twice has no effect.
+      /// \param[in] _hUuid UUID of the handler.
+      /// \param[in] _topic Fully qualified topic of the subscription.
+      /// \param[in] _type The executor. Inline handlers are not registered.
+      /// \param[in] _concurrency Maximum number of tasks of the handler
+      /// running at the same time. Only used by DEDICATED handlers, which
+      /// get one thread per task.
+      public: void Register(const std::string &_hUuid,
+                            const std::string &_topic,
+                            const Executor_t _type,
+                            const std::size_t _concurrency = 1u)
+      {
+        if (Inline(_type))
+          return;
+
+        std::lock_guard<std::mutex> lk(this->mutex);
+        if (this->handlers.find(_hUuid) != this->handlers.end())
+          return;
+
+        Entry entry;
+        entry.type = _type;
+        entry.topic = _topic;
+        if (_type == Executor_t::DEDICATED)
+        {
+          entry.strand = std::make_shared<Strand>(
+            std::make_shared<WorkerPool>(_concurrency), _concurrency);
+        }
+        else if (_type == Executor_t::TOPIC_STRAND)
+        {
+          auto &strand = this->topics[_topic];
+          if (!strand)
+            strand = std::make_shared<Strand>(this->Pool());
+          entry.strand = strand;
+        }
+        else
+        {
+          entry.strand = std::make_shared<Strand>(this->Pool());
+        }
+
+        this->handlers[_hUuid] = entry;
+        this->registered = this->handlers.size();
+      }
+
+      /// \brief Unregister a subscription handler. Its pending callbacks are
+      /// discarded and the callback in progress (if any) is waited for,
+      /// unless this function is called from the strand of the handler. The
+      /// caller must not hold a lock that the callback might need.
+      /// \param[in] _hUuid UUID of the handler.
+      public: void Release(const std::string &_hUuid)
+      {
+        std::shared_ptr<Strand> strand;
+        {
+          std::lock_guard<std::mutex> lk(this->mutex);
+          auto it = this->handlers.find(_hUuid);
+          if (it == this->handlers.end())
+            return;
+
+          Entry entry = it->second;
+          this->handlers.erase(it);
+          this->registered = this->handlers.size();
+          strand = entry.strand;
+
+          // Drop the topic strand when its last subscription is gone.
+          bool shared = false;
+          if (entry.type == Executor_t::TOPIC_STRAND)
+          {
+            for (const auto &other : this->handlers)
+              shared = shared || other.second.strand == entry.strand;
+            if (!shared)
+              this->topics.erase(entry.topic);
+          }
+
+          if (!shared)
+          {
+            entry.strand->Close();
+            if (entry.type == Executor_t::DEDICATED)
+              entry.strand->Pool()->Stop(false);
+          }
+        }
+
+        // Wait without holding the mutex, the callback in progress might be
+        // posting.
+        strand->Wait();
+      }
+
+      /// \brief Run a callback with the executor of its handler. Only
+      /// handlers that don't run inline should be posted.
+      /// \param[in] _hUuid UUID of the handler.
+      /// \param[in] _task The callback.
+      /// \return True if the task was queued, or false if the handler isn't
+      /// registered (e.g.: it was just unsubscribed) and the task was
+      /// discarded.
+      public: bool Post(const std::string &_hUuid,
+                        std::function<void()> &&_task)
+      {
+        // Skip the lock if there's nobody registered.
+        if (this->registered == 0u)
+          return false;
+
+        std::shared_ptr<Strand> strand;
+        bool shared;
+        {
+          std::lock_guard<std::mutex> lk(this->mutex);
+          auto it = this->handlers.find(_hUuid);
+          if (it == this->handlers.end())
+            return false;
+          strand = it->second.strand;
+          shared = it->second.type == Executor_t::TOPIC_STRAND;
+        }
+
+        if (shared)
+        {
+          // A topic strand isn't closed when one of its handlers is
+          // released, so skip the callbacks of released handlers. A callback
+          // that passed the check is in progress and Release() waits for it.
+          strand->Post([this, _hUuid, task = std::move(_task)]()
+            {
+              if (this->Registered(_hUuid))
+                task();
+            });
+        }
+        else
+        {
+          strand->Post(std::move(_task));
+        }
+        return true;
+      }
+
+      /// \brief Check whether a handler is registered.
+      /// \param[in] _hUuid UUID of the handler.
+      /// \return True if the handler is registered.
+      public: bool Registered(const std::string &_hUuid) const
+      {
+        if (this->registered == 0u)
+          return false;
+
+        std::lock_guard<std::mutex> lk(this->mutex);
+        return this->handlers.find(_hUuid) != this->handlers.end();
+      }
+
+      /// \brief Get the shared pool, creating it if needed. The caller
+      /// must hold the mutex.
+      /// \return The shared pool.
+      private: const std::shared_ptr<WorkerPool> &Pool()
+      {
+        if (!this->pool)
+          this->pool = std::make_shared<WorkerPool>(this->poolSize);
+        return this->pool;
+      }
+
+      /// \brief A registered handler.
+      private: struct Entry
+               {
+                 /// \brief The executor.
+                 public: Executor_t type = Executor_t::POOL;
+
+                 /// \brief Fully qualified topic of the subscription.
+                 public: std::string topic;
+
+                 /// \brief The strand running the callbacks.
+                 public: std::shared_ptr<Strand> strand;
+               };
+
+      /// \brief Number of threads of the shared pool.
+      private: const std::size_t poolSize;
+
+      /// \brief Protects the members below.
+      private: mutable std::mutex mutex;
+
+      /// \brief Number of registered handlers.
+      private: std::atomic<std::size_t> registered{0};
+
+      /// \brief The shared pool.
+      private: std::shared_ptr<WorkerPool> pool;
+
+      /// \brief Registered handlers indexed by handler UUID.
+      private: std::unordered_map<std::string, Entry> handlers;
+
+      /// \brief Strands of the TOPIC_STRAND subscriptions indexed by topic.
+      private: std::unordered_map<std::string, std::shared_ptr<Strand>>
+        topics;
+    };
+    }
+  }
+}
+#endif
@@ -0,0 +1,300 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "Executors.hh"
+#include "gtest/gtest.h"
+
+using namespace ignition;
+using namespace transport;
+
+//////////////////////////////////////////////////
+/// \brief Wait until a counter reaches a value.
+/// \param[in] _counter The counter.
+/// \param[in] _value The expected value.
+/// \return True if the counter reached the value before the timeout.
+static bool waitFor(const std::atomic<int> &_counter, const int _value)
+{
+  for (int i = 0; i < 500 && _counter < _value; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  return _counter == _value;
+}
+
+//////////////////////////////////////////////////
+/// \brief The number of threads of a pool is positive and bounded.
+TEST(ExecutorsTest, PoolThreadsFromString)
+{
+  std::size_t threads = 3;
+  EXPECT_TRUE(PoolThreadsFromString("1", threads));
+  EXPECT_EQ(1u, threads);
+  EXPECT_TRUE(PoolThreadsFromString("2", threads));
+  EXPECT_EQ(2u, threads);
+
+  // Large values are clamped.
+  for (const std::string str : {"100000000", "18446744073709551615",
+                                "99999999999999999999999"})
+  {
+    threads = 3;
+    EXPECT_TRUE(PoolThreadsFromString(str, threads)) << str;
+    EXPECT_EQ(MaxPoolThreads(), threads) << str;
+  }
+
+  // Invalid values don't modify the output.
+  for (const std::string str : {"", "0", "00", "-1", "+4", " 4", "4 ",
+                                "12abc", "0x10", "abc"})
+  {
+    threads = 3;
+    EXPECT_FALSE(PoolThreadsFromString(str, threads)) << str;
+    EXPECT_EQ(3u, threads) << str;
+  }
+
+  WorkerPool pool(MaxPoolThreads() + 1);
+  EXPECT_EQ(MaxPoolThreads(), pool.Size());
+}
+
+//////////////////////////////////////////////////
+/// \brief DEFAULT and SINGLE_THREADED handlers run inline, they are never
+/// registered.
+TEST(ExecutorsTest, Inline)
+{
+  EXPECT_TRUE(Executors::Inline(Executor_t::DEFAULT));
+  EXPECT_TRUE(Executors::Inline(Executor_t::SINGLE_THREADED));
+  EXPECT_FALSE(Executors::Inline(Executor_t::POOL));
+  EXPECT_FALSE(Executors::Inline(Executor_t::TOPIC_STRAND));
+  EXPECT_FALSE(Executors::Inline(Executor_t::DEDICATED));
+
+  Executors executors(2);
+  executors.Register("h1", "/foo", Executor_t::SINGLE_THREADED);
+  executors.Register("h2", "/foo", Executor_t::DEFAULT);
+
+  EXPECT_FALSE(executors.Registered("h1"));
+  EXPECT_FALSE(executors.Registered("h2"));
+  EXPECT_FALSE(executors.Post("h1", []{}));
+  EXPECT_FALSE(executors.Post("unknown", []{}));
+}
+
+//////////////////////////////////////////////////
+/// \brief The tasks of a handler run in order and never concurrently, for
+/// every executor.
+TEST(ExecutorsTest, Ordering)
+{
+  const int kTasks = 1000;
+  Executors executors(4);
+
+  for (auto type : {Executor_t::POOL, Executor_t::TOPIC_STRAND,
+                    Executor_t::DEDICATED})
+  {
+    executors.Register("h", "/foo", type);
+    EXPECT_TRUE(executors.Registered("h"));
+
+    std::vector<int> seen;
+    std::atomic<int> running{0};
+    std::atomic<int> done{0};
+    for (int i = 0; i < kTasks; ++i)
+    {
+      EXPECT_TRUE(executors.Post("h", [&, i]()
+        {
+          EXPECT_EQ(1, ++running);
+          seen.push_back(i);
+          --running;
+          ++done;
+        }));
+    }
+
+    ASSERT_TRUE(waitFor(done, kTasks));
+    for (int i = 0; i < kTasks; ++i)
+      EXPECT_EQ(i, seen[i]);
+
+    executors.Release("h");
+    EXPECT_FALSE(executors.Registered("h"));
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief A slow handler doesn't block the others, and TOPIC_STRAND
+/// handlers of the same topic are serialized.
+TEST(ExecutorsTest, Isolation)
+{
+  Executors executors(2);
+  executors.Register("slow", "/slow", Executor_t::DEDICATED);
+  executors.Register("fast", "/fast", Executor_t::POOL);
+  executors.Register("t1", "/topic", Executor_t::TOPIC_STRAND);
+  executors.Register("t2", "/topic", Executor_t::TOPIC_STRAND);
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  bool release = false;
+  std::atomic<int> slowDone{0};
+  executors.Post("slow", [&]()
+    {
+      std::unique_lock<std::mutex> lk(mutex);
+      cv.wait(lk, [&]{return release;});
+      ++slowDone;
+    });
+
+  std::atomic<int> fastDone{0};
+  for (int i = 0; i < 10; ++i)
+    executors.Post("fast", [&]{++fastDone;});
+  EXPECT_TRUE(waitFor(fastDone, 10));
+  EXPECT_EQ(0, slowDone);
+
+  std::atomic<int> running{0};
+  std::atomic<int> topicDone{0};
+  for (int i = 0; i < 100; ++i)
+  {
+    for (auto handler : {"t1", "t2"})
+    {
+      executors.Post(handler, [&]()
+        {
+          EXPECT_EQ(1, ++running);
+          --running;
+          ++topicDone;
+        });
+    }
+  }
+  EXPECT_TRUE(waitFor(topicDone, 200));
+
+  {
+    std::lock_guard<std::mutex> lk(mutex);
+    release = true;
+  }
+  cv.notify_all();
+  EXPECT_TRUE(waitFor(slowDone, 1));
+}
+
+//////////////////////////////////////////////////
+/// \brief A DEDICATED handler with a concurrency N runs up to N tasks at
+/// the same time, never more.
+TEST(ExecutorsTest, Concurrency)
+{
+  const int kConcurrency = 3;
+  const int kTasks = 12;
+  Executors executors(1);
+  executors.Register("h", "/srv", Executor_t::DEDICATED, kConcurrency);
+
+  std::mutex mutex;
+  std::condition_variable cv;
+  int running = 0;
+  int maxRunning = 0;
+  std::atomic<int> done{0};
+  for (int i = 0; i < kTasks; ++i)
+  {
+    EXPECT_TRUE(executors.Post("h", [&]()
+      {
+        std::unique_lock<std::mutex> lk(mutex);
+        maxRunning = std::max(maxRunning, ++running);
+        cv.notify_all();
+
+        // Wait until the other tasks had the chance to start.
+        cv.wait_for(lk, std::chrono::milliseconds(100),
+          [&]{return running == kConcurrency;});
+        --running;
+        ++done;
+      }));
+  }
+
+  ASSERT_TRUE(waitFor(done, kTasks));
+  EXPECT_EQ(kConcurrency, maxRunning);
+}
+
+//////////////////////////////////////////////////
+/// \brief Releasing a handler discards its pending tasks, also from its
+/// own callback.
+TEST(ExecutorsTest, Release)
+{
+  auto executors = std::make_shared<Executors>(1);
+  executors->Register("h", "/foo", Executor_t::DEDICATED);
+
+  std::atomic<int> done{0};
+  for (int i = 0; i < 10; ++i)
+  {
+    executors->Post("h", [&]()
+      {
+        ++done;
+        executors->Release("h");
+      });
+  }
+
+  EXPECT_TRUE(waitFor(done, 1));
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(1, done);
+  EXPECT_FALSE(executors->Post("h", []{}));
+}
+
+//////////////////////////////////////////////////
+/// \brief Releasing a handler waits for its callback in progress, like
+/// destroying a subscriber while its callback sleeps.
+TEST(ExecutorsTest, ReleaseWaits)
+{
+  Executors executors(2);
+  for (auto type : {Executor_t::POOL, Executor_t::TOPIC_STRAND,
+                    Executor_t::DEDICATED})
+  {
+    executors.Register("h", "/foo", type);
+
+    // Another subscription of the topic keeps its strand busy.
+    executors.Register("other", "/foo", type);
+    std::atomic<bool> stop{false};
+    std::function<void()> busy = [&]()
+      {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        if (!stop)
+          executors.Post("other", std::function<void()>(busy));
+      };
+    executors.Post("other", std::function<void()>(busy));
+
+    std::atomic<int> started{0};
+    std::atomic<int> done{0};
+    for (int i = 0; i < 2; ++i)
+    {
+      executors.Post("h", [&]()
+        {
+          ++started;
+          std::this_thread::sleep_for(std::chrono::milliseconds(200));
+          ++done;
+        });
+    }
+
+    ASSERT_TRUE(waitFor(started, 1));
+    executors.Release("h");
+    EXPECT_EQ(1, done);
+    EXPECT_FALSE(executors.Registered("h"));
+
+    // The pending callback is discarded.
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+    EXPECT_EQ(1, started);
+
+    stop = true;
+    executors.Release("other");
+  }
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -15,8 +15,11 @@
  *
 */
 
+#include <atomic>
 #include <map>
 #include <string>
+#include <thread>
+#include <vector>
 #include <ignition/msgs.hh>
 
 #include "ignition/transport/HandlerStorage.hh"
@@ -239,6 +242,94 @@ TEST(RepStorageTest, SubStorageNoCallbacks)
   EXPECT_EQ(handler->HandlerUuid(), sub1HandlerPtr->HandlerUuid());
 }
 
+//////////////////////////////////////////////////
+/// \brief Check that Version() only changes when a handler is added or
+/// removed.
+TEST(RepStorageTest, SubStorageVersion)
+{
+  transport::HandlerStorage<transport::ISubscriptionHandler> subs;
+  std::shared_ptr<transport::SubscriptionHandler<ignition::msgs::Int32>>
+    sub1HandlerPtr(new transport::SubscriptionHandler
+      <ignition::msgs::Int32>(nUuid1));
+  std::string handlerUuid = sub1HandlerPtr->HandlerUuid();
+
+  uint64_t version = subs.Version();
+
+  subs.AddHandler(topic, nUuid1, sub1HandlerPtr);
+  EXPECT_GT(subs.Version(), version);
+  version = subs.Version();
+
+  // Nothing changes.
+  EXPECT_FALSE(subs.RemoveHandler(topic, nUuid2, handlerUuid));
+  EXPECT_FALSE(subs.RemoveHandlersForNode(topic, nUuid2));
+  EXPECT_EQ(version, subs.Version());
+
+  EXPECT_TRUE(subs.RemoveHandler(topic, nUuid1, handlerUuid));
+  EXPECT_GT(subs.Version(), version);
+  version = subs.Version();
+
+  subs.AddHandler(topic, nUuid1, sub1HandlerPtr);
+  EXPECT_TRUE(subs.RemoveHandlersForNode(topic, nUuid1));
+  EXPECT_GT(subs.Version(), version);
+}
+
+//////////////////////////////////////////////////
+/// \brief Readers and writers can use the storage concurrently.
+TEST(RepStorageTest, SubStorageConcurrentAccess)
+{
+  transport::HandlerStorage<transport::ISubscriptionHandler> subs;
+  const int kTopics = 32;
+  const int kIterations = 500;
+
+  // Topic 0 is always there.
+  subs.AddHandler("/topic0", nUuid1, std::make_shared<
+    transport::SubscriptionHandler<ignition::msgs::Int32>>(nUuid1));
+
+  std::atomic<bool> done{false};
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 4; ++i)
+  {
+    readers.emplace_back([&subs, &done]()
+    {
+      std::map<std::string, std::map<std::string,
+        transport::ISubscriptionHandlerPtr>> handlers;
+      while (!done)
+      {
+        EXPECT_TRUE(subs.Handlers("/topic0", handlers));
+        EXPECT_EQ(1u, handlers.size());
+        std::this_thread::yield();
+      }
+    });
+  }
+
+  std::vector<std::thread> writers;
+  for (int i = 0; i < 2; ++i)
+  {
+    writers.emplace_back([&subs, i, kTopics, kIterations]()
+    {
+      std::string nUuid = "writer" + std::to_string(i);
+      for (int j = 0; j < kIterations; ++j)
+      {
+        std::string t = "/topic" + std::to_string(1 + j % (kTopics - 1));
+        subs.AddHandler(t, nUuid, std::make_shared<
+          transport::SubscriptionHandler<ignition::msgs::Int32>>(nUuid));
+        EXPECT_TRUE(subs.HasHandlersForNode(t, nUuid));
+        EXPECT_TRUE(subs.RemoveHandlersForNode(t, nUuid));
+      }
+    });
+  }
+
+  for (auto &writer : writers)
+    writer.join();
+  done = true;
+  for (auto &reader : readers)
+    reader.join();
+
+  for (int i = 1; i < kTopics; ++i)
+    EXPECT_FALSE(subs.HasHandlersForTopic("/topic" + std::to_string(i)));
+  EXPECT_TRUE(subs.HasHandlersForTopic("/topic0"));
+}
+
 //////////////////////////////////////////////////
 int main(int argc, char **argv)
 {
@@ -20,6 +20,7 @@
 #include <cassert>
 #include <csignal>
 #include <condition_variable>
+#include <cstdint>
 #include <iostream>
 #include <map>
 #include <memory>
@@ -39,6 +40,7 @@
 
 #include "NodePrivate.hh"
 #include "NodeSharedPrivate.hh"
+#include "TopicId.hh"
 
 #ifdef _MSC_VER
 #pragma warning(disable: 4503)
@@ -103,7 +105,8 @@ namespace ignition
       /// \param[in] _publisher The message publisher.
       public: explicit PublisherPrivate(const MessagePublisher &_publisher)
         : shared(NodeShared::Instance()),
-          publisher(_publisher)
+          publisher(_publisher),
+          topicId(MakeTopicId(_publisher.Topic(), _publisher.MsgTypeName()))
       {
       }
 
@@ -178,6 +181,232 @@ namespace ignition
         return info;
       }
 
+      /// \brief Get the subscribers of this publisher. The snapshot is only
+      /// rebuilt when a subscription changed since the previous call, so in
+      /// steady state this doesn't look up any map or compare any type name.
+      /// \return The subscribers of this publisher.
+      public: std::shared_ptr<const NodeSharedPrivate::SubscriberSnapshot>
+        Subscribers()
+      {
+        // Read the epoch before the storages. If a subscription changes
+        // while the snapshot is built, the snapshot is rebuilt next time.
+        const uint64_t epoch = this->shared->SubscriptionEpoch();
+
+        auto snapshot = std::atomic_load(&this->subscribers);
+        if (snapshot && snapshot->epoch == epoch)
+          return snapshot;
+
+        const std::string &msgType = this->publisher.MsgTypeName();
+        const NodeShared::SubscriberInfo &info =
+          this->shared->CheckSubscriberInfo(this->publisher.Topic(), msgType);
+
+        auto newSnapshot =
+          std::make_shared<NodeSharedPrivate::SubscriberSnapshot>();
+        newSnapshot->epoch = epoch;
+        newSnapshot->haveRemote = info.haveRemote;
+
+        for (const auto &node : info.localHandlers)
+        {
+          for (const auto &handler : node.second)
+          {
+            if (!handler.second)
+            {
+              std::cerr << "Node::Publisher::Publish(): "
+                        << "NULL local subscription handler" << std::endl;
+              continue;
+            }
+
+            if (handler.second->TypeName() != kGenericMessageType &&
+                handler.second->TypeName() != msgType)
+            {
+              continue;
+            }
+
+            newSnapshot->localHandlers.push_back(handler.second);
+          }
+        }
+
+        for (const auto &node : info.rawHandlers)
+        {
+          for (const auto &handler : node.second)
+          {
+            const RawSubscriptionHandlerPtr &rawHandler = handler.second;
+
+            if (!rawHandler)
+            {
+              std::cerr << "Node::Publisher::Publish(): "
+                        << "NULL raw subscription handler" << std::endl;
+              continue;
+            }
+
+            if (rawHandler->TypeName() != kGenericMessageType &&
+                rawHandler->TypeName() != msgType)
+            {
+              continue;
+            }
+
+            newSnapshot->rawHandlers.push_back(rawHandler);
+          }
+        }
+
+        snapshot = newSnapshot;
+        std::atomic_store(&this->subscribers, snapshot);
+        return snapshot;
+      }
+
+      /// \brief Queue a message for the local and raw handlers of this
+      /// topic. The publish thread delivers it asynchronously.
+      /// \param[in] _subscribers The subscribers of this publisher.
+      /// \param[in] _msg The message for the local handlers, which get a copy
+      /// of it. nullptr if they use _sharedMsg or deserialize _buffer.
+      /// \param[in] _sharedMsg Immutable message for the local handlers,
+      /// shared without copying it, or nullptr.
+      /// \param[in] _buffer The serialized message for the raw handlers.
+      /// \param[in] _size The size of the serialized message (bytes).
+      public: void QueueLocal(
+        const std::shared_ptr<const NodeSharedPrivate::SubscriberSnapshot>
+          &_subscribers,
+        const ProtoMsg *_msg,
+        const std::shared_ptr<const ProtoMsg> &_sharedMsg,
+        const std::shared_ptr<char> &_buffer,
+        const std::size_t _size)
+      {
+        if (_subscribers->localHandlers.empty() &&
+            _subscribers->rawHandlers.empty())
+        {
+          return;
+        }
+
+        std::unique_ptr<NodeSharedPrivate::PublishMsgDetails> pubMsgDetails(
+          new NodeSharedPrivate::PublishMsgDetails);
+
+        // Create and populate the message information object.
+        pubMsgDetails->info.SetTopicAndPartition(this->publisher.Topic());
+        pubMsgDetails->info.SetType(this->publisher.MsgTypeName());
+        pubMsgDetails->info.SetIntraProcess(true);
+
+        // The handlers and the buffer are shared by reference, they are not
+        // copied.
+        pubMsgDetails->subscribers = _subscribers;
+        pubMsgDetails->sharedBuffer = _buffer;
+        pubMsgDetails->msgSize = _size;
+
+        // Copy the message for the local handlers. This copy is necessary to
+        // facilitate asynchronous publication, unless the message is
+        // immutable. All the local handlers share the same instance.
+        if (_sharedMsg)
+        {
+          pubMsgDetails->localMsg = _sharedMsg;
+        }
+        else if (_msg && !_subscribers->localHandlers.empty())
+        {
+          ProtoMsg *msgCopy = _msg->New();
+          msgCopy->CopyFrom(*_msg);
+          pubMsgDetails->localMsg.reset(msgCopy);
+        }
+
+        // Add the publish message details to the publish queue. The message
+        // will be published asynchronously to the local and raw callbacks.
+        if (!this->shared->dataPtr->pubQueue->Push(std::move(pubMsgDetails)) &&
+            this->shared->verbose)
+        {
+          std::cerr << "Node::Publisher::Publish(): Publish queue full, "
+                    << "message dropped on topic [" << this->publisher.Topic()
+                    << "]" << std::endl;
+        }
+      }
+
+      /// \brief Publish a message.
+      /// \param[in] _msg The message.
+      /// \param[in] _sharedMsg If not null, the local handlers share this
+      /// immutable message instead of a copy of _msg. It must point to _msg.
+      /// \return true when success.
+      public: bool Publish(const ProtoMsg &_msg,
+                           const std::shared_ptr<const ProtoMsg> &_sharedMsg)
+      {
+        if (!this->Valid())
+          return false;
+
+        const std::string &publisherMsgType = this->publisher.MsgTypeName();
+
+        // Check that the msg type matches the topic type previously
+        // advertised.
+        if (publisherMsgType != _msg.GetTypeName())
+        {
+          std::cerr << "Node::Publisher::Publish() Type mismatch.\n"
+                    << "\t* Type advertised: "
+                    << this->publisher.MsgTypeName()
+                    << "\n\t* Type published: " << _msg.GetTypeName()
+                    << std::endl;
+          return false;
+        }
+
+        // Check the publication throttling option.
+        if (!this->UpdateThrottling())
+          return true;
+
+        const auto subscribers = this->Subscribers();
+
+        // The serialized message size and buffer.
+#if GOOGLE_PROTOBUF_VERSION < 3001000
+        const std::size_t msgSize =
+          static_cast<std::size_t>(_msg.ByteSize());
+#else
+        // ByteSizeLong appeared in version 3.1 of Protobuf, and ByteSize
+        // became deprecated.
+        const std::size_t msgSize =
+          static_cast<std::size_t>(_msg.ByteSizeLong());
+#endif
+        std::shared_ptr<char> msgBuffer;
+
+        // Only serialize the message if we have a raw subscriber or a remote
+        // subscriber. The same buffer is shared by both of them.
+        if (!subscribers->rawHandlers.empty() || subscribers->haveRemote)
+        {
+          msgBuffer = this->shared->dataPtr->bufferPool->Acquire(msgSize);
+
+          // Fail out early if we are unable to serialize the message. We do
+          // not want to send a corrupt/bad message to some subscribers and
+          // not others.
+          if (!_msg.SerializeToArray(msgBuffer.get(),
+                static_cast<int>(msgSize)))
+          {
+            std::cerr << "Node::Publisher::Publish(): Error serializing data"
+                      << std::endl;
+            return false;
+          }
+        }
+
+        // Local and raw subscribers.
+        this->QueueLocal(subscribers, _sharedMsg ? nullptr : &_msg,
+            _sharedMsg, msgBuffer, msgSize);
+
+        // Handle remote subscribers.
+        if (subscribers->haveRemote)
+          return this->PublishRemote(msgBuffer, msgSize);
+
+        return true;
+      }
+
+      /// \brief Send a serialized message to the remote subscribers.
+      /// ZeroMQ keeps a reference to the buffer until the message is sent.
+      /// \param[in] _buffer The serialized message.
+      /// \param[in] _size The size of the serialized message (bytes).
+      /// \return True on success.
+      public: bool PublishRemote(const std::shared_ptr<char> &_buffer,
+                                 const std::size_t _size)
+      {
+        // Zmq will call this lambda when the message is published.
+        // We use it to release our reference to the buffer.
+        auto myDeallocator = [](void *, void *_hint)
+        {
+          delete reinterpret_cast<std::shared_ptr<char> *>(_hint);
+        };
+
+        return this->shared->dataPtr->Publish(this->topicId, _buffer.get(),
+            _size, myDeallocator, new std::shared_ptr<char>(_buffer), "");
+      }
+
       /// \brief Pointer to the object shared between all the nodes within the
       /// same process.
       public: NodeShared *shared = nullptr;
@@ -185,6 +414,9 @@ namespace ignition
       /// \brief The message publisher.
       public: MessagePublisher publisher;
 
+      /// \brief Identifier of the topic and type of the publisher.
+      public: TopicId topicId = 0;
+
       /// \brief Timestamp of the last callback executed.
       public: Timestamp lastCbTimestamp;
 
@@ -194,6 +426,11 @@ namespace ignition
 
       /// \brief Mutex to protect the node::publisher from race conditions.
       public: mutable std::mutex mutex;
+
+      /// \brief Cached subscribers of this publisher. Accessed atomically,
+      /// since copies of a publisher share it.
+      public: std::shared_ptr<const NodeSharedPrivate::SubscriberSnapshot>
+        subscribers;
     };
     }
   }
@@ -246,8 +483,6 @@ bool Node::Publisher::HasConnections() const
   const std::string &topic = publisher.Topic();
   const std::string &msgType = publisher.MsgTypeName();
 
-  std::lock_guard<std::recursive_mutex> lk(this->dataPtr->shared->mutex);
-
   /// \todo(anyone): Checking "remoteSubscribers.HasTopic()" will return
   /// true even
   /// if the subscriber has not successfully authenticated with the
@@ -261,166 +496,57 @@ bool Node::Publisher::HasConnections() const
 //////////////////////////////////////////////////
 bool Node::Publisher::Publish(const ProtoMsg &_msg)
 {
-  if (!this->Valid())
-    return false;
-
-  const std::string &publisherMsgType = this->dataPtr->publisher.MsgTypeName();
+  return this->dataPtr->Publish(_msg, nullptr);
+}
 
-  // Check that the msg type matches the topic type previously advertised.
-  if (publisherMsgType != _msg.GetTypeName())
+//////////////////////////////////////////////////
+bool Node::Publisher::Publish(const std::shared_ptr<const ProtoMsg> &_msg)
+{
+  if (!_msg)
   {
-    std::cerr << "Node::Publisher::Publish() Type mismatch.\n"
-              << "\t* Type advertised: "
-              << this->dataPtr->publisher.MsgTypeName()
-              << "\n\t* Type published: " << _msg.GetTypeName() << std::endl;
+    std::cerr << "Node::Publisher::Publish(): NULL message" << std::endl;
     return false;
   }
 
-  // Check the publication throttling option.
-  if (!this->UpdateThrottling())
-    return true;
+  return this->dataPtr->Publish(*_msg, _msg);
+}
 
-  const std::string &publisherTopic = this->dataPtr->publisher.Topic();
+//////////////////////////////////////////////////
+std::shared_ptr<char> Node::Publisher::Loan(const std::size_t _size)
+{
+  if (!this->Valid())
+    return nullptr;
 
-  const NodeShared::SubscriberInfo &subscribers =
-      this->dataPtr->shared->CheckSubscriberInfo(
-        publisherTopic, publisherMsgType);
+  return this->dataPtr->shared->dataPtr->bufferPool->Acquire(_size);
+}
 
-  // The serialized message size and buffer.
-#if GOOGLE_PROTOBUF_VERSION < 3001000
-  const std::size_t msgSize = static_cast<std::size_t>(_msg.ByteSize());
-#else
-  // ByteSizeLong appeared in version 3.1 of Protobuf, and ByteSize
-  // became deprecated.
-  const std::size_t msgSize = static_cast<std::size_t>(_msg.ByteSizeLong());
-#endif
-  char *msgBuffer = nullptr;
+//////////////////////////////////////////////////
+bool Node::Publisher::PublishLoaned(std::shared_ptr<char> _buffer,
+    const std::size_t _size)
+{
+  if (!this->Valid())
+    return false;
 
-  // Only serialize the message if we have a raw subscriber or a remote
-  // subscriber.
-  if (subscribers.haveRaw || subscribers.haveRemote)
+  if (!_buffer || BufferPool::Capacity(_buffer) < _size)
   {
-    // Allocate the buffer to store the serialized data.
-    msgBuffer = static_cast<char *>(new char[msgSize]);
-
-    // Fail out early if we are unable to serialize the message. We do not
-    // want to send a corrupt/bad message to some subscribers and not others.
-    if (!_msg.SerializeToArray(msgBuffer, msgSize))
-    {
-      delete[] msgBuffer;
-      std::cerr << "Node::Publisher::Publish(): Error serializing data"
-                << std::endl;
-      return false;
-    }
+    std::cerr << "Node::Publisher::PublishLoaned(): The buffer was not "
+              << "obtained with Loan() or it is smaller than the message"
+              << std::endl;
+    return false;
   }
 
-  // Local and raw subscribers.
-  if (subscribers.haveLocal || subscribers.haveRaw)
-  {
-    std::unique_ptr<NodeSharedPrivate::PublishMsgDetails> pubMsgDetails(
-      new NodeSharedPrivate::PublishMsgDetails);
-
-    // Create and populate the message information object.
-    // This must be a shared pointer so that we can pass it to
-    // multiple threads below, and then allow this function to go
-    // out of scope.
-    pubMsgDetails->info.SetTopicAndPartition(this->dataPtr->publisher.Topic());
-    pubMsgDetails->info.SetType(this->dataPtr->publisher.MsgTypeName());
-    pubMsgDetails->info.SetIntraProcess(true);
-
-    pubMsgDetails->msgCopy.reset(_msg.New());
-    pubMsgDetails->msgCopy->CopyFrom(_msg);
-
-    if (subscribers.haveLocal)
-    {
-      for (const std::pair<std::string, ISubscriptionHandler_M> &node :
-           subscribers.localHandlers)
-      {
-        for (const std::pair<std::string, ISubscriptionHandlerPtr> &handler :
-             node.second)
-        {
-          if (!handler.second)
-          {
-            std::cerr << "Node::Publisher::Publish(): "
-                      << "NULL local subscription handler" << std::endl;
-            continue;
-          }
-
-          if (handler.second->TypeName() != kGenericMessageType &&
-              handler.second->TypeName() != _msg.GetTypeName())
-          {
-            continue;
-          }
-
-          pubMsgDetails->localHandlers.push_back(handler.second);
-        }
-      }
-    }
-
-    if (subscribers.haveRaw)
-    {
-      for (auto &node : subscribers.rawHandlers)
-      {
-        for (auto &handler : node.second)
-        {
-          const RawSubscriptionHandlerPtr &rawHandler = handler.second;
-
-          if (!rawHandler)
-          {
-            std::cerr << "Node::Publisher::Publish(): "
-                      << "NULL raw subscription handler" << std::endl;
-            continue;
-          }
+  // Check the publication throttling option.
+  if (!this->UpdateThrottling())
+    return true;
 
-          if (rawHandler->TypeName() != kGenericMessageType &&
-              rawHandler->TypeName() != _msg.GetTypeName())
-          {
-            continue;
-          }
+  const auto subscribers = this->dataPtr->Subscribers();
 
-          if (!pubMsgDetails->sharedBuffer)
-          {
-            pubMsgDetails->msgSize = msgSize;
-            // If the sharedBuffer has not been created, do so now.
-            pubMsgDetails->sharedBuffer.reset(new char[msgSize]);
-            memcpy(pubMsgDetails->sharedBuffer.get(), msgBuffer, msgSize);
-          }
-          pubMsgDetails->rawHandlers.push_back(rawHandler);
-        }
-      }
-    }
-
-    // Add the publish message details to the publish queue. The message
-    // will be published asynchronously to the local and raw callbacks.
-    {
-      std::unique_lock<std::mutex> queueLock(
-          this->dataPtr->shared->dataPtr->pubThreadMutex);
-      this->dataPtr->shared->dataPtr->pubQueue.push(std::move(pubMsgDetails));
-    }
-
-    this->dataPtr->shared->dataPtr->signalNewPub.notify_one();
-  }
+  // Local and raw subscribers. The local ones will deserialize the buffer.
+  this->dataPtr->QueueLocal(subscribers, nullptr, nullptr, _buffer, _size);
 
   // Handle remote subscribers.
-  if (subscribers.haveRemote)
-  {
-    // Zmq will call this lambda when the message is published.
-    // We use it to deallocate the buffer.
-    auto myDeallocator = [](void *_buffer, void *)
-    {
-      delete[] reinterpret_cast<char*>(_buffer);
-    };
-
-    if (!this->dataPtr->shared->Publish(this->dataPtr->publisher.Topic(),
-          msgBuffer, msgSize, myDeallocator, _msg.GetTypeName()))
-    {
-      return false;
-    }
-  }
-  else
-  {
-    delete[] msgBuffer;
-  }
+  if (subscribers->haveRemote)
+    return this->dataPtr->PublishRemote(_buffer, _size);
 
   return true;
 }
@@ -472,10 +598,11 @@ bool Node::Publisher::PublishRaw(
       delete[] reinterpret_cast<char*>(_buffer);
     };
 
-    // Note: This will copy _msgData (i.e. not zero copy)
-    if (!this->dataPtr->shared->Publish(
-          this->dataPtr->publisher.Topic(),
-          msgBuffer, msgSize, myDeallocator, _msgType))
+    // Note: This will copy _msgData (i.e. not zero copy). A publisher of
+    // the generic type also sends the actual type.
+    if (!this->dataPtr->shared->dataPtr->Publish(this->dataPtr->topicId,
+          msgBuffer, msgSize, myDeallocator, nullptr,
+          _msgType == publisherMsgType ? "" : _msgType))
     {
       return false;
     }
@@ -596,6 +723,11 @@ bool Node::Unsubscribe(const std::string &_topic)
     return false;
   }
 
+  // Discard the pending callbacks of the subscriptions being removed and
+  // wait for the ones in progress. This is done before taking the mutex, a
+  // callback in progress might need it.
+  this->dataPtr->ReleaseExecutors(fullyQualifiedTopic);
+
   std::lock_guard<std::recursive_mutex> lk(this->dataPtr->shared->mutex);
 
   // Remove the subscribers for the given topic that belong to this node.
@@ -609,8 +741,20 @@ bool Node::Unsubscribe(const std::string &_topic)
   if (!this->dataPtr->shared->localSubscribers
       .HasSubscriber(fullyQualifiedTopic))
   {
-    this->dataPtr->shared->dataPtr->subscriber->setsockopt(
-      ZMQ_UNSUBSCRIBE, fullyQualifiedTopic.data(), fullyQualifiedTopic.size());
+    auto &sharedPrivate = this->dataPtr->shared->dataPtr;
+    std::lock_guard<std::mutex> subLk(sharedPrivate->subscriberMutex);
+
+    // There is one filter per reference to each identifier of the topic.
+    for (const auto &id : sharedPrivate->topicIds.Remove(fullyQualifiedTopic))
+    {
+      char filter[kTopicIdSize];
+      EncodeTopicId(id.first, filter);
+      for (unsigned int i = 0; i < id.second; ++i)
+      {
+        sharedPrivate->subscriber->setsockopt(
+          ZMQ_UNSUBSCRIBE, filter, sizeof(filter));
+      }
+    }
   }
 
   // Notify to the publishers that I am no longer interested in the topic.
@@ -699,23 +843,34 @@ bool Node::UnadvertiseSrv(const std::string &_topic)
     return false;
   }
 
-  std::lock_guard<std::recursive_mutex> lk(this->dataPtr->shared->mutex);
+  // Remove the REP handlers of this node while holding the mutex, so the
+  // reception thread doesn't find them anymore. Their threads are stopped
+  // afterwards without the mutex, a request in progress might need it.
+  std::map<std::string, std::map<std::string, IRepHandlerPtr>> handlers;
+  bool unadvertised;
+  {
+    std::lock_guard<std::recursive_mutex> lk(this->dataPtr->shared->mutex);
+    this->dataPtr->shared->repliers.Handlers(fullyQualifiedTopic, handlers);
 
-  // Remove the topic from the list of advertised topics in this node.
-  this->dataPtr->srvsAdvertised.erase(fullyQualifiedTopic);
+    // Remove the topic from the list of advertised topics in this node.
+    this->dataPtr->srvsAdvertised.erase(fullyQualifiedTopic);
 
-  // Remove all the REP handlers for this node.
-  this->dataPtr->shared->repliers.RemoveHandlersForNode(
-    fullyQualifiedTopic, this->dataPtr->nUuid);
+    // Remove all the REP handlers for this node.
+    this->dataPtr->shared->repliers.RemoveHandlersForNode(
+      fullyQualifiedTopic, this->dataPtr->nUuid);
 
-  // Notify the discovery service to unregister and unadvertise my services.
-  if (!this->dataPtr->shared->dataPtr->srvDiscovery->Unadvertise(
-        fullyQualifiedTopic, this->dataPtr->nUuid))
-  {
-    return false;
+    // Notify the discovery service to unregister and unadvertise my
+    // services.
+    unadvertised = this->dataPtr->shared->dataPtr->srvDiscovery->Unadvertise(
+      fullyQualifiedTopic, this->dataPtr->nUuid);
   }
 
-  return true;
+  // Stop the threads of the REP handlers, if any, and wait for the requests
+  // in progress.
+  for (auto const &handler : handlers[this->dataPtr->nUuid])
+    this->dataPtr->shared->dataPtr->executors->Release(handler.first);
+
+  return unadvertised;
 }
 
 //////////////////////////////////////////////////
@@ -792,15 +947,20 @@ bool Node::SubscribeRaw(
     return false;
   }
 
+  // Subscriptions without an executor use the one of the node.
+  SubscribeOptions opts(_opts);
+  if (opts.Executor() == Executor_t::DEFAULT)
+    opts.SetExecutor(this->Options().Executor());
+
   const std::shared_ptr<RawSubscriptionHandler> handlerPtr =
       std::make_shared<RawSubscriptionHandler>(
-        this->dataPtr->nUuid, _msgType, _opts);
+        this->dataPtr->nUuid, _msgType, opts);
 
   handlerPtr->SetCallback(_callback);
 
   std::lock_guard<std::recursive_mutex> lk(this->dataPtr->shared->mutex);
 
-  this->dataPtr->shared->localSubscribers.raw.AddHandler(
+  this->dataPtr->shared->AddSubscriptionHandler(
         fullyQualifiedTopic, this->dataPtr->nUuid, handlerPtr);
 
   return this->dataPtr->SubscribeHelper(fullyQualifiedTopic);
@@ -972,9 +1132,51 @@ Node::Publisher Node::Advertise(const std::string &_topic,
   return Publisher(publisher);
 }
 
+//////////////////////////////////////////////////
+/// \brief Get the UUIDs and executors of the handlers registered by a node
+/// for a topic.
+/// \param[in] _storage The handlers.
+/// \param[in] _topic Fully qualified topic name.
+/// \param[in] _nUuid Node UUID.
+/// \param[out] _executors The executor of each handler UUID.
+template<typename T>
+static void nodeExecutors(const HandlerStorage<T> &_storage,
+    const std::string &_topic, const std::string &_nUuid,
+    std::map<std::string, Executor_t> &_executors)
+{
+  std::map<std::string, std::map<std::string, std::shared_ptr<T>>> handlers;
+  if (!_storage.Handlers(_topic, handlers) ||
+      handlers.find(_nUuid) == handlers.end())
+  {
+    return;
+  }
+
+  for (auto const &handler : handlers[_nUuid])
+    _executors[handler.first] = handler.second->Executor();
+}
+
+//////////////////////////////////////////////////
+void NodePrivate::ReleaseExecutors(const std::string &_fullyQualifiedTopic)
+{
+  std::map<std::string, Executor_t> executors;
+  {
+    std::lock_guard<std::recursive_mutex> lk(this->shared->mutex);
+    nodeExecutors(this->shared->localSubscribers.normal,
+        _fullyQualifiedTopic, this->nUuid, executors);
+    nodeExecutors(this->shared->localSubscribers.raw, _fullyQualifiedTopic,
+        this->nUuid, executors);
+  }
+
+  for (auto const &executor : executors)
+    this->shared->dataPtr->executors->Release(executor.first);
+}
+
 //////////////////////////////////////////////////
 bool NodePrivate::SubscribeHelper(const std::string &_fullyQualifiedTopic)
 {
+  // The executors of the new subscriptions were set up when their handlers
+  // were stored (see NodeShared::AddSubscriptionHandler()).
+
   // Add the topic to the list of subscribed topics (if it was not before).
   this->topicsSubscribed.insert(_fullyQualifiedTopic);
 
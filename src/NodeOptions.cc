@@ -55,6 +55,8 @@ NodeOptions &NodeOptions::operator=(const NodeOptions &_other)
   this->SetNameSpace(_other.NameSpace());
   this->SetPartition(_other.Partition());
   this->dataPtr->topicsRemap = _other.dataPtr->topicsRemap;
+  this->dataPtr->executor = _other.dataPtr->executor;
+  this->dataPtr->responserPolicy = _other.dataPtr->responserPolicy;
   return *this;
 }
 
@@ -134,3 +136,27 @@ bool NodeOptions::TopicRemap(const std::string &_fromTopic,
 
   return topicIt != this->dataPtr->topicsRemap.end();
 }
+
+//////////////////////////////////////////////////
+void NodeOptions::SetExecutor(const Executor_t _executor)
+{
+  this->dataPtr->executor = _executor;
+}
+
+//////////////////////////////////////////////////
+Executor_t NodeOptions::Executor() const
+{
+  return this->dataPtr->executor;
+}
+
+//////////////////////////////////////////////////
+void NodeOptions::SetResponserPolicy(const ResponserPolicy_t _policy)
+{
+  this->dataPtr->responserPolicy = _policy;
+}
+
+//////////////////////////////////////////////////
+ResponserPolicy_t NodeOptions::ResponserPolicy() const
+{
+  return this->dataPtr->responserPolicy;
+}
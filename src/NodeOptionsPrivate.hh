@@ -23,6 +23,8 @@
 
 #include "ignition/transport/config.hh"
 #include "ignition/transport/NetUtils.hh"
+#include "ignition/transport/NodeOptions.hh"
+#include "ignition/transport/SubscribeOptions.hh"
 
 namespace ignition
 {
@@ -50,6 +52,12 @@ namespace ignition
       /// \brief Table of remappings. The key is the original topic name and
       /// its value is the new topic name to be used instead.
       public: std::map<std::string, std::string> topicsRemap;
+
+      /// \brief Executor of the subscriptions that don't set one.
+      public: Executor_t executor = Executor_t::DEFAULT;
+
+      /// \brief How the service requests choose a responser.
+      public: ResponserPolicy_t responserPolicy = ResponserPolicy_t::FIRST;
     };
     }
   }
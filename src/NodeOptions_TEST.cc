@@ -72,6 +72,22 @@ TEST(NodeOptionsTest, accessors)
   EXPECT_EQ(opts.Partition(), defaultPartition);
   EXPECT_TRUE(opts.SetPartition(aPartition));
   EXPECT_EQ(opts.Partition(), aPartition);
+
+  // Executor.
+  EXPECT_EQ(opts.Executor(), transport::Executor_t::DEFAULT);
+  opts.SetExecutor(transport::Executor_t::POOL);
+  EXPECT_EQ(opts.Executor(), transport::Executor_t::POOL);
+  transport::NodeOptions opts2(opts);
+  EXPECT_EQ(opts2.Executor(), transport::Executor_t::POOL);
+
+  // Responser policy.
+  EXPECT_EQ(opts.ResponserPolicy(), transport::ResponserPolicy_t::FIRST);
+  opts.SetResponserPolicy(transport::ResponserPolicy_t::LEAST_OUTSTANDING);
+  EXPECT_EQ(opts.ResponserPolicy(),
+    transport::ResponserPolicy_t::LEAST_OUTSTANDING);
+  transport::NodeOptions opts3(opts);
+  EXPECT_EQ(opts3.ResponserPolicy(),
+    transport::ResponserPolicy_t::LEAST_OUTSTANDING);
 }
 
 //////////////////////////////////////////////////
@@ -50,6 +50,12 @@ namespace ignition
       /// \sa TopicUtils::FullyQualifiedName
       public: bool SubscribeHelper(const std::string &_fullyQualifiedTopic);
 
+      /// \brief Release the executors of the subscriptions of this node to
+      /// a topic, waiting for their callbacks in progress. The caller must
+      /// not hold the mutex of NodeShared.
+      /// \param[in] _fullyQualifiedTopic Fully qualified topic name.
+      public: void ReleaseExecutors(const std::string &_fullyQualifiedTopic);
+
       /// \brief The list of topics subscribed by this node.
       public: std::unordered_set<std::string> topicsSubscribed;
 
@@ -23,13 +23,25 @@
 #pragma warning(pop)
 #endif
 
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
 #include <chrono>
+#include <cstdint>
+#include <cstdlib>
 #include <cstring>
+#include <deque>
 #include <iostream>
 #include <map>
+#include <memory>
 #include <mutex>
+#include <set>
 #include <string>
 #include <thread>
+#include <unordered_set>
 #include <vector>
 
 // TODO(anyone): Remove after fixing the warnings.
@@ -63,6 +75,10 @@ using namespace transport;
 
 const char kIgnAuthDomain[] = "ign-auth";
 
+// Request type of the messages that grant more chunks of a streamed
+// response, or stop it.
+const char kStreamCreditType[] = "ignition.transport.StreamCredit";
+
 // Enum that encapsulates the possible values for ZeroMQ's setsocketopt
 // for ZMQ_PLAIN_SERVER. A value of 1 enables
 // plain authentication server, and a value of 0 disables.
@@ -109,6 +125,132 @@ std::string receiveHelper(zmq::socket_t &_socket)
   return std::string(reinterpret_cast<char *>(msg.data()), msg.size());
 }
 
+//////////////////////////////////////////////////
+// Helper to receive all the messages queued in a socket without blocking.
+// Returns true if at least one message was received.
+bool drainHelper(zmq::socket_t &_socket)
+{
+  bool received = false;
+  try
+  {
+    zmq::message_t msg(0);
+    while (_socket.recv(&msg, ZMQ_DONTWAIT))
+      received = true;
+  }
+  catch(const zmq::error_t &_error)
+  {
+    std::cerr << "Error receiving from an internal socket: " << _error.what()
+              << std::endl;
+  }
+  return received;
+}
+
+//////////////////////////////////////////////////
+// Helper to parse the number of chunks granted by a stream credit frame.
+// Returns false if the frame isn't a positive decimal number. Numbers larger
+// than NodeSharedPrivate::MaxStreamCredits are saturated.
+bool creditsHelper(const std::string &_data, int &_credits)
+{
+  if (_data.empty() || _data.find_first_not_of("0123456789") !=
+      std::string::npos)
+  {
+    return false;
+  }
+
+  errno = 0;
+  const long long value = std::strtoll(_data.c_str(), nullptr, 10);
+  if (errno != ERANGE && value <= 0)
+    return false;
+
+  _credits = errno == ERANGE ? NodeSharedPrivate::MaxStreamCredits :
+    static_cast<int>(std::min<long long>(value,
+      NodeSharedPrivate::MaxStreamCredits));
+  return true;
+}
+
+//////////////////////////////////////////////////
+// Helper to monitor the connections of a socket. The events that make the
+// socket ready to send to a new peer are delivered to _monitor.
+void monitorHelper(zmq::socket_t &_socket, zmq::socket_t &_monitor,
+                   const std::string &_endpoint)
+{
+#ifdef ZMQ_EVENT_HANDSHAKE_SUCCEEDED
+  const int events = ZMQ_EVENT_CONNECTED | ZMQ_EVENT_HANDSHAKE_SUCCEEDED;
+#else
+  const int events = ZMQ_EVENT_CONNECTED;
+#endif
+
+  if (zmq_socket_monitor(static_cast<void *>(_socket), _endpoint.c_str(),
+        events) != 0)
+  {
+    std::cerr << "Unable to monitor socket connections. New service "
+              << "connections will be detected periodically" << std::endl;
+    return;
+  }
+  _monitor.connect(_endpoint.c_str());
+}
+
+//////////////////////////////////////////////////
+// Helper to get the inter-process endpoint used by the process identified by
+// _pUuid for publishing to subscribers running on the same host.
+std::string ipcEndpoint(const std::string &_pUuid)
+{
+  std::string dir;
+  if (!env("IGN_TRANSPORT_IPC_DIR", dir) || dir.empty())
+    dir = "/tmp";
+
+  return "ipc://" + dir + "/ign-transport-" + _pUuid + ".pub";
+}
+
+//////////////////////////////////////////////////
+// Helper to check whether the same host inter-process transport is enabled.
+bool ipcEnabled()
+{
+#ifdef _WIN32
+  return false;
+#else
+  std::string ignIpc;
+  return !env("IGN_TRANSPORT_IPC", ignIpc) || ignIpc != "0";
+#endif
+}
+
+//////////////////////////////////////////////////
+// Helper to select the endpoint used for receiving data from a publisher.
+// If the publisher runs on this host and it is bound to an inter-process
+// endpoint, we use it and skip the TCP stack. Otherwise, we fall back to the
+// TCP address advertised through discovery.
+std::string dataEndpoint(const MessagePublisher &_pub,
+  const std::string &_hostAddr)
+{
+  if (!ipcEnabled())
+    return _pub.Addr();
+
+  // The advertised address has the form tcp://<host>:<port>.
+  const std::string prefix = "tcp://";
+  const std::string &addr = _pub.Addr();
+  auto portPos = addr.rfind(':');
+  if (addr.compare(0, prefix.size(), prefix) != 0 ||
+      portPos == std::string::npos || portPos < prefix.size() ||
+      addr.substr(prefix.size(), portPos - prefix.size()) != _hostAddr)
+  {
+    return addr;
+  }
+
+#ifndef _WIN32
+  // The publisher might be running an older version or might have the
+  // inter-process transport disabled. Check that the endpoint exists.
+  std::string ipcEp = ipcEndpoint(_pub.PUuid());
+  struct stat st;
+  if (stat(ipcEp.c_str() + std::strlen("ipc://"), &st) == 0 &&
+      S_ISSOCK(st.st_mode))
+  {
+    return ipcEp;
+  }
+#endif
+
+  return addr;
+}
+
 //////////////////////////////////////////////////
 // Helper to send an authentication error. This is used by basic
 // authentication.
@@ -160,6 +302,73 @@ NodeShared::NodeShared()
   Uuid uuid;
   this->pUuid = uuid.ToString();
 
+  // Create the queue used to publish to local subscribers.
+  std::size_t pubQueueSize = NodeSharedPrivate::kDefaultPubQueueSize;
+  std::string pubQueueSizeStr;
+  if (env("IGN_TRANSPORT_PUB_QUEUE_SIZE", pubQueueSizeStr) &&
+      !PublishQueueSizeFromString(pubQueueSizeStr, pubQueueSize))
+  {
+    std::cerr << "Invalid IGN_TRANSPORT_PUB_QUEUE_SIZE ["
+              << pubQueueSizeStr << "]. Using the default value ["
+              << pubQueueSize << "]" << std::endl;
+  }
+
+  PublishQueuePolicy pubQueuePolicy = PublishQueuePolicy::BLOCK;
+  std::string pubQueuePolicyStr;
+  if (env("IGN_TRANSPORT_PUB_QUEUE_POLICY", pubQueuePolicyStr) &&
+      !PublishQueuePolicyFromString(pubQueuePolicyStr, pubQueuePolicy))
+  {
+    std::cerr << "Invalid IGN_TRANSPORT_PUB_QUEUE_POLICY ["
+              << pubQueuePolicyStr << "]. Using [block]" << std::endl;
+  }
+
+  this->dataPtr->pubQueue.reset(
+    new PublishQueue<std::unique_ptr<NodeSharedPrivate::PublishMsgDetails>>(
+      pubQueueSize, pubQueuePolicy));
+
+  // Limit the memory kept by the idle buffers of the loaned messages.
+  std::string bufferPoolSizeStr;
+  if (env("IGN_TRANSPORT_BUFFER_POOL_SIZE", bufferPoolSizeStr))
+  {
+    const std::size_t kMaxBufferPoolSize = 1024 * 1024 * 1024;
+    std::size_t bufferPoolSize = 0;
+    bool valid = !bufferPoolSizeStr.empty() &&
+      bufferPoolSizeStr.find_first_not_of("0123456789") == std::string::npos;
+    try
+    {
+      if (valid)
+        bufferPoolSize = std::stoull(bufferPoolSizeStr);
+    }
+    catch (...)
+    {
+      valid = false;
+    }
+
+    if (valid && bufferPoolSize <= kMaxBufferPoolSize)
+    {
+      this->dataPtr->bufferPool->SetMaxIdleBytes(bufferPoolSize);
+    }
+    else
+    {
+      std::cerr << "Invalid IGN_TRANSPORT_BUFFER_POOL_SIZE ["
+                << bufferPoolSizeStr << "]. Using the default value ["
+                << BufferPool::kDefaultMaxIdleBytes << "]" << std::endl;
+    }
+  }
+
+  // Create the executors used by the subscriptions with their own threads.
+  std::size_t executorThreads =
+    std::max(std::thread::hardware_concurrency(), 1u);
+  std::string executorThreadsStr;
+  if (env("IGN_TRANSPORT_EXECUTOR_THREADS", executorThreadsStr) &&
+      !PoolThreadsFromString(executorThreadsStr, executorThreads))
+  {
+    std::cerr << "Invalid IGN_TRANSPORT_EXECUTOR_THREADS ["
+              << executorThreadsStr << "]. Using the default value ["
+              << executorThreads << "]" << std::endl;
+  }
+  this->dataPtr->executors.reset(new Executors(executorThreads));
+
   // Initialize my discovery services.
   this->dataPtr->msgDiscovery.reset(
       new MsgDiscovery(this->pUuid, this->kMsgDiscPort));
@@ -168,13 +377,22 @@ NodeShared::NodeShared()
 
   // Initialize the 0MQ objects.
   if (!this->InitializeSockets())
+  {
+    // There won't be a publish thread, don't let the publishers block.
+    this->dataPtr->pubQueue->Close();
     return;
+  }
 
   if (this->verbose)
   {
     std::cout << "Current host address: " << this->hostAddr << std::endl;
     std::cout << "Process UUID: " << this->pUuid << std::endl;
     std::cout << "Bind at: [" << this->myAddress << "] for pub/sub\n";
+    if (!this->dataPtr->myIpcAddress.empty())
+    {
+      std::cout << "Bind at: [" << this->dataPtr->myIpcAddress
+                << "] for same host pub/sub\n";
+    }
     std::cout << "Bind at: [" << this->myControlAddress << "] for control\n";
     std::cout << "Bind at: [" << this->myReplierAddress << "] for srv. calls\n";
     std::cout << "Identity for receiving srv. requests: ["
@@ -219,8 +437,9 @@ NodeShared::~NodeShared()
   this->dataPtr->exit = true;
 
   // Notify the local pubthread and join.
-  this->dataPtr->signalNewPub.notify_all();
-  this->dataPtr->pubThread.join();
+  this->dataPtr->pubQueue->Close();
+  if (this->dataPtr->pubThread.joinable())
+    this->dataPtr->pubThread.join();
 
   // Wait for the service thread before exit.
   if (this->threadReception.joinable())
@@ -229,6 +448,9 @@ NodeShared::~NodeShared()
   // Wait for the authentication thread before exit.
   if (this->dataPtr->accessControlThread.joinable())
     this->dataPtr->accessControlThread.join();
+
+  // Stop the callbacks running on their own threads.
+  this->dataPtr->executors.reset();
 }
 
 //////////////////////////////////////////////////
@@ -242,7 +464,11 @@ void NodeShared::RunReceptionTask()
       {static_cast<void*>(*this->dataPtr->subscriber), 0, ZMQ_POLLIN, 0},
       {static_cast<void*>(*this->dataPtr->control), 0, ZMQ_POLLIN, 0},
       {static_cast<void*>(*this->dataPtr->replier), 0, ZMQ_POLLIN, 0},
-      {static_cast<void*>(*this->dataPtr->responseReceiver), 0, ZMQ_POLLIN, 0}
+      {static_cast<void*>(*this->dataPtr->responseReceiver), 0, ZMQ_POLLIN, 0},
+      {static_cast<void*>(*this->dataPtr->srvRepliesReceiver), 0, ZMQ_POLLIN,
+        0},
+      {static_cast<void*>(*this->dataPtr->requesterMonitor), 0, ZMQ_POLLIN, 0},
+      {static_cast<void*>(*this->dataPtr->replierMonitor), 0, ZMQ_POLLIN, 0}
     };
     try
     {
@@ -263,6 +489,29 @@ void NodeShared::RunReceptionTask()
       this->RecvSrvRequest();
     if (items[3].revents & ZMQ_POLLIN)
       this->RecvSrvResponse();
+    if (items[4].revents & ZMQ_POLLIN)
+    {
+      // Consume the notifications and send the pending replies.
+      drainHelper(*this->dataPtr->srvRepliesReceiver);
+      this->SendSrvReplies();
+    }
+
+    // A new connection might be ready for the requests and replies waiting
+    // for one. Try again on every connection event, and periodically in
+    // case an event was missed.
+    bool connected = false;
+    if (items[5].revents & ZMQ_POLLIN)
+      connected |= drainHelper(*this->dataPtr->requesterMonitor);
+    if (items[6].revents & ZMQ_POLLIN)
+      connected |= drainHelper(*this->dataPtr->replierMonitor);
+
+    if (connected || std::chrono::steady_clock::now() -
+        this->dataPtr->lastRetry >=
+          std::chrono::milliseconds(NodeSharedPrivate::Timeout))
+    {
+      this->RetryPendingSends();
+      this->ExpireRequests();
+    }
   }
 }
 
@@ -271,23 +520,43 @@ bool NodeShared::Publish(
     const std::string &_topic,
     char *_data,
     const size_t _dataSize, DeallocFunc *_ffn,
+    const std::string &_msgType,
+    void *_hint)
+{
+  return this->dataPtr->Publish(MakeTopicId(_topic, _msgType), _data,
+      _dataSize, _ffn, _hint, "");
+}
+
+//////////////////////////////////////////////////
+bool NodeSharedPrivate::Publish(
+    const TopicId _id,
+    char *_data,
+    const std::size_t _dataSize,
+    DeallocFunc *_ffn,
+    void *_hint,
     const std::string &_msgType)
 {
   try
   {
     // Create the messages.
-    // Note that we use zero copy for passing the message data (msg2).
-    zmq::message_t msg0(_topic.data(), _topic.size()),
-                   msg1(this->myAddress.data(), this->myAddress.size()),
-                   msg2(_data, _dataSize, _ffn, nullptr),
-                   msg3(_msgType.data(), _msgType.size());
+    // Note that we use zero copy for passing the message data (msg1).
+    zmq::message_t msg0(kTopicIdSize),
+                   msg1(_data, _dataSize, _ffn, _hint);
+    EncodeTopicId(_id, reinterpret_cast<char *>(msg0.data()));
 
     // Send the messages
-    std::lock_guard<std::recursive_mutex> lock(this->mutex);
-    this->dataPtr->publisher->send(msg0, ZMQ_SNDMORE);
-    this->dataPtr->publisher->send(msg1, ZMQ_SNDMORE);
-    this->dataPtr->publisher->send(msg2, ZMQ_SNDMORE);
-    this->dataPtr->publisher->send(msg3, 0);
+    std::lock_guard<std::mutex> lock(this->publisherMutex);
+    this->publisher->send(msg0, ZMQ_SNDMORE);
+    if (_msgType.empty())
+    {
+      this->publisher->send(msg1, 0);
+    }
+    else
+    {
+      zmq::message_t msg2(_msgType.data(), _msgType.size());
+      this->publisher->send(msg1, ZMQ_SNDMORE);
+      this->publisher->send(msg2, 0);
+    }
   }
   catch(const zmq::error_t& ze)
   {
@@ -302,47 +571,85 @@ bool NodeShared::Publish(
 void NodeShared::RecvMsgUpdate()
 {
   zmq::message_t msg(0);
-  std::string topic;
-  // std::string sender;
-  std::string data;
+  TopicId id = 0;
+  bool validId = false;
+  // The payload isn't copied, the callbacks share the ZeroMQ message.
+  auto data = std::make_shared<zmq::message_t>();
   std::string msgType;
-  HandlerInfo handlerInfo;
 
   {
-    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    std::lock_guard<std::mutex> lock(this->dataPtr->subscriberMutex);
 
     try
     {
       if (!this->dataPtr->subscriber->recv(&msg, 0))
         return;
-      topic = std::string(reinterpret_cast<char *>(msg.data()), msg.size());
-
-      // TODO(caguero): Use this as extra metadata for the subscriber.
-      if (!this->dataPtr->subscriber->recv(&msg, 0))
-        return;
-      // sender = std::string(reinterpret_cast<char *>(msg.data()), msg.size());
+      validId = DecodeTopicId(msg.data(), msg.size(), id);
 
-      if (!this->dataPtr->subscriber->recv(&msg, 0))
+      if (!this->dataPtr->subscriber->recv(data.get(), 0))
         return;
-      data = std::string(reinterpret_cast<char *>(msg.data()), msg.size());
 
-      if (!this->dataPtr->subscriber->recv(&msg, 0))
-        return;
-      msgType = std::string(reinterpret_cast<char *>(msg.data()), msg.size());
+      // The type is only sent when it isn't the one the identifier stands
+      // for.
+      if (data->more())
+      {
+        if (!this->dataPtr->subscriber->recv(&msg, 0))
+          return;
+        msgType = std::string(reinterpret_cast<char *>(msg.data()), msg.size());
+      }
     }
     catch(const zmq::error_t &_error)
     {
       std::cerr << "Error: " << _error.what() << std::endl;
       return;
     }
+  }
 
-    handlerInfo = this->CheckHandlerInfo(topic);
+  if (!validId)
+    return;
+
+  // Find the topic and the handlers of the identifier. They're cached until
+  // a subscription changes.
+  const uint64_t version = this->dataPtr->topicIds.Version() +
+      this->localSubscribers.normal.Version() +
+      this->localSubscribers.raw.Version();
+  auto &cache = this->dataPtr->recvCache;
+  if (version != this->dataPtr->recvCacheVersion)
+  {
+    cache.clear();
+    this->dataPtr->recvCacheVersion = version;
   }
 
-  MessageInfo info;
-  info.SetTopicAndPartition(topic);
-  info.SetType(msgType);
-  this->TriggerCallbacks(info, data, handlerInfo);
+  auto it = cache.find(id);
+  if (it == cache.end())
+  {
+    std::string topic;
+    std::string type;
+    if (!this->dataPtr->topicIds.Find(id, topic, type))
+      return;
+
+    NodeSharedPrivate::RecvEntry entry;
+    entry.info.SetTopicAndPartition(topic);
+    entry.info.SetType(type);
+    entry.handlers = std::make_shared<const HandlerInfo>(
+        this->CheckHandlerInfo(topic));
+    it = cache.insert(std::make_pair(id, std::move(entry))).first;
+  }
+
+  const auto handlers = it->second.handlers;
+  if (msgType.empty())
+  {
+    this->TriggerCallbacks(it->second.info,
+        reinterpret_cast<char *>(data->data()), data->size(), data,
+        *handlers);
+  }
+  else
+  {
+    MessageInfo info(it->second.info);
+    info.SetType(msgType);
+    this->TriggerCallbacks(info, reinterpret_cast<char *>(data->data()),
+        data->size(), data, *handlers);
+  }
 }
 
 //////////////////////////////////////////////////
@@ -351,8 +658,8 @@ NodeShared::HandlerInfo NodeShared::CheckHandlerInfo(
 {
   HandlerInfo info;
 
-  std::lock_guard<std::recursive_mutex> lk(this->mutex);
-
+  // The handler storages are thread safe, don't take the shared mutex in
+  // the receive path.
   info.haveLocal = this->localSubscribers.normal.Handlers(
         _topic, info.localHandlers);
 
@@ -369,8 +676,8 @@ NodeShared::SubscriberInfo NodeShared::CheckSubscriberInfo(
 {
   SubscriberInfo info;
 
-  std::lock_guard<std::recursive_mutex> lk(this->mutex);
-
+  // The handler and topic storages are thread safe, don't take the shared
+  // mutex in the publish path.
   info.haveLocal = this->localSubscribers.normal.Handlers(
         _topic, info.localHandlers);
 
@@ -383,6 +690,15 @@ NodeShared::SubscriberInfo NodeShared::CheckSubscriberInfo(
   return info;
 }
 
+//////////////////////////////////////////////////
+uint64_t NodeShared::SubscriptionEpoch() const
+{
+  // The versions only grow, so does their sum.
+  return this->localSubscribers.normal.Version() +
+         this->localSubscribers.raw.Version() +
+         this->remoteSubscribers.Version();
+}
+
 //////////////////////////////////////////////////
 void NodeShared::TriggerSubscriberCallbacks(
     const std::string &_topic,
@@ -402,12 +718,28 @@ void NodeShared::TriggerCallbacks(
     const MessageInfo &_info,
     const std::string &_msgData,
     const HandlerInfo &_handlerInfo)
+{
+  this->TriggerCallbacks(_info, _msgData.data(), _msgData.size(), nullptr,
+      _handlerInfo);
+}
+
+//////////////////////////////////////////////////
+void NodeShared::TriggerCallbacks(
+    const MessageInfo &_info,
+    const char *_msgData,
+    const std::size_t _size,
+    const std::shared_ptr<const void> &_owner,
+    const HandlerInfo &_handlerInfo)
 {
   if (!_handlerInfo.haveLocal && !_handlerInfo.haveRaw)
     return;
 
   if (_handlerInfo.haveRaw)
   {
+    // The data shared by the deferred raw callbacks, if any.
+    std::shared_ptr<const void> owner = _owner;
+    const char *rawData = _msgData;
+
     for (const auto &node : _handlerInfo.rawHandlers)
     {
       for (const auto &handler : node.second)
@@ -418,8 +750,27 @@ void NodeShared::TriggerCallbacks(
           if (rawHandler->TypeName() == _info.Type() ||
               rawHandler->TypeName() == kGenericMessageType)
           {
-            rawHandler->RunRawCallback(_msgData.c_str(), _msgData.size(),
-                _info);
+            if (Executors::Inline(rawHandler->Executor()))
+            {
+              rawHandler->RunRawCallback(_msgData, _size, _info);
+              continue;
+            }
+
+            // The callback runs later. Without an owner keeping the data
+            // alive, it needs its own copy of it.
+            if (!owner)
+            {
+              auto copy = std::make_shared<const std::string>(
+                  _msgData, _size);
+              rawData = copy->data();
+              owner = copy;
+            }
+
+            this->dataPtr->executors->Post(rawHandler->HandlerUuid(),
+              [rawHandler, owner, rawData, _size, _info]()
+              {
+                rawHandler->RunRawCallback(rawData, _size, _info);
+              });
           }
         }
         else
@@ -433,7 +784,9 @@ void NodeShared::TriggerCallbacks(
     // This will be instantiated by the first suitable handler that we
     // encounter. If there is no suitable handler, then we can avoid
     // deserializing the message altogether.
-    std::shared_ptr<ProtoMsg> msg;
+    // The same immutable instance is shared by the typed and the generic
+    // handlers.
+    std::shared_ptr<const ProtoMsg> msg;
 
     for (const auto &node : _handlerInfo.localHandlers)
     {
@@ -450,7 +803,7 @@ void NodeShared::TriggerCallbacks(
               // If the message has not been deserialized yet, do it now since
               // we have allegedly found a subscriber which should be able to
               // do it.
-              msg = localHandler->CreateMsg(_msgData, _info.Type());
+              msg = localHandler->CreateMsg(_msgData, _size, _info.Type());
 
               if (!msg)
               {
@@ -463,7 +816,17 @@ void NodeShared::TriggerCallbacks(
               }
             }
 
-            localHandler->RunLocalCallback(*msg, _info);
+            if (Executors::Inline(localHandler->Executor()))
+            {
+              localHandler->RunLocalCallback(*msg, _info);
+              continue;
+            }
+
+            this->dataPtr->executors->Post(localHandler->HandlerUuid(),
+              [localHandler, msg, _info]()
+              {
+                localHandler->RunLocalCallback(*msg, _info);
+              });
           }
         }
         else
@@ -553,9 +916,7 @@ void NodeShared::RecvSrvRequest()
   std::string sender;
   std::string nodeUuid;
   std::string reqUuid;
-  std::string req;
-  std::string rep;
-  std::string resultStr;
+  std::vector<std::string> reqs;
   std::string dstId;
   std::string reqType;
   std::string repType;
@@ -593,7 +954,7 @@ void NodeShared::RecvSrvRequest()
 
       if (!this->dataPtr->replier->recv(&msg, 0))
         return;
-      req = std::string(reinterpret_cast<char *>(msg.data()), msg.size());
+      reqs.emplace_back(reinterpret_cast<char *>(msg.data()), msg.size());
 
       if (!this->dataPtr->replier->recv(&msg, 0))
         return;
@@ -602,6 +963,14 @@ void NodeShared::RecvSrvRequest()
       if (!this->dataPtr->replier->recv(&msg, 0))
         return;
       repType = std::string(reinterpret_cast<char *>(msg.data()), msg.size());
+
+      // The rest of the requests of a batch.
+      while (msg.more())
+      {
+        if (!this->dataPtr->replier->recv(&msg, 0))
+          return;
+        reqs.emplace_back(reinterpret_cast<char *>(msg.data()), msg.size());
+      }
     }
     catch(const zmq::error_t &_error)
     {
@@ -610,86 +979,353 @@ void NodeShared::RecvSrvRequest()
       return;
     }
 
+    // The requester of a streamed response grants more chunks or stops it.
+    // The data frame has the number of chunks, or nothing to stop.
+    if (reqType == kStreamCreditType)
+    {
+      std::shared_ptr<NodeSharedPrivate::SrvStream> stream;
+      {
+        std::lock_guard<std::mutex> lk(this->dataPtr->srvStreamsMutex);
+        auto it = this->dataPtr->srvStreams.find(dstId + reqUuid);
+        if (it != this->dataPtr->srvStreams.end())
+          stream = it->second;
+      }
+
+      int granted = 0;
+      if (!reqs.front().empty() && !creditsHelper(reqs.front(), granted))
+      {
+        std::cerr << "NodeShared::RecvSrvRequest() dropping malformed "
+                  << "stream credits [" << reqs.front() << "]" << std::endl;
+        return;
+      }
+
+      if (stream)
+      {
+        std::lock_guard<std::mutex> lk(stream->mutex);
+        if (reqs.front().empty())
+        {
+          stream->cancelled = true;
+        }
+        else
+        {
+          stream->credits = static_cast<int>(std::min<int64_t>(
+            static_cast<int64_t>(stream->credits) + granted,
+            NodeSharedPrivate::MaxStreamCredits));
+        }
+        stream->cv.notify_all();
+      }
+      return;
+    }
+
+    // The services running on their own threads were registered with the
+    // executors when advertised (see AddRepHandler()).
     hasHandler =
       this->repliers.FirstHandler(topic, reqType, repType, repHandler);
   }
 
-  // Get the REP handler.
-  if (hasHandler)
+  if (!hasHandler)
   {
-    // Run the service call and get the results.
-    bool result = repHandler->RunCallback(req, rep);
+    // std::cerr << "I do not have a service call registered for topic ["
+    //           << topic << "]\n";
+    return;
+  }
+
+  NodeSharedPrivate::SrvReply reply;
+  reply.sender = sender;
+  reply.dstId = dstId;
+  reply.topic = topic;
+  reply.nodeUuid = nodeUuid;
+  reply.reqUuid = reqUuid;
 
-    // If 'reptype' is msgs::Empty", this is a oneway request
-    // and we don't send response
-    if (repType == ignition::msgs::Empty().GetTypeName())
+  // If 'reptype' is msgs::Empty", this is a oneway request
+  // and we don't send response
+  const bool oneway = repType == ignition::msgs::Empty().GetTypeName();
+
+  NodeSharedPrivate *priv = this->dataPtr.get();
+
+  // Run a streamed response on the threads of the service. Each chunk is
+  // sent by the reception thread, and a chunk is only queued when the
+  // requester has room for it, so a slow requester slows down the service
+  // instead of piling up chunks in memory.
+  if (repHandler->IsStream())
+  {
+    auto stream = std::make_shared<NodeSharedPrivate::SrvStream>();
+    const std::string streamKey = dstId + reqUuid;
     {
-      return;
+      std::lock_guard<std::mutex> lk(this->dataPtr->srvStreamsMutex);
+      this->dataPtr->srvStreams[streamKey] = stream;
     }
 
-    if (result)
-      resultStr = "1";
-    else
-      resultStr = "0";
-
+    auto task = [priv, repHandler, stream, streamKey,
+                 reply = std::move(reply), req = reqs.front()]() mutable
     {
-      std::lock_guard<std::recursive_mutex> lock(this->mutex);
-      // I am still not connected to this address.
-      if (std::find(this->srvConnections.begin(), this->srvConnections.end(),
-            sender) == this->srvConnections.end())
+      bool result = false;
+      if (!priv->exit)
       {
-        this->dataPtr->replier->connect(sender.c_str());
-        this->srvConnections.push_back(sender);
-        std::this_thread::sleep_for(std::chrono::milliseconds(100));
-
-        if (this->verbose)
+        auto send = [priv, &stream, &reply](const std::string &_chunk)
         {
-          std::cout << "\t* Connected to [" << sender
-                    << "] for sending a response" << std::endl;
-        }
+          if (!priv->WaitStreamCredit(*stream))
+            return false;
+
+          NodeSharedPrivate::SrvReply chunk;
+          chunk.sender = reply.sender;
+          chunk.dstId = reply.dstId;
+          chunk.topic = reply.topic;
+          chunk.nodeUuid = reply.nodeUuid;
+          chunk.reqUuid = reply.reqUuid;
+          chunk.responses.emplace_back(_chunk, true);
+          chunk.chunk = true;
+          priv->QueueSrvReply(std::move(chunk), true);
+          return true;
+        };
+
+        result = repHandler->RunStreamCallback(req, send);
+      }
+
+      {
+        std::lock_guard<std::mutex> lk(priv->srvStreamsMutex);
+        priv->srvStreams.erase(streamKey);
+      }
+
+      // The requester doesn't wait for the end of a stream it stopped.
+      {
+        std::lock_guard<std::mutex> lk(stream->mutex);
+        if (stream->cancelled)
+          return;
+      }
+
+      // The end of the stream, after all its chunks.
+      reply.responses.emplace_back(std::string(), result);
+      reply.created = std::chrono::steady_clock::now();
+      priv->QueueSrvReply(std::move(reply), true);
+    };
+
+    if (!this->dataPtr->executors->Post(repHandler->HandlerUuid(),
+          std::move(task)))
+    {
+      std::cerr << "NodeShared::RecvSrvRequest() error: service [" << topic
+                << "] is no longer available" << std::endl;
+
+      std::lock_guard<std::mutex> lk(this->dataPtr->srvStreamsMutex);
+      this->dataPtr->srvStreams.erase(streamKey);
+    }
+    return;
+  }
+
+  // Run the service calls of the batch in order.
+  auto runCallbacks = [](const IRepHandlerPtr &_handler,
+                         const std::vector<std::string> &_reqs,
+                         NodeSharedPrivate::SrvReply &_reply)
+  {
+    _reply.responses.reserve(_reqs.size());
+    for (const auto &req : _reqs)
+    {
+      std::string rep;
+      const bool result = _handler->RunCallback(req, rep);
+      _reply.responses.emplace_back(std::move(rep), result);
+    }
+  };
+
+  // Run the service call on the reception thread.
+  if (repHandler->MaxConcurrency() == 0u)
+  {
+    runCallbacks(repHandler, reqs, reply);
+    if (oneway)
+      return;
+
+    this->dataPtr->QueueSrvReply(std::move(reply), false);
+    this->SendSrvReplies();
+    return;
+  }
+
+  // Run the service call on the threads of the service. The reply is sent
+  // by the reception thread once the call completes.
+  auto task = [priv, repHandler, oneway, runCallbacks,
+               reply = std::move(reply), reqs = std::move(reqs)]() mutable
+  {
+    if (priv->exit)
+      return;
+
+    runCallbacks(repHandler, reqs, reply);
+    if (!oneway)
+      priv->QueueSrvReply(std::move(reply), true);
+  };
+
+  if (!this->dataPtr->executors->Post(repHandler->HandlerUuid(),
+        std::move(task)))
+  {
+    std::cerr << "NodeShared::RecvSrvRequest() error: service [" << topic
+              << "] is no longer available" << std::endl;
+  }
+}
+
+//////////////////////////////////////////////////
+void NodeShared::SendSrvReplies()
+{
+  std::vector<NodeSharedPrivate::SrvReply> replies;
+  {
+    std::lock_guard<std::mutex> lk(this->dataPtr->srvRepliesMutex);
+    replies.swap(this->dataPtr->srvReplies);
+  }
+
+  // Replies whose destination isn't connected yet.
+  std::vector<NodeSharedPrivate::SrvReply> unsent;
+
+  for (auto &reply : replies)
+  {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+
+    // I am still not connected to this address. The reply is sent once the
+    // connection is ready.
+    if (std::find(this->srvConnections.begin(), this->srvConnections.end(),
+          reply.sender) == this->srvConnections.end())
+    {
+      this->dataPtr->replier->connect(reply.sender.c_str());
+      this->srvConnections.push_back(reply.sender);
+
+      if (this->verbose)
+      {
+        std::cout << "\t* Connected to [" << reply.sender
+                  << "] for sending a response" << std::endl;
       }
     }
 
     // Send the reply.
     try
     {
-      std::lock_guard<std::recursive_mutex> lock(this->mutex);
       zmq::message_t response;
 
-      response.rebuild(dstId.size());
-      memcpy(response.data(), dstId.data(), dstId.size());
+      response.rebuild(reply.dstId.size());
+      memcpy(response.data(), reply.dstId.data(), reply.dstId.size());
       this->dataPtr->replier->send(response, ZMQ_SNDMORE);
 
-      response.rebuild(topic.size());
-      memcpy(response.data(), topic.data(), topic.size());
+      response.rebuild(reply.topic.size());
+      memcpy(response.data(), reply.topic.data(), reply.topic.size());
       this->dataPtr->replier->send(response, ZMQ_SNDMORE);
 
-      response.rebuild(nodeUuid.size());
-      memcpy(response.data(), nodeUuid.data(), nodeUuid.size());
+      response.rebuild(reply.nodeUuid.size());
+      memcpy(response.data(), reply.nodeUuid.data(), reply.nodeUuid.size());
       this->dataPtr->replier->send(response, ZMQ_SNDMORE);
 
-      response.rebuild(reqUuid.size());
-      memcpy(response.data(), reqUuid.data(), reqUuid.size());
+      response.rebuild(reply.reqUuid.size());
+      memcpy(response.data(), reply.reqUuid.data(), reply.reqUuid.size());
       this->dataPtr->replier->send(response, ZMQ_SNDMORE);
 
-      response.rebuild(rep.size());
-      memcpy(response.data(), rep.data(), rep.size());
-      this->dataPtr->replier->send(response, ZMQ_SNDMORE);
-
-      response.rebuild(resultStr.size());
-      memcpy(response.data(), resultStr.data(), resultStr.size());
-      this->dataPtr->replier->send(response, 0);
+      // A response and a result per request of the batch.
+      for (std::size_t i = 0; i < reply.responses.size(); ++i)
+      {
+        const auto &rep = reply.responses[i].first;
+        response.rebuild(rep.size());
+        memcpy(response.data(), rep.data(), rep.size());
+        this->dataPtr->replier->send(response, ZMQ_SNDMORE);
+
+        // A chunk of a streamed response is marked with "c".
+        const std::string resultStr = reply.chunk ? "c" :
+          (reply.responses[i].second ? "1" : "0");
+        response.rebuild(resultStr.size());
+        memcpy(response.data(), resultStr.data(), resultStr.size());
+        this->dataPtr->replier->send(response,
+            i + 1 < reply.responses.size() ? ZMQ_SNDMORE : 0);
+      }
     }
     catch(const zmq::error_t &_error)
     {
-      std::cerr << "NodeShared::RecvSrvRequest() error sending response: "
-                << _error.what() << std::endl;
-      return;
+      const bool expired = std::chrono::steady_clock::now() - reply.created >
+        std::chrono::milliseconds(NodeSharedPrivate::ConnectTimeout);
+
+      if (_error.num() == EHOSTUNREACH && !expired)
+        unsent.push_back(std::move(reply));
+      else
+      {
+        std::cerr << "NodeShared::SendSrvReplies() error sending response: "
+                  << _error.what() << std::endl;
+      }
     }
   }
-  // else
-  //   std::cerr << "I do not have a service call registered for topic ["
-  //             << topic << "]\n";
+
+  if (unsent.empty())
+    return;
+
+  // Keep them ahead of the replies queued in the meantime.
+  std::lock_guard<std::mutex> lk(this->dataPtr->srvRepliesMutex);
+  this->dataPtr->srvReplies.insert(this->dataPtr->srvReplies.begin(),
+      std::make_move_iterator(unsent.begin()),
+      std::make_move_iterator(unsent.end()));
+}
+
+//////////////////////////////////////////////////
+void NodeShared::RetryPendingSends()
+{
+  this->dataPtr->lastRetry = std::chrono::steady_clock::now();
+
+  std::vector<NodeSharedPrivate::SrvKey> services;
+  {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    auto &unsent = this->dataPtr->unsentRequests;
+    for (auto it = unsent.begin(); it != unsent.end();)
+    {
+      if (this->dataPtr->lastRetry - it->second >
+          std::chrono::milliseconds(NodeSharedPrivate::ConnectTimeout))
+      {
+        std::cerr << "Unable to connect to the responser of service ["
+                  << std::get<0>(it->first) << "]" << std::endl;
+        it = unsent.erase(it);
+      }
+      else
+      {
+        services.push_back(it->first);
+        ++it;
+      }
+    }
+  }
+
+  for (const auto &service : services)
+  {
+    this->SendPendingRemoteReqs(std::get<0>(service), std::get<1>(service),
+        std::get<2>(service));
+  }
+
+  bool haveReplies;
+  {
+    std::lock_guard<std::mutex> lk(this->dataPtr->srvRepliesMutex);
+    haveReplies = !this->dataPtr->srvReplies.empty();
+  }
+
+  if (haveReplies)
+    this->SendSrvReplies();
+}
+
+//////////////////////////////////////////////////
+void NodeShared::SendStreamCredit(const std::string &_topic,
+  const std::string &_responserId, const std::string &_nodeUuid,
+  const uint64_t _reqId, const int _credits)
+{
+  // It travels like a request, so the responser finds the stream from the
+  // socket ID of the requester and the request identifier.
+  const std::string data = _credits > 0 ? std::to_string(_credits) : "";
+  const std::string myId = this->responseReceiverId.ToString();
+  const std::vector<std::string> frames = {_responserId, _topic,
+    this->myRequesterAddress, myId, _nodeUuid,
+    std::string(reinterpret_cast<const char *>(&_reqId), sizeof(_reqId)),
+    data, kStreamCreditType, ""};
+
+  std::lock_guard<std::recursive_mutex> lock(this->mutex);
+  try
+  {
+    zmq::message_t msg;
+    for (std::size_t i = 0; i < frames.size(); ++i)
+    {
+      msg.rebuild(frames[i].size());
+      memcpy(msg.data(), frames[i].data(), frames[i].size());
+      this->dataPtr->requester->send(msg,
+          i + 1 < frames.size() ? ZMQ_SNDMORE : 0);
+    }
+  }
+  catch(const zmq::error_t &_error)
+  {
+    std::cerr << "NodeShared::SendStreamCredit() error: " << _error.what()
+              << std::endl;
+  }
 }
 
 //////////////////////////////////////////////////
@@ -701,14 +1337,17 @@ void NodeShared::RecvSrvResponse()
   zmq::message_t msg(0);
   std::string topic;
   std::string nodeUuid;
-  std::string reqUuid;
-  std::string rep;
-  std::string resultStr;
-  bool result;
+  uint64_t reqId = 0;
+  std::vector<std::pair<std::string, bool>> reps;
+  bool chunk = false;
 
   IReqHandlerPtr reqHandlerPtr;
   bool hasHandler;
 
+  // Chunks of a streamed response granted to the responser.
+  int credits = 0;
+  std::string responserId;
+
   {
     std::lock_guard<std::recursive_mutex> lock(this->mutex);
 
@@ -727,16 +1366,24 @@ void NodeShared::RecvSrvResponse()
 
       if (!this->dataPtr->responseReceiver->recv(&msg, 0))
         return;
-      reqUuid = std::string(reinterpret_cast<char *>(msg.data()), msg.size());
-
-      if (!this->dataPtr->responseReceiver->recv(&msg, 0))
-        return;
-      rep = std::string(reinterpret_cast<char *>(msg.data()), msg.size());
+      if (msg.size() == sizeof(reqId))
+        memcpy(&reqId, msg.data(), sizeof(reqId));
 
-      if (!this->dataPtr->responseReceiver->recv(&msg, 0))
-        return;
-      resultStr = std::string(reinterpret_cast<char *>(msg.data()), msg.size());
-      result = resultStr == "1";
+      // A response and a result per request of the batch.
+      do
+      {
+        if (!this->dataPtr->responseReceiver->recv(&msg, 0))
+          return;
+        std::string rep(reinterpret_cast<char *>(msg.data()), msg.size());
+
+        if (!this->dataPtr->responseReceiver->recv(&msg, 0))
+          return;
+        std::string resultStr(reinterpret_cast<char *>(msg.data()),
+            msg.size());
+
+        chunk = resultStr == "c";
+        reps.emplace_back(std::move(rep), chunk || resultStr == "1");
+      } while (msg.more());
     }
     catch(const zmq::error_t &_error)
     {
@@ -745,27 +1392,80 @@ void NodeShared::RecvSrvResponse()
       return;
     }
 
-    hasHandler =
-      this->requests.Handler(topic, nodeUuid, reqUuid, reqHandlerPtr);
+    auto inflight = this->dataPtr->inflightRequests.find(reqId);
+    hasHandler = inflight != this->dataPtr->inflightRequests.end();
+    if (hasHandler && chunk)
+    {
+      // The request is still waiting for the rest of the stream. Grant
+      // more chunks once half of the window was received.
+      reqHandlerPtr = inflight->second.handler;
+      responserId = inflight->second.responserId;
+      if (++inflight->second.chunks >= NodeSharedPrivate::StreamWindow / 2)
+      {
+        credits = inflight->second.chunks;
+        inflight->second.chunks = 0;
+      }
+    }
+    else if (hasHandler)
+    {
+      reqHandlerPtr = inflight->second.handler;
+      this->dataPtr->responsers.OnResponse(inflight->second.responserId,
+          std::chrono::steady_clock::now() - inflight->second.sent);
+      if (!this->requests.RemoveHandler(inflight->second.topic,
+            reqHandlerPtr->NodeUuid(), reqHandlerPtr->HandlerUuid()))
+      {
+        std::cerr << "NodeShare::RecvSrvResponse(): "
+                  << "Error removing request handler" << std::endl;
+      }
+
+      this->dataPtr->inflightRequests.erase(inflight);
+    }
   }
 
-  if (hasHandler)
+  if (hasHandler && chunk)
   {
-    // Notify the result.
-    reqHandlerPtr->NotifyResult(rep, result);
+    if (reqHandlerPtr->NotifyChunk(reps.front().first))
+    {
+      // The chunks are granted again only after the callback took them.
+      if (credits > 0)
+      {
+        this->SendStreamCredit(topic, responserId, nodeUuid, reqId,
+            credits);
+      }
+      return;
+    }
 
-    // Remove the handler.
-    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    // The requester stopped the stream.
+    bool found;
     {
-      if (!this->requests.RemoveHandler(topic, nodeUuid, reqUuid))
+      std::lock_guard<std::recursive_mutex> lock(this->mutex);
+      auto inflight = this->dataPtr->inflightRequests.find(reqId);
+      found = inflight != this->dataPtr->inflightRequests.end();
+      if (found)
       {
-        std::cerr << "NodeShare::RecvSrvResponse(): "
-                  << "Error removing request handler" << std::endl;
+        this->dataPtr->responsers.OnResponse(responserId,
+            std::chrono::steady_clock::now() - inflight->second.sent);
+        this->requests.RemoveHandler(inflight->second.topic,
+            reqHandlerPtr->NodeUuid(), reqHandlerPtr->HandlerUuid());
+        this->dataPtr->inflightRequests.erase(inflight);
       }
     }
+
+    if (found)
+    {
+      this->SendStreamCredit(topic, responserId, nodeUuid, reqId, 0);
+      reqHandlerPtr->NotifyResult("", false);
+    }
   }
-  else
+  else if (hasHandler)
+  {
+    // Notify the results.
+    reqHandlerPtr->NotifyBatchResult(reps);
+  }
+  else if (!chunk)
   {
+    // Chunks still arrive for a while after their stream was stopped, so
+    // only the other responses are unexpected.
     std::cerr << "Received a service call response but I don't have a handler"
               << " for it" << std::endl;
   }
@@ -775,51 +1475,52 @@ void NodeShared::RecvSrvResponse()
 void NodeShared::SendPendingRemoteReqs(const std::string &_topic,
   const std::string &_reqType, const std::string &_repType)
 {
-  std::string responserAddr;
-  std::string responserId;
   SrvAddresses_M addresses;
   this->dataPtr->srvDiscovery->Publishers(_topic, addresses);
   if (addresses.empty())
     return;
 
-  // Find a publisher that offers this service with a particular pair of REQ/REP
-  // types.
-  bool found = false;
+  // Find the publishers that offer this service with a particular pair of
+  // REQ/REP types.
+  std::vector<ServicePublisher> responsers;
   for (auto &proc : addresses)
   {
-    auto &v = proc.second;
-    for (auto &pub : v)
+    for (auto &pub : proc.second)
     {
       if (pub.ReqTypeName() == _reqType && pub.RepTypeName() == _repType)
-      {
-        found = true;
-        responserAddr = pub.Addr();
-        responserId = pub.SocketId();
-        break;
-      }
+        responsers.push_back(pub);
     }
-    if (found)
-      break;
   }
 
-  if (!found)
+  if (responsers.empty())
     return;
 
-  if (verbose)
+  std::lock_guard<std::recursive_mutex> lock(this->mutex);
+
+  // When the requests were first held back because the connection wasn't
+  // ready.
+  const NodeSharedPrivate::SrvKey key(_topic, _reqType, _repType);
+  auto unsent = this->dataPtr->unsentRequests.find(key);
+  auto firstAttempt = std::chrono::steady_clock::now();
+  if (unsent != this->dataPtr->unsentRequests.end())
   {
-    std::cout << "Found a service call responser at ["
-              << responserAddr << "]" << std::endl;
+    firstAttempt = unsent->second;
+    this->dataPtr->unsentRequests.erase(unsent);
   }
 
-  std::lock_guard<std::recursive_mutex> lock(this->mutex);
-
-  // I am still not connected to this address.
-  if (std::find(this->srvConnections.begin(), this->srvConnections.end(),
-        responserAddr) == this->srvConnections.end())
+  // I am still not connected to some of the addresses. The requests for
+  // them are sent once the connection is ready.
+  for (const auto &responser : responsers)
   {
+    const std::string &responserAddr = responser.Addr();
+    if (std::find(this->srvConnections.begin(), this->srvConnections.end(),
+          responserAddr) != this->srvConnections.end())
+    {
+      continue;
+    }
+
     this->dataPtr->requester->connect(responserAddr.c_str());
     this->srvConnections.push_back(responserAddr);
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
     if (this->verbose)
     {
       std::cout << "\t* Connected to [" << responserAddr
@@ -827,92 +1528,261 @@ void NodeShared::SendPendingRemoteReqs(const std::string &_topic,
     }
   }
 
-  // Send all the pending REQs.
-  IReqHandler_M reqs;
-  if (!this->requests.Handlers(_topic, reqs))
+  // Send the pending REQs, in order.
+  auto queue = this->dataPtr->queuedRequests.find(_topic);
+  if (queue == this->dataPtr->queuedRequests.end())
     return;
 
-  for (auto &node : reqs)
+  auto &pending = queue->second;
+
+  // Requests with other types stay in the queue for another responser.
+  std::deque<NodeSharedPrivate::QueuedRequest> otherTypes;
+
+  while (!pending.empty())
   {
-    for (auto &req : node.second)
+    IReqHandlerPtr req = pending.front().handler;
+
+    // Check that the pending service call has types that match the responser.
+    if (req->ReqTypeName() != _reqType || req->RepTypeName() != _repType)
     {
-      // Check if this service call has been already requested.
-      if (req.second->Requested())
-        continue;
+      otherTypes.push_back(std::move(pending.front()));
+      pending.pop_front();
+      continue;
+    }
 
-      // Check that the pending service call has types that match the responser.
-      if (req.second->ReqTypeName() != _reqType ||
-          req.second->RepTypeName() != _repType)
+    std::vector<std::string> data;
+    if (!req->SerializeBatch(data))
+    {
+      pending.pop_front();
+      continue;
+    }
+
+    const std::size_t index = this->dataPtr->responsers.Select(_topic,
+        responsers, pending.front().policy);
+    const std::string responserId = responsers[index].SocketId();
+
+    if (verbose)
+    {
+      std::cout << "Sending a service call request to ["
+                << responsers[index].Addr() << "]" << std::endl;
+    }
+
+    auto nodeUuid = req->NodeUuid();
+    const uint64_t reqId = req->RequestId();
+
+    // A oneway request doesn't get a response.
+    const bool oneway = _repType == ignition::msgs::Empty().GetTypeName();
+    if (!oneway)
+      this->dataPtr->responsers.OnSent(responserId);
+
+    bool sent = true;
+    try
+    {
+      zmq::message_t msg;
+
+      msg.rebuild(responserId.size());
+      memcpy(msg.data(), responserId.data(), responserId.size());
+      this->dataPtr->requester->send(msg, ZMQ_SNDMORE);
+
+      msg.rebuild(_topic.size());
+      memcpy(msg.data(), _topic.data(), _topic.size());
+      this->dataPtr->requester->send(msg, ZMQ_SNDMORE);
+
+      msg.rebuild(this->myRequesterAddress.size());
+      memcpy(msg.data(), this->myRequesterAddress.data(),
+        this->myRequesterAddress.size());
+      this->dataPtr->requester->send(msg, ZMQ_SNDMORE);
+
+      std::string myId = this->responseReceiverId.ToString();
+      msg.rebuild(myId.size());
+      memcpy(msg.data(), myId.data(), myId.size());
+      this->dataPtr->requester->send(msg, ZMQ_SNDMORE);
+
+      msg.rebuild(nodeUuid.size());
+      memcpy(msg.data(), nodeUuid.data(), nodeUuid.size());
+      this->dataPtr->requester->send(msg, ZMQ_SNDMORE);
+
+      // The responser sends this frame back untouched, so the request
+      // identifier is enough to find the request when the response arrives.
+      msg.rebuild(sizeof(reqId));
+      memcpy(msg.data(), &reqId, sizeof(reqId));
+      this->dataPtr->requester->send(msg, ZMQ_SNDMORE);
+
+      msg.rebuild(data.front().size());
+      memcpy(msg.data(), data.front().data(), data.front().size());
+      this->dataPtr->requester->send(msg, ZMQ_SNDMORE);
+
+      msg.rebuild(_reqType.size());
+      memcpy(msg.data(), _reqType.data(), _reqType.size());
+      this->dataPtr->requester->send(msg, ZMQ_SNDMORE);
+
+      msg.rebuild(_repType.size());
+      memcpy(msg.data(), _repType.data(), _repType.size());
+      this->dataPtr->requester->send(msg,
+          data.size() > 1u ? ZMQ_SNDMORE : 0);
+
+      // The rest of the requests of a batch share the frames above.
+      for (std::size_t i = 1; i < data.size(); ++i)
       {
-        continue;
+        msg.rebuild(data[i].size());
+        memcpy(msg.data(), data[i].data(), data[i].size());
+        this->dataPtr->requester->send(msg,
+            i + 1 < data.size() ? ZMQ_SNDMORE : 0);
       }
+    }
+    catch(const zmq::error_t &_error)
+    {
+      if (!oneway)
+        this->dataPtr->responsers.OnFailed(responserId);
+      sent = false;
+
+      // The connection to the responser isn't ready yet. Try the other
+      // responsers, and if none is ready, keep this and the following
+      // requests pending until one is.
+      if (_error.num() == EHOSTUNREACH)
+      {
+        responsers.erase(responsers.begin() + index);
+        if (!responsers.empty())
+          continue;
 
-      // Mark the handler as requested.
-      req.second->Requested(true);
+        this->dataPtr->unsentRequests[key] = firstAttempt;
+        break;
+      }
 
-      std::string data;
-      if (!req.second->Serialize(data))
-        continue;
+      // Debug output.
+      // std::cerr << "Error connecting [" << _error.what() << "]\n";
+    }
 
-      auto nodeUuid = req.second->NodeUuid();
-      auto reqUuid = req.second->HandlerUuid();
+    pending.pop_front();
+    req->Requested(true);
 
-      try
-      {
-        zmq::message_t msg;
+    // Remove the handler associated to this service request. We won't
+    // receive a response because this is a oneway request.
+    if (oneway)
+    {
+      this->requests.RemoveHandler(_topic, nodeUuid, req->HandlerUuid());
+    }
+    else if (sent)
+    {
+      this->dataPtr->inflightRequests[reqId] = {_topic, req, responserId,
+          std::chrono::steady_clock::now()};
+    }
+  }
 
-        msg.rebuild(responserId.size());
-        memcpy(msg.data(), responserId.data(), responserId.size());
-        this->dataPtr->requester->send(msg, ZMQ_SNDMORE);
+  // Keep the original order of the requests left.
+  pending.insert(pending.begin(), otherTypes.begin(), otherTypes.end());
+  if (pending.empty())
+    this->dataPtr->queuedRequests.erase(queue);
+}
 
-        msg.rebuild(_topic.size());
-        memcpy(msg.data(), _topic.data(), _topic.size());
-        this->dataPtr->requester->send(msg, ZMQ_SNDMORE);
+//////////////////////////////////////////////////
+void NodeShared::AddSubscriptionHandler(const std::string &_topic,
+  const std::string &_nUuid, const ISubscriptionHandlerPtr &_handler)
+{
+  this->dataPtr->executors->Register(_handler->HandlerUuid(), _topic,
+      _handler->Executor());
+  this->localSubscribers.normal.AddHandler(_topic, _nUuid, _handler);
+}
 
-        msg.rebuild(this->myRequesterAddress.size());
-        memcpy(msg.data(), this->myRequesterAddress.data(),
-          this->myRequesterAddress.size());
-        this->dataPtr->requester->send(msg, ZMQ_SNDMORE);
+//////////////////////////////////////////////////
+void NodeShared::AddSubscriptionHandler(const std::string &_topic,
+  const std::string &_nUuid, const RawSubscriptionHandlerPtr &_handler)
+{
+  this->dataPtr->executors->Register(_handler->HandlerUuid(), _topic,
+      _handler->Executor());
+  this->localSubscribers.raw.AddHandler(_topic, _nUuid, _handler);
+}
 
-        std::string myId = this->responseReceiverId.ToString();
-        msg.rebuild(myId.size());
-        memcpy(msg.data(), myId.data(), myId.size());
-        this->dataPtr->requester->send(msg, ZMQ_SNDMORE);
+//////////////////////////////////////////////////
+void NodeShared::AddRepHandler(const std::string &_topic,
+  const std::string &_nUuid, const IRepHandlerPtr &_handler)
+{
+  // Streamed responses wait for the requester, so they always run on their
+  // own threads.
+  if (_handler->MaxConcurrency() > 0u || _handler->IsStream())
+  {
+    this->dataPtr->executors->Register(_handler->HandlerUuid(), _topic,
+        Executor_t::DEDICATED, std::max(1u, _handler->MaxConcurrency()));
+  }
 
-        msg.rebuild(nodeUuid.size());
-        memcpy(msg.data(), nodeUuid.data(), nodeUuid.size());
-        this->dataPtr->requester->send(msg, ZMQ_SNDMORE);
+  this->repliers.AddHandler(_topic, _nUuid, _handler);
+}
 
-        msg.rebuild(reqUuid.size());
-        memcpy(msg.data(), reqUuid.data(), reqUuid.size());
-        this->dataPtr->requester->send(msg, ZMQ_SNDMORE);
+//////////////////////////////////////////////////
+void NodeShared::AddRequest(const std::string &_topic,
+  const std::string &_nUuid, const IReqHandlerPtr &_handler,
+  const ResponserPolicy_t _policy)
+{
+  _handler->RequestId(this->dataPtr->nextRequestId++);
+  this->requests.AddHandler(_topic, _nUuid, _handler);
+  this->dataPtr->queuedRequests[_topic].push_back({_handler, _policy});
+}
 
-        msg.rebuild(data.size());
-        memcpy(msg.data(), data.data(), data.size());
-        this->dataPtr->requester->send(msg, ZMQ_SNDMORE);
+//////////////////////////////////////////////////
+bool NodeShared::AbandonRequest(const std::string &_topic,
+  const IReqHandlerPtr &_handler)
+{
+  std::lock_guard<std::recursive_mutex> lock(this->mutex);
 
-        msg.rebuild(_reqType.size());
-        memcpy(msg.data(), _reqType.data(), _reqType.size());
-        this->dataPtr->requester->send(msg, ZMQ_SNDMORE);
+  // The handler is removed once its response arrives.
+  if (!this->requests.RemoveHandler(_topic, _handler->NodeUuid(),
+        _handler->HandlerUuid()))
+  {
+    return false;
+  }
 
-        msg.rebuild(_repType.size());
-        memcpy(msg.data(), _repType.data(), _repType.size());
-        this->dataPtr->requester->send(msg, 0);
-      }
-      catch(const zmq::error_t& /*ze*/)
+  // The request might not have been sent yet.
+  auto queue = this->dataPtr->queuedRequests.find(_topic);
+  if (queue != this->dataPtr->queuedRequests.end())
+  {
+    auto &pending = queue->second;
+    pending.erase(std::remove_if(pending.begin(), pending.end(),
+      [&_handler](const NodeSharedPrivate::QueuedRequest &_queued)
       {
-        // Debug output.
-        // std::cerr << "Error connecting [" << ze.what() << "]\n";
-      }
+        return _queued.handler == _handler;
+      }), pending.end());
+    if (pending.empty())
+      this->dataPtr->queuedRequests.erase(queue);
+  }
 
-      // Remove the handler associated to this service request. We won't
-      // receive a response because this is a oneway request.
-      if (_repType == ignition::msgs::Empty().GetTypeName())
-      {
-        this->requests.RemoveHandler(_topic, nodeUuid, reqUuid);
-      }
+  auto inflight = this->dataPtr->inflightRequests.find(_handler->RequestId());
+  if (inflight != this->dataPtr->inflightRequests.end())
+  {
+    this->dataPtr->responsers.OnFailed(inflight->second.responserId);
+    this->dataPtr->inflightRequests.erase(inflight);
+  }
+
+  return true;
+}
+
+//////////////////////////////////////////////////
+void NodeShared::AddRequestTimeout(const std::string &_topic,
+  const IReqHandlerPtr &_handler, const unsigned int _timeout)
+{
+  this->dataPtr->requestDeadlines.emplace(std::chrono::steady_clock::now() +
+      std::chrono::milliseconds(_timeout), std::make_pair(_topic, _handler));
+}
+
+//////////////////////////////////////////////////
+void NodeShared::ExpireRequests()
+{
+  std::vector<IReqHandlerPtr> expired;
+  {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+    const auto now = std::chrono::steady_clock::now();
+    auto &deadlines = this->dataPtr->requestDeadlines;
+    while (!deadlines.empty() && deadlines.begin()->first <= now)
+    {
+      const auto &request = deadlines.begin()->second;
+      if (this->AbandonRequest(request.first, request.second))
+        expired.push_back(request.second);
+      deadlines.erase(deadlines.begin());
     }
   }
+
+  // Notify the handlers without holding the mutex, like the responses.
+  for (const auto &handler : expired)
+    handler->NotifyResult("", false);
 }
 
 //////////////////////////////////////////////////
@@ -938,20 +1808,40 @@ void NodeShared::OnNewConnection(const MessagePublisher &_pub)
   {
     try
     {
-      // Handle security
-      this->dataPtr->SecurityOnNewConnection();
+      {
+        std::lock_guard<std::mutex> subLk(this->dataPtr->subscriberMutex);
 
-      // I am not connected to the process.
-      if (!this->connections.HasPublisher(addr))
-        this->dataPtr->subscriber->connect(addr.c_str());
+        // Handle security
+        this->dataPtr->SecurityOnNewConnection();
 
-      // Add a new filter for the topic.
-      this->dataPtr->subscriber->setsockopt(ZMQ_SUBSCRIBE,
-          topic.data(), topic.size());
+        // I am not connected to the process.
+        if (!this->connections.HasPublisher(addr))
+        {
+          std::string dataAddr = dataEndpoint(_pub, this->hostAddr);
+          this->dataPtr->subscriber->connect(dataAddr.c_str());
 
-      int queueVal = 0;
-      this->dataPtr->subscriber->setsockopt(ZMQ_RCVHWM,
-          &queueVal, sizeof(queueVal));
+          if (this->verbose && dataAddr != addr)
+          {
+            std::cout << "\t* Using [" << dataAddr
+                      << "] for same host data\n";
+          }
+        }
+
+        // Add a new filter for the topic and type. Data messages start
+        // with their identifier.
+        TopicId id;
+        if (this->dataPtr->topicIds.Add(topic, type, id))
+        {
+          char filter[kTopicIdSize];
+          EncodeTopicId(id, filter);
+          this->dataPtr->subscriber->setsockopt(ZMQ_SUBSCRIBE,
+              filter, sizeof(filter));
+        }
+
+        int queueVal = 0;
+        this->dataPtr->subscriber->setsockopt(ZMQ_RCVHWM,
+            &queueVal, sizeof(queueVal));
+      }
 
       // Register the new connection with the publisher.
       this->connections.AddPublisher(_pub);
@@ -966,12 +1856,12 @@ void NodeShared::OnNewConnection(const MessagePublisher &_pub)
         std::cout << "\t* Connected to [" << ctrl << "] for control\n";
       }
 
+      // The messages are queued until the connection is ready, and the
+      // linger period lets them go out after the socket is closed.
       int lingerVal = 300;
       socket.setsockopt(ZMQ_LINGER, &lingerVal, sizeof(lingerVal));
       socket.connect(ctrl.c_str());
 
-      std::this_thread::sleep_for(std::chrono::milliseconds(100));
-
       std::vector<std::string> handlerNodeUuids =
           this->localSubscribers.NodeUuids(topic, _pub.MsgTypeName());
 
@@ -1064,13 +1954,13 @@ void NodeShared::OnNewSrvConnection(const ServicePublisher &_pub)
     std::cout << _pub;
   }
 
-  // I am still not connected to this address.
+  // I am still not connected to this address. The pending requests are
+  // sent once the connection is ready.
   if (std::find(this->srvConnections.begin(), this->srvConnections.end(),
         addr) == this->srvConnections.end())
   {
     this->dataPtr->requester->connect(addr.c_str());
     this->srvConnections.push_back(addr);
-    std::this_thread::sleep_for(std::chrono::milliseconds(100));
     if (this->verbose)
     {
       std::cout << "\t* Connected to [" << addr
@@ -1093,12 +1983,72 @@ void NodeShared::OnNewSrvDisconnection(const ServicePublisher &_pub)
 {
   std::string addr = _pub.Addr();
 
-  std::lock_guard<std::recursive_mutex> lock(this->mutex);
+  // Requests that won't get a response because their responser is gone.
+  std::vector<IReqHandlerPtr> failed;
+  {
+    std::lock_guard<std::recursive_mutex> lock(this->mutex);
+
+    // Remove the address from the list of connected addresses.
+    this->srvConnections.erase(std::remove(std::begin(this->srvConnections),
+      std::end(this->srvConnections), addr.c_str()),
+      std::end(this->srvConnections));
+
+    // Forget the responsers without any service left, and the services
+    // without any responser left. The discovery might still list the
+    // services being removed: all the services of the process if there is
+    // no topic, or the service of the node otherwise.
+    std::unordered_set<std::string> responserIds;
+    std::unordered_set<std::string> services;
+    std::set<std::pair<std::string, std::string>> responsersByService;
+    const auto &info = this->dataPtr->srvDiscovery->Info();
+    std::vector<std::string> topics;
+    info.TopicList(topics);
+    for (const auto &topic : topics)
+    {
+      SrvAddresses_M addresses;
+      if (!info.Publishers(topic, addresses))
+        continue;
+
+      for (const auto &proc : addresses)
+      {
+        for (const auto &pub : proc.second)
+        {
+          const bool removed = pub.PUuid() == _pub.PUuid() &&
+            (_pub.Topic().empty() ||
+             (pub.Topic() == _pub.Topic() && pub.NUuid() == _pub.NUuid()));
+          if (removed)
+            continue;
+
+          responserIds.insert(pub.SocketId());
+          services.insert(topic);
+          responsersByService.emplace(topic, pub.SocketId());
+        }
+      }
+    }
+    this->dataPtr->responsers.Retain(responserIds);
+    this->dataPtr->responsers.RetainServices(services);
+
+    // Abandon the requests sent to a responser that doesn't provide their
+    // service anymore.
+    std::vector<std::pair<std::string, IReqHandlerPtr>> orphans;
+    for (const auto &inflight : this->dataPtr->inflightRequests)
+    {
+      if (responsersByService.find(std::make_pair(inflight.second.topic,
+            inflight.second.responserId)) == responsersByService.end())
+      {
+        orphans.emplace_back(inflight.second.topic, inflight.second.handler);
+      }
+    }
+    for (const auto &orphan : orphans)
+    {
+      if (this->AbandonRequest(orphan.first, orphan.second))
+        failed.push_back(orphan.second);
+    }
+  }
 
-  // Remove the address from the list of connected addresses.
-  this->srvConnections.erase(std::remove(std::begin(this->srvConnections),
-    std::end(this->srvConnections), addr.c_str()),
-    std::end(this->srvConnections));
+  // Notify the handlers without holding the mutex, like the responses.
+  for (const auto &handler : failed)
+    handler->NotifyResult("", false);
 
   if (this->verbose)
   {
@@ -1114,6 +2064,7 @@ bool NodeShared::InitializeSockets()
   {
     // Set the hostname's ip address.
     this->hostAddr = this->dataPtr->msgDiscovery->HostAddr();
+    this->dataPtr->responsers.SetLocal(this->hostAddr, this->pUuid);
 
     // Publisher socket listening in a random port.
     std::string anyTcpEp = "tcp://" + this->hostAddr + ":*";
@@ -1136,6 +2087,27 @@ bool NodeShared::InitializeSockets()
         &bindEndPoint, &size);
     this->myAddress = bindEndPoint;
 
+    // Subscribers running on the same host connect to this inter-process
+    // endpoint instead of the TCP one. This is best effort: if the bind
+    // fails, they will keep using TCP.
+    if (ipcEnabled())
+    {
+      std::string ipcEp = ipcEndpoint(this->pUuid);
+      try
+      {
+        this->dataPtr->publisher->bind(ipcEp.c_str());
+        this->dataPtr->myIpcAddress = ipcEp;
+      }
+      catch(const zmq::error_t &_error)
+      {
+        if (this->verbose)
+        {
+          std::cerr << "Unable to bind [" << ipcEp << "]: " << _error.what()
+                    << ". Same host subscribers will use TCP" << std::endl;
+        }
+      }
+    }
+
     // Control socket listening in a random port.
     this->dataPtr->control->bind(anyTcpEp.c_str());
     this->dataPtr->control->getsockopt(ZMQ_LAST_ENDPOINT, &bindEndPoint, &size);
@@ -1166,6 +2138,28 @@ bool NodeShared::InitializeSockets()
         &lingerVal, sizeof(lingerVal));
     this->dataPtr->requester->setsockopt(ZMQ_ROUTER_MANDATORY, &RouteOn,
       sizeof(RouteOn));
+
+    // In-process pair used to wake up the reception thread when a service
+    // running on its own threads has a reply ready.
+    const std::string srvRepliesEp = "inproc://srv_replies";
+    this->dataPtr->srvRepliesReceiver->setsockopt(ZMQ_LINGER,
+        &lingerVal, sizeof(lingerVal));
+    this->dataPtr->srvRepliesNotifier->setsockopt(ZMQ_LINGER,
+        &lingerVal, sizeof(lingerVal));
+    this->dataPtr->srvRepliesReceiver->bind(srvRepliesEp.c_str());
+    this->dataPtr->srvRepliesNotifier->connect(srvRepliesEp.c_str());
+
+    // Monitor the connections of the requester and replier sockets. The
+    // requests and replies waiting for a new connection are sent as soon
+    // as it's ready.
+    this->dataPtr->requesterMonitor->setsockopt(ZMQ_LINGER,
+        &lingerVal, sizeof(lingerVal));
+    this->dataPtr->replierMonitor->setsockopt(ZMQ_LINGER,
+        &lingerVal, sizeof(lingerVal));
+    monitorHelper(*this->dataPtr->requester,
+        *this->dataPtr->requesterMonitor, "inproc://requester_monitor");
+    monitorHelper(*this->dataPtr->replier,
+        *this->dataPtr->replierMonitor, "inproc://replier_monitor");
   }
   catch(const zmq::error_t& ze)
   {
@@ -1178,6 +2172,16 @@ bool NodeShared::InitializeSockets()
   return true;
 }
 
+/////////////////////////////////////////////////
+void NodeShared::PublishQueueStats(std::size_t &_depth,
+                                   std::size_t &_capacity,
+                                   uint64_t &_dropped) const
+{
+  _depth = this->dataPtr->pubQueue->Depth();
+  _capacity = this->dataPtr->pubQueue->Capacity();
+  _dropped = this->dataPtr->pubQueue->Dropped();
+}
+
 /////////////////////////////////////////////////
 bool NodeShared::TopicPublishers(const std::string &_topic,
                                  SrvAddresses_M &_publishers) const
@@ -1450,62 +2454,89 @@ void NodeSharedPrivate::PublishThread()
   while (!this->exit)
   {
     std::unique_ptr<PublishMsgDetails> msgDetails = nullptr;
-    // Lock the mutex, and acquire the next message to be published.
-    {
-      std::unique_lock<std::mutex> queueLock(this->pubThreadMutex);
 
-      // Wait for more messages if the queue is empty. Otherwise get the
-      // next message and continue.
-      if (this->pubQueue.empty())
-      {
-        auto now = std::chrono::system_clock::now();
-        this->signalNewPub.wait_until(queueLock, now + 500ms,
-          [&]{return !this->pubQueue.empty() || this->exit;});
-      }
+    // Wait for the next message to be published.
+    if (!this->pubQueue->WaitAndPop(msgDetails, 500ms))
+      continue;
 
-      if (this->pubQueue.empty())
-        continue;
+    // Stop early on exit.
+    if (this->exit)
+      break;
 
-      // Stop early on exit.
-      if (this->exit)
-        break;
+    // Messages published from a serialized buffer are deserialized once
+    // here and shared by all the local handlers.
+    const auto &localHandlers = msgDetails->subscribers->localHandlers;
+    bool haveMsg = true;
+    if (!msgDetails->localMsg && !localHandlers.empty() &&
+        msgDetails->sharedBuffer)
+    {
+      msgDetails->localMsg = localHandlers.front()->CreateMsg(
+          msgDetails->sharedBuffer.get(), msgDetails->msgSize,
+          msgDetails->info.Type());
 
-      // Get the message
-      msgDetails = std::move(this->pubQueue.front());
-      this->pubQueue.pop();
+      if (!msgDetails->localMsg)
+      {
+        std::cerr << "Unable to deserialize a message of type ["
+                  << msgDetails->info.Type() << "] on topic ["
+                  << msgDetails->info.Topic() << "]" << std::endl;
+        haveMsg = false;
+      }
     }
 
+    // The message and its buffer are shared with the callbacks, which may
+    // run on other threads after this iteration.
+    std::shared_ptr<const PublishMsgDetails> details(std::move(msgDetails));
+
     // Send the message to all the local handlers.
-    for (auto &handler : msgDetails->localHandlers)
+    for (auto &handler : localHandlers)
     {
-      try
-      {
-        handler->RunLocalCallback(*(msgDetails->msgCopy.get()),
-            msgDetails->info);
-      }
-      catch (...)
+      if (!haveMsg)
+        break;
+
+      auto task = [handler, details]()
       {
-        std::cerr << "Exception occurred in a local callback "
-          << "on topic [" << msgDetails->info.Topic() << "] with message ["
-          << msgDetails->msgCopy->DebugString() << "]" << std::endl;
-      }
+        try
+        {
+          handler->RunLocalCallback(*details->localMsg,
+              details->info);
+        }
+        catch (...)
+        {
+          std::cerr << "Exception occurred in a local callback "
+            << "on topic [" << details->info.Topic() << "] with message ["
+            << details->localMsg->DebugString() << "]" << std::endl;
+        }
+      };
+
+      if (Executors::Inline(handler->Executor()))
+        task();
+      else
+        this->executors->Post(handler->HandlerUuid(), task);
     }
 
     // Send the message to all the raw handlers.
-    for (auto &handler : msgDetails->rawHandlers)
+    for (auto &handler : details->subscribers->rawHandlers)
     {
-      try
+      auto task = [handler, details]()
       {
-        handler->RunRawCallback(msgDetails->sharedBuffer.get(),
-            msgDetails->msgSize, msgDetails->info);
-      }
-      catch (...)
-      {
-        std::cerr << "Exception occured in a local raw callback "
-          << "on topic [" << msgDetails->info.Topic() << "] with "
-          << "message [" << msgDetails->msgCopy->DebugString() << "]"
-          << std::endl;
-      }
+        try
+        {
+          handler->RunRawCallback(details->sharedBuffer.get(),
+              details->msgSize, details->info);
+        }
+        catch (...)
+        {
+          std::cerr << "Exception occured in a local raw callback "
+            << "on topic [" << details->info.Topic() << "] with "
+            << "message of type [" << details->info.Type() << "]"
+            << std::endl;
+        }
+      };
+
+      if (Executors::Inline(handler->Executor()))
+        task();
+      else
+        this->executors->Post(handler->HandlerUuid(), task);
     }
   }
 }
@@ -27,11 +27,31 @@
 #endif
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <map>
 #include <memory>
-#include <queue>
+#include <mutex>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "ignition/transport/Discovery.hh"
+#include "ignition/transport/MessageInfo.hh"
+#include "ignition/transport/NodeShared.hh"
+#include "ignition/transport/TransportTypes.hh"
+
+#include "BufferPool.hh"
+#include "Executors.hh"
+#include "PublishQueue.hh"
+#include "ResponserSelector.hh"
+#include "TopicId.hh"
 
 namespace ignition
 {
@@ -51,7 +71,12 @@ namespace ignition
                 control(new zmq::socket_t(*context, ZMQ_DEALER)),
                 requester(new zmq::socket_t(*context, ZMQ_ROUTER)),
                 responseReceiver(new zmq::socket_t(*context, ZMQ_ROUTER)),
-                replier(new zmq::socket_t(*context, ZMQ_ROUTER))
+                replier(new zmq::socket_t(*context, ZMQ_ROUTER)),
+                srvRepliesReceiver(new zmq::socket_t(*context, ZMQ_PAIR)),
+                srvRepliesNotifier(new zmq::socket_t(*context, ZMQ_PAIR)),
+                requesterMonitor(new zmq::socket_t(*context, ZMQ_PAIR)),
+                replierMonitor(new zmq::socket_t(*context, ZMQ_PAIR)),
+                bufferPool(std::make_shared<BufferPool>())
       {
       }
 
@@ -95,6 +120,26 @@ namespace ignition
       /// \brief ZMQ socket to receive service call requests.
       public: std::unique_ptr<zmq::socket_t> replier;
 
+      /// \brief ZMQ socket polled by the reception thread. It's notified
+      /// when there are service replies to send.
+      public: std::unique_ptr<zmq::socket_t> srvRepliesReceiver;
+
+      /// \brief ZMQ socket notifying srvRepliesReceiver. Protected by
+      /// srvRepliesMutex.
+      public: std::unique_ptr<zmq::socket_t> srvRepliesNotifier;
+
+      /// \brief ZMQ socket receiving the connection events of the requester
+      /// socket.
+      public: std::unique_ptr<zmq::socket_t> requesterMonitor;
+
+      /// \brief ZMQ socket receiving the connection events of the replier
+      /// socket.
+      public: std::unique_ptr<zmq::socket_t> replierMonitor;
+
+      /// \brief Buffers used to serialize outgoing messages. They are shared
+      /// between ZeroMQ and the local raw handlers without copies.
+      public: std::shared_ptr<BufferPool> bufferPool;
+
       /// \brief Thread the handle access control
       public: std::thread accessControlThread;
 
@@ -115,14 +160,54 @@ namespace ignition
       /// \brief When true, the reception thread will finish.
       public: std::atomic<bool> exit = false;
 
+      /// \brief Inter-process endpoint where the publisher socket is bound
+      /// for subscribers running on this host. Empty if not available.
+      public: std::string myIpcAddress;
+
       /// \brief Timeout used for receiving messages (ms.).
       public: static const int Timeout = 250;
 
+      /// \brief Maximum time that a service request or reply waits for the
+      /// connection to its destination (ms.).
+      public: static const int ConnectTimeout = 5000;
+
+      /// \brief Chunks of a streamed response that a responser may send
+      /// before the requester grants more.
+      public: static const int StreamWindow = 16;
+
+      /// \brief Maximum chunks of a streamed response that a requester may
+      /// grant in advance. Larger grants are saturated to it.
+      public: static const int MaxStreamCredits = 1 << 20;
+
+      /// \brief Maximum time that a responser waits for the requester to
+      /// grant more chunks before giving up on the stream (ms.).
+      public: static const int StreamTimeout = 10000;
+
       ////////////////////////////////////////////////////////////////
       /////// The following is for asynchronous publication of ///////
       /////// messages to local subscribers.                    ///////
       ////////////////////////////////////////////////////////////////
 
+      /// \brief Immutable view of the subscribers of a publisher: the local
+      /// and raw handlers of its topic that accept its message type, and
+      /// whether there are remote subscribers. Each Node::Publisher caches
+      /// one and only rebuilds it when NodeShared::SubscriptionEpoch()
+      /// changes, so publishing doesn't walk the handler maps.
+      public: struct SubscriberSnapshot
+              {
+                /// \brief Subscription epoch the snapshot was built at.
+                public: uint64_t epoch = 0;
+
+                /// \brief The local handlers accepting the message type.
+                public: std::vector<ISubscriptionHandlerPtr> localHandlers;
+
+                /// \brief The raw handlers accepting the message type.
+                public: std::vector<RawSubscriptionHandlerPtr> rawHandlers;
+
+                /// \brief Whether there are remote subscribers.
+                public: bool haveRemote = false;
+              };
+
       /// \brief Encapsulates information needed to publish a message. An
       /// instance of this class is pushed onto a publish queue, pubQueue, when
       /// a message is published through Node::Publisher::Publish.
@@ -134,17 +219,20 @@ namespace ignition
       /// local subscriber callbacks.
       public: struct PublishMsgDetails
               {
-                /// \brief All the local subscription handlers.
-                public: std::vector<ISubscriptionHandlerPtr> localHandlers;
+                /// \brief The local and raw handlers of the message. They
+                /// are shared with the publisher, not copied.
+                public: std::shared_ptr<const SubscriberSnapshot> subscribers;
 
-                /// \brief All the raw handlers.
-                public: std::vector<RawSubscriptionHandlerPtr> rawHandlers;
-
-                /// \brief Buffer for the raw handlers.
-                public: std::unique_ptr<char[]> sharedBuffer = nullptr;
+                /// \brief Buffer for the raw handlers. It might also be in use
+                /// by ZeroMQ for the remote subscribers.
+                public: std::shared_ptr<char> sharedBuffer = nullptr;
 
-                /// \brief Msg copy for the local handlers.
-                public: std::unique_ptr<ProtoMsg> msgCopy = nullptr;
+                /// \brief Immutable msg shared by all the local handlers. It
+                /// is a copy of the published message, the message itself if
+                /// it was published through a shared pointer, or empty if
+                /// the local handlers receive the message deserialized from
+                /// sharedBuffer.
+                public: std::shared_ptr<const ProtoMsg> localMsg = nullptr;
 
                 /// \brief Message size.
                 // cppcheck-suppress unusedStructMember
@@ -157,18 +245,260 @@ namespace ignition
       /// \brief Publish thread used to process the pubQueue.
       public: std::thread pubThread;
 
-      /// \brief Mutex to protect the pubThread and pubQueue.
-      public: std::mutex pubThreadMutex;
-
       /// \brief Queue onto which new messages are pushed. The pubThread
       /// will pop off the messages and send them to local subscribers.
-      public: std::queue<std::unique_ptr<PublishMsgDetails>> pubQueue;
+      /// Its capacity and overflow policy can be set with the
+      /// IGN_TRANSPORT_PUB_QUEUE_SIZE and IGN_TRANSPORT_PUB_QUEUE_POLICY
+      /// environment variables.
+      public: std::unique_ptr<PublishQueue<std::unique_ptr<PublishMsgDetails>>>
+        pubQueue;
 
-      /// \brief used to signal when new work is available
-      public: std::condition_variable signalNewPub;
+      /// \brief Default capacity of the pubQueue.
+      public: static const std::size_t kDefaultPubQueueSize = 16384;
 
       /// \brief Handles local publication of messages on the pubQueue.
       public: void PublishThread();
+
+      /// \brief Protects the publisher socket. The publish path only takes
+      /// this mutex, not the NodeShared mutex.
+      public: std::mutex publisherMutex;
+
+      /// \brief Protects the subscriber socket, which is used by the
+      /// reception thread and by the threads (un)subscribing. The receive
+      /// path only takes this mutex, not the NodeShared mutex.
+      public: std::mutex subscriberMutex;
+
+      /// \brief Executors running the callbacks of the subscriptions that
+      /// don't use SINGLE_THREADED. The size of the shared pool can be set
+      /// with the IGN_TRANSPORT_EXECUTOR_THREADS environment variable.
+      public: std::unique_ptr<Executors> executors;
+
+      /// \brief Send a message to the remote subscribers. The message has
+      /// two frames, the identifier of the topic and type and the data, plus
+      /// the type name when it isn't the one the identifier stands for.
+      /// \param[in] _id Identifier of the topic and the advertised type.
+      /// \param[in] _data Serialized data.
+      /// \param[in] _dataSize Size of the data (bytes).
+      /// \param[in] _ffn Deallocation function. ZeroMQ calls it when the data
+      /// is sent.
+      /// \param[in] _hint Passed to _ffn.
+      /// \param[in] _msgType Type of the message if it's not the advertised
+      /// one, or empty.
+      /// \return True on success.
+      public: bool Publish(const TopicId _id,
+                           char *_data,
+                           const std::size_t _dataSize,
+                           DeallocFunc *_ffn,
+                           void *_hint,
+                           const std::string &_msgType);
+
+      /// \brief Topic and type of the identifiers this process subscribed
+      /// to. Its entries match the ZeroMQ filters of the subscriber socket.
+      public: TopicIdTable topicIds;
+
+      /// \brief What the reception thread needs to deliver a message with
+      /// a given identifier.
+      public: struct RecvEntry
+              {
+                /// \brief Information about the topic and type.
+                public: MessageInfo info;
+
+                /// \brief Handlers of the topic.
+                public: std::shared_ptr<const NodeShared::HandlerInfo>
+                  handlers;
+              };
+
+      /// \brief Entries of the identifiers received so far. Only used by
+      /// the reception thread, and cleared whenever the subscriptions or
+      /// the topicIds change.
+      public: std::unordered_map<TopicId, RecvEntry> recvCache;
+
+      /// \brief Subscription version the recvCache was built at.
+      public: uint64_t recvCacheVersion = 0;
+
+      /// \brief A service reply waiting to be sent.
+      public: struct SrvReply
+              {
+                /// \brief Address of the requester.
+                public: std::string sender;
+
+                /// \brief Identity of the requester socket.
+                public: std::string dstId;
+
+                /// \brief Service name.
+                public: std::string topic;
+
+                /// \brief UUID of the requesting node.
+                public: std::string nodeUuid;
+
+                /// \brief UUID of the request.
+                public: std::string reqUuid;
+
+                /// \brief Serialized responses and results of the service
+                /// calls, one per request of the batch.
+                public: std::vector<std::pair<std::string, bool>> responses;
+
+                /// \brief True if this is a chunk of a streamed response.
+                public: bool chunk = false;
+
+                /// \brief When the reply was created.
+                public: std::chrono::steady_clock::time_point created =
+                  std::chrono::steady_clock::now();
+              };
+
+      /// \brief Queue a service reply. Only the reception thread uses the
+      /// replier socket, so the services running on other threads pass
+      /// their replies to it through this queue.
+      /// \param[in] _reply The reply.
+      /// \param[in] _notify True to wake up the reception thread, false if
+      /// the caller is the reception thread.
+      public: void QueueSrvReply(SrvReply &&_reply, const bool _notify)
+      {
+        std::lock_guard<std::mutex> lk(this->srvRepliesMutex);
+        this->srvReplies.push_back(std::move(_reply));
+
+        // A single notification is enough for all the replies queued until
+        // the reception thread takes them.
+        if (!_notify || this->srvReplies.size() > 1u)
+          return;
+
+        try
+        {
+          zmq::message_t msg(0);
+          this->srvRepliesNotifier->send(msg, ZMQ_DONTWAIT);
+        }
+        catch(const zmq::error_t &_error)
+        {
+          std::cerr << "Error notifying a service reply: " << _error.what()
+                    << std::endl;
+        }
+      }
+
+      /// \brief Protects srvReplies and srvRepliesNotifier.
+      public: std::mutex srvRepliesMutex;
+
+      /// \brief Service replies waiting to be sent.
+      public: std::vector<SrvReply> srvReplies;
+
+      /// \brief Flow control of a streamed response being sent.
+      public: struct SrvStream
+              {
+                /// \brief Protects credits and cancelled.
+                public: std::mutex mutex;
+
+                /// \brief Notified when the requester grants more chunks or
+                /// cancels the stream.
+                public: std::condition_variable cv;
+
+                /// \brief Chunks that can be sent without waiting.
+                public: int credits = StreamWindow;
+
+                /// \brief True if the requester stopped the stream.
+                public: bool cancelled = false;
+              };
+
+      /// \brief Wait until a stream can send another chunk.
+      /// \param[in] _stream The stream.
+      /// \return True if the chunk can be sent, false if the stream was
+      /// cancelled, the requester didn't grant more chunks in time or the
+      /// node is exiting.
+      public: bool WaitStreamCredit(SrvStream &_stream)
+      {
+        const auto deadline = std::chrono::steady_clock::now() +
+          std::chrono::milliseconds(StreamTimeout);
+
+        std::unique_lock<std::mutex> lk(_stream.mutex);
+        while (!_stream.cancelled && _stream.credits <= 0)
+        {
+          if (this->exit || std::chrono::steady_clock::now() >= deadline)
+            return false;
+
+          _stream.cv.wait_for(lk, std::chrono::milliseconds(Timeout));
+        }
+
+        if (_stream.cancelled)
+          return false;
+
+        --_stream.credits;
+        return true;
+      }
+
+      /// \brief Streamed responses being sent, indexed by requester socket
+      /// ID and request UUID. Protected by srvStreamsMutex.
+      public: std::map<std::string, std::shared_ptr<SrvStream>> srvStreams;
+
+      /// \brief Protects srvStreams.
+      public: std::mutex srvStreamsMutex;
+
+      /// \brief Service, request type and response type of a remote service.
+      public: using SrvKey = std::tuple<std::string, std::string, std::string>;
+
+      /// \brief Services with pending requests that couldn't be sent because
+      /// the connection to the responser wasn't ready yet, and when the
+      /// first attempt failed. They are sent again when the requester socket
+      /// connects. Protected by the NodeShared mutex.
+      public: std::map<SrvKey, std::chrono::steady_clock::time_point>
+        unsentRequests;
+
+      /// \brief Last time the reception thread retried the unsent requests
+      /// and replies.
+      public: std::chrono::steady_clock::time_point lastRetry;
+
+      /// \brief A request not sent yet.
+      public: struct QueuedRequest
+              {
+                /// \brief The request handler.
+                public: IReqHandlerPtr handler;
+
+                /// \brief How to choose the responser.
+                public: ResponserPolicy_t policy;
+              };
+
+      /// \brief Requests not sent yet, in order, indexed by service name.
+      /// Sending them doesn't walk the requests already sent. Protected by
+      /// the NodeShared mutex.
+      public: std::unordered_map<std::string, std::deque<QueuedRequest>>
+        queuedRequests;
+
+      /// \brief Requests to abandon if they don't get their response in
+      /// time, indexed by deadline. The requests that get their response
+      /// stay until their deadline. Protected by the NodeShared mutex.
+      public: std::multimap<std::chrono::steady_clock::time_point,
+        std::pair<std::string, IReqHandlerPtr>> requestDeadlines;
+
+      /// \brief A request sent and waiting for its response.
+      public: struct InflightRequest
+              {
+                /// \brief Service name.
+                public: std::string topic;
+
+                /// \brief The request handler.
+                public: IReqHandlerPtr handler;
+
+                /// \brief Socket ID of the responser.
+                public: std::string responserId;
+
+                /// \brief When the request was sent.
+                public: std::chrono::steady_clock::time_point sent;
+
+                /// \brief Chunks of a streamed response received since the
+                /// last grant of more chunks.
+                public: int chunks = 0;
+              };
+
+      /// \brief Requests waiting for their responses, indexed by request
+      /// identifier. The identifier travels in the request and comes back
+      /// in the response, so matching them is a single lookup. Protected by
+      /// the NodeShared mutex.
+      public: std::unordered_map<uint64_t, InflightRequest> inflightRequests;
+
+      /// \brief Identifier of the next request. Protected by the NodeShared
+      /// mutex.
+      public: uint64_t nextRequestId = 1;
+
+      /// \brief Chooses the responsers of the requests. Protected by the
+      /// NodeShared mutex.
+      public: ResponserSelector responsers;
     };
     }
   }
@@ -15,13 +15,17 @@
  *
 */
 
+#include <atomic>
 #include <chrono>
 #include <csignal>
 #include <cstdlib>
 #include <functional>
+#include <future>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <thread>
+#include <vector>
 #include <ignition/msgs.hh>
 
 #include "gtest/gtest.h"
@@ -654,6 +658,55 @@ TEST(NodeTest, PubSubSameThreadGenericCb)
   reset();
 }
 
+//////////////////////////////////////////////////
+/// \brief A message published through a shared pointer reaches the typed
+/// and the generic subscribers without being copied.
+TEST(NodeTest, PubSharedMsgSameThread)
+{
+  transport::Node node;
+  auto pub = node.Advertise<ignition::msgs::Int32>(g_topic);
+  EXPECT_TRUE(pub);
+
+  std::mutex mutex;
+  std::vector<const transport::ProtoMsg *> received;
+
+  std::function<void(const ignition::msgs::Int32&)> typedCb =
+    [&mutex, &received](const ignition::msgs::Int32 &_msg)
+  {
+    std::lock_guard<std::mutex> lk(mutex);
+    received.push_back(&_msg);
+  };
+  std::function<void(const transport::ProtoMsg&)> genericCb =
+    [&mutex, &received](const transport::ProtoMsg &_msg)
+  {
+    std::lock_guard<std::mutex> lk(mutex);
+    received.push_back(&_msg);
+  };
+
+  EXPECT_TRUE(node.Subscribe(g_topic, typedCb));
+  EXPECT_TRUE(node.Subscribe(g_topic, genericCb));
+
+  // Wait some time before publishing.
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  EXPECT_FALSE(pub.Publish(std::shared_ptr<const transport::ProtoMsg>()));
+
+  // The type is still checked.
+  EXPECT_FALSE(pub.Publish(std::make_shared<ignition::msgs::Vector3d>()));
+
+  auto msg = std::make_shared<ignition::msgs::Int32>();
+  msg->set_data(data);
+  EXPECT_TRUE(pub.Publish(msg));
+
+  // Give some time to the subscribers.
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  std::lock_guard<std::mutex> lk(mutex);
+  ASSERT_EQ(2u, received.size());
+  EXPECT_EQ(msg.get(), received[0]);
+  EXPECT_EQ(msg.get(), received[1]);
+}
+
 //////////////////////////////////////////////////
 /// \brief A thread can create a node, and send and receive messages.
 /// This test uses a callback that accepts a parameter with the message
@@ -817,6 +870,225 @@ TEST(NodeTest, PubRawSubSameThreadMessageInfo)
   reset();
 }
 
+//////////////////////////////////////////////////
+/// \brief Publish messages serialized into loaned buffers.
+TEST(NodeTest, PubLoanedSubSameThread)
+{
+  reset();
+
+  ignition::msgs::Int32 msg;
+  msg.set_data(data);
+  const std::size_t msgSize = msg.ByteSizeLong();
+
+  // An invalid publisher doesn't loan buffers.
+  transport::Node::Publisher invalidPub;
+  EXPECT_EQ(nullptr, invalidPub.Loan(msgSize));
+
+  transport::Node node;
+  auto pub = node.Advertise<ignition::msgs::Int32>(g_topic);
+  EXPECT_TRUE(pub);
+
+  EXPECT_TRUE(node.Subscribe(g_topic, cb));
+  EXPECT_TRUE(node.SubscribeRaw(g_topic, rawCbInfo));
+
+  // Wait some time before publishing.
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+  // Only buffers obtained with Loan() are accepted.
+  std::shared_ptr<char> foreignBuffer(new char[msgSize],
+      std::default_delete<char[]>());
+  EXPECT_FALSE(pub.PublishLoaned(foreignBuffer, msgSize));
+  EXPECT_FALSE(pub.PublishLoaned(nullptr, 0));
+
+  for (int i = 0; i < 2; ++i)
+  {
+    std::shared_ptr<char> buffer = pub.Loan(msgSize);
+    ASSERT_NE(nullptr, buffer);
+    ASSERT_TRUE(msg.SerializeToArray(buffer.get(), msgSize));
+
+    // The buffer is too small for a bigger message.
+    EXPECT_FALSE(pub.PublishLoaned(buffer, 1024 * 1024));
+
+    EXPECT_TRUE(pub.PublishLoaned(std::move(buffer), msgSize));
+
+    // Give some time to the subscribers.
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+
+    // Check that both the typed and the raw subscribers received it.
+    EXPECT_TRUE(cbExecuted);
+    EXPECT_EQ(2, counter);
+
+    reset();
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief A publisher notices the subscriptions created and removed after
+/// its previous publications, also through its copies.
+TEST(NodeTest, PubSubscriptionChanges)
+{
+  reset();
+
+  ignition::msgs::Int32 msg;
+  msg.set_data(data);
+
+  transport::Node node;
+  auto pub = node.Advertise<ignition::msgs::Int32>(g_topic);
+  EXPECT_TRUE(pub);
+
+  // Nobody is listening yet.
+  EXPECT_TRUE(pub.Publish(msg));
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_FALSE(cbExecuted);
+
+  // A subscriber of another type is never called.
+  EXPECT_TRUE(node.Subscribe(g_topic, cbVector));
+  EXPECT_TRUE(node.Subscribe(g_topic, cb));
+
+  for (int i = 0; i < 2; ++i)
+  {
+    EXPECT_TRUE(pub.Publish(msg));
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_TRUE(cbExecuted);
+    EXPECT_FALSE(cbVectorExecuted);
+    EXPECT_EQ(1, counter);
+    reset();
+  }
+
+  // A copy of the publisher shares its subscribers.
+  auto pubCopy = pub;
+  EXPECT_TRUE(node.SubscribeRaw(g_topic, rawCbInfo));
+  EXPECT_TRUE(pubCopy.Publish(msg));
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_TRUE(cbExecuted);
+  EXPECT_EQ(2, counter);
+  reset();
+
+  EXPECT_TRUE(node.Unsubscribe(g_topic));
+  EXPECT_TRUE(pub.Publish(msg));
+  std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  EXPECT_FALSE(cbExecuted);
+  EXPECT_EQ(0, counter);
+}
+
+//////////////////////////////////////////////////
+/// \brief A slow subscriber with its own thread doesn't delay a subscriber
+/// of another topic, and its messages arrive in order.
+TEST(NodeTest, PubSubDedicatedExecutor)
+{
+  const std::string slowTopic = "/slow";
+  const int kMsgs = 5;
+
+  std::mutex mutex;
+  std::vector<int> slowData;
+  std::atomic<int> fastCounter{0};
+
+  std::function<void(const ignition::msgs::Int32 &)> slowCb =
+    [&](const ignition::msgs::Int32 &_msg)
+    {
+      std::this_thread::sleep_for(std::chrono::milliseconds(100));
+      std::lock_guard<std::mutex> lk(mutex);
+      slowData.push_back(_msg.data());
+    };
+
+  std::function<void(const ignition::msgs::Int32 &)> fastCb =
+    [&](const ignition::msgs::Int32 &/*_msg*/)
+    {
+      ++fastCounter;
+    };
+
+  transport::NodeOptions nodeOptions;
+  nodeOptions.SetExecutor(transport::Executor_t::POOL);
+  transport::Node node(nodeOptions);
+  auto slowPub = node.Advertise<ignition::msgs::Int32>(slowTopic);
+  auto fastPub = node.Advertise<ignition::msgs::Int32>(g_topic);
+  EXPECT_TRUE(slowPub);
+  EXPECT_TRUE(fastPub);
+
+  transport::SubscribeOptions opts;
+  opts.SetExecutor(transport::Executor_t::DEDICATED);
+  EXPECT_TRUE(node.Subscribe(slowTopic, slowCb, opts));
+  EXPECT_TRUE(node.Subscribe(g_topic, fastCb));
+
+  ignition::msgs::Int32 msg;
+  for (int i = 0; i < kMsgs; ++i)
+  {
+    msg.set_data(i);
+    EXPECT_TRUE(slowPub.Publish(msg));
+    EXPECT_TRUE(fastPub.Publish(msg));
+  }
+
+  // The fast subscriber is done long before the slow one.
+  for (int i = 0; i < 50 && fastCounter < kMsgs; ++i)
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+  EXPECT_EQ(kMsgs, fastCounter);
+  {
+    std::lock_guard<std::mutex> lk(mutex);
+    EXPECT_LT(slowData.size(), static_cast<std::size_t>(kMsgs));
+  }
+
+  for (int i = 0; i < 20; ++i)
+  {
+    {
+      std::lock_guard<std::mutex> lk(mutex);
+      if (slowData.size() == static_cast<std::size_t>(kMsgs))
+        break;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+
+  std::lock_guard<std::mutex> lk(mutex);
+  ASSERT_EQ(static_cast<std::size_t>(kMsgs), slowData.size());
+  for (int i = 0; i < kMsgs; ++i)
+    EXPECT_EQ(i, slowData[i]);
+}
+
+//////////////////////////////////////////////////
+/// \brief Destroying a subscriber waits for its callback in progress, so
+/// the callback never outlives the node.
+TEST(NodeTest, DestroySubscriberDuringCallback)
+{
+  for (auto executor : {transport::Executor_t::POOL,
+                        transport::Executor_t::TOPIC_STRAND,
+                        transport::Executor_t::DEDICATED})
+  {
+    std::atomic<int> started{0};
+    std::atomic<int> done{0};
+    std::function<void(const ignition::msgs::Int32 &)> cb =
+      [&](const ignition::msgs::Int32 &/*_msg*/)
+      {
+        ++started;
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        ++done;
+      };
+
+    transport::Node pubNode;
+    auto pub = pubNode.Advertise<ignition::msgs::Int32>(g_topic);
+    EXPECT_TRUE(pub);
+
+    std::unique_ptr<transport::Node> subNode(new transport::Node());
+    transport::SubscribeOptions opts;
+    opts.SetExecutor(executor);
+    EXPECT_TRUE(subNode->Subscribe(g_topic, cb, opts));
+
+    ignition::msgs::Int32 msg;
+    msg.set_data(data);
+    EXPECT_TRUE(pub.Publish(msg));
+    EXPECT_TRUE(pub.Publish(msg));
+
+    for (int i = 0; i < 100 && started == 0; ++i)
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    ASSERT_EQ(1, started);
+
+    subNode.reset();
+    EXPECT_EQ(1, done);
+
+    // The pending callback is discarded.
+    std::this_thread::sleep_for(std::chrono::milliseconds(250));
+    EXPECT_EQ(1, started);
+  }
+}
+
 //////////////////////////////////////////////////
 /// \brief Subscribe to a topic using a lambda function.
 TEST(NodeTest, PubSubSameThreadLambda)
@@ -1224,6 +1496,176 @@ TEST(NodeTest, ServiceCallAsync)
   reset();
 }
 
+//////////////////////////////////////////////////
+/// \brief Make an asynchronous service call that returns a future.
+TEST(NodeTest, ServiceCallAsyncFuture)
+{
+  reset();
+
+  ignition::msgs::Int32 req;
+  req.set_data(data);
+
+  transport::Node node;
+  EXPECT_TRUE(node.Advertise(g_topic, srvEcho));
+
+  // Request an invalid service name.
+  auto invalid = node.RequestAsync<ignition::msgs::Int32,
+    ignition::msgs::Int32>("invalid service", req, 1000);
+  EXPECT_FALSE(invalid.valid());
+
+  auto future = node.RequestAsync<ignition::msgs::Int32,
+    ignition::msgs::Int32>(g_topic, req, 1000);
+  ASSERT_TRUE(future.valid());
+  ASSERT_EQ(future.wait_for(std::chrono::milliseconds(1000)),
+    std::future_status::ready);
+
+  auto response = future.get();
+  EXPECT_EQ(response.first.data(), data);
+  EXPECT_TRUE(response.second);
+  EXPECT_TRUE(srvExecuted);
+
+  // Nobody answers a request to an unknown service, it's abandoned after
+  // the timeout.
+  future = node.RequestAsync<ignition::msgs::Int32,
+    ignition::msgs::Int32>("/unknown_service", req, 200);
+  ASSERT_TRUE(future.valid());
+  EXPECT_EQ(future.wait_for(std::chrono::milliseconds(100)),
+    std::future_status::timeout);
+  ASSERT_EQ(future.wait_for(std::chrono::milliseconds(2000)),
+    std::future_status::ready);
+
+  response = future.get();
+  EXPECT_EQ(response.first.data(), 0);
+  EXPECT_FALSE(response.second);
+
+  reset();
+}
+
+//////////////////////////////////////////////////
+/// \brief Make a batch of service calls.
+TEST(NodeTest, ServiceCallBatch)
+{
+  reset();
+
+  std::vector<ignition::msgs::Int32> reqs(3);
+  for (int i = 0; i < 3; ++i)
+    reqs[i].set_data(data + i);
+
+  std::vector<ignition::msgs::Int32> reps;
+  std::vector<bool> results;
+  unsigned int timeout = 1000;
+
+  std::function<bool(const ignition::msgs::Int32 &, ignition::msgs::Int32 &)>
+    advCb = [](const ignition::msgs::Int32 &_req, ignition::msgs::Int32 &_rep)
+    -> bool
+  {
+    _rep.set_data(_req.data());
+    return true;
+  };
+
+  transport::Node node;
+  EXPECT_TRUE((node.Advertise<ignition::msgs::Int32,
+        ignition::msgs::Int32>(g_topic, advCb)));
+
+  // Request an invalid service name.
+  EXPECT_FALSE(node.RequestBatch("invalid service", reqs, timeout, reps,
+    results));
+
+  ASSERT_TRUE(node.RequestBatch(g_topic, reqs, timeout, reps, results));
+  ASSERT_EQ(reps.size(), reqs.size());
+  ASSERT_EQ(results.size(), reqs.size());
+  for (int i = 0; i < 3; ++i)
+  {
+    EXPECT_EQ(reps[i].data(), data + i);
+    EXPECT_TRUE(results[i]);
+  }
+
+  // An empty batch.
+  reqs.clear();
+  EXPECT_TRUE(node.RequestBatch(g_topic, reqs, timeout, reps, results));
+  EXPECT_TRUE(reps.empty());
+  EXPECT_TRUE(results.empty());
+
+  reset();
+}
+
+//////////////////////////////////////////////////
+/// \brief Request a service that streams its response.
+TEST(NodeTest, ServiceCallStream)
+{
+  reset();
+
+  // Sends as many chunks as the request asks for.
+  std::function<bool(const ignition::msgs::Int32 &,
+    const std::function<bool(const ignition::msgs::Int32 &)> &)> advCb =
+    [](const ignition::msgs::Int32 &_req,
+       const std::function<bool(const ignition::msgs::Int32 &)> &_send)
+  {
+    ignition::msgs::Int32 chunk;
+    for (int i = 0; i < _req.data(); ++i)
+    {
+      chunk.set_data(i);
+      if (!_send(chunk))
+        return false;
+    }
+    return true;
+  };
+
+  transport::Node node;
+  EXPECT_FALSE((node.AdvertiseStream<ignition::msgs::Int32,
+        ignition::msgs::Int32>("invalid service", advCb)));
+  EXPECT_TRUE((node.AdvertiseStream<ignition::msgs::Int32,
+        ignition::msgs::Int32>(g_topic, advCb)));
+
+  ignition::msgs::Int32 req;
+  req.set_data(10);
+
+  std::vector<int> chunks;
+  int done = 0;
+  bool result = false;
+  std::function<bool(const ignition::msgs::Int32 &)> chunkCb =
+    [&chunks](const ignition::msgs::Int32 &_chunk)
+  {
+    chunks.push_back(_chunk.data());
+    return true;
+  };
+  std::function<void(const bool)> doneCb = [&done, &result](const bool _result)
+  {
+    ++done;
+    result = _result;
+  };
+
+  // Request an invalid service name.
+  EXPECT_FALSE(node.RequestStream("invalid service", req, chunkCb, doneCb));
+
+  EXPECT_TRUE(node.RequestStream(g_topic, req, chunkCb, doneCb));
+  ASSERT_EQ(chunks.size(), 10u);
+  for (int i = 0; i < 10; ++i)
+    EXPECT_EQ(chunks[i], i);
+  EXPECT_EQ(done, 1);
+  EXPECT_TRUE(result);
+
+  // Stop the stream after a few chunks.
+  chunks.clear();
+  chunkCb = [&chunks](const ignition::msgs::Int32 &_chunk)
+  {
+    chunks.push_back(_chunk.data());
+    return chunks.size() < 3u;
+  };
+  EXPECT_TRUE(node.RequestStream(g_topic, req, chunkCb, doneCb));
+  EXPECT_EQ(chunks.size(), 3u);
+  EXPECT_EQ(done, 2);
+  EXPECT_FALSE(result);
+
+  // A regular request doesn't work with a streaming service.
+  ignition::msgs::Int32 rep;
+  bool repResult = true;
+  EXPECT_TRUE(node.Request(g_topic, req, 1000u, rep, repResult));
+  EXPECT_FALSE(repResult);
+
+  reset();
+}
+
 //////////////////////////////////////////////////
 /// \brief Make an asynchronous service call without input using free function.
 TEST(NodeTest, ServiceCallWithoutInputAsync)
@@ -0,0 +1,403 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef IGN_TRANSPORT_PUBLISHQUEUE_HH_
+#define IGN_TRANSPORT_PUBLISHQUEUE_HH_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include "ignition/transport/config.hh"
+
+namespace ignition
+{
+  namespace transport
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_TRANSPORT_VERSION_NAMESPACE {
+    //
+    /// \brief What to do when a message is pushed onto a full PublishQueue.
+    enum class PublishQueuePolicy
+    {
+      /// \brief Wait until the consumer makes room for the message.
+      BLOCK,
+      /// \brief Drop the oldest message in the queue.
+      DROP_OLDEST,
+      /// \brief Drop the message being pushed.
+      DROP_NEWEST
+    };
+
+    /// \brief Parse a PublishQueuePolicy from a string.
+    /// \param[in] _str One of "block", "drop_oldest" or "drop_newest".
+    /// \param[out] _policy The parsed policy.
+    /// \return True if _str is a valid policy.
+    inline bool PublishQueuePolicyFromString(const std::string &_str,
+                                             PublishQueuePolicy &_policy)
+    {
+      if (_str == "block")
+        _policy = PublishQueuePolicy::BLOCK;
+      else if (_str == "drop_oldest")
+        _policy = PublishQueuePolicy::DROP_OLDEST;
+      else if (_str == "drop_newest")
+        _policy = PublishQueuePolicy::DROP_NEWEST;
+      else
+        return false;
+
+      return true;
+    }
+
+    /// \brief Smallest capacity of a PublishQueue.
+    static const std::size_t kMinPublishQueueSize = 2;
+
+    /// \brief Largest capacity of a PublishQueue.
+    static const std::size_t kMaxPublishQueueSize = 1 << 20;
+
+    /// \brief Parse the capacity of a PublishQueue from a string.
+    /// \param[in] _str A number between kMinPublishQueueSize and
+    /// kMaxPublishQueueSize.
+    /// \param[out] _size The parsed capacity.
+    /// \return True if _str is a valid capacity.
+    inline bool PublishQueueSizeFromString(const std::string &_str,
+                                           std::size_t &_size)
+    {
+      // std::stoul accepts a sign, so a negative value would wrap around.
+      if (_str.empty() ||
+          _str.find_first_not_of("0123456789") != std::string::npos)
+      {
+        return false;
+      }
+
+      unsigned long long size;
+      try
+      {
+        size = std::stoull(_str);
+      }
+      catch (...)
+      {
+        return false;
+      }
+
+      if (size < kMinPublishQueueSize || size > kMaxPublishQueueSize)
+        return false;
+
+      _size = static_cast<std::size_t>(size);
+      return true;
+    }
+
+    /// \class PublishQueue PublishQueue.hh
+    /// \brief Bounded queue used to hand messages from the publishers to the
+    /// thread that runs the local callbacks. Any number of threads can push
+    /// without locks. A single consumer pops; it spins briefly when the
+    /// queue is empty and then parks on a condition variable. Producers only
+    /// take a lock to wake up a parked consumer.
+    ///
+    /// The implementation is a bounded ring of sequenced cells (D. Vyukov's
+    /// bounded MPMC queue). Producers may also pop, which is used to drop
+    /// the oldest message when the queue is full.
+    template<typename T>
+    class PublishQueue
+    {
+      /// \brief Constructor.
+      /// \param[in] _capacity Maximum number of queued elements. It is
+      /// clamped to [kMinPublishQueueSize, kMaxPublishQueueSize] and rounded
+      /// up to the next power of two.
+      /// \param[in] _policy What to do when the queue is full.
+      public: PublishQueue(const std::size_t _capacity,
+                           const PublishQueuePolicy _policy)
+        : policy(_policy)
+      {
+        const std::size_t capacity =
+          std::min(_capacity, kMaxPublishQueueSize);
+        std::size_t size = kMinPublishQueueSize;
+        while (size < capacity)
+          size <<= 1;
+
+        this->mask = size - 1;
+        this->cells.reset(new Cell[size]);
+        for (std::size_t i = 0; i < size; ++i)
+          this->cells[i].sequence.store(i, std::memory_order_relaxed);
+      }
+
+      /// \brief Push an element. If the queue is full, the overflow policy
+      /// is applied. A push from the consumer thread never blocks: if the
+      /// policy is BLOCK, the element is dropped instead, because nobody
+      /// else would make room for it.
+      /// \param[in] _item The element.
+      /// \return True if _item was queued, false if it was dropped.
+      public: bool Push(T &&_item)
+      {
+        unsigned int attempts = 0;
+        while (!this->TryPush(_item))
+        {
+          if (this->closed ||
+              this->policy == PublishQueuePolicy::DROP_NEWEST ||
+              (this->policy == PublishQueuePolicy::BLOCK &&
+               std::this_thread::get_id() == this->consumerId.load()))
+          {
+            ++this->dropped;
+            return false;
+          }
+
+          if (this->policy == PublishQueuePolicy::DROP_OLDEST)
+          {
+            T oldest;
+            if (this->TryPop(oldest))
+              ++this->dropped;
+          }
+          else
+          {
+            // Blocking: the consumer is busy, back off.
+            this->Backoff(attempts++);
+          }
+        }
+
+        // Wake up the consumer if it's parked. The fence pairs with the one
+        // in WaitAndPop(): either we see the flag or the consumer sees the
+        // new element.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (this->parked.load())
+        {
+          std::lock_guard<std::mutex> lk(this->mutex);
+          this->cv.notify_one();
+        }
+
+        return true;
+      }
+
+      /// \brief Pop an element without blocking.
+      /// \param[out] _item The element.
+      /// \return True if an element was popped.
+      public: bool Pop(T &_item)
+      {
+        return this->TryPop(_item);
+      }
+
+      /// \brief Pop an element, waiting if the queue is empty. Only the
+      /// consumer thread should call this function.
+      /// \param[out] _item The element.
+      /// \param[in] _timeout Maximum time to wait.
+      /// \return True if an element was popped, false on timeout or if the
+      /// queue was closed.
+      public: bool WaitAndPop(T &_item,
+                              const std::chrono::milliseconds &_timeout)
+      {
+        this->consumerId.store(std::this_thread::get_id());
+
+        // Spin for a little while, new messages usually come in bursts.
+        for (unsigned int i = 0; i < kSpinIterations; ++i)
+        {
+          if (this->TryPop(_item))
+            return true;
+          if (this->closed)
+            return false;
+          std::this_thread::yield();
+        }
+
+        // Park. The flag is set before checking the queue again, so a
+        // producer either sees the flag or we see its element.
+        std::unique_lock<std::mutex> lk(this->mutex);
+        this->parked.store(true);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        bool popped = false;
+        this->cv.wait_for(lk, _timeout, [&]
+          {
+            popped = this->TryPop(_item);
+            return popped || this->closed;
+          });
+        this->parked.store(false);
+
+        return popped;
+      }
+
+      /// \brief Close the queue. The consumer is woken up and producers stop
+      /// blocking: a push onto a full closed queue is dropped.
+      public: void Close()
+      {
+        std::lock_guard<std::mutex> lk(this->mutex);
+        this->closed = true;
+        this->cv.notify_all();
+      }
+
+      /// \brief Get the number of elements waiting in the queue.
+      /// \return The approximate number of queued elements.
+      public: std::size_t Depth() const
+      {
+        std::size_t head = this->dequeuePos.load(std::memory_order_relaxed);
+        std::size_t tail = this->enqueuePos.load(std::memory_order_relaxed);
+        return tail >= head ? tail - head : 0;
+      }
+
+      /// \brief Get the capacity of the queue.
+      /// \return The maximum number of queued elements.
+      public: std::size_t Capacity() const
+      {
+        return this->mask + 1;
+      }
+
+      /// \brief Get the number of elements dropped because the queue was
+      /// full (or closed).
+      /// \return The number of dropped elements.
+      public: uint64_t Dropped() const
+      {
+        return this->dropped.load();
+      }
+
+      /// \brief Get the overflow policy.
+      /// \return The overflow policy.
+      public: PublishQueuePolicy Policy() const
+      {
+        return this->policy;
+      }
+
+      /// \brief Try to push an element.
+      /// \param[in, out] _item The element. It's moved only on success.
+      /// \return True on success, false if the queue is full.
+      private: bool TryPush(T &_item)
+      {
+        std::size_t pos = this->enqueuePos.load(std::memory_order_relaxed);
+        for (;;)
+        {
+          Cell &cell = this->cells[pos & this->mask];
+          std::size_t seq = cell.sequence.load(std::memory_order_acquire);
+          intptr_t diff =
+            static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+          if (diff == 0)
+          {
+            if (this->enqueuePos.compare_exchange_weak(
+                  pos, pos + 1, std::memory_order_relaxed))
+            {
+              cell.data = std::move(_item);
+              cell.sequence.store(pos + 1, std::memory_order_release);
+              return true;
+            }
+          }
+          else if (diff < 0)
+          {
+            return false;
+          }
+          else
+          {
+            pos = this->enqueuePos.load(std::memory_order_relaxed);
+          }
+        }
+      }
+
+      /// \brief Try to pop an element.
+      /// \param[out] _item The element.
+      /// \return True on success, false if the queue is empty.
+      private: bool TryPop(T &_item)
+      {
+        std::size_t pos = this->dequeuePos.load(std::memory_order_relaxed);
+        for (;;)
+        {
+          Cell &cell = this->cells[pos & this->mask];
+          std::size_t seq = cell.sequence.load(std::memory_order_acquire);
+          intptr_t diff =
+            static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+          if (diff == 0)
+          {
+            if (this->dequeuePos.compare_exchange_weak(
+                  pos, pos + 1, std::memory_order_relaxed))
+            {
+              _item = std::move(cell.data);
+              cell.sequence.store(pos + this->mask + 1,
+                  std::memory_order_release);
+              return true;
+            }
+          }
+          else if (diff < 0)
+          {
+            return false;
+          }
+          else
+          {
+            pos = this->dequeuePos.load(std::memory_order_relaxed);
+          }
+        }
+      }
+
+      /// \brief Wait a bit before retrying a blocked push. Spin first, then
+      /// yield and finally sleep.
+      /// \param[in] _attempt Number of previous attempts.
+      private: void Backoff(const unsigned int _attempt)
+      {
+        if (_attempt < kSpinIterations)
+          std::this_thread::yield();
+        else
+          std::this_thread::sleep_for(std::chrono::microseconds(50));
+      }
+
+      /// \brief A slot of the ring.
+      private: struct Cell
+               {
+                 /// \brief Sequence number used to synchronize the slot.
+                 public: std::atomic<std::size_t> sequence;
+
+                 /// \brief The element.
+                 public: T data;
+               };
+
+      /// \brief Number of times the consumer spins before parking, and the
+      /// number of times a blocked producer yields before sleeping.
+      private: static const unsigned int kSpinIterations = 64;
+
+      /// \brief The ring.
+      private: std::unique_ptr<Cell[]> cells;
+
+      /// \brief Capacity - 1. The capacity is a power of two.
+      private: std::size_t mask = 0;
+
+      /// \brief Overflow policy.
+      private: const PublishQueuePolicy policy;
+
+      /// \brief Next position to push.
+      private: alignas(64) std::atomic<std::size_t> enqueuePos{0};
+
+      /// \brief Next position to pop.
+      private: alignas(64) std::atomic<std::size_t> dequeuePos{0};
+
+      /// \brief Number of dropped elements.
+      private: std::atomic<uint64_t> dropped{0};
+
+      /// \brief True while the consumer is parked.
+      private: std::atomic<bool> parked{false};
+
+      /// \brief True when the queue is closed.
+      private: std::atomic<bool> closed{false};
+
+      /// \brief Id of the consumer thread.
+      private: std::atomic<std::thread::id> consumerId;
+
+      /// \brief Mutex used to park the consumer.
+      private: std::mutex mutex;
+
+      /// \brief Used to wake up the consumer.
+      private: std::condition_variable cv;
+    };
+    }
+  }
+}
+#endif
@@ -0,0 +1,257 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <chrono>
+#include <cstddef>
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "PublishQueue.hh"
+#include "gtest/gtest.h"
+
+using namespace ignition;
+using namespace transport;
+
+using IntQueue = PublishQueue<std::unique_ptr<int>>;
+
+//////////////////////////////////////////////////
+/// \brief Check the policy parser.
+TEST(PublishQueueTest, PolicyFromString)
+{
+  PublishQueuePolicy policy = PublishQueuePolicy::BLOCK;
+  EXPECT_TRUE(PublishQueuePolicyFromString("drop_oldest", policy));
+  EXPECT_EQ(PublishQueuePolicy::DROP_OLDEST, policy);
+  EXPECT_TRUE(PublishQueuePolicyFromString("drop_newest", policy));
+  EXPECT_EQ(PublishQueuePolicy::DROP_NEWEST, policy);
+  EXPECT_TRUE(PublishQueuePolicyFromString("block", policy));
+  EXPECT_EQ(PublishQueuePolicy::BLOCK, policy);
+  EXPECT_FALSE(PublishQueuePolicyFromString("whatever", policy));
+  EXPECT_EQ(PublishQueuePolicy::BLOCK, policy);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the capacity parser.
+TEST(PublishQueueTest, SizeFromString)
+{
+  std::size_t size = 16;
+  EXPECT_TRUE(PublishQueueSizeFromString("1000", size));
+  EXPECT_EQ(1000u, size);
+  EXPECT_TRUE(PublishQueueSizeFromString("2", size));
+  EXPECT_EQ(2u, size);
+  EXPECT_TRUE(PublishQueueSizeFromString("1048576", size));
+  EXPECT_EQ(kMaxPublishQueueSize, size);
+
+  // Invalid values don't modify the output.
+  for (const std::string str : {"", "-1", "+4", " 4", "4 ", "0x10", "abc",
+                                "0", "1", "1048577", "1073741825",
+                                "18446744073709551615",
+                                "99999999999999999999999"})
+  {
+    EXPECT_FALSE(PublishQueueSizeFromString(str, size)) << str;
+    EXPECT_EQ(kMaxPublishQueueSize, size) << str;
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Out of range capacities are clamped.
+TEST(PublishQueueTest, ClampCapacity)
+{
+  IntQueue empty(0, PublishQueuePolicy::DROP_NEWEST);
+  EXPECT_EQ(kMinPublishQueueSize, empty.Capacity());
+
+  IntQueue huge(std::numeric_limits<std::size_t>::max(),
+                PublishQueuePolicy::DROP_NEWEST);
+  EXPECT_EQ(kMaxPublishQueueSize, huge.Capacity());
+}
+
+//////////////////////////////////////////////////
+/// \brief Elements are popped in order and the capacity is a power of two.
+TEST(PublishQueueTest, PushPop)
+{
+  IntQueue queue(5, PublishQueuePolicy::DROP_NEWEST);
+  EXPECT_EQ(8u, queue.Capacity());
+  EXPECT_EQ(0u, queue.Depth());
+
+  std::unique_ptr<int> item;
+  EXPECT_FALSE(queue.Pop(item));
+
+  for (int i = 0; i < 3; ++i)
+    EXPECT_TRUE(queue.Push(std::unique_ptr<int>(new int(i))));
+  EXPECT_EQ(3u, queue.Depth());
+
+  for (int i = 0; i < 3; ++i)
+  {
+    ASSERT_TRUE(queue.Pop(item));
+    EXPECT_EQ(i, *item);
+  }
+  EXPECT_FALSE(queue.Pop(item));
+  EXPECT_EQ(0u, queue.Depth());
+  EXPECT_EQ(0u, queue.Dropped());
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the DROP_NEWEST policy.
+TEST(PublishQueueTest, DropNewest)
+{
+  IntQueue queue(4, PublishQueuePolicy::DROP_NEWEST);
+  for (int i = 0; i < 6; ++i)
+    queue.Push(std::unique_ptr<int>(new int(i)));
+
+  EXPECT_EQ(4u, queue.Depth());
+  EXPECT_EQ(2u, queue.Dropped());
+
+  std::unique_ptr<int> item;
+  ASSERT_TRUE(queue.Pop(item));
+  EXPECT_EQ(0, *item);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the DROP_OLDEST policy.
+TEST(PublishQueueTest, DropOldest)
+{
+  IntQueue queue(4, PublishQueuePolicy::DROP_OLDEST);
+  for (int i = 0; i < 6; ++i)
+    EXPECT_TRUE(queue.Push(std::unique_ptr<int>(new int(i))));
+
+  EXPECT_EQ(4u, queue.Depth());
+  EXPECT_EQ(2u, queue.Dropped());
+
+  std::unique_ptr<int> item;
+  ASSERT_TRUE(queue.Pop(item));
+  EXPECT_EQ(2, *item);
+}
+
+//////////////////////////////////////////////////
+/// \brief A blocked producer resumes when the consumer makes room, and a
+/// closed queue doesn't block.
+TEST(PublishQueueTest, Block)
+{
+  IntQueue queue(2, PublishQueuePolicy::BLOCK);
+  EXPECT_TRUE(queue.Push(std::unique_ptr<int>(new int(0))));
+  EXPECT_TRUE(queue.Push(std::unique_ptr<int>(new int(1))));
+
+  std::thread producer([&queue]()
+  {
+    EXPECT_TRUE(queue.Push(std::unique_ptr<int>(new int(2))));
+  });
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(2u, queue.Depth());
+
+  std::unique_ptr<int> item;
+  ASSERT_TRUE(queue.WaitAndPop(item, std::chrono::milliseconds(100)));
+  EXPECT_EQ(0, *item);
+  producer.join();
+
+  ASSERT_TRUE(queue.WaitAndPop(item, std::chrono::milliseconds(100)));
+  EXPECT_EQ(1, *item);
+  ASSERT_TRUE(queue.WaitAndPop(item, std::chrono::milliseconds(100)));
+  EXPECT_EQ(2, *item);
+  EXPECT_EQ(0u, queue.Dropped());
+
+  // The consumer thread can't block on itself.
+  EXPECT_TRUE(queue.Push(std::unique_ptr<int>(new int(3))));
+  EXPECT_TRUE(queue.Push(std::unique_ptr<int>(new int(4))));
+  EXPECT_FALSE(queue.Push(std::unique_ptr<int>(new int(5))));
+  EXPECT_EQ(1u, queue.Dropped());
+
+  // Nor can anybody else once the queue is closed.
+  queue.Close();
+  std::thread lateProducer([&queue]()
+  {
+    EXPECT_FALSE(queue.Push(std::unique_ptr<int>(new int(6))));
+  });
+  lateProducer.join();
+  EXPECT_EQ(2u, queue.Dropped());
+}
+
+//////////////////////////////////////////////////
+/// \brief A parked consumer is woken up by a producer, and it times out if
+/// there's nothing to pop.
+TEST(PublishQueueTest, WaitAndPop)
+{
+  IntQueue queue(8, PublishQueuePolicy::BLOCK);
+
+  std::unique_ptr<int> item;
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_FALSE(queue.WaitAndPop(item, std::chrono::milliseconds(50)));
+  EXPECT_GE(std::chrono::steady_clock::now() - start,
+            std::chrono::milliseconds(50));
+
+  std::thread producer([&queue]()
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    queue.Push(std::unique_ptr<int>(new int(7)));
+  });
+
+  ASSERT_TRUE(queue.WaitAndPop(item, std::chrono::seconds(5)));
+  EXPECT_EQ(7, *item);
+  producer.join();
+}
+
+//////////////////////////////////////////////////
+/// \brief Many producers and one consumer, nothing is lost or duplicated.
+TEST(PublishQueueTest, MultipleProducers)
+{
+  const int kProducers = 8;
+  const int kItemsPerProducer = 10000;
+  IntQueue queue(64, PublishQueuePolicy::BLOCK);
+
+  std::vector<std::thread> producers;
+  for (int p = 0; p < kProducers; ++p)
+  {
+    producers.emplace_back([&queue, p]()
+    {
+      for (int i = 0; i < kItemsPerProducer; ++i)
+      {
+        EXPECT_TRUE(queue.Push(
+          std::unique_ptr<int>(new int(p * kItemsPerProducer + i))));
+      }
+    });
+  }
+
+  std::vector<int> lastSeen(kProducers, -1);
+  int received = 0;
+  std::unique_ptr<int> item;
+  while (received < kProducers * kItemsPerProducer &&
+         queue.WaitAndPop(item, std::chrono::seconds(5)))
+  {
+    // Elements from the same producer keep their order.
+    int producer = *item / kItemsPerProducer;
+    int index = *item % kItemsPerProducer;
+    EXPECT_GT(index, lastSeen[producer]);
+    lastSeen[producer] = index;
+    ++received;
+  }
+
+  for (auto &producer : producers)
+    producer.join();
+
+  EXPECT_EQ(kProducers * kItemsPerProducer, received);
+  EXPECT_EQ(0u, queue.Dropped());
+  EXPECT_EQ(0u, queue.Depth());
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
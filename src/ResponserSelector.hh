@@ -0,0 +1,260 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef IGN_TRANSPORT_RESPONSERSELECTOR_HH_
+#define IGN_TRANSPORT_RESPONSERSELECTOR_HH_
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "ignition/transport/config.hh"
+#include "ignition/transport/NodeOptions.hh"
+#include "ignition/transport/Publisher.hh"
+
+namespace ignition
+{
+  namespace transport
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_TRANSPORT_VERSION_NAMESPACE {
+    //
+    /// \class ResponserSelector ResponserSelector.hh
+    /// \brief Chooses which of the responsers of a service gets a request,
+    /// following a ResponserPolicy_t. It keeps track of the requests waiting
+    /// for each responser and of the latency of their responses.
+    /// Not thread safe.
+    class ResponserSelector
+    {
+      /// \brief Set the address of this host and the UUID of this process,
+      /// used to find the responsers running on the same host.
+      /// \param[in] _hostAddr IP address of this host.
+      /// \param[in] _pUuid UUID of this process.
+      public: void SetLocal(const std::string &_hostAddr,
+                            const std::string &_pUuid)
+      {
+        this->hostAddr = _hostAddr;
+        this->pUuid = _pUuid;
+      }
+
+      /// \brief Choose a responser.
+      /// \param[in] _topic Service name.
+      /// \param[in] _candidates Responsers of the service with the right
+      /// types. It can't be empty.
+      /// \param[in] _policy How to choose.
+      /// \return The index of the responser in _candidates.
+      public: std::size_t Select(
+                  const std::string &_topic,
+                  const std::vector<ServicePublisher> &_candidates,
+                  const ResponserPolicy_t _policy)
+      {
+        const std::size_t n = _candidates.size();
+        if (n <= 1u || _policy == ResponserPolicy_t::FIRST)
+          return 0u;
+
+        // Start where the last request of the service left off, so the
+        // responsers tied on the policy share the requests.
+        const std::size_t start = this->next[_topic]++ % n;
+
+        std::size_t best = start;
+        double bestScore = 0;
+        bool found = false;
+        for (std::size_t i = 0; i < n; ++i)
+        {
+          const std::size_t index = (start + i) % n;
+          const auto &candidate = _candidates[index];
+
+          double score;
+          switch (_policy)
+          {
+            case ResponserPolicy_t::LEAST_OUTSTANDING:
+              score = static_cast<double>(
+                this->stats[candidate.SocketId()].outstanding);
+              break;
+            case ResponserPolicy_t::LOWEST_LATENCY:
+            {
+              // The expected wait: the latency of the responser times the
+              // requests ahead of this one. Responsers without responses
+              // yet are tried first.
+              const auto &stats = this->stats[candidate.SocketId()];
+              score = stats.latency * (stats.outstanding + 1);
+              break;
+            }
+            case ResponserPolicy_t::SAME_HOST:
+              score = this->IsLocal(candidate) ? 0 : 1;
+              break;
+            default:
+              score = 0;
+              break;
+          }
+
+          if (!found || score < bestScore)
+          {
+            best = index;
+            bestScore = score;
+            found = true;
+          }
+        }
+
+        return best;
+      }
+
+      /// \brief Record that a request was sent to a responser.
+      /// \param[in] _id Socket ID of the responser.
+      public: void OnSent(const std::string &_id)
+      {
+        ++this->stats[_id].outstanding;
+      }
+
+      /// \brief Record the response of a responser.
+      /// \param[in] _id Socket ID of the responser.
+      /// \param[in] _latency Time since the request was sent.
+      public: void OnResponse(
+                  const std::string &_id,
+                  const std::chrono::steady_clock::duration _latency)
+      {
+        auto &stats = this->stats[_id];
+        if (stats.outstanding > 0u)
+          --stats.outstanding;
+
+        const double ms =
+          std::chrono::duration<double, std::milli>(_latency).count();
+        if (stats.latency <= 0)
+          stats.latency = ms;
+        else
+          stats.latency += kLatencyWeight * (ms - stats.latency);
+      }
+
+      /// \brief Record that a request sent to a responser won't get a
+      /// response: its timeout expired, it couldn't be sent or it was
+      /// abandoned.
+      /// \param[in] _id Socket ID of the responser.
+      public: void OnFailed(const std::string &_id)
+      {
+        auto it = this->stats.find(_id);
+        if (it != this->stats.end() && it->second.outstanding > 0u)
+          --it->second.outstanding;
+      }
+
+      /// \brief Forget the responsers that are gone.
+      /// \param[in] _ids Socket IDs of the responsers still known.
+      public: void Retain(const std::unordered_set<std::string> &_ids)
+      {
+        for (auto it = this->stats.begin(); it != this->stats.end();)
+        {
+          if (_ids.find(it->first) == _ids.end())
+            it = this->stats.erase(it);
+          else
+            ++it;
+        }
+      }
+
+      /// \brief Forget where the next selection starts for the services
+      /// without responsers left.
+      /// \param[in] _topics Services which still have responsers.
+      public: void RetainServices(
+                  const std::unordered_set<std::string> &_topics)
+      {
+        for (auto it = this->next.begin(); it != this->next.end();)
+        {
+          if (_topics.find(it->first) == _topics.end())
+            it = this->next.erase(it);
+          else
+            ++it;
+        }
+      }
+
+      /// \brief Get the number of responsers with stats.
+      /// \return The number of responsers.
+      public: std::size_t Size() const
+      {
+        return this->stats.size();
+      }
+
+      /// \brief Get the number of services whose requests were spread among
+      /// several responsers.
+      /// \return The number of services.
+      public: std::size_t ServiceCount() const
+      {
+        return this->next.size();
+      }
+
+      /// \brief Get the number of requests waiting for a responser.
+      /// \param[in] _id Socket ID of the responser.
+      /// \return The number of requests.
+      public: std::size_t Outstanding(const std::string &_id) const
+      {
+        auto it = this->stats.find(_id);
+        return it == this->stats.end() ? 0u : it->second.outstanding;
+      }
+
+      /// \brief Whether a responser runs on this host.
+      /// \param[in] _pub The responser.
+      /// \return True if it runs on this host.
+      private: bool IsLocal(const ServicePublisher &_pub) const
+      {
+        if (_pub.PUuid() == this->pUuid)
+          return true;
+
+        // The advertised address has the form tcp://<host>:<port>.
+        const std::string prefix = "tcp://";
+        const std::string &addr = _pub.Addr();
+        auto portPos = addr.rfind(':');
+        if (addr.compare(0, prefix.size(), prefix) != 0 ||
+            portPos == std::string::npos || portPos < prefix.size())
+        {
+          return false;
+        }
+
+        const std::string host = addr.substr(prefix.size(),
+            portPos - prefix.size());
+        return host == this->hostAddr || host.compare(0, 4, "127.") == 0;
+      }
+
+      /// \brief Weight of a new sample in the latency average.
+      private: static constexpr double kLatencyWeight = 0.2;
+
+      /// \brief What we know about a responser.
+      private: struct Stats
+               {
+                 /// \brief Requests waiting for a response.
+                 public: std::size_t outstanding = 0;
+
+                 /// \brief Moving average of the latency (ms), or 0 if there
+                 /// wasn't any response yet.
+                 public: double latency = 0;
+               };
+
+      /// \brief Stats indexed by the socket ID of the responser.
+      private: std::unordered_map<std::string, Stats> stats;
+
+      /// \brief Where the next selection starts, indexed by service name.
+      private: std::unordered_map<std::string, std::size_t> next;
+
+      /// \brief IP address of this host.
+      private: std::string hostAddr;
+
+      /// \brief UUID of this process.
+      private: std::string pUuid;
+    };
+    }
+  }
+}
+#endif
@@ -0,0 +1,241 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "ignition/transport/AdvertiseOptions.hh"
+#include "ignition/transport/Publisher.hh"
+#include "ResponserSelector.hh"
+#include "gtest/gtest.h"
+
+using namespace ignition;
+using namespace transport;
+
+static const std::string g_topic = "/foo"; // NOLINT(*)
+
+//////////////////////////////////////////////////
+/// \brief Create a responser.
+/// \param[in] _addr Address of the responser.
+/// \param[in] _id Socket ID of the responser.
+/// \return The responser.
+static ServicePublisher makeResponser(const std::string &_addr,
+                                      const std::string &_id)
+{
+  return ServicePublisher(g_topic, _addr, _id, "pUuid-" + _id,
+    "nUuid-" + _id, "reqType", "repType", AdvertiseServiceOptions());
+}
+
+//////////////////////////////////////////////////
+/// \brief Three responsers on three hosts.
+static std::vector<ServicePublisher> makeResponsers()
+{
+  return {
+    makeResponser("tcp://10.0.0.1:1000", "a"),
+    makeResponser("tcp://10.0.0.2:1000", "b"),
+    makeResponser("tcp://10.0.0.3:1000", "c")};
+}
+
+//////////////////////////////////////////////////
+TEST(ResponserSelectorTest, First)
+{
+  ResponserSelector selector;
+  auto responsers = makeResponsers();
+  for (int i = 0; i < 5; ++i)
+  {
+    EXPECT_EQ(selector.Select(g_topic, responsers, ResponserPolicy_t::FIRST),
+      0u);
+  }
+}
+
+//////////////////////////////////////////////////
+TEST(ResponserSelectorTest, RoundRobin)
+{
+  ResponserSelector selector;
+  auto responsers = makeResponsers();
+
+  std::vector<int> counts(responsers.size(), 0);
+  for (int i = 0; i < 30; ++i)
+  {
+    ++counts[selector.Select(g_topic, responsers,
+      ResponserPolicy_t::ROUND_ROBIN)];
+  }
+
+  for (auto count : counts)
+    EXPECT_EQ(count, 10);
+
+  // A single responser.
+  responsers.resize(1);
+  EXPECT_EQ(selector.Select(g_topic, responsers,
+    ResponserPolicy_t::ROUND_ROBIN), 0u);
+}
+
+//////////////////////////////////////////////////
+TEST(ResponserSelectorTest, LeastOutstanding)
+{
+  ResponserSelector selector;
+  auto responsers = makeResponsers();
+
+  // Nothing answers, so the requests spread evenly.
+  for (int i = 0; i < 30; ++i)
+  {
+    auto index = selector.Select(g_topic, responsers,
+      ResponserPolicy_t::LEAST_OUTSTANDING);
+    selector.OnSent(responsers[index].SocketId());
+  }
+
+  for (const auto &responser : responsers)
+    EXPECT_EQ(selector.Outstanding(responser.SocketId()), 10u);
+
+  // "b" answers everything, so it gets the next request.
+  for (int i = 0; i < 10; ++i)
+    selector.OnResponse("b", std::chrono::milliseconds(1));
+  EXPECT_EQ(selector.Outstanding("b"), 0u);
+
+  auto index = selector.Select(g_topic, responsers,
+    ResponserPolicy_t::LEAST_OUTSTANDING);
+  EXPECT_EQ(responsers[index].SocketId(), "b");
+}
+
+//////////////////////////////////////////////////
+TEST(ResponserSelectorTest, Failures)
+{
+  ResponserSelector selector;
+  auto responsers = makeResponsers();
+
+  // The requests sent to "a" time out, so it isn't avoided forever.
+  for (int i = 0; i < 3; ++i)
+    selector.OnSent("a");
+  selector.OnSent("b");
+  for (int i = 0; i < 3; ++i)
+    selector.OnFailed("a");
+  EXPECT_EQ(selector.Outstanding("a"), 0u);
+
+  // Extra failures and unknown responsers are ignored.
+  selector.OnFailed("a");
+  selector.OnFailed("unknown");
+  EXPECT_EQ(selector.Outstanding("a"), 0u);
+  EXPECT_EQ(selector.Outstanding("unknown"), 0u);
+
+  auto index = selector.Select(g_topic, responsers,
+    ResponserPolicy_t::LEAST_OUTSTANDING);
+  EXPECT_NE(responsers[index].SocketId(), "b");
+  EXPECT_EQ(selector.Size(), 3u);
+
+  // "b" is gone.
+  selector.Retain({"a", "c"});
+  EXPECT_EQ(selector.Size(), 2u);
+  EXPECT_EQ(selector.Outstanding("b"), 0u);
+
+  selector.Retain({});
+  EXPECT_EQ(selector.Size(), 0u);
+}
+
+//////////////////////////////////////////////////
+TEST(ResponserSelectorTest, RetainServices)
+{
+  ResponserSelector selector;
+  auto responsers = makeResponsers();
+
+  selector.Select(g_topic, responsers, ResponserPolicy_t::ROUND_ROBIN);
+  selector.Select("/other", responsers, ResponserPolicy_t::ROUND_ROBIN);
+  EXPECT_EQ(selector.ServiceCount(), 2u);
+
+  // The last responser of "/other" is gone.
+  selector.RetainServices({g_topic});
+  EXPECT_EQ(selector.ServiceCount(), 1u);
+
+  selector.RetainServices({});
+  EXPECT_EQ(selector.ServiceCount(), 0u);
+}
+
+//////////////////////////////////////////////////
+TEST(ResponserSelectorTest, LowestLatency)
+{
+  ResponserSelector selector;
+  auto responsers = makeResponsers();
+
+  // Responsers without responses yet are tried first.
+  selector.OnSent("a");
+  selector.OnResponse("a", std::chrono::milliseconds(50));
+  selector.OnSent("b");
+  selector.OnResponse("b", std::chrono::milliseconds(10));
+  auto index = selector.Select(g_topic, responsers,
+    ResponserPolicy_t::LOWEST_LATENCY);
+  EXPECT_EQ(responsers[index].SocketId(), "c");
+
+  selector.OnSent("c");
+  selector.OnResponse("c", std::chrono::milliseconds(30));
+
+  for (int i = 0; i < 5; ++i)
+  {
+    index = selector.Select(g_topic, responsers,
+      ResponserPolicy_t::LOWEST_LATENCY);
+    EXPECT_EQ(responsers[index].SocketId(), "b");
+  }
+
+  // The requests waiting for "b" make it slower than "c".
+  for (int i = 0; i < 3; ++i)
+    selector.OnSent("b");
+  index = selector.Select(g_topic, responsers,
+    ResponserPolicy_t::LOWEST_LATENCY);
+  EXPECT_EQ(responsers[index].SocketId(), "c");
+}
+
+//////////////////////////////////////////////////
+TEST(ResponserSelectorTest, SameHost)
+{
+  ResponserSelector selector;
+  selector.SetLocal("10.0.0.2", "myProcess");
+  auto responsers = makeResponsers();
+  responsers.push_back(makeResponser("tcp://127.0.0.1:1000", "d"));
+
+  std::vector<int> counts(responsers.size(), 0);
+  for (int i = 0; i < 20; ++i)
+  {
+    ++counts[selector.Select(g_topic, responsers,
+      ResponserPolicy_t::SAME_HOST)];
+  }
+
+  EXPECT_EQ(counts[0], 0);
+  EXPECT_EQ(counts[1], 10);
+  EXPECT_EQ(counts[2], 0);
+  EXPECT_EQ(counts[3], 10);
+
+  // No responser on this host.
+  selector.SetLocal("10.0.0.9", "myProcess");
+  responsers.pop_back();
+  std::fill(counts.begin(), counts.end(), 0);
+  for (int i = 0; i < 30; ++i)
+  {
+    ++counts[selector.Select(g_topic, responsers,
+      ResponserPolicy_t::SAME_HOST)];
+  }
+
+  for (std::size_t i = 0; i < responsers.size(); ++i)
+    EXPECT_EQ(counts[i], 10);
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -36,6 +36,7 @@ SubscribeOptions::SubscribeOptions(const SubscribeOptions &_otherSubscribeOpts)
   : dataPtr(new SubscribeOptionsPrivate())
 {
   this->SetMsgsPerSec(_otherSubscribeOpts.MsgsPerSec());
+  this->SetExecutor(_otherSubscribeOpts.Executor());
 }
 
 //////////////////////////////////////////////////
@@ -60,3 +61,15 @@ void SubscribeOptions::SetMsgsPerSec(const uint64_t _newMsgsPerSec)
 {
   this->dataPtr->msgsPerSec = _newMsgsPerSec;
 }
+
+//////////////////////////////////////////////////
+void SubscribeOptions::SetExecutor(const Executor_t _executor)
+{
+  this->dataPtr->executor = _executor;
+}
+
+//////////////////////////////////////////////////
+Executor_t SubscribeOptions::Executor() const
+{
+  return this->dataPtr->executor;
+}
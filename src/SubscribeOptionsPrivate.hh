@@ -21,6 +21,7 @@
 #include <cstdint>
 
 #include "ignition/transport/Helpers.hh"
+#include "ignition/transport/SubscribeOptions.hh"
 
 namespace ignition
 {
@@ -41,6 +42,9 @@ namespace ignition
 
       /// \brief Default message subscription rate.
       public: uint64_t msgsPerSec = kUnthrottled;
+
+      /// \brief Executor running the callbacks.
+      public: Executor_t executor = Executor_t::DEFAULT;
     };
     }
   }
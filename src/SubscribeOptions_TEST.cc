@@ -29,9 +29,11 @@ TEST(SubscribeOptionsTest, copyConstructor)
 {
   SubscribeOptions opts1;
   opts1.SetMsgsPerSec(2u);
+  opts1.SetExecutor(Executor_t::DEDICATED);
   EXPECT_EQ(opts1.MsgsPerSec(), 2u);
   SubscribeOptions opts2(opts1);
   EXPECT_EQ(opts2.MsgsPerSec(), opts1.MsgsPerSec());
+  EXPECT_EQ(opts2.Executor(), opts1.Executor());
 }
 
 //////////////////////////////////////////////////
@@ -43,6 +45,11 @@ TEST(SubscribeOptionsTest, accessors)
   EXPECT_EQ(opts.MsgsPerSec(), kUnthrottled);
   opts.SetMsgsPerSec(3u);
   EXPECT_EQ(opts.MsgsPerSec(), 3u);
+
+  // Executor.
+  EXPECT_EQ(opts.Executor(), Executor_t::DEFAULT);
+  opts.SetExecutor(Executor_t::TOPIC_STRAND);
+  EXPECT_EQ(opts.Executor(), Executor_t::TOPIC_STRAND);
 }
 
 //////////////////////////////////////////////////
@@ -49,6 +49,12 @@ namespace ignition
       return this->hUuid;
     }
 
+    /////////////////////////////////////////////////
+    Executor_t SubscriptionHandlerBase::Executor() const
+    {
+      return this->opts.Executor();
+    }
+
     /////////////////////////////////////////////////
     bool SubscriptionHandlerBase::UpdateThrottling()
     {
@@ -80,6 +86,16 @@ namespace ignition
       // Do nothing
     }
 
+    /////////////////////////////////////////////////
+    const std::shared_ptr<ProtoMsg> ISubscriptionHandler::CreateMsg(
+        const char *_data,
+        const std::size_t _size,
+        const std::string &_type) const
+    {
+      // Handlers that only know how to parse a string pay for a copy.
+      return this->CreateMsg(std::string(_data, _size), _type);
+    }
+
     /////////////////////////////////////////////////
     class RawSubscriptionHandler::Implementation
     {
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <memory>
+#include <string>
+#include <ignition/msgs.hh>
+
+#include "ignition/transport/SubscriptionHandler.hh"
+#include "gtest/gtest.h"
+
+using namespace ignition;
+using namespace transport;
+
+//////////////////////////////////////////////////
+/// \brief A handler that only knows how to parse a string.
+class StringOnlyHandler : public ISubscriptionHandler
+{
+  public: StringOnlyHandler()
+    : ISubscriptionHandler("node-UUID")
+  {
+  }
+
+  public: bool RunLocalCallback(const ProtoMsg &,
+                                const MessageInfo &)
+  {
+    return true;
+  }
+
+  public: const std::shared_ptr<ProtoMsg> CreateMsg(
+    const std::string &_data,
+    const std::string &/*_type*/) const
+  {
+    auto msg = std::make_shared<ignition::msgs::Int32>();
+    msg->ParseFromString(_data);
+    return msg;
+  }
+
+  public: using ISubscriptionHandler::CreateMsg;
+
+  public: std::string TypeName()
+  {
+    return ignition::msgs::Int32().GetTypeName();
+  }
+};
+
+//////////////////////////////////////////////////
+/// \brief Messages are parsed in place from a serialized buffer.
+TEST(SubscriptionHandlerTest, CreateMsgFromArray)
+{
+  ignition::msgs::Int32 msg;
+  msg.set_data(5);
+  std::string data;
+  ASSERT_TRUE(msg.SerializeToString(&data));
+
+  SubscriptionHandler<ignition::msgs::Int32> typed("node-UUID");
+  auto typedMsg = typed.CreateMsg(data.data(), data.size(), msg.GetTypeName());
+  ASSERT_NE(nullptr, typedMsg);
+  EXPECT_EQ(5,
+    std::static_pointer_cast<ignition::msgs::Int32>(typedMsg)->data());
+
+  SubscriptionHandler<ProtoMsg> generic("node-UUID");
+  auto genericMsg =
+    generic.CreateMsg(data.data(), data.size(), msg.GetTypeName());
+  ASSERT_NE(nullptr, genericMsg);
+  EXPECT_EQ(msg.DebugString(), genericMsg->DebugString());
+  EXPECT_EQ(nullptr, generic.CreateMsg(data.data(), data.size(), "_unknown_"));
+
+  // Handlers overriding only the string version still work.
+  StringOnlyHandler stringOnly;
+  const ISubscriptionHandler &base = stringOnly;
+  auto stringOnlyMsg = base.CreateMsg(data.data(), data.size(),
+    msg.GetTypeName());
+  ASSERT_NE(nullptr, stringOnlyMsg);
+  EXPECT_EQ(msg.DebugString(), stringOnlyMsg->DebugString());
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,227 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#ifndef IGN_TRANSPORT_TOPICID_HH_
+#define IGN_TRANSPORT_TOPICID_HH_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "ignition/transport/config.hh"
+
+namespace ignition
+{
+  namespace transport
+  {
+    // Inline bracket to help doxygen filtering.
+    inline namespace IGNITION_TRANSPORT_VERSION_NAMESPACE {
+    //
+    /// \brief Compact identifier of a (topic, message type) pair. Data
+    /// messages carry it instead of the topic and type names.
+    using TopicId = uint64_t;
+
+    /// \brief Size of an encoded TopicId (bytes).
+    static const std::size_t kTopicIdSize = sizeof(TopicId);
+
+    /// \brief Get the identifier of a topic and message type. Every process
+    /// derives the same identifier from the same names (64-bit FNV-1a), so
+    /// publishers and subscribers don't need to exchange it.
+    /// \param[in] _topic Fully qualified topic name.
+    /// \param[in] _type Message type name.
+    /// \return The identifier.
+    inline TopicId MakeTopicId(const std::string &_topic,
+                               const std::string &_type)
+    {
+      const uint64_t kPrime = 1099511628211ULL;
+      uint64_t hash = 14695981039346656037ULL;
+
+      auto add = [&hash, kPrime](const std::string &_str)
+      {
+        for (const unsigned char c : _str)
+        {
+          hash ^= c;
+          hash *= kPrime;
+        }
+      };
+
+      add(_topic);
+      // Hash a null separator, so ("/a", "b.c") and ("/ab", ".c") differ.
+      hash *= kPrime;
+      add(_type);
+
+      return hash;
+    }
+
+    /// \brief Encode an identifier in network byte order.
+    /// \param[in] _id The identifier.
+    /// \param[out] _buffer Buffer of at least kTopicIdSize bytes.
+    inline void EncodeTopicId(const TopicId _id, char *_buffer)
+    {
+      for (std::size_t i = 0; i < kTopicIdSize; ++i)
+      {
+        _buffer[i] = static_cast<char>(
+          (_id >> (8 * (kTopicIdSize - 1 - i))) & 0xff);
+      }
+    }
+
+    /// \brief Decode an identifier encoded with EncodeTopicId().
+    /// \param[in] _data The encoded identifier.
+    /// \param[in] _size Size of _data (bytes).
+    /// \param[out] _id The identifier.
+    /// \return False if _data doesn't have the size of an identifier.
+    inline bool DecodeTopicId(const void *_data, const std::size_t _size,
+                              TopicId &_id)
+    {
+      if (_size != kTopicIdSize)
+        return false;
+
+      const unsigned char *bytes = static_cast<const unsigned char *>(_data);
+      _id = 0;
+      for (std::size_t i = 0; i < kTopicIdSize; ++i)
+        _id = (_id << 8) | bytes[i];
+
+      return true;
+    }
+
+    /// \brief Thread safe table of the topic and type behind each identifier
+    /// that a process is subscribed to. Each entry counts how many times it
+    /// was added, which matches the number of ZeroMQ filters installed for
+    /// it.
+    class TopicIdTable
+    {
+      /// \brief Add a reference to the identifier of a topic and type.
+      /// \param[in] _topic Fully qualified topic name.
+      /// \param[in] _type Message type name.
+      /// \param[out] _id The identifier.
+      /// \return False if the identifier collides with another topic and
+      /// type, in which case nothing is added.
+      public: bool Add(const std::string &_topic,
+                       const std::string &_type,
+                       TopicId &_id)
+      {
+        _id = MakeTopicId(_topic, _type);
+
+        std::lock_guard<std::mutex> lk(this->mutex);
+        auto it = this->entries.find(_id);
+        if (it == this->entries.end())
+        {
+          this->entries[_id] = Entry{_topic, _type, 1};
+          ++this->version;
+          return true;
+        }
+
+        if (it->second.topic != _topic || it->second.type != _type)
+        {
+          std::cerr << "Topic [" << _topic << "] with type [" << _type
+                    << "] has the same identifier as topic ["
+                    << it->second.topic << "] with type [" << it->second.type
+                    << "]" << std::endl;
+          return false;
+        }
+
+        ++it->second.refs;
+        return true;
+      }
+
+      /// \brief Remove all the identifiers of a topic.
+      /// \param[in] _topic Fully qualified topic name.
+      /// \return The identifiers removed and how many references each one
+      /// had.
+      public: std::vector<std::pair<TopicId, unsigned int>> Remove(
+        const std::string &_topic)
+      {
+        std::vector<std::pair<TopicId, unsigned int>> removed;
+
+        std::lock_guard<std::mutex> lk(this->mutex);
+        for (auto it = this->entries.begin(); it != this->entries.end();)
+        {
+          if (it->second.topic == _topic)
+          {
+            removed.push_back(std::make_pair(it->first, it->second.refs));
+            it = this->entries.erase(it);
+          }
+          else
+            ++it;
+        }
+
+        if (!removed.empty())
+          ++this->version;
+
+        return removed;
+      }
+
+      /// \brief Get the topic and type of an identifier.
+      /// \param[in] _id The identifier.
+      /// \param[out] _topic Fully qualified topic name.
+      /// \param[out] _type Message type name.
+      /// \return False if the identifier isn't in the table.
+      public: bool Find(const TopicId _id,
+                        std::string &_topic,
+                        std::string &_type) const
+      {
+        std::lock_guard<std::mutex> lk(this->mutex);
+        auto it = this->entries.find(_id);
+        if (it == this->entries.end())
+          return false;
+
+        _topic = it->second.topic;
+        _type = it->second.type;
+        return true;
+      }
+
+      /// \brief Get the version of the table. It grows every time that an
+      /// identifier is added or removed.
+      /// \return The version.
+      public: uint64_t Version() const
+      {
+        return this->version.load(std::memory_order_acquire);
+      }
+
+      /// \brief An entry of the table.
+      private: struct Entry
+               {
+                 /// \brief Fully qualified topic name.
+                 public: std::string topic;
+
+                 /// \brief Message type name.
+                 public: std::string type;
+
+                 /// \brief Number of references.
+                 public: unsigned int refs;
+               };
+
+      /// \brief Protects the entries.
+      private: mutable std::mutex mutex;
+
+      /// \brief The entries, indexed by identifier.
+      private: std::unordered_map<TopicId, Entry> entries;
+
+      /// \brief Version of the table.
+      private: std::atomic<uint64_t> version{0};
+    };
+    }
+  }
+}
+
+#endif
@@ -0,0 +1,112 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <string>
+
+#include "TopicId.hh"
+#include "gtest/gtest.h"
+
+using namespace ignition;
+using namespace transport;
+
+//////////////////////////////////////////////////
+/// \brief Identifiers only depend on the topic and the type.
+TEST(TopicIdTest, MakeTopicId)
+{
+  const std::string type = "ignition.msgs.Int32";
+  EXPECT_EQ(MakeTopicId("/foo", type), MakeTopicId("/foo", type));
+  EXPECT_NE(MakeTopicId("/foo", type), MakeTopicId("/bar", type));
+  EXPECT_NE(MakeTopicId("/foo", type),
+            MakeTopicId("/foo", "ignition.msgs.Int64"));
+  EXPECT_NE(MakeTopicId("/a", "b.c"), MakeTopicId("/ab", ".c"));
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the encoding.
+TEST(TopicIdTest, EncodeDecode)
+{
+  const TopicId id = 0x0102030405060708ULL;
+  char buffer[kTopicIdSize];
+  EncodeTopicId(id, buffer);
+
+  // Network byte order.
+  EXPECT_EQ(1, buffer[0]);
+  EXPECT_EQ(8, buffer[kTopicIdSize - 1]);
+
+  TopicId decoded = 0;
+  EXPECT_TRUE(DecodeTopicId(buffer, sizeof(buffer), decoded));
+  EXPECT_EQ(id, decoded);
+
+  // A topic name isn't an identifier.
+  const std::string topic = "/foo";
+  EXPECT_FALSE(DecodeTopicId(topic.data(), topic.size(), decoded));
+
+  const TopicId maxId = ~TopicId(0);
+  EncodeTopicId(maxId, buffer);
+  EXPECT_TRUE(DecodeTopicId(buffer, sizeof(buffer), decoded));
+  EXPECT_EQ(maxId, decoded);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check the table of identifiers.
+TEST(TopicIdTest, Table)
+{
+  TopicIdTable table;
+  std::string topic;
+  std::string type;
+
+  TopicId id1;
+  TopicId id2;
+  uint64_t version = table.Version();
+  EXPECT_TRUE(table.Add("/foo", "type1", id1));
+  EXPECT_TRUE(table.Add("/foo", "type1", id1));
+  EXPECT_TRUE(table.Add("/foo", "type2", id2));
+  EXPECT_EQ(MakeTopicId("/foo", "type1"), id1);
+  EXPECT_NE(id1, id2);
+  EXPECT_GT(table.Version(), version);
+
+  EXPECT_TRUE(table.Find(id1, topic, type));
+  EXPECT_EQ("/foo", topic);
+  EXPECT_EQ("type1", type);
+  EXPECT_FALSE(table.Find(MakeTopicId("/bar", "type1"), topic, type));
+
+  // Nothing to remove.
+  version = table.Version();
+  EXPECT_TRUE(table.Remove("/bar").empty());
+  EXPECT_EQ(version, table.Version());
+
+  // Each identifier is returned with its number of references.
+  auto removed = table.Remove("/foo");
+  ASSERT_EQ(2u, removed.size());
+  for (const auto &entry : removed)
+  {
+    if (entry.first == id1)
+      EXPECT_EQ(2u, entry.second);
+    else
+      EXPECT_EQ(1u, entry.second);
+  }
+  EXPECT_GT(table.Version(), version);
+  EXPECT_FALSE(table.Find(id1, topic, type));
+  EXPECT_FALSE(table.Find(id2, topic, type));
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -501,3 +501,102 @@ TEST(TopicStorageTest, HasTopicWithType)
   EXPECT_TRUE(test.AddPublisher(publisher2));
   EXPECT_TRUE(test.HasTopic(g_topic1));
 }
+
+//////////////////////////////////////////////////
+/// \brief Check that Version() only changes when the storage does.
+TEST(TopicStorageTest, Version)
+{
+  init();
+
+  Publisher publisher1(g_topic1, g_addr1, g_pUuid1, g_nUuid1, g_opts1);
+  Publisher publisher2(g_topic2, g_addr2, g_pUuid2, g_nUuid2, g_opts2);
+
+  TopicStorage<Publisher> test;
+  uint64_t version = test.Version();
+
+  EXPECT_TRUE(test.AddPublisher(publisher1));
+  EXPECT_GT(test.Version(), version);
+  version = test.Version();
+
+  // Nothing changes.
+  EXPECT_FALSE(test.AddPublisher(publisher1));
+  EXPECT_FALSE(test.DelPublisherByNode(g_topic1, g_pUuid1, g_nUuid2));
+  EXPECT_FALSE(test.DelPublishersByProc(g_pUuid2));
+  EXPECT_EQ(version, test.Version());
+
+  EXPECT_TRUE(test.AddPublisher(publisher2));
+  EXPECT_GT(test.Version(), version);
+  version = test.Version();
+
+  EXPECT_TRUE(test.DelPublisherByNode(g_topic1, g_pUuid1, g_nUuid1));
+  EXPECT_GT(test.Version(), version);
+  version = test.Version();
+
+  EXPECT_TRUE(test.DelPublishersByProc(g_pUuid2));
+  EXPECT_GT(test.Version(), version);
+}
+
+//////////////////////////////////////////////////
+/// \brief Check that the lookups by process, node and address follow the
+/// changes of the storage.
+TEST(TopicStorageTest, Indexes)
+{
+  init();
+
+  // Two processes with publishers of the same topics in several nodes.
+  TopicStorage<Publisher> test;
+  for (int i = 0; i < 10; ++i)
+  {
+    const std::string topic = "topic" + std::to_string(i);
+    EXPECT_TRUE(test.AddPublisher(
+      Publisher(topic, g_addr1, g_pUuid1, g_nUuid1, g_opts1)));
+    EXPECT_TRUE(test.AddPublisher(
+      Publisher(topic, g_addr1, g_pUuid1, g_nUuid2, g_opts1)));
+    EXPECT_TRUE(test.AddPublisher(
+      Publisher(topic, g_addr2, g_pUuid2, g_nUuid3, g_opts1)));
+  }
+
+  std::map<std::string, std::vector<Publisher>> pubs;
+  test.PublishersByProc(g_pUuid1, pubs);
+  ASSERT_EQ(pubs.size(), 2u);
+  EXPECT_EQ(pubs[g_nUuid1].size(), 10u);
+  EXPECT_EQ(pubs[g_nUuid2].size(), 10u);
+
+  std::vector<Publisher> nodePubs;
+  test.PublishersByNode(g_pUuid2, g_nUuid3, nodePubs);
+  EXPECT_EQ(nodePubs.size(), 10u);
+
+  // Removing the publishers of one node keeps the other node's.
+  for (int i = 0; i < 10; ++i)
+  {
+    EXPECT_TRUE(test.DelPublisherByNode("topic" + std::to_string(i),
+      g_pUuid1, g_nUuid1));
+  }
+  test.PublishersByNode(g_pUuid1, g_nUuid1, nodePubs);
+  EXPECT_TRUE(nodePubs.empty());
+  test.PublishersByProc(g_pUuid1, pubs);
+  ASSERT_EQ(pubs.size(), 1u);
+  EXPECT_EQ(pubs[g_nUuid2].size(), 10u);
+  EXPECT_TRUE(test.HasPublisher(g_addr1));
+
+  // Removing a process forgets its address, but not the other process.
+  EXPECT_TRUE(test.DelPublishersByProc(g_pUuid1));
+  EXPECT_FALSE(test.DelPublishersByProc(g_pUuid1));
+  EXPECT_FALSE(test.HasPublisher(g_addr1));
+  EXPECT_TRUE(test.HasPublisher(g_addr2));
+  test.PublishersByProc(g_pUuid1, pubs);
+  EXPECT_TRUE(pubs.empty());
+
+  std::vector<std::string> topics;
+  test.TopicList(topics);
+  EXPECT_EQ(topics.size(), 10u);
+
+  // The same publisher can be added again once removed.
+  EXPECT_TRUE(test.DelPublishersByProc(g_pUuid2));
+  EXPECT_FALSE(test.HasPublisher(g_addr2));
+  EXPECT_TRUE(test.AddPublisher(
+    Publisher(g_topic1, g_addr2, g_pUuid2, g_nUuid3, g_opts1)));
+  EXPECT_TRUE(test.HasPublisher(g_addr2));
+  test.PublishersByNode(g_pUuid2, g_nUuid3, nodePubs);
+  EXPECT_EQ(nodePubs.size(), 1u);
+}
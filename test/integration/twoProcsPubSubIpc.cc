@@ -0,0 +1,174 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+#include <ignition/msgs.hh>
+
+#include "gtest/gtest.h"
+#include "ignition/transport/Node.hh"
+#include "ignition/transport/test_config.h"
+
+using namespace ignition;
+
+static std::string partition;  // NOLINT(*)
+static std::string g_ipcDir;  // NOLINT(*)
+static const std::string g_topic = "/foo";  // NOLINT(*)
+static std::atomic<int> counter(0);
+
+//////////////////////////////////////////////////
+/// \brief Callback for receiving Vector3d data.
+void cbVector(const ignition::msgs::Vector3d &/*_msg*/)
+{
+  ++counter;
+}
+
+//////////////////////////////////////////////////
+/// \brief Get the inter-process endpoints bound in a directory.
+/// \param[in] _dir The directory.
+/// \return The paths of the endpoints.
+static std::vector<std::string> ipcEndpoints(const std::string &_dir)
+{
+  std::vector<std::string> endpoints;
+  DIR *dir = opendir(_dir.c_str());
+  if (!dir)
+    return endpoints;
+
+  const std::string prefix = "ign-transport-";
+  const std::string suffix = ".pub";
+  while (struct dirent *entry = readdir(dir))
+  {
+    const std::string name = entry->d_name;
+    const std::string path = _dir + "/" + name;
+    struct stat st;
+    if (name.size() > prefix.size() + suffix.size() &&
+        name.compare(0, prefix.size(), prefix) == 0 &&
+        name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0 &&
+        stat(path.c_str(), &st) == 0 && S_ISSOCK(st.st_mode))
+    {
+      endpoints.push_back(path);
+    }
+  }
+  closedir(dir);
+  return endpoints;
+}
+
+//////////////////////////////////////////////////
+/// \brief Run the publisher in another process and check that its messages
+/// are received.
+/// \param[in] _ipc Whether the publisher is expected to bind an
+/// inter-process endpoint.
+static void checkPubSub(const bool _ipc)
+{
+  counter = 0;
+  const std::size_t endpoints = ipcEndpoints(g_ipcDir).size();
+
+  std::string publisherPath = testing::portablePathUnion(
+     IGN_TRANSPORT_TEST_DIR,
+     "INTEGRATION_twoProcsPublisher_aux");
+
+  testing::forkHandlerType pi = testing::forkAndRun(publisherPath.c_str(),
+    partition.c_str());
+
+  // Restore the environment changed for the publisher.
+  unsetenv("IGN_TRANSPORT_IPC");
+  setenv("IGN_TRANSPORT_IPC_DIR", g_ipcDir.c_str(), 1);
+
+  transport::Node node;
+  EXPECT_TRUE(node.Subscribe(g_topic, cbVector));
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(500));
+  EXPECT_EQ(endpoints + (_ipc ? 1u : 0u), ipcEndpoints(g_ipcDir).size());
+
+  testing::waitAndCleanupFork(pi);
+
+  // The publisher sends the second message after the connection was made.
+  EXPECT_GT(counter, 0);
+}
+
+//////////////////////////////////////////////////
+/// \brief Publishers and subscribers running on the same host exchange
+/// messages through the inter-process endpoint of the publisher.
+TEST(twoProcPubSubIpc, PubSubIpc)
+{
+  checkPubSub(true);
+}
+
+//////////////////////////////////////////////////
+/// \brief A publisher with the inter-process transport disabled doesn't
+/// bind an inter-process endpoint, and its subscribers fall back to TCP.
+TEST(twoProcPubSubIpc, PubSubIpcDisabled)
+{
+  setenv("IGN_TRANSPORT_IPC", "0", 1);
+  checkPubSub(false);
+}
+
+//////////////////////////////////////////////////
+/// \brief A publisher that can't bind its inter-process endpoint only uses
+/// TCP, and its subscribers fall back to it.
+TEST(twoProcPubSubIpc, PubSubIpcUnavailable)
+{
+  setenv("IGN_TRANSPORT_IPC_DIR", (g_ipcDir + "/missing").c_str(), 1);
+  checkPubSub(false);
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  // Get a random partition name.
+  partition = testing::getRandomNumber();
+
+  // Set the partition name for this process.
+  setenv("IGN_PARTITION", partition.c_str(), 1);
+
+  // Bind the inter-process endpoints in a directory of this test, so we can
+  // check which processes bound one.
+  char dir[] = "/tmp/ign-transport-ipc-XXXXXX";
+  if (!mkdtemp(dir))
+  {
+    std::cerr << "Unable to create a temporary directory" << std::endl;
+    return -1;
+  }
+  g_ipcDir = dir;
+  setenv("IGN_TRANSPORT_IPC_DIR", g_ipcDir.c_str(), 1);
+  unsetenv("IGN_TRANSPORT_IPC");
+
+  // Bind the endpoint of this process before the tests count them.
+  transport::Node node;
+  if (ipcEndpoints(g_ipcDir).empty())
+  {
+    std::cerr << "The inter-process endpoint wasn't bound" << std::endl;
+    return -1;
+  }
+
+  ::testing::InitGoogleTest(&argc, argv);
+  const int result = RUN_ALL_TESTS();
+
+  for (const auto &endpoint : ipcEndpoints(g_ipcDir))
+    unlink(endpoint.c_str());
+  rmdir(g_ipcDir.c_str());
+
+  return result;
+}
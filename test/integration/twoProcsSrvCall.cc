@@ -16,7 +16,10 @@
 */
 #include <chrono>
 #include <cstdlib>
+#include <future>
 #include <string>
+#include <utility>
+#include <vector>
 #include <ignition/msgs.hh>
 
 #include "ignition/transport/Node.hh"
@@ -114,6 +117,85 @@ TEST(twoProcSrvCall, SrvTwoProcs)
   testing::waitAndCleanupFork(pi);
 }
 
+//////////////////////////////////////////////////
+/// \brief Keep many asynchronous requests in flight to the same responser
+/// and check that every future gets the response to its own request.
+TEST(twoProcSrvCall, SrvTwoProcsPipelined)
+{
+  std::string responser_path = testing::portablePathUnion(
+    IGN_TRANSPORT_TEST_DIR,
+    "INTEGRATION_twoProcsSrvCallReplier_aux");
+
+  testing::forkHandlerType pi = testing::forkAndRun(responser_path.c_str(),
+    partition.c_str());
+
+  const int kRequests = 1000;
+
+  transport::Node node;
+  std::vector<std::future<std::pair<ignition::msgs::Int32, bool>>> futures;
+  for (int i = 0; i < kRequests; ++i)
+  {
+    ignition::msgs::Int32 req;
+    req.set_data(i);
+    futures.push_back(
+      node.RequestAsync<ignition::msgs::Int32, ignition::msgs::Int32>(
+        g_topic, req, 5000));
+    EXPECT_TRUE(futures.back().valid());
+  }
+
+  auto deadline =
+    std::chrono::steady_clock::now() + std::chrono::milliseconds(5000);
+  for (int i = 0; i < kRequests; ++i)
+  {
+    auto status = futures[i].wait_until(deadline);
+    EXPECT_EQ(status, std::future_status::ready);
+    if (status != std::future_status::ready)
+      continue;
+
+    auto response = futures[i].get();
+    EXPECT_EQ(response.first.data(), i);
+    EXPECT_TRUE(response.second);
+  }
+
+  // Wait for the child process to return.
+  testing::waitAndCleanupFork(pi);
+}
+
+//////////////////////////////////////////////////
+/// \brief Send a batch of requests to a responser in another process and
+/// check that every response matches its request.
+TEST(twoProcSrvCall, SrvTwoProcsBatch)
+{
+  std::string responser_path = testing::portablePathUnion(
+    IGN_TRANSPORT_TEST_DIR,
+    "INTEGRATION_twoProcsSrvCallReplier_aux");
+
+  testing::forkHandlerType pi = testing::forkAndRun(responser_path.c_str(),
+    partition.c_str());
+
+  const int kRequests = 100;
+  std::vector<ignition::msgs::Int32> reqs(kRequests);
+  for (int i = 0; i < kRequests; ++i)
+    reqs[i].set_data(i);
+
+  std::vector<ignition::msgs::Int32> reps;
+  std::vector<bool> results;
+  unsigned int timeout = 5000;
+
+  transport::Node node;
+  EXPECT_TRUE(node.RequestBatch(g_topic, reqs, timeout, reps, results));
+  ASSERT_EQ(reps.size(), reqs.size());
+  ASSERT_EQ(results.size(), reqs.size());
+  for (int i = 0; i < kRequests; ++i)
+  {
+    EXPECT_EQ(reps[i].data(), i);
+    EXPECT_TRUE(results[i]);
+  }
+
+  // Wait for the child process to return.
+  testing::waitAndCleanupFork(pi);
+}
+
 //////////////////////////////////////////////////
 /// \brief This test spawns a service responser and a service requester. The
 /// requester uses a wrong type for the request argument. The test should verify
@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <future>
+#include <string>
+#include <thread>
+#include <ignition/msgs.hh>
+
+#include "ignition/transport/Node.hh"
+#include "gtest/gtest.h"
+#include "ignition/transport/test_config.h"
+
+using namespace ignition;
+
+static std::string partition; // NOLINT(*)
+static std::string g_slowTopic = "/slow"; // NOLINT(*)
+static std::string g_fastTopic = "/fast"; // NOLINT(*)
+static std::atomic<int> counter{0};
+
+//////////////////////////////////////////////////
+/// \brief Service call response callback.
+void response(const ignition::msgs::Int32 &_rep, const bool _result)
+{
+  EXPECT_EQ(_rep.data(), 5);
+  EXPECT_TRUE(_result);
+  ++counter;
+}
+
+//////////////////////////////////////////////////
+/// \brief The replier runs the requests of a service with a maximum
+/// concurrency on its own threads: several slow requests run at the same
+/// time and they don't block the other services.
+TEST(twoProcSrvCallConcurrent, SrvConcurrentRequests)
+{
+  std::string responser_path = testing::portablePathUnion(
+    IGN_TRANSPORT_TEST_DIR,
+    "INTEGRATION_twoProcsSrvCallConcurrentReplier_aux");
+
+  testing::forkHandlerType pi = testing::forkAndRun(responser_path.c_str(),
+    partition.c_str());
+
+  ignition::msgs::Int32 req;
+  req.set_data(5);
+  ignition::msgs::Int32 rep;
+  bool result;
+
+  transport::Node node;
+
+  // Wait until the replier is up.
+  EXPECT_TRUE(node.Request(g_fastTopic, req, 5000u, rep, result));
+  EXPECT_TRUE(result);
+
+  // Each slow request takes 1 second. Running one after the other, four of
+  // them would take 4 seconds.
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < 4; ++i)
+    EXPECT_TRUE(node.Request(g_slowTopic, req, response));
+
+  // The fast service replies while the slow requests are running.
+  EXPECT_TRUE(node.Request(g_fastTopic, req, 500u, rep, result));
+  EXPECT_TRUE(result);
+  EXPECT_EQ(0, counter);
+
+  int i = 0;
+  while (i < 300 && counter < 4)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ++i;
+  }
+  auto elapsed = std::chrono::steady_clock::now() - start;
+
+  EXPECT_EQ(4, counter);
+  EXPECT_LT(elapsed, std::chrono::milliseconds(2500));
+
+  // Wait for the child process to return.
+  testing::waitAndCleanupFork(pi);
+}
+
+//////////////////////////////////////////////////
+/// \brief The responser of an asynchronous request goes away before
+/// replying: the request is abandoned after its timeout and the future gets
+/// a failed result.
+TEST(twoProcSrvCallConcurrent, SrvAsyncResponserGone)
+{
+  std::string responser_path = testing::portablePathUnion(
+    IGN_TRANSPORT_TEST_DIR,
+    "INTEGRATION_twoProcsSrvCallConcurrentReplier_aux");
+
+  testing::forkHandlerType pi = testing::forkAndRun(responser_path.c_str(),
+    partition.c_str());
+
+  ignition::msgs::Int32 req;
+  req.set_data(5);
+  ignition::msgs::Int32 rep;
+  bool result;
+
+  transport::Node node;
+
+  // Wait until the replier is up.
+  EXPECT_TRUE(node.Request(g_fastTopic, req, 5000u, rep, result));
+  EXPECT_TRUE(result);
+
+  // The slow service takes 1 second to reply, the replier is stopped before.
+  auto future = node.RequestAsync<ignition::msgs::Int32,
+    ignition::msgs::Int32>(g_slowTopic, req, 2000u);
+  ASSERT_TRUE(future.valid());
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  testing::killFork(pi);
+  testing::waitAndCleanupFork(pi);
+
+  ASSERT_EQ(future.wait_for(std::chrono::milliseconds(5000)),
+    std::future_status::ready);
+  auto response = future.get();
+  EXPECT_EQ(response.first.data(), 0);
+  EXPECT_FALSE(response.second);
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  // Get a random partition name.
+  partition = testing::getRandomNumber();
+
+  // Set the partition name for this process.
+  setenv("IGN_PARTITION", partition.c_str(), 1);
+
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <ignition/msgs.hh>
+
+#include "ignition/transport/Node.hh"
+#include "gtest/gtest.h"
+#include "ignition/transport/test_config.h"
+
+using namespace ignition;
+
+static std::string g_slowTopic = "/slow"; // NOLINT(*)
+static std::string g_fastTopic = "/fast"; // NOLINT(*)
+
+//////////////////////////////////////////////////
+/// \brief Provide a slow service.
+bool srvSlowEcho(const ignition::msgs::Int32 &_req,
+  ignition::msgs::Int32 &_rep)
+{
+  std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+  _rep.set_data(_req.data());
+  return true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Provide a fast service.
+bool srvFastEcho(const ignition::msgs::Int32 &_req,
+  ignition::msgs::Int32 &_rep)
+{
+  _rep.set_data(_req.data());
+  return true;
+}
+
+//////////////////////////////////////////////////
+void runReplier()
+{
+  transport::Node node;
+
+  // The slow service runs up to 4 requests at the same time, on its own
+  // threads.
+  transport::AdvertiseServiceOptions opts;
+  opts.SetMaxConcurrency(4u);
+  EXPECT_TRUE(node.Advertise(g_slowTopic, srvSlowEcho, opts));
+  EXPECT_TRUE(node.Advertise(g_fastTopic, srvFastEcho));
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(8000));
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  if (argc != 2)
+  {
+    std::cerr << "Partition name has not be passed as argument" << std::endl;
+    return -1;
+  }
+
+  // Set the partition name for this test.
+  setenv("IGN_PARTITION", argv[1], 1);
+
+  runReplier();
+}
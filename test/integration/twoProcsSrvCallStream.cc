@@ -0,0 +1,172 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+#include <ignition/msgs.hh>
+
+#include "ignition/transport/Node.hh"
+#include "gtest/gtest.h"
+#include "ignition/transport/test_config.h"
+
+using namespace ignition;
+
+static std::string partition; // NOLINT(*)
+static std::string g_topic = "/stream"; // NOLINT(*)
+
+//////////////////////////////////////////////////
+/// \brief Wait until a flag is set or 5 seconds elapse.
+/// \param[in] _flag The flag.
+static void waitFor(const std::atomic<bool> &_flag)
+{
+  int i = 0;
+  while (i < 500 && !_flag)
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    ++i;
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Receive a long streamed response from another process. The
+/// chunk callback is slow, so the responser has to wait for it, and every
+/// chunk arrives once and in order.
+TEST(twoProcSrvCallStream, SrvStream)
+{
+  std::string responser_path = testing::portablePathUnion(
+    IGN_TRANSPORT_TEST_DIR,
+    "INTEGRATION_twoProcsSrvCallStreamReplier_aux");
+
+  testing::forkHandlerType pi = testing::forkAndRun(responser_path.c_str(),
+    partition.c_str());
+
+  const int kChunks = 200;
+  ignition::msgs::Int32 req;
+  req.set_data(kChunks);
+
+  std::vector<int> chunks;
+  std::atomic<bool> done{false};
+  std::atomic<bool> result{false};
+
+  std::function<bool(const ignition::msgs::Int32 &)> chunkCb =
+    [&chunks](const ignition::msgs::Int32 &_chunk)
+  {
+    // Slower than the responser.
+    if (chunks.size() < 40u)
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    chunks.push_back(_chunk.data());
+    return true;
+  };
+  std::function<void(const bool)> doneCb =
+    [&done, &result](const bool _result)
+  {
+    result = _result;
+    done = true;
+  };
+
+  transport::Node node;
+  EXPECT_TRUE(node.RequestStream(g_topic, req, chunkCb, doneCb));
+
+  waitFor(done);
+  EXPECT_TRUE(done);
+  EXPECT_TRUE(result);
+  ASSERT_EQ(chunks.size(), static_cast<std::size_t>(kChunks));
+  for (int i = 0; i < kChunks; ++i)
+    EXPECT_EQ(chunks[i], i);
+
+  // Wait for the child process to return.
+  testing::waitAndCleanupFork(pi);
+}
+
+//////////////////////////////////////////////////
+/// \brief Stop a streamed response from another process. No chunk arrives
+/// after the callback asked to stop.
+TEST(twoProcSrvCallStream, SrvStreamStop)
+{
+  std::string responser_path = testing::portablePathUnion(
+    IGN_TRANSPORT_TEST_DIR,
+    "INTEGRATION_twoProcsSrvCallStreamReplier_aux");
+
+  testing::forkHandlerType pi = testing::forkAndRun(responser_path.c_str(),
+    partition.c_str());
+
+  ignition::msgs::Int32 req;
+  req.set_data(1000000);
+
+  std::atomic<int> received{0};
+  std::atomic<bool> done{false};
+  std::atomic<bool> result{true};
+
+  std::function<bool(const ignition::msgs::Int32 &)> chunkCb =
+    [&received](const ignition::msgs::Int32 &)
+  {
+    return ++received < 5;
+  };
+  std::function<void(const bool)> doneCb =
+    [&done, &result](const bool _result)
+  {
+    result = _result;
+    done = true;
+  };
+
+  transport::Node node;
+  EXPECT_TRUE(node.RequestStream(g_topic, req, chunkCb, doneCb));
+
+  waitFor(done);
+  EXPECT_TRUE(done);
+  EXPECT_FALSE(result);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  EXPECT_EQ(received, 5);
+
+  // The responser is free for another stream.
+  req.set_data(10);
+  done = false;
+  received = 0;
+  chunkCb = [&received](const ignition::msgs::Int32 &)
+  {
+    ++received;
+    return true;
+  };
+  EXPECT_TRUE(node.RequestStream(g_topic, req, chunkCb, doneCb));
+
+  waitFor(done);
+  EXPECT_TRUE(done);
+  EXPECT_TRUE(result);
+  EXPECT_EQ(received, 10);
+
+  // Wait for the child process to return.
+  testing::waitAndCleanupFork(pi);
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  // Get a random partition name.
+  partition = testing::getRandomNumber();
+
+  // Set the partition name for this process.
+  setenv("IGN_PARTITION", partition.c_str(), 1);
+
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
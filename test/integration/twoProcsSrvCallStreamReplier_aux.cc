@@ -0,0 +1,74 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <thread>
+#include <ignition/msgs.hh>
+
+#include "ignition/transport/Node.hh"
+#include "gtest/gtest.h"
+#include "ignition/transport/test_config.h"
+
+using namespace ignition;
+
+static std::string g_topic = "/stream"; // NOLINT(*)
+
+//////////////////////////////////////////////////
+/// \brief Provide a service that streams as many chunks as requested.
+bool srvStream(const ignition::msgs::Int32 &_req,
+  const std::function<bool(const ignition::msgs::Int32 &)> &_send)
+{
+  ignition::msgs::Int32 chunk;
+  for (int i = 0; i < _req.data(); ++i)
+  {
+    chunk.set_data(i);
+    if (!_send(chunk))
+      return false;
+  }
+  return true;
+}
+
+//////////////////////////////////////////////////
+void runReplier()
+{
+  transport::Node node;
+
+  // Two streams can run at the same time.
+  transport::AdvertiseServiceOptions opts;
+  opts.SetMaxConcurrency(2u);
+  EXPECT_TRUE((node.AdvertiseStream<ignition::msgs::Int32,
+    ignition::msgs::Int32>(g_topic, srvStream, opts)));
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(8000));
+}
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  if (argc != 2)
+  {
+    std::cerr << "Partition name has not be passed as argument" << std::endl;
+    return -1;
+  }
+
+  // Set the partition name for this test.
+  setenv("IGN_PARTITION", argv[1], 1);
+
+  runReplier();
+}
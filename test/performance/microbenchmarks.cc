@@ -0,0 +1,757 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+/// \file microbenchmarks.cc
+/// \brief Microbenchmarks of the hot paths of ign-transport. Run the
+/// executable with
+///
+///   --benchmark_out=results.json --benchmark_out_format=json
+///
+/// to store the results in a machine-readable format, and with
+/// --benchmark_filter=<regex> to run a subset of the benchmarks.
+/// The benchmarks named "*Remote*" and "Service*" talk to
+/// PERFORMANCE_microbenchmarks_aux, which runs in another process.
+
+#include <benchmark/benchmark.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <future>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <ignition/msgs.hh>
+
+#include "ignition/transport/AdvertiseOptions.hh"
+#include "ignition/transport/Discovery.hh"
+#include "ignition/transport/MessageInfo.hh"
+#include "ignition/transport/Node.hh"
+#include "ignition/transport/NodeOptions.hh"
+#include "ignition/transport/NodeShared.hh"
+#include "ignition/transport/Publisher.hh"
+#include "ignition/transport/TopicStorage.hh"
+#include "ignition/transport/TopicUtils.hh"
+#include "ignition/transport/log/Log.hh"
+#include "ignition/transport/test_config.h"
+
+using namespace ignition;
+
+/// \brief Smallest message payload (bytes).
+static const int64_t kMinSize = 16;
+
+/// \brief Largest message payload (bytes).
+static const int64_t kMaxSize = 16 << 20;
+
+/// \brief Version carried by the discovery messages.
+static const uint32_t kDiscoveryVersion = transport::MsgDiscovery::Version();
+
+/// \brief Set when the auxiliary process answers, the remote benchmarks
+/// are skipped otherwise.
+static bool g_remoteReady = false;
+
+/// \brief Partition of the benchmarks.
+static std::string g_partition; // NOLINT(*)
+
+/// \brief Path of the auxiliary executable.
+static std::string g_auxPath; // NOLINT(*)
+
+//////////////////////////////////////////////////
+/// \brief Create a message with a payload of a given size.
+/// \param[in] _size Payload size (bytes).
+/// \return The message.
+static msgs::StringMsg makeMsg(const int64_t _size)
+{
+  msgs::StringMsg msg;
+  msg.set_data(std::string(static_cast<std::size_t>(_size), 'x'));
+  return msg;
+}
+
+//////////////////////////////////////////////////
+/// \brief Callback of the local subscribers, it does nothing.
+static void onStringMsg(const msgs::StringMsg &/*_msg*/)
+{
+}
+
+//////////////////////////////////////////////////
+/// \brief Get the fully qualified name of a topic of a node.
+/// \param[in] _node The node.
+/// \param[in] _topic Topic name.
+/// \return The fully qualified name.
+static std::string fullyQualified(const transport::Node &_node,
+                                  const std::string &_topic)
+{
+  std::string name;
+  transport::TopicUtils::FullyQualifiedName(_node.Options().Partition(),
+    _node.Options().NameSpace(), _topic, name);
+  return name;
+}
+
+//////////////////////////////////////////////////
+/// \brief Receives the replies of the auxiliary process.
+class PongSink
+{
+  /// \brief Constructor.
+  public: PongSink()
+  {
+    this->node.SubscribeRaw("/bench/pong",
+      [this](const char *, const size_t, const transport::MessageInfo &)
+      {
+        std::lock_guard<std::mutex> lk(this->mutex);
+        ++this->received;
+        this->cv.notify_all();
+      }, msgs::StringMsg().GetTypeName());
+  }
+
+  /// \brief Wait until a number of replies have been received.
+  /// \param[in] _count Number of replies.
+  /// \param[in] _timeout Maximum time to wait.
+  /// \return True if the replies arrived before the timeout.
+  public: bool WaitFor(const uint64_t _count,
+                       const std::chrono::milliseconds &_timeout)
+  {
+    std::unique_lock<std::mutex> lk(this->mutex);
+    return this->cv.wait_for(lk, _timeout,
+      [this, _count]{return this->received >= _count;});
+  }
+
+  /// \brief Get the number of replies received.
+  /// \return The number of replies.
+  public: uint64_t Received()
+  {
+    std::lock_guard<std::mutex> lk(this->mutex);
+    return this->received;
+  }
+
+  /// \brief Node subscribed to the replies.
+  private: transport::Node node;
+
+  /// \brief Protects received.
+  private: std::mutex mutex;
+
+  /// \brief Notified when a reply arrives.
+  private: std::condition_variable cv;
+
+  /// \brief Number of replies received.
+  private: uint64_t received = 0;
+};
+
+/// \brief The publisher to the auxiliary process.
+static std::unique_ptr<transport::Node> g_pingNode;
+
+/// \brief Publisher of /bench/ping.
+static transport::Node::Publisher g_pingPub;
+
+/// \brief Receiver of /bench/pong.
+static std::unique_ptr<PongSink> g_pongSink;
+
+//////////////////////////////////////////////////
+/// \brief Publish to a subscriber in the same process.
+static void BM_PublishLocal(benchmark::State &_state)
+{
+  transport::Node node;
+  auto pub = node.Advertise<msgs::StringMsg>("/bench/local");
+  node.Subscribe("/bench/local", onStringMsg);
+
+  auto msg = makeMsg(_state.range(0));
+  for (auto _ : _state)
+    benchmark::DoNotOptimize(pub.Publish(msg));
+
+  _state.SetBytesProcessed(_state.iterations() * _state.range(0));
+}
+BENCHMARK(BM_PublishLocal)->RangeMultiplier(16)->Range(kMinSize, kMaxSize);
+
+//////////////////////////////////////////////////
+/// \brief Publish a serialized message to a raw subscriber in the same
+/// process.
+static void BM_PublishRawLocal(benchmark::State &_state)
+{
+  transport::Node node;
+  auto pub = node.Advertise<msgs::StringMsg>("/bench/raw");
+  node.SubscribeRaw("/bench/raw",
+    [](const char *, const size_t, const transport::MessageInfo &){},
+    msgs::StringMsg().GetTypeName());
+
+  std::string data;
+  makeMsg(_state.range(0)).SerializeToString(&data);
+  const std::string type = msgs::StringMsg().GetTypeName();
+  for (auto _ : _state)
+    benchmark::DoNotOptimize(pub.PublishRaw(data, type));
+
+  _state.SetBytesProcessed(_state.iterations() * _state.range(0));
+}
+BENCHMARK(BM_PublishRawLocal)->RangeMultiplier(16)->Range(kMinSize, kMaxSize);
+
+//////////////////////////////////////////////////
+/// \brief Round trip of a message to another process: the time between
+/// publishing it and receiving the copy that the other process sends back.
+static void BM_PublishRemote(benchmark::State &_state)
+{
+  if (!g_remoteReady)
+  {
+    _state.SkipWithError("The auxiliary process isn't available");
+    return;
+  }
+
+  auto msg = makeMsg(_state.range(0));
+  for (auto _ : _state)
+  {
+    const uint64_t expected = g_pongSink->Received() + 1;
+    g_pingPub.Publish(msg);
+    if (!g_pongSink->WaitFor(expected, std::chrono::seconds(5)))
+    {
+      _state.SkipWithError("Timeout waiting for the reply");
+      break;
+    }
+  }
+
+  _state.SetBytesProcessed(_state.iterations() * _state.range(0));
+}
+BENCHMARK(BM_PublishRemote)->RangeMultiplier(16)->Range(kMinSize, kMaxSize)
+  ->UseRealTime();
+
+//////////////////////////////////////////////////
+/// \brief Dispatch a received message to a subscriber, as RecvMsgUpdate()
+/// does once the data has arrived.
+static void BM_RecvDispatch(benchmark::State &_state)
+{
+  transport::Node node;
+  node.Subscribe("/bench/dispatch", onStringMsg);
+
+  auto data = std::make_shared<std::string>();
+  makeMsg(_state.range(0)).SerializeToString(data.get());
+
+  const std::string topic = fullyQualified(node, "/bench/dispatch");
+  transport::MessageInfo info;
+  info.SetTopicAndPartition(topic);
+  info.SetType(msgs::StringMsg().GetTypeName());
+
+  auto shared = transport::NodeShared::Instance();
+  for (auto _ : _state)
+  {
+    auto handlers = shared->CheckHandlerInfo(topic);
+    shared->TriggerCallbacks(info, data->data(), data->size(), data,
+      handlers);
+  }
+
+  _state.SetBytesProcessed(_state.iterations() * _state.range(0));
+}
+BENCHMARK(BM_RecvDispatch)->RangeMultiplier(16)->Range(kMinSize, kMaxSize);
+
+//////////////////////////////////////////////////
+/// \brief Look up the local subscribers of a topic when there are many
+/// subscribed topics.
+static void BM_HandlerStorageHandlers(benchmark::State &_state)
+{
+  transport::Node node;
+  for (int64_t i = 0; i < _state.range(0); ++i)
+  {
+    node.Subscribe("/bench/handlers/" + std::to_string(i), onStringMsg);
+  }
+
+  const std::string topic = fullyQualified(node, "/bench/handlers/0");
+  auto shared = transport::NodeShared::Instance();
+  std::map<std::string, transport::ISubscriptionHandler_M> handlers;
+  for (auto _ : _state)
+  {
+    benchmark::DoNotOptimize(
+      shared->localSubscribers.normal.Handlers(topic, handlers));
+  }
+}
+BENCHMARK(BM_HandlerStorageHandlers)->RangeMultiplier(10)->Range(1, 1000);
+
+//////////////////////////////////////////////////
+/// \brief Build the fully qualified name of a topic.
+static void BM_FullyQualifiedName(benchmark::State &_state)
+{
+  const std::string topic =
+    "/" + std::string(static_cast<std::size_t>(_state.range(0)), 't');
+  std::string name;
+  for (auto _ : _state)
+  {
+    benchmark::DoNotOptimize(transport::TopicUtils::FullyQualifiedName(
+      "partition", "/ns", topic, name));
+  }
+}
+BENCHMARK(BM_FullyQualifiedName)->RangeMultiplier(8)->Range(8, 512);
+
+//////////////////////////////////////////////////
+/// \brief Serialize the discovery message that advertises a topic.
+static void BM_DiscoveryEncode(benchmark::State &_state)
+{
+  transport::MessagePublisher publisher("/bench/discovery",
+    "tcp://127.0.0.1:12345", "tcp://127.0.0.1:12346",
+    "process-uuid", "node-uuid", msgs::StringMsg().GetTypeName(),
+    transport::AdvertiseMessageOptions());
+
+  std::string buffer;
+  for (auto _ : _state)
+  {
+    msgs::Discovery msg;
+    msg.set_version(kDiscoveryVersion);
+    msg.set_type(msgs::Discovery::ADVERTISE);
+    msg.set_process_uuid("process-uuid");
+    publisher.FillDiscovery(msg);
+    msg.SerializeToString(&buffer);
+    benchmark::DoNotOptimize(buffer.data());
+  }
+}
+BENCHMARK(BM_DiscoveryEncode);
+
+//////////////////////////////////////////////////
+/// \brief Parse the discovery message that advertises a topic.
+static void BM_DiscoveryDecode(benchmark::State &_state)
+{
+  transport::MessagePublisher publisher("/bench/discovery",
+    "tcp://127.0.0.1:12345", "tcp://127.0.0.1:12346",
+    "process-uuid", "node-uuid", msgs::StringMsg().GetTypeName(),
+    transport::AdvertiseMessageOptions());
+
+  msgs::Discovery original;
+  original.set_version(kDiscoveryVersion);
+  original.set_type(msgs::Discovery::ADVERTISE);
+  original.set_process_uuid("process-uuid");
+  publisher.FillDiscovery(original);
+  std::string buffer;
+  original.SerializeToString(&buffer);
+
+  for (auto _ : _state)
+  {
+    msgs::Discovery msg;
+    msg.ParseFromArray(buffer.data(), static_cast<int>(buffer.size()));
+    transport::MessagePublisher decoded;
+    decoded.SetFromDiscovery(msg);
+    benchmark::DoNotOptimize(decoded.Topic().data());
+  }
+}
+BENCHMARK(BM_DiscoveryDecode);
+
+//////////////////////////////////////////////////
+/// \brief Pack the advertisements of many topics into datagrams, as when a
+/// process sends all its topics.
+static void BM_DiscoveryPack(benchmark::State &_state)
+{
+  std::vector<msgs::Discovery> discoveryMsgs(_state.range(0));
+  for (std::size_t i = 0; i < discoveryMsgs.size(); ++i)
+  {
+    transport::MessagePublisher publisher(
+      "/bench/discovery/" + std::to_string(i),
+      "tcp://127.0.0.1:12345", "tcp://127.0.0.1:12346",
+      "process-uuid", "node-uuid", msgs::StringMsg().GetTypeName(),
+      transport::AdvertiseMessageOptions());
+    discoveryMsgs[i].set_version(kDiscoveryVersion);
+    discoveryMsgs[i].set_type(msgs::Discovery::ADVERTISE);
+    discoveryMsgs[i].set_process_uuid("process-uuid");
+    publisher.FillDiscovery(discoveryMsgs[i]);
+  }
+
+  std::vector<std::string> datagrams;
+  for (auto _ : _state)
+  {
+    transport::packDiscoveryMsgs(discoveryMsgs, 1400u, datagrams);
+    benchmark::DoNotOptimize(datagrams.data());
+  }
+
+  _state.counters["datagrams"] = static_cast<double>(datagrams.size());
+  _state.SetItemsProcessed(_state.iterations() * _state.range(0));
+}
+BENCHMARK(BM_DiscoveryPack)->Arg(1)->Arg(100)->Arg(3000);
+
+//////////////////////////////////////////////////
+/// \brief Topics and processes of the storage benchmarks.
+static const int kStorageTopics = 10000;
+static const int kStorageProcs = 100;
+
+//////////////////////////////////////////////////
+/// \brief Fill a storage with kStorageTopics topics, each one advertised by
+/// one of kStorageProcs processes.
+static void fillStorage(transport::TopicStorage<transport::Publisher> &_storage)
+{
+  for (int i = 0; i < kStorageTopics; ++i)
+  {
+    const std::string proc = std::to_string(i % kStorageProcs);
+    _storage.AddPublisher(transport::Publisher(
+      "/bench/storage/" + std::to_string(i), "tcp://10.0.0.1:" + proc,
+      "process-" + proc, "node-" + proc, transport::AdvertiseOptions()));
+  }
+}
+
+//////////////////////////////////////////////////
+/// \brief Look up the publishers of a process and the publishers of an
+/// address in a large storage.
+static void BM_TopicStorageByProc(benchmark::State &_state)
+{
+  transport::TopicStorage<transport::Publisher> storage;
+  fillStorage(storage);
+
+  std::map<std::string, std::vector<transport::Publisher>> pubs;
+  int proc = 0;
+  for (auto _ : _state)
+  {
+    const std::string suffix = std::to_string(proc++ % kStorageProcs);
+    storage.PublishersByProc("process-" + suffix, pubs);
+    benchmark::DoNotOptimize(
+      storage.HasPublisher("tcp://10.0.0.1:" + suffix));
+  }
+}
+BENCHMARK(BM_TopicStorageByProc);
+
+//////////////////////////////////////////////////
+/// \brief Remove all the publishers of a process from a large storage, as
+/// when a process stops sending heartbeats.
+static void BM_TopicStorageDelByProc(benchmark::State &_state)
+{
+  transport::TopicStorage<transport::Publisher> storage;
+  fillStorage(storage);
+
+  int proc = 0;
+  for (auto _ : _state)
+  {
+    const std::string pUuid = "process-" + std::to_string(proc);
+    benchmark::DoNotOptimize(storage.DelPublishersByProc(pUuid));
+
+    // Put the process back, out of the measurement.
+    _state.PauseTiming();
+    for (int i = proc; i < kStorageTopics; i += kStorageProcs)
+    {
+      storage.AddPublisher(transport::Publisher(
+        "/bench/storage/" + std::to_string(i),
+        "tcp://10.0.0.1:" + std::to_string(proc), pUuid,
+        "node-" + std::to_string(proc), transport::AdvertiseOptions()));
+    }
+    proc = (proc + 1) % kStorageProcs;
+    _state.ResumeTiming();
+  }
+}
+BENCHMARK(BM_TopicStorageDelByProc);
+
+//////////////////////////////////////////////////
+/// \brief Round trip of a service request to another process.
+static void BM_ServiceRequest(benchmark::State &_state)
+{
+  if (!g_remoteReady)
+  {
+    _state.SkipWithError("The auxiliary process isn't available");
+    return;
+  }
+
+  transport::Node node;
+  auto req = makeMsg(_state.range(0));
+  msgs::StringMsg rep;
+  bool result;
+  for (auto _ : _state)
+  {
+    if (!node.Request("/bench/echo", req, 5000u, rep, result) || !result)
+    {
+      _state.SkipWithError("Service request failed");
+      break;
+    }
+  }
+
+  _state.SetBytesProcessed(_state.iterations() * _state.range(0));
+}
+BENCHMARK(BM_ServiceRequest)->RangeMultiplier(16)->Range(kMinSize, kMaxSize)
+  ->UseRealTime();
+
+//////////////////////////////////////////////////
+/// \brief Throughput of asynchronous service requests, keeping a window of
+/// range(0) requests in flight to the same responser.
+static void BM_ServiceRequestPipelined(benchmark::State &_state)
+{
+  if (!g_remoteReady)
+  {
+    _state.SkipWithError("The auxiliary process isn't available");
+    return;
+  }
+
+  transport::Node node;
+  auto req = makeMsg(kMinSize);
+  const auto window = static_cast<std::size_t>(_state.range(0));
+  std::vector<std::future<std::pair<msgs::StringMsg, bool>>> futures;
+  futures.reserve(window);
+  for (auto _ : _state)
+  {
+    futures.clear();
+    for (std::size_t i = 0; i < window; ++i)
+    {
+      futures.push_back(node.RequestAsync<msgs::StringMsg, msgs::StringMsg>(
+        "/bench/echo", req, 5000));
+    }
+
+    bool ok = true;
+    for (auto &future : futures)
+    {
+      ok = ok && future.valid() &&
+        future.wait_for(std::chrono::seconds(5)) == std::future_status::ready
+        && future.get().second;
+    }
+
+    if (!ok)
+    {
+      _state.SkipWithError("Service request failed");
+      break;
+    }
+  }
+
+  _state.SetItemsProcessed(_state.iterations() * _state.range(0));
+}
+BENCHMARK(BM_ServiceRequestPipelined)->RangeMultiplier(8)->Range(1, 4096)
+  ->UseRealTime();
+
+//////////////////////////////////////////////////
+/// \brief Throughput of batches of range(0) service requests sent in a
+/// single message.
+static void BM_ServiceRequestBatch(benchmark::State &_state)
+{
+  if (!g_remoteReady)
+  {
+    _state.SkipWithError("The auxiliary process isn't available");
+    return;
+  }
+
+  transport::Node node;
+  std::vector<msgs::StringMsg> reqs(_state.range(0), makeMsg(kMinSize));
+  std::vector<msgs::StringMsg> reps;
+  std::vector<bool> results;
+  for (auto _ : _state)
+  {
+    if (!node.RequestBatch("/bench/echo", reqs, 5000u, reps, results))
+    {
+      _state.SkipWithError("Service request failed");
+      break;
+    }
+  }
+
+  _state.SetItemsProcessed(_state.iterations() * _state.range(0));
+}
+BENCHMARK(BM_ServiceRequestBatch)->RangeMultiplier(8)->Range(1, 4096)
+  ->UseRealTime();
+
+//////////////////////////////////////////////////
+/// \brief Wait until a service is discovered.
+/// \param[in] _node Node used to discover the service.
+/// \param[in] _service Service name.
+/// \return True if the service was discovered.
+static bool waitForService(const transport::Node &_node,
+                           const std::string &_service)
+{
+  std::vector<transport::ServicePublisher> publishers;
+  for (int i = 0; i < 500; ++i)
+  {
+    if (_node.ServiceInfo(_service, publishers) && !publishers.empty())
+      return true;
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  return false;
+}
+
+//////////////////////////////////////////////////
+/// \brief Latency of the first request to a responser that was just
+/// discovered, which includes setting up the connections in both ways.
+/// Every iteration starts a new auxiliary process in a partition of its
+/// own, and only the request is timed.
+static void BM_ServiceFirstRequest(benchmark::State &_state)
+{
+  auto req = makeMsg(kMinSize);
+  msgs::StringMsg rep;
+  bool result;
+  int iteration = 0;
+  for (auto _ : _state)
+  {
+    const std::string partition =
+      g_partition + "_first_" + std::to_string(iteration++);
+    testing::forkHandlerType pi = testing::forkAndRun(g_auxPath.c_str(),
+      partition.c_str());
+
+    transport::NodeOptions opts;
+    opts.SetPartition(partition);
+    transport::Node node(opts);
+
+    bool ok = waitForService(node, "/bench/echo");
+    if (ok)
+    {
+      auto start = std::chrono::steady_clock::now();
+      ok = node.Request("/bench/echo", req, 5000u, rep, result) && result;
+      std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+      _state.SetIterationTime(elapsed.count());
+    }
+
+    testing::killFork(pi);
+    testing::waitAndCleanupFork(pi);
+
+    if (!ok)
+    {
+      _state.SkipWithError("The first request to the new responser failed");
+      break;
+    }
+  }
+}
+BENCHMARK(BM_ServiceFirstRequest)->Iterations(10)->UseManualTime();
+
+//////////////////////////////////////////////////
+/// \brief Insert a message in an in-memory log. The payload is capped at
+/// 1 MB, the database would grow to several GB with larger messages.
+static void BM_LogInsertMessage(benchmark::State &_state)
+{
+  transport::log::Log log;
+  if (!log.Open(":memory:", std::ios_base::out))
+  {
+    _state.SkipWithError("Unable to open the log");
+    return;
+  }
+
+  std::string data;
+  makeMsg(_state.range(0)).SerializeToString(&data);
+  const std::string type = msgs::StringMsg().GetTypeName();
+  int64_t time = 0;
+  for (auto _ : _state)
+  {
+    benchmark::DoNotOptimize(log.InsertMessage(
+      std::chrono::nanoseconds(++time), "/bench/log", type,
+      data.data(), data.size()));
+  }
+
+  _state.SetBytesProcessed(_state.iterations() * _state.range(0));
+}
+BENCHMARK(BM_LogInsertMessage)->RangeMultiplier(16)->Range(kMinSize, 1 << 20);
+
+//////////////////////////////////////////////////
+/// \brief Insert a batch of small messages, spread over a few topics, in an
+/// in-memory log. This is the recording throughput, in messages per second,
+/// when the recorder writes the batch of messages it received.
+static void BM_LogInsertMessages(benchmark::State &_state)
+{
+  transport::log::Log log;
+  if (!log.Open(":memory:", std::ios_base::out))
+  {
+    _state.SkipWithError("Unable to open the log");
+    return;
+  }
+
+  std::string data;
+  makeMsg(kMinSize).SerializeToString(&data);
+  const std::string type = msgs::StringMsg().GetTypeName();
+  std::vector<transport::log::RecordedMessage> batch;
+  for (int64_t i = 0; i < _state.range(0); ++i)
+  {
+    batch.push_back(transport::log::RecordedMessage{
+      std::chrono::nanoseconds(i), "/bench/log" + std::to_string(i % 4),
+      type, data});
+  }
+
+  for (auto _ : _state)
+  {
+    benchmark::DoNotOptimize(log.InsertMessages(batch));
+  }
+
+  _state.SetItemsProcessed(_state.iterations() * _state.range(0));
+}
+BENCHMARK(BM_LogInsertMessages)->RangeMultiplier(8)->Range(1, 4096);
+
+//////////////////////////////////////////////////
+/// \brief Read all the messages of an in-memory log, in the order of the time
+/// they were received, as the playback does. The argument selects whether the
+/// log stores every message in its own row (0) or in compressed chunks (1).
+static void BM_LogReadMessages(benchmark::State &_state)
+{
+  transport::log::LogProfile profile;
+  profile.chunked = _state.range(0) != 0;
+
+  transport::log::Log log;
+  if (!log.SetProfile(profile) || !log.Open(":memory:", std::ios_base::out))
+  {
+    _state.SkipWithError("Unable to open the log");
+    return;
+  }
+
+  std::string data;
+  makeMsg(kMinSize).SerializeToString(&data);
+  const std::string type = msgs::StringMsg().GetTypeName();
+  std::vector<transport::log::RecordedMessage> batch;
+  for (int64_t i = 0; i < 10000; ++i)
+  {
+    batch.push_back(transport::log::RecordedMessage{
+      std::chrono::nanoseconds(i), "/bench/log" + std::to_string(i % 4),
+      type, data});
+  }
+  log.InsertMessages(batch);
+
+  for (auto _ : _state)
+  {
+    for (const transport::log::Message &msg : log.QueryMessages())
+      benchmark::DoNotOptimize(msg.Data());
+  }
+
+  _state.SetItemsProcessed(_state.iterations() * batch.size());
+}
+BENCHMARK(BM_LogReadMessages)->Arg(0)->Arg(1);
+
+//////////////////////////////////////////////////
+int main(int argc, char **argv)
+{
+  // Run in a partition of our own, so the benchmarks don't see other
+  // processes.
+  g_partition = testing::getRandomNumber();
+  setenv("IGN_PARTITION", g_partition.c_str(), 1);
+  setenv(transport::log::SchemaLocationEnvVar.c_str(),
+    IGN_TRANSPORT_LOG_SQL_PATH, 1);
+
+  benchmark::Initialize(&argc, argv);
+  if (benchmark::ReportUnrecognizedArguments(argc, argv))
+    return 1;
+
+  g_auxPath = testing::portablePathUnion(
+    IGN_TRANSPORT_TEST_DIR, "PERFORMANCE_microbenchmarks_aux");
+  testing::forkHandlerType pi = testing::forkAndRun(g_auxPath.c_str(),
+    g_partition.c_str());
+
+  g_pingNode.reset(new transport::Node());
+  g_pingPub = g_pingNode->Advertise<msgs::StringMsg>("/bench/ping");
+  g_pongSink.reset(new PongSink());
+
+  // Wait until messages flow both ways.
+  const auto small = makeMsg(kMinSize);
+  for (int i = 0; i < 100 && !g_remoteReady; ++i)
+  {
+    g_pingPub.Publish(small);
+    g_remoteReady = g_pongSink->WaitFor(1, std::chrono::milliseconds(100));
+  }
+
+  if (!g_remoteReady)
+  {
+    std::cerr << "The auxiliary process didn't answer, the remote benchmarks "
+              << "will be skipped" << std::endl;
+  }
+
+  benchmark::RunSpecifiedBenchmarks();
+
+  g_pongSink.reset();
+  g_pingPub = transport::Node::Publisher();
+  g_pingNode.reset();
+
+  testing::killFork(pi);
+  testing::waitAndCleanupFork(pi);
+
+  return 0;
+}
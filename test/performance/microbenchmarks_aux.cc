@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2020 Open Source Robotics Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+*/
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <ignition/msgs.hh>
+
+#include "ignition/transport/Node.hh"
+
+using namespace ignition;
+
+//////////////////////////////////////////////////
+/// \brief Provide the echo service.
+bool srvEcho(const msgs::StringMsg &_req, msgs::StringMsg &_rep)
+{
+  _rep.set_data(_req.data());
+  return true;
+}
+
+//////////////////////////////////////////////////
+/// \brief Remote peer of the microbenchmarks. It sends back every message
+/// received on /bench/ping through /bench/pong and replies to /bench/echo
+/// until it's killed.
+int main(int argc, char **argv)
+{
+  if (argc != 2)
+  {
+    std::cerr << "Partition name has not be passed as argument" << std::endl;
+    return -1;
+  }
+
+  // Set the partition name for this process.
+  setenv("IGN_PARTITION", argv[1], 1);
+
+  transport::Node node;
+  auto pub = node.Advertise("/bench/pong",
+    msgs::StringMsg().GetTypeName());
+  if (!pub)
+  {
+    std::cerr << "Error advertising /bench/pong" << std::endl;
+    return -1;
+  }
+
+  auto cb = [&pub](const char *_msgData, const size_t _size,
+                   const transport::MessageInfo &/*_info*/)
+  {
+    pub.PublishRaw(std::string(_msgData, _size),
+      msgs::StringMsg().GetTypeName());
+  };
+
+  if (!node.SubscribeRaw("/bench/ping", cb, msgs::StringMsg().GetTypeName()))
+  {
+    std::cerr << "Error subscribing to /bench/ping" << std::endl;
+    return -1;
+  }
+
+  if (!node.Advertise("/bench/echo", srvEcho))
+  {
+    std::cerr << "Error advertising /bench/echo" << std::endl;
+    return -1;
+  }
+
+  transport::waitForShutdown();
+  return 0;
+}